@@ -20,6 +20,7 @@ using std::min;
 
 // MythTV headers
 #include "programinfoupdater.h"
+#include "programinfobinary.h"
 #include "mythcorecontext.h"
 #include "mythscheduler.h"
 #include "mythmiscutil.h"
@@ -1444,6 +1445,103 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     STR_FROM_LIST(m_inputName);           // 50
     DATETIME_FROM_LIST(m_bookmarkUpdate); // 51
 
+    FinishDeserialize(origChanid, origRecstartts);
+
+    return true;
+}
+
+/** \fn ProgramInfo::ToBinary(ProgramInfoPacker&) const
+ *  \brief Serializes ProgramInfo in the compact binary form of the
+ *         PROGINFO_BINARY_1 protocol extension.
+ *
+ *  The fields are those of ToStringList(), in the same order, but each
+ *  is written at its native width and the audio, video and subtitle
+ *  properties are kept together.
+ *  \sa FromBinary(ProgramInfoUnpacker&)
+ */
+void ProgramInfo::ToBinary(ProgramInfoPacker &out) const
+{
+    out << m_title << m_subtitle << m_description
+        << m_season << m_episode << m_totalEpisodes
+        << m_syndicatedEpisode << m_category
+        << m_chanId << m_chanStr << m_chanSign << m_chanName
+        << m_pathname << static_cast<quint64>(m_fileSize)
+
+        << m_startTs << m_endTs << m_findId << m_hostname
+        << m_sourceId << m_inputId << m_recPriority << m_recStatus
+        << m_recordId
+
+        << m_recType << m_dupIn << m_dupMethod
+        << m_recStartTs << m_recEndTs << m_programFlags
+        << (!m_recGroup.isEmpty() ? m_recGroup : "Default")
+        << m_chanPlaybackFilters << m_seriesId << m_programId << m_inetRef
+
+        << m_lastModified << m_stars << m_originalAirDate
+        << (!m_playGroup.isEmpty() ? m_playGroup : "Default")
+        << m_recPriority2 << m_parentId
+        << (!m_storageGroup.isEmpty() ? m_storageGroup : "Default")
+        << m_properties
+
+        << m_year << m_partNumber << m_partTotal
+        << static_cast<quint8>(m_catType)
+
+        << m_recordedId << m_inputName << m_bookmarkUpdate;
+}
+
+/** \fn ProgramInfo::FromBinary(ProgramInfoUnpacker&)
+ *  \brief Initializes this ProgramInfo from the next program written by
+ *         ToBinary().
+ *  \return true if it succeeds, false if the data is truncated or corrupt.
+ */
+bool ProgramInfo::FromBinary(ProgramInfoUnpacker &in)
+{
+    uint      origChanid     = m_chanId;
+    QDateTime origRecstartts = m_recStartTs;
+    quint64   filesize = 0;
+    quint8    cattype  = 0;
+
+    in >> m_title >> m_subtitle >> m_description
+       >> m_season >> m_episode >> m_totalEpisodes
+       >> m_syndicatedEpisode >> m_category
+       >> m_chanId >> m_chanStr >> m_chanSign >> m_chanName
+       >> m_pathname >> filesize
+
+       >> m_startTs >> m_endTs >> m_findId >> m_hostname
+       >> m_sourceId >> m_inputId >> m_recPriority >> m_recStatus
+       >> m_recordId
+
+       >> m_recType >> m_dupIn >> m_dupMethod
+       >> m_recStartTs >> m_recEndTs >> m_programFlags
+       >> m_recGroup
+       >> m_chanPlaybackFilters >> m_seriesId >> m_programId >> m_inetRef
+
+       >> m_lastModified >> m_stars >> m_originalAirDate
+       >> m_playGroup
+       >> m_recPriority2 >> m_parentId
+       >> m_storageGroup
+       >> m_properties
+
+       >> m_year >> m_partNumber >> m_partTotal
+       >> cattype
+
+       >> m_recordedId >> m_inputName >> m_bookmarkUpdate;
+
+    if (in.AtError())
+        return false;
+
+    m_fileSize = filesize;
+    m_catType = static_cast<CategoryType>(cattype);
+
+    FinishDeserialize(origChanid, origRecstartts);
+
+    return true;
+}
+
+/// Resets the state that is not serialized if this is now a different
+/// program, and updates the sort fields.
+void ProgramInfo::FinishDeserialize(uint origChanid,
+                                    const QDateTime &origRecstartts)
+{
     if (!origChanid || !origRecstartts.isValid() ||
         (origChanid != m_chanId) || (origRecstartts != m_recStartTs))
     {
@@ -1455,8 +1553,6 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     }
 
     ensureSortFields();
-
-    return true;
 }
 
 /** \brief Converts ProgramInfo into QString QHash containing each field
@@ -62,6 +62,8 @@ using ProgramList = AutoDeleteDeque<ProgramInfo*>;
 
 class MSqlQuery;
 class ProgramInfoUpdater;
+class ProgramInfoPacker;
+class ProgramInfoUnpacker;
 class PMapDBReplacement;
 
 class MPUBLIC ProgramInfo
@@ -294,6 +296,11 @@ class MPUBLIC ProgramInfo
         if (!FromStringList(it, list.end()))
             ProgramInfo::clear();
     }
+    explicit ProgramInfo(ProgramInfoUnpacker &in)
+    {
+        if (!FromBinary(in))
+            ProgramInfo::clear();
+    }
 
     bool operator==(const ProgramInfo& rhs);
     ProgramInfo &operator=(const ProgramInfo &other);
@@ -308,6 +315,7 @@ class MPUBLIC ProgramInfo
 
     // Serializers
     void ToStringList(QStringList &list) const;
+    void ToBinary(ProgramInfoPacker &out) const;
     virtual void ToMap(InfoMap &progMap,
                        bool showrerecord = false,
                        uint star_range = 10) const;
@@ -729,6 +737,8 @@ class MPUBLIC ProgramInfo
 
     bool FromStringList(QStringList::const_iterator &it,
                         const QStringList::const_iterator&  end);
+    bool FromBinary(ProgramInfoUnpacker &in);
+    void FinishDeserialize(uint origChanid, const QDateTime &origRecstartts);
 
     static void QueryMarkupMap(
         const QString &video_pathname,
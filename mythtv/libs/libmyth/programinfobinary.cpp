@@ -0,0 +1,188 @@
+// C++ headers
+#include <array>
+#include <cstring>
+#include <limits>
+
+// MythTV headers
+#include "programinfobinary.h"
+#include "programinfo.h"
+#include "mythdate.h"
+#include "mythlogging.h"
+
+#define LOC QString("ProgramInfoBinary: ")
+
+static constexpr std::array<char,4> kMagic { 'M', 'P', 'I', 'B' };
+static constexpr int kHeaderSize { 4 + 1 + 1 + 4 };
+/// Written for invalid dates and times, as QDate uses for its julian day.
+static constexpr qint64 kInvalid { std::numeric_limits<qint64>::min() };
+
+static void init_stream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+ProgramInfoPacker::ProgramInfoPacker()
+  : m_stream(&m_body, QIODevice::WriteOnly)
+{
+    init_stream(m_stream);
+}
+
+void ProgramInfoPacker::Add(const ProgramInfo &pginfo)
+{
+    pginfo.ToBinary(*this);
+    m_count++;
+}
+
+/** \brief Returns the header and the programs added so far.
+ *
+ *  The body is only compressed if asked to and it is large enough for
+ *  that to be worthwhile.
+ */
+QByteArray ProgramInfoPacker::Finish(bool compress)
+{
+    compress = compress && (m_body.size() >= kCompressMin);
+
+    QByteArray data;
+    {
+        QDataStream header(&data, QIODevice::WriteOnly);
+        init_stream(header);
+        header.writeRawData(kMagic.data(), kMagic.size());
+        header << kVersion << static_cast<quint8>(compress ? kCompressed : 0)
+               << static_cast<quint32>(m_count);
+    }
+    data += compress ? qCompress(m_body) : m_body;
+    return data;
+}
+
+ProgramInfoPacker &ProgramInfoPacker::operator<<(const QString &str)
+{
+    auto it = m_strings.constFind(str);
+    if (it != m_strings.constEnd())
+    {
+        m_stream << static_cast<quint32>(*it + 1);
+        return *this;
+    }
+
+    m_strings.insert(str, m_strings.size());
+    m_stream << static_cast<quint32>(0) << str.toUtf8();
+    return *this;
+}
+
+ProgramInfoPacker &ProgramInfoPacker::operator<<(const QDateTime &dt)
+{
+    m_stream << (dt.isValid() ? static_cast<qint64>(dt.toSecsSinceEpoch()) : kInvalid);
+    return *this;
+}
+
+ProgramInfoPacker &ProgramInfoPacker::operator<<(QDate date)
+{
+    m_stream << (date.isValid() ? date.toJulianDay() : kInvalid);
+    return *this;
+}
+
+ProgramInfoUnpacker::ProgramInfoUnpacker(const QByteArray &data)
+{
+    std::array<char,4> magic {};
+    quint8  version = 0;
+    quint8  flags   = 0;
+    quint32 count   = 0;
+
+    QDataStream header(data);
+    init_stream(header);
+    header.readRawData(magic.data(), magic.size());
+    header >> version >> flags >> count;
+    if (header.status() != QDataStream::Ok || magic != kMagic)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Data is not a binary program list");
+        return;
+    }
+    if (version != ProgramInfoPacker::kVersion)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unsupported binary program list version %1").arg(version));
+        return;
+    }
+
+    QByteArray body = data.mid(kHeaderSize);
+    if ((flags & ProgramInfoPacker::kCompressed) && !body.isEmpty())
+    {
+        body = qUncompress(body);
+        if (body.isEmpty())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to uncompress program list");
+            return;
+        }
+    }
+
+    m_body.setData(body);
+    m_body.open(QIODevice::ReadOnly);
+    m_stream.setDevice(&m_body);
+    init_stream(m_stream);
+    m_count = count;
+    m_valid = true;
+}
+
+/** \brief Reads the next program.
+ *  \return a new ProgramInfo owned by the caller, or nullptr once the
+ *          list is exhausted or found to be corrupt.
+ */
+ProgramInfo *ProgramInfoUnpacker::Next(void)
+{
+    if (!m_valid || m_read >= m_count)
+        return nullptr;
+
+    auto *pginfo = new ProgramInfo(*this);
+    if (AtError())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Program list is corrupt after %1 of %2 programs")
+                .arg(m_read).arg(m_count));
+        delete pginfo;
+        m_valid = false;
+        return nullptr;
+    }
+
+    m_read++;
+    return pginfo;
+}
+
+ProgramInfoUnpacker &ProgramInfoUnpacker::operator>>(QString &str)
+{
+    quint32 ref = 0;
+    m_stream >> ref;
+    if (ref == 0)
+    {
+        QByteArray utf8;
+        m_stream >> utf8;
+        str = QString::fromUtf8(utf8);
+        m_strings << str;
+    }
+    else if (ref <= static_cast<quint32>(m_strings.size()))
+    {
+        str = m_strings[ref - 1];
+    }
+    else
+    {
+        str.clear();
+        m_stream.setStatus(QDataStream::ReadCorruptData);
+    }
+    return *this;
+}
+
+ProgramInfoUnpacker &ProgramInfoUnpacker::operator>>(QDateTime &dt)
+{
+    qint64 secs = kInvalid;
+    m_stream >> secs;
+    dt = (secs == kInvalid) ? QDateTime() : MythDate::fromSecsSinceEpoch(secs);
+    return *this;
+}
+
+ProgramInfoUnpacker &ProgramInfoUnpacker::operator>>(QDate &date)
+{
+    qint64 day = kInvalid;
+    m_stream >> day;
+    date = (day == kInvalid) ? QDate() : QDate::fromJulianDay(day);
+    return *this;
+}
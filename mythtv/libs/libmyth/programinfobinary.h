@@ -0,0 +1,91 @@
+#ifndef PROGRAM_INFO_BINARY_H
+#define PROGRAM_INFO_BINARY_H
+
+// C++ headers
+#include <cstdint> // for [u]int[32,64]_t
+
+// Qt headers
+#include <QBuffer>
+#include <QByteArray>
+#include <QDataStream>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+
+// Myth
+#include "mythexp.h"
+
+class ProgramInfo;
+
+/** \brief Serializes a list of ProgramInfo into the compact binary form
+ *         used by the PROGINFO_BINARY_1 protocol extension.
+ *
+ *  The result starts with the "MPIB" magic, a quint8 format version, a
+ *  quint8 of flags and a quint32 program count.  The body follows, zlib
+ *  compressed when kCompressed is set.  It holds the fields of each
+ *  program in ToStringList() order at their native width, in big endian.
+ *
+ *  Strings are interned: the first time a string is seen it is written
+ *  out in full, after that only its number is.  Titles, channels, hosts
+ *  and groups shared by many programs are therefore only sent once.
+ */
+class MPUBLIC ProgramInfoPacker
+{
+  public:
+    ProgramInfoPacker();
+
+    void Add(const ProgramInfo &pginfo);
+    QByteArray Finish(bool compress = true);
+    uint Count(void) const { return m_count; }
+
+    // Used by ProgramInfo::ToBinary()
+    ProgramInfoPacker &operator<<(const QString &str);
+    ProgramInfoPacker &operator<<(const QDateTime &dt);
+    ProgramInfoPacker &operator<<(QDate date);
+    template <typename T>
+    ProgramInfoPacker &operator<<(T value) { m_stream << value; return *this; }
+
+    static constexpr quint8 kVersion    {1};
+    static constexpr quint8 kCompressed {0x01};
+    /// Bodies smaller than this are not worth compressing.
+    static constexpr int    kCompressMin {16 * 1024};
+
+  private:
+    QByteArray          m_body;
+    QDataStream         m_stream;
+    QHash<QString,uint> m_strings;
+    uint                m_count {0};
+};
+
+/** \brief Reads a list of ProgramInfo written by ProgramInfoPacker.
+ *
+ *  Check IsValid() before reading; Next() returns nullptr once all of
+ *  the programs have been read, or the data turns out to be truncated.
+ */
+class MPUBLIC ProgramInfoUnpacker
+{
+  public:
+    explicit ProgramInfoUnpacker(const QByteArray &data);
+
+    bool IsValid(void) const { return m_valid; }
+    uint Count(void) const { return m_count; }
+    ProgramInfo *Next(void);
+
+    // Used by ProgramInfo::FromBinary()
+    ProgramInfoUnpacker &operator>>(QString &str);
+    ProgramInfoUnpacker &operator>>(QDateTime &dt);
+    ProgramInfoUnpacker &operator>>(QDate &date);
+    template <typename T>
+    ProgramInfoUnpacker &operator>>(T &value) { m_stream >> value; return *this; }
+    bool AtError(void) const { return m_stream.status() != QDataStream::Ok; }
+
+  private:
+    QBuffer     m_body;
+    QDataStream m_stream;
+    QStringList m_strings;
+    uint        m_count {0};
+    uint        m_read  {0};
+    bool        m_valid {false};
+};
+
+#endif // PROGRAM_INFO_BINARY_H
@@ -8,26 +8,55 @@
 #include "compat.h"
 #include "remoteutil.h"
 #include "programinfo.h"
+#include "programinfobinary.h"
 #include "mythcorecontext.h"
 #include "storagegroup.h"
 #include "mythevent.h"
 #include "mythsocket.h"
+#include "mythversion.h"
+#include "mythlogging.h"
+
+/// Fetches the programs for QUERY_RECORDINGS \p type, in the binary form
+/// if the backend supports it.
+static uint RemoteQueryRecordings(vector<ProgramInfo *> &reclist,
+                                  const QString &type)
+{
+    QStringList strlist(QString("QUERY_RECORDINGS %1").arg(type));
+    if (!gCoreContext->HasProtoExtension(MYTH_PROTO_PROGINFO_BINARY))
+        return RemoteGetRecordingList(reclist, strlist);
+
+    strlist[0] += " Binary";
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() != 2)
+        return 0;
+
+    ProgramInfoUnpacker unpacker(QByteArray::fromBase64(strlist[1].toLatin1()));
+    if (!unpacker.IsValid() || unpacker.Count() != strlist[0].toUInt())
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "RemoteQueryRecordings() binary program list is invalid.");
+        return 0;
+    }
+
+    uint reclist_initial_size = (uint) reclist.size();
+    while (ProgramInfo *pginfo = unpacker.Next())
+        reclist.push_back(pginfo);
+
+    return ((uint) reclist.size()) - reclist_initial_size;
+}
 
 vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
 {
-    QString str = "QUERY_RECORDINGS ";
+    QString str;
     if (sort < 0)
-        str += "Descending";
+        str = "Descending";
     else if (sort > 0)
-        str += "Ascending";
+        str = "Ascending";
     else
-        str += "Unsorted";
-
-    QStringList strlist(str);
+        str = "Unsorted";
 
     auto *info = new vector<ProgramInfo *>;
 
-    if (!RemoteGetRecordingList(*info, strlist))
+    if (!RemoteQueryRecordings(*info, str))
     {
         delete info;
         return nullptr;
@@ -36,6 +65,104 @@ vector<ProgramInfo *> *RemoteGetRecordedList(int sort)
     return info;
 }
 
+/// Reads the program count and programs that end a QUERY_RECORDINGS Page
+/// or Since reply, starting at \p it.
+static bool read_programs(QStringList::const_iterator it,
+                          const QStringList::const_iterator &end,
+                          bool binary, vector<ProgramInfo *> &reclist)
+{
+    if (it == end)
+        return false;
+    uint count = (*it++).toUInt();
+
+    if (binary)
+    {
+        if (end - it != 1)
+            return false;
+        ProgramInfoUnpacker unpacker(QByteArray::fromBase64(it->toLatin1()));
+        if (!unpacker.IsValid() || unpacker.Count() != count)
+            return false;
+        while (ProgramInfo *pginfo = unpacker.Next())
+            reclist.push_back(pginfo);
+        return true;
+    }
+
+    if (end - it < static_cast<int>(count * NUMPROGRAMLINES))
+        return false;
+    for (uint i = 0; i < count; i++)
+        reclist.push_back(new ProgramInfo(it, end));
+    return true;
+}
+
+/** \brief Fetches up to \p count recordings, starting with the \p start'th
+ *         oldest.
+ *
+ *  \p total is set to the number of recordings and \p generation to the
+ *  generation of the recordings list, for RemoteGetRecordingChanges().
+ *  Needs the RECLIST_DELTA_1 protocol extension.
+ */
+bool RemoteGetRecordedPage(uint start, uint count,
+                           vector<ProgramInfo *> &reclist,
+                           uint &total, uint64_t &generation)
+{
+    bool binary = gCoreContext->HasProtoExtension(MYTH_PROTO_PROGINFO_BINARY);
+    QStringList strlist(QString("QUERY_RECORDINGS Ascending Page %1 %2%3")
+                        .arg(start).arg(count).arg(binary ? " Binary" : ""));
+
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() < 3)
+        return false;
+
+    generation = strlist[0].toULongLong();
+    total = strlist[1].toUInt();
+
+    if (!read_programs(strlist.cbegin() + 2, strlist.cend(), binary, reclist))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "RemoteGetRecordedPage() program list is invalid.");
+        return false;
+    }
+    return true;
+}
+
+/** \brief Fetches the recordings changed since \p generation, and the
+ *         recordedids of those deleted since.
+ *
+ *  \p generation is updated to be passed in next time.
+ *  \return false if the changes could not be fetched, or are no longer
+ *          known, in which case the whole list must be reloaded.
+ *  Needs the RECLIST_DELTA_1 protocol extension.
+ */
+bool RemoteGetRecordingChanges(uint64_t &generation,
+                               vector<ProgramInfo *> &changed,
+                               vector<uint> &deleted)
+{
+    bool binary = gCoreContext->HasProtoExtension(MYTH_PROTO_PROGINFO_BINARY);
+    QStringList strlist(QString("QUERY_RECORDINGS Since %1%2")
+                        .arg(generation).arg(binary ? " Binary" : ""));
+
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() < 2)
+        return false;
+
+    generation = strlist[0].toULongLong();
+    if (strlist[1] == "RELOAD")
+        return false;
+
+    uint ndeleted = strlist[1].toUInt();
+    if (static_cast<uint>(strlist.size()) < 2 + ndeleted + 1)
+        return false;
+    for (uint i = 0; i < ndeleted; i++)
+        deleted.push_back(strlist[2 + i].toUInt());
+
+    if (!read_programs(strlist.cbegin() + 2 + ndeleted, strlist.cend(),
+                       binary, changed))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "RemoteGetRecordingChanges() program list is invalid.");
+        return false;
+    }
+    return true;
+}
+
 bool RemoteGetLoad(system_load_array& load)
 {
     QStringList strlist(QString("QUERY_LOAD"));
@@ -522,13 +649,9 @@ int RemoteGetRecordingStatus(
  */
 vector<ProgramInfo *> *RemoteGetCurrentlyRecordingList(void)
 {
-    QString str = "QUERY_RECORDINGS ";
-    str += "Recording";
-    QStringList strlist( str );
-
     auto *reclist = new vector<ProgramInfo *>;
     auto *info = new vector<ProgramInfo *>;
-    if (!RemoteGetRecordingList(*info, strlist))
+    if (!RemoteQueryRecordings(*info, "Recording"))
     {
         delete info;
         return reclist;
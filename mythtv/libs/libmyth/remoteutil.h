@@ -1,6 +1,7 @@
 #ifndef REMOTEUTIL_H_
 #define REMOTEUTIL_H_
 
+#include <cstdint>
 #include <ctime>
 
 #include <QStringList>
@@ -17,6 +18,12 @@ class MythEvent;
 using system_load_array = std::array<double,3>;
 
 MPUBLIC vector<ProgramInfo *> *RemoteGetRecordedList(int sort);
+MPUBLIC bool RemoteGetRecordedPage(uint start, uint count,
+                                   vector<ProgramInfo *> &reclist,
+                                   uint &total, uint64_t &generation);
+MPUBLIC bool RemoteGetRecordingChanges(uint64_t &generation,
+                                       vector<ProgramInfo *> &changed,
+                                       vector<uint> &deleted);
 MPUBLIC bool RemoteGetLoad(system_load_array &load);
 MPUBLIC bool RemoteGetUptime(std::chrono::seconds &uptime);
 MPUBLIC
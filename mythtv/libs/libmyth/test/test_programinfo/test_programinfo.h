@@ -23,6 +23,7 @@
 
 #include "mythcorecontext.h"
 #include "programinfo.h"
+#include "programinfobinary.h"
 #include "programtypes.h"
 
 class TestProgramInfo : public QObject
@@ -99,6 +100,53 @@ class TestProgramInfo : public QObject
         );
     }
 
+    /// A recording in a series, with its own subtitle, description and times
+    static ProgramInfo mockEpisode (uint recordedid)
+    {
+        QDateTime start = MythDate::fromString("2016-10-26 00:00:00").addDays(recordedid);
+        return ProgramInfo
+            (recordedid,
+             (recordedid % 2) ? "The Flash (2014)" : "Supergirl", "",
+             QString("Episode %1").arg(recordedid), "",
+             QString("Episode %1 of the series, in which our hero faces a "
+                     "new and unexpected threat to the city.").arg(recordedid),
+             recordedid / 23 + 1, recordedid % 23 + 1, 23, "syndicatedepisode", "Drama",
+             1514, "514", "WNUVDT", "WNUBDT (WNUV-DT)", "",
+             QString("Default"), QString("Default"),
+             QString("/recordings/1514_%1.ts").arg(start.toString("yyyyMMddhhmmss")),
+             "localhost", "Default",
+             "EP01922936", QString("EP01922936%1").arg(recordedid, 4, 10, QChar('0')),
+             "ttvdb.py_279121",
+             ProgramInfo::kCategoryTVShow, 0, 6056109800,
+             start, start.addSecs(3600), start.addSecs(-120), start.addSecs(3720),
+             0.0, 2016, 0, 0, start.date(), start.addSecs(4354),
+             RecStatus::Recorded, 0,
+             kDupsInAll, kDupCheckSubThenDesc,
+             0, 0, 0, 0, 0, "Prime A-1",
+             QDateTime());
+    }
+
+    static constexpr uint kLibrarySize = 2000;
+
+    /// The QUERY_RECORDINGS reply for m_library, joined and converted as
+    /// by MythSocket::WriteStringList().
+    QByteArray libraryText(void)
+    {
+        QStringList list(QString::number(m_library.size()));
+        for (const auto & pginfo : m_library)
+            pginfo.ToStringList(list);
+        return list.join("[]:[]").toUtf8();
+    }
+
+    /// The PROGINFO_BINARY_1 QUERY_RECORDINGS reply for m_library.
+    QByteArray libraryBinary(void)
+    {
+        ProgramInfoPacker packer;
+        for (const auto & pginfo : m_library)
+            packer.Add(pginfo);
+        return packer.Finish().toBase64();
+    }
+
     QString m_draculaList = "Dracula||Its a movie.|0|0|0|||4294967295|||||0|"
         "946684800|946690200|4294967295||0|0|0|0|0|4294967295|0|0|0|946684800|"
         "946690200|0|Default|||tt0051554|11868|4294967295|0||Default|0|0|"
@@ -120,6 +168,7 @@ class TestProgramInfo : public QObject
     ProgramInfo m_dracula;
     ProgramInfo m_flash34;
     ProgramInfo m_supergirl23;
+    std::vector<ProgramInfo> m_library;
 
     QMap<QString,int> m_intOverrides {};
 
@@ -175,6 +224,9 @@ class TestProgramInfo : public QObject
              kDupsInAll, kDupCheckSubThenDesc,
              0, 0, 0, 0, 0, "Prime A-0",
              QDateTime());
+
+        for (uint i = 1; i <= kLibrarySize; i++)
+            m_library.push_back(mockEpisode(i));
     }
 
     void cleanupTestCase()
@@ -289,6 +341,114 @@ class TestProgramInfo : public QObject
         QVERIFY(m_supergirl23 == lrigrepus23c);
     }
 
+    void programToBinary_test(void)
+    {
+        ProgramInfoPacker packer;
+        packer.Add(m_dracula);
+        packer.Add(m_flash34);
+        packer.Add(m_supergirl23);
+        QCOMPARE(packer.Count(), 3U);
+        QByteArray data = packer.Finish();
+
+        ProgramInfoUnpacker unpacker(data);
+        QVERIFY(unpacker.IsValid());
+        QCOMPARE(unpacker.Count(), 3U);
+        QScopedPointer<ProgramInfo> alucard(unpacker.Next());
+        QScopedPointer<ProgramInfo> hsalf34(unpacker.Next());
+        QScopedPointer<ProgramInfo> lrigrepus23(unpacker.Next());
+        QVERIFY(alucard && hsalf34 && lrigrepus23);
+        QVERIFY(m_dracula == *alucard);
+        QVERIFY(m_flash34 == *hsalf34);
+        QVERIFY(m_supergirl23 == *lrigrepus23);
+        QCOMPARE(hsalf34->GetFilesize(), (uint64_t)6056109800);
+        QCOMPARE(hsalf34->GetOriginalAirDate(), QDate(2016,10,26));
+        QVERIFY(!alucard->GetOriginalAirDate().isValid());
+        QVERIFY(!alucard->GetLastModifiedTime().isValid());
+        QVERIFY(unpacker.Next() == nullptr);
+
+        // A truncated list is detected rather than misread
+        ProgramInfoUnpacker truncated(data.left(data.size() - 4));
+        QVERIFY(truncated.IsValid());
+        delete truncated.Next();
+        delete truncated.Next();
+        QVERIFY(truncated.Next() == nullptr);
+
+        QVERIFY(!ProgramInfoUnpacker(QByteArray("MythTV")).IsValid());
+    }
+
+    void programToBinaryCompressed_test(void)
+    {
+        ProgramInfoPacker packer;
+        for (const auto & pginfo : m_library)
+            packer.Add(pginfo);
+        QByteArray plain = packer.Finish(false);
+        QByteArray compressed = packer.Finish(true);
+        QVERIFY(compressed.size() < plain.size());
+
+        ProgramInfoUnpacker unpacker(compressed);
+        QVERIFY(unpacker.IsValid());
+        QCOMPARE(unpacker.Count(), kLibrarySize);
+        for (auto & pginfo : m_library)
+        {
+            QScopedPointer<ProgramInfo> copy(unpacker.Next());
+            QVERIFY(copy && pginfo == *copy);
+        }
+        QVERIFY(unpacker.Next() == nullptr);
+    }
+
+    /**
+     * Encode and decode cost of QUERY_RECORDINGS for a large library,
+     * in the text protocol and with the PROGINFO_BINARY_1 extension.
+     */
+    void programListTextEncode_benchmark(void)
+    {
+        QByteArray reply;
+        QBENCHMARK { reply = libraryText(); }
+        QVERIFY(!reply.isEmpty());
+    }
+
+    void programListTextDecode_benchmark(void)
+    {
+        QByteArray reply = libraryText();
+        std::vector<ProgramInfo *> programs;
+        QBENCHMARK
+        {
+            QStringList list = QString::fromUtf8(reply).split("[]:[]");
+            QStringList::const_iterator it = list.cbegin() + 1;
+            for (uint i = 0; i < kLibrarySize; i++)
+                programs.push_back(new ProgramInfo(it, list.cend()));
+            qDeleteAll(programs);
+            programs.clear();
+        }
+    }
+
+    void programListBinaryEncode_benchmark(void)
+    {
+        QByteArray reply;
+        QBENCHMARK { reply = libraryBinary(); }
+        int textSize = libraryText().size();
+        QVERIFY2(reply.size() < textSize,
+                 qPrintable(QString("binary reply %1 bytes, text reply %2 bytes")
+                            .arg(reply.size()).arg(textSize)));
+    }
+
+    void programListBinaryDecode_benchmark(void)
+    {
+        QByteArray reply = libraryBinary();
+        std::vector<ProgramInfo *> programs;
+        size_t decoded = 0;
+        QBENCHMARK
+        {
+            ProgramInfoUnpacker unpacker(QByteArray::fromBase64(reply));
+            while (ProgramInfo *pginfo = unpacker.Next())
+                programs.push_back(pginfo);
+            decoded = programs.size();
+            qDeleteAll(programs);
+            programs.clear();
+        }
+        QCOMPARE(decoded, (size_t)kLibrarySize);
+    }
+
     void programSorting_test(void)
     {
         QStringList program_list;
@@ -613,6 +613,15 @@ bool MythCoreContext::IsConnectedToMaster(void)
     return d->m_serverSock;
 }
 
+/// Returns true if the master backend accepted the protocol \p extension
+/// when the command socket was connected.
+bool MythCoreContext::HasProtoExtension(const QString &extension)
+{
+    QMutexLocker locker(&d->m_sockLock);
+    return d->m_serverSock &&
+           d->m_serverSock->GetProtoExtensions().contains(extension);
+}
+
 void MythCoreContext::BlockShutdown(void)
 {
     QStringList strlist;
@@ -1680,9 +1689,10 @@ bool MythCoreContext::CheckProtoVersion(MythSocket *socket,
     if (!socket)
         return false;
 
-    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2")
+    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2 %3")
                         .arg(MYTH_PROTO_VERSION)
-                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
+                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN))
+                        .arg(MYTH_PROTO_EXTENSIONS));
     socket->WriteStringList(strlist);
 
     if (!socket->ReadStringList(strlist, timeout) || strlist.empty())
@@ -1713,6 +1723,7 @@ bool MythCoreContext::CheckProtoVersion(MythSocket *socket,
     }
     if (strlist[0] == "ACCEPT")
     {
+        socket->SetProtoExtensions(strlist.mid(2));
         if (!d->m_announcedProtocol)
         {
             d->m_announcedProtocol = true;
@@ -104,6 +104,7 @@ class MBASE_PUBLIC MythCoreContext : public QObject, public MythObservable, publ
     QString GetFilePrefix(void);
 
     bool IsConnectedToMaster(void);
+    bool HasProtoExtension(const QString &extension);
     void SetAsBackend(bool backend);
     bool IsBackend(void) const;        ///< is this process a backend process
     void SetAsFrontend(bool frontend);
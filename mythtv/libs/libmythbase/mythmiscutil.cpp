@@ -2,6 +2,7 @@
 #include "mythmiscutil.h"
 
 // C++ headers
+#include <algorithm>
 #include <array>
 #include <cerrno>
 #include <cstdlib>
@@ -22,6 +23,11 @@
 #include <sys/stat.h> // for umask, chmod
 #endif
 
+#ifdef __linux__
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
+
 #if CONFIG_DARWIN
 #include <mach/mach.h>
 #endif
@@ -368,6 +374,69 @@ long long copy(QFile &dst, QFile &src, uint block_size)
     return (ok) ? total_bytes : -1LL;
 }
 
+/** \brief Sends \p count bytes from \p offset in the file \p filefd to the
+ *         socket \p sockfd, without copying them through user space.
+ *
+ *  The socket may be non-blocking; this waits up to \p timeout for it to
+ *  accept more data each time it is full.
+ *  \return the number of bytes sent, which is less than \p count if the
+ *          file ended, the socket timed out or an error occurred, or -1 if
+ *          the kernel cannot send between these descriptors (or on this
+ *          platform), in which case nothing has been sent.
+ */
+long long sendFileToSocket(int sockfd, int filefd, long long offset,
+                           long long count, std::chrono::milliseconds timeout)
+{
+#ifdef __linux__
+    // Limit each call so progress is checked for regularly
+    static constexpr long long kMaxChunk { 4LL * 1024 * 1024 };
+
+    off_t pos = offset;
+    long long sent = 0;
+    while (sent < count)
+    {
+        ssize_t ret = sendfile(sockfd, filefd, &pos,
+                               std::min(count - sent, kMaxChunk));
+        if (ret > 0)
+        {
+            sent += ret;
+            continue;
+        }
+        if (ret == 0)
+            break; // end of file
+
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            pollfd pfd { sockfd, POLLOUT, 0 };
+            int pret = poll(&pfd, 1, timeout.count());
+            if (pret > 0 || (pret < 0 && errno == EINTR))
+                continue;
+            LOG(VB_NETWORK, LOG_ERR,
+                QString("sendFileToSocket: Timed out after %1 of %2 bytes")
+                    .arg(sent).arg(count));
+            break;
+        }
+        if ((errno == EINVAL || errno == ENOSYS) && (sent == 0))
+            return -1;
+
+        LOG(VB_NETWORK, LOG_ERR,
+            QString("sendFileToSocket: Failed after %1 of %2 bytes")
+                .arg(sent).arg(count) + ENO);
+        break;
+    }
+    return sent;
+#else
+    Q_UNUSED(sockfd);
+    Q_UNUSED(filefd);
+    Q_UNUSED(offset);
+    Q_UNUSED(count);
+    Q_UNUSED(timeout);
+    return -1;
+#endif
+}
+
 QString createTempFile(QString name_template, bool dir)
 {
     int ret = -1;
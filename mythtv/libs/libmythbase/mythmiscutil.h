@@ -43,6 +43,9 @@ MBASE_PUBLIC bool ping(const QString &host, std::chrono::milliseconds timeout);
 MBASE_PUBLIC bool telnet(const QString &host, int port);
 
 MBASE_PUBLIC long long copy(QFile &dst, QFile &src, uint block_size = 0);
+MBASE_PUBLIC long long sendFileToSocket(int sockfd, int filefd, long long offset,
+                                        long long count,
+                                        std::chrono::milliseconds timeout);
 MBASE_PUBLIC QString createTempFile(
     QString name_template = "/tmp/mythtv_XXXXXX", bool dir = false);
 MBASE_PUBLIC bool makeFileAccessible(const QString& filename);
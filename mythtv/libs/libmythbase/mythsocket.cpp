@@ -26,6 +26,7 @@ using std::vector;
 // MythTV
 #include "mythsocket.h"
 #include "mythtimer.h"
+#include "mythmiscutil.h"
 #include "mythevent.h"
 #include "mythversion.h"
 #include "mythlogging.h"
@@ -75,12 +76,21 @@ static QString to_sample(const QByteArray &payload)
     return sample;
 }
 
+/** \param read_string_lists If set, each string list is read as soon as
+ *         all of it has arrived, on the socket's thread and without
+ *         waiting on the rest of one that has not, and passed to
+ *         MythSocketCBs::readStringList() in place of readyRead() being
+ *         called.  ReadStringList() may still be used while the callback
+ *         is disabled with SetReadyReadCallbackEnabled().
+ */
 MythSocket::MythSocket(
-    qt_socket_fd_t socket, MythSocketCBs *cb, bool use_shared_thread) :
+    qt_socket_fd_t socket, MythSocketCBs *cb, bool use_shared_thread,
+    bool read_string_lists) :
     ReferenceCounter(QString("MythSocket(%1)").arg(socket)),
     m_tcpSocket(new QTcpSocket()),
     m_callback(cb),
-    m_useSharedThread(use_shared_thread)
+    m_useSharedThread(use_shared_thread),
+    m_readStringLists(read_string_lists)
 {
     LOG(VB_SOCKET, LOG_INFO, LOC + QString("MythSocket(%1, 0x%2) ctor")
         .arg(socket).arg((intptr_t)(cb),0,16));
@@ -279,10 +289,38 @@ void MythSocket::ReadyReadHandler(void)
     m_dataAvailable.fetchAndStoreOrdered(1);
     if (m_callback && m_disableReadyReadCallback.testAndSetOrdered(0,0))
     {
-        emit CallReadyRead();
+        if (m_readStringLists)
+            ReadStringListsHandler();
+        else
+            emit CallReadyRead();
     }
 }
 
+void MythSocket::ReadStringListsHandler(void)
+{
+    // The callback may disable itself, to use ReadStringList() for a
+    // reply, so check before reading each list.
+    QStringList list;
+    while (m_callback && m_disableReadyReadCallback.testAndSetOrdered(0,0) &&
+           ReadAvailableStringList(list))
+    {
+        LOG(VB_SOCKET, LOG_DEBUG, LOC +
+            "calling m_callback->readStringList()");
+        m_callback->readStringList(this, list);
+    }
+}
+
+void MythSocket::SetReadyReadCallbackEnabled(bool enabled)
+{
+    m_disableReadyReadCallback.fetchAndStoreOrdered((enabled) ? 0 : 1);
+
+    // Lists that arrived while the callback was disabled will not cause
+    // another readyRead, so look for them now.
+    if (enabled && m_readStringLists)
+        QMetaObject::invokeMethod(this, "ReadStringListsHandler",
+                                  Qt::QueuedConnection);
+}
+
 void MythSocket::CallReadyReadHandler(void)
 {
     // Because the connection to this is a queued connection the
@@ -418,9 +456,10 @@ bool MythSocket::Validate(std::chrono::milliseconds timeout, bool error_dialog_d
     if (m_isValidated)
         return true;
 
-    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2")
+    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2 %3")
                         .arg(MYTH_PROTO_VERSION)
-                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
+                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN))
+                        .arg(MYTH_PROTO_EXTENSIONS));
 
     WriteStringList(strlist);
 
@@ -454,6 +493,7 @@ bool MythSocket::Validate(std::chrono::milliseconds timeout, bool error_dialog_d
     {
         LOG(VB_GENERAL, LOG_NOTICE, QString("Using protocol version %1 %2")
             .arg(MYTH_PROTO_VERSION).arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
+        m_protoExtensions = strlist.mid(2);
         m_isValidated = true;
     }
     else
@@ -551,6 +591,26 @@ int MythSocket::Read(char *data, int size,  std::chrono::milliseconds max_wait)
     return ret;
 }
 
+/** \brief Sends \p size bytes from \p offset in the file \p fd, without
+ *         copying them through user space.
+ *  \return the number of bytes sent, which is less than \p size on error,
+ *          or -1 if files cannot be sent this way, in which case nothing
+ *          has been sent and the caller should Write() the data instead.
+ */
+int MythSocket::SendFile(int fd, long long offset, int size)
+{
+    int ret = -1;
+    QMetaObject::invokeMethod(
+        this, "SendFileReal",
+        (QThread::currentThread() != m_thread->qthread()) ?
+        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        Q_ARG(int, fd),
+        Q_ARG(long long, offset),
+        Q_ARG(int, size),
+        Q_ARG(int*, &ret));
+    return ret;
+}
+
 void MythSocket::Reset(void)
 {
     QMetaObject::invokeMethod(
@@ -959,6 +1019,57 @@ void MythSocket::ReadStringListReal(
     *ret = true;
 }
 
+/** \brief Reads a string list if all of it has arrived.
+ *
+ *  Unlike ReadStringListReal() this never waits; a list that has only
+ *  partly arrived is left in the socket until the rest of it has.
+ *  \note This must be called from the socket's thread.
+ */
+bool MythSocket::ReadAvailableStringList(QStringList &list)
+{
+    if (m_tcpSocket->bytesAvailable() < 8)
+        return false;
+
+    QByteArray sizestr = m_tcpSocket->peek(8);
+    int btr = QString(sizestr).trimmed().toInt();
+    if (btr < 1)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Protocol error: '%1' is not a valid size "
+                    "prefix. %2 bytes pending.")
+                .arg(sizestr.constData()).arg(m_tcpSocket->bytesAvailable()));
+        ResetReal();
+        return false;
+    }
+
+    if (m_tcpSocket->bytesAvailable() < 8 + btr)
+        return false;
+
+    QByteArray payload = m_tcpSocket->read(8 + btr);
+    QString str = QString::fromUtf8(payload.constData() + 8);
+
+    if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
+    {
+        QString msg = QString("read  <- %1 %2")
+            .arg(m_tcpSocket->socketDescriptor(), 2)
+            .arg(payload.constData());
+
+        if (logLevel < LOG_DEBUG && msg.length() > 128)
+        {
+            msg.truncate(127);
+            msg += "…";
+        }
+        LOG(VB_NETWORK, LOG_INFO, LOC + msg);
+    }
+
+    list = str.split("[]:[]");
+
+    m_dataAvailable.fetchAndStoreOrdered(
+        (m_tcpSocket->bytesAvailable() > 0) ? 1 : 0);
+
+    return true;
+}
+
 void MythSocket::WriteReal(const char *data, int size, int *ret)
 {
     *ret = m_tcpSocket->write(data, size);
@@ -987,6 +1098,24 @@ void MythSocket::ReadReal(char *data, int size, std::chrono::milliseconds max_wa
         (m_tcpSocket->bytesAvailable() > 0) ? 1 : 0);
 }
 
+void MythSocket::SendFileReal(int fd, long long offset, int size, int *ret)
+{
+    // Anything already written to m_tcpSocket must go out first
+    while (m_tcpSocket->bytesToWrite() > 0)
+    {
+        if (m_tcpSocket->state() != QAbstractSocket::ConnectedState ||
+            !m_tcpSocket->waitForBytesWritten(kLongTimeout.count()))
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "SendFile: Unable to flush socket");
+            *ret = 0;
+            return;
+        }
+    }
+
+    *ret = sendFileToSocket(m_tcpSocket->socketDescriptor(), fd, offset,
+                            size, kLongTimeout);
+}
+
 void MythSocket::ResetReal(void)
 {
     vector<char> trash;
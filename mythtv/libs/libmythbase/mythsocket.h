@@ -31,7 +31,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
 
   public:
     explicit MythSocket(qt_socket_fd_t socket = -1, MythSocketCBs *cb = nullptr,
-               bool use_shared_thread = false);
+               bool use_shared_thread = false, bool read_string_lists = false);
 
     bool ConnectToHost(const QString &hostname, quint16 port);
     bool ConnectToHost(const QHostAddress &address, quint16 port);
@@ -45,9 +45,12 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     QStringList GetAnnounce(void) const { return m_announce; }
     void SetAnnounce(const QStringList &new_announce);
     bool IsAnnounced(void) const { return m_isAnnounced; }
+    /// The protocol extensions the peer accepted in Validate().
+    QStringList GetProtoExtensions(void) const { return m_protoExtensions; }
+    void SetProtoExtensions(const QStringList &extensions)
+        { m_protoExtensions = extensions; }
 
-    void SetReadyReadCallbackEnabled(bool enabled)
-        { m_disableReadyReadCallback.fetchAndStoreOrdered((enabled) ? 0 : 1); }
+    void SetReadyReadCallbackEnabled(bool enabled);
 
     bool SendReceiveStringList(
         QStringList &list, uint min_reply_length = 0,
@@ -66,6 +69,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     // RemoteFile stuff
     int Write(const char *data, int size);
     int Read(char *data, int size,  std::chrono::milliseconds max_wait);
+    int SendFile(int fd, long long offset, int size);
     void Reset(void);
 
     static constexpr std::chrono::milliseconds kShortTimeout { kMythSocketShortTimeout };
@@ -81,6 +85,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     void DisconnectHandler(void);
     void ReadyReadHandler(void);
     void CallReadyReadHandler(void);
+    void ReadStringListsHandler(void);
 
     void ReadStringListReal(QStringList *list, std::chrono::milliseconds timeoutMS, bool *ret);
     void WriteStringListReal(const QStringList *list, bool *ret);
@@ -89,6 +94,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
 
     void WriteReal(const char *data, int size, int *ret);
     void ReadReal(char *data, int size, std::chrono::milliseconds max_wait_ms, int *ret);
+    void SendFileReal(int fd, long long offset, int size, int *ret);
     void ResetReal(void);
 
     void IsDataAvailableReal(bool *ret) const;
@@ -96,6 +102,8 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
   protected:
     ~MythSocket() override; // force reference counting
 
+    bool ReadAvailableStringList(QStringList &list);
+
     QTcpSocket     *m_tcpSocket        {nullptr}; // only set in ctor
     MThread        *m_thread           {nullptr}; // only set in ctor
     mutable QMutex  m_lock;
@@ -104,6 +112,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     int             m_peerPort         {-1};      // protected by m_lock
     MythSocketCBs  *m_callback         {nullptr}; // only set in ctor
     bool            m_useSharedThread;            // only set in ctor
+    bool            m_readStringLists;            // only set in ctor
     QAtomicInt      m_disableReadyReadCallback {false};
     bool            m_connected        {false};   // protected by m_lock
     /// This is used internally as a hint that there might be
@@ -112,6 +121,7 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     bool            m_isValidated      {false}; // only set in thread using MythSocket
     bool            m_isAnnounced      {false}; // only set in thread using MythSocket
     QStringList     m_announce; // only set in thread using MythSocket
+    QStringList     m_protoExtensions; // only set in thread using MythSocket
 
     static const int kSocketReceiveBufferSize;
 
@@ -10,6 +10,7 @@ static constexpr std::chrono::milliseconds kMythSocketShortTimeout {  7s };
 static constexpr std::chrono::milliseconds kMythSocketLongTimeout  { 30s };
 
 class MythSocket;
+class QStringList;
 class MBASE_PUBLIC MythSocketCBs
 {
   public:
@@ -17,6 +18,10 @@ class MBASE_PUBLIC MythSocketCBs
     virtual void connected(MythSocket*) = 0;
     virtual void error(MythSocket */*socket*/, int /*err*/) {}
     virtual void readyRead(MythSocket*) = 0;
+    /// Called in place of readyRead() with each string list that arrives,
+    /// on sockets created with read_string_lists set.
+    virtual void readStringList(MythSocket */*socket*/,
+                                QStringList &/*list*/) {}
     virtual void connectionFailed(MythSocket*) = 0;
     virtual void connectionClosed(MythSocket*) = 0;
 };
@@ -46,6 +46,30 @@
  */
 #define MYTH_PROTO_VERSION "91"
 #define MYTH_PROTO_TOKEN "BuzzOff"
+
+/** \brief Optional extensions to the MythTV network protocol.
+ *
+ *   Clients list the extensions they want after the token in the
+ *   MYTH_PROTO_VERSION command, and a backend lists those it supports
+ *   after the version in its ACCEPT reply.  Peers that know nothing of
+ *   extensions ignore the extra items, so adding one does not need a new
+ *   protocol version.  Changing the format of an extension means giving
+ *   it a new name instead.
+ *
+ *   PROGINFO_BINARY_1
+ *       "QUERY_RECORDINGS <type> Binary" is answered with the program count
+ *       and a single base64 encoded item holding the programs, as written
+ *       by ProgramInfoPacker, in place of NUMPROGRAMLINES items each.
+ *
+ *   RECLIST_DELTA_1
+ *       "QUERY_RECORDINGS <type> Page <start> <count>" returns part of the
+ *       recordings list and its generation, "QUERY_RECORDINGS Since
+ *       <generation>" the recordings changed since then.
+ */
+#define MYTH_PROTO_PROGINFO_BINARY "PROGINFO_BINARY_1"
+#define MYTH_PROTO_RECLIST_DELTA   "RECLIST_DELTA_1"
+#define MYTH_PROTO_EXTENSIONS \
+    MYTH_PROTO_PROGINFO_BINARY " " MYTH_PROTO_RECLIST_DELTA
 /*
  *  Protocol cleanups needed:
  *
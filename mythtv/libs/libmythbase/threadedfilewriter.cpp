@@ -1,4 +1,5 @@
 // C++ headers
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <cstdio>
@@ -52,7 +53,49 @@ const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
  *   using another thread. The goal here so to block as little as
  *   possible when the classes using this class want to add data
  *   to the stream.
+ *
+ *   By default every Write() is copied into a list of heap allocated
+ *   buffers. Recorders can instead call EnableRingBuffer() before
+ *   Open() to have the data copied into a single preallocated ring,
+ *   which DiskLoop() writes out of directly.
+ */
+
+/** \brief Switch to ring buffer mode.
+ *
+ *   In this mode Write() appends into one fixed-size buffer
+ *   allocated here, so there is no heap allocation per write. The
+ *   ring size replaces the usual maximum buffer size. When the ring
+ *   fills up a blocking writer waits for DiskLoop() to free space,
+ *   the time spent waiting is reported by GetStallTime().
+ *
+ *   This must be called before Open().
+ *
+ *  \param size Size of the ring in bytes.
+ *  \return true if ring buffer mode is enabled.
  */
+bool ThreadedFileWriter::EnableRingBuffer(uint size)
+{
+    QMutexLocker locker(&m_bufLock);
+
+    if (m_ring)
+        return true;
+
+    if (m_writeThread)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "EnableRingBuffer() called after Open(), ignoring.");
+        return false;
+    }
+
+    m_ringSize = std::max(size, kMinWriteSize);
+    m_ring     = new char[m_ringSize];
+    m_ringRead = m_ringWrite = 0;
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Using %1 KB ring buffer").arg(m_ringSize / 1024));
+
+    return true;
+}
 
 /** \fn ThreadedFileWriter::ReOpen(QString)
  *  \brief Reopens the file we are writing to or opens a new file
@@ -171,6 +214,16 @@ ThreadedFileWriter::~ThreadedFileWriter()
         m_syncThread = nullptr;
     }
 
+    if (m_ring)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Ring buffer peak fill %1 of %2 bytes, "
+                    "writers stalled for %3 ms")
+            .arg(m_ringPeak).arg(m_ringSize).arg(m_stallTime.count()));
+        delete[] m_ring;
+        m_ring = nullptr;
+    }
+
     if (m_fd >= 0)
     {
         close(m_fd);
@@ -197,6 +250,9 @@ int ThreadedFileWriter::Write(const void *data, uint count)
     if (m_ignoreWrites)
         return -1;
 
+    if (m_ring)
+        return RingWrite(static_cast<const char*>(data), count, locker);
+
     uint written    = 0;
     uint left       = count;
 
@@ -283,6 +339,113 @@ int ThreadedFileWriter::Write(const void *data, uint count)
     return count;
 }
 
+/** \brief Copies data into the ring buffer, see Write(const void*, uint)
+ *
+ *   Must be called with m_bufLock held. Only the free part of the
+ *   ring is touched, DiskLoop() owns the used part while the lock
+ *   is released, so the copy is safe without further locking.
+ */
+int ThreadedFileWriter::RingWrite(const char *data, uint count,
+                                  QMutexLocker &locker)
+{
+    if (!m_blocking && (m_totalBufferUse + count > m_ringSize))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "Ring buffer full."
+            "\n\t\t\tfile will be truncated, no further writing "
+            "will be done."
+            "\n\t\t\tThis generally indicates your disk performance "
+            "\n\t\t\tis insufficient to deal with the number of on-going "
+            "\n\t\t\trecordings, or you have a disk failure.");
+        m_ignoreWrites = true;
+        return -1;
+    }
+
+    uint written = 0;
+
+    while (written < count)
+    {
+        if (m_ignoreWrites)
+            return -1;
+
+        uint space = m_ringSize - m_totalBufferUse;
+        if (space == 0)
+        {
+            if (!m_warned)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "Ring buffer full."
+                    "\n\t\t\tThis generally indicates your disk performance "
+                    "\n\t\t\tis insufficient or you have a disk failure.");
+                m_warned = true;
+            }
+            // wait until some was written to disk, and try again
+            MythTimer stallTimer;
+            stallTimer.start();
+            m_bufferHasData.wakeAll();
+            if (!m_bufferWasFreed.wait(locker.mutex(), 1000))
+            {
+                LOG(VB_GENERAL, LOG_DEBUG, LOC +
+                    QString("Taking a long time waiting to write.. "
+                            "%1 bytes to go").arg(count - written));
+            }
+            m_stallTime += stallTimer.elapsed();
+            continue;
+        }
+
+        uint towrite = std::min(count - written, space);
+        uint first   = std::min(towrite, m_ringSize - m_ringWrite);
+        memcpy(m_ring + m_ringWrite, data + written, first);
+        if (towrite > first)
+            memcpy(m_ring, data + written + first, towrite - first);
+
+        m_ringWrite = (m_ringWrite + towrite) % m_ringSize;
+        m_totalBufferUse += towrite;
+        m_ringPeak = std::max(m_ringPeak, m_totalBufferUse);
+        written += towrite;
+    }
+
+    if (m_totalBufferUse >= kMinWriteSize)
+        m_bufferHasData.wakeAll();
+
+    LOG(VB_FILE, LOG_DEBUG, LOC + QString("Write(*, %1) ring fill %2")
+            .arg(count,4).arg(m_totalBufferUse));
+
+    return count;
+}
+
+/** \brief Returns true when there is no data left to write to disk.
+ *
+ *   Must be called with m_bufLock held.
+ */
+bool ThreadedFileWriter::IsBufferEmpty(void) const
+{
+    if (m_ring)
+        return m_totalBufferUse == 0;
+    return m_writeBuffers.empty();
+}
+
+/// \brief Returns the number of bytes buffered but not yet written to disk.
+uint ThreadedFileWriter::GetBufferFill(void) const
+{
+    QMutexLocker locker(&m_bufLock);
+    return m_totalBufferUse;
+}
+
+/// \brief Returns the ring buffer high water mark in bytes.
+uint ThreadedFileWriter::GetPeakBufferFill(void) const
+{
+    QMutexLocker locker(&m_bufLock);
+    return m_ringPeak;
+}
+
+/// \brief Returns the total time Write() has waited for ring buffer space.
+std::chrono::milliseconds ThreadedFileWriter::GetStallTime(void) const
+{
+    QMutexLocker locker(&m_bufLock);
+    return m_stallTime;
+}
+
 /** \fn ThreadedFileWriter::Seek(long long pos, int whence)
  *  \brief Seek to a position within stream; May be unsafe.
  *
@@ -298,7 +461,7 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
 {
     QMutexLocker locker(&m_bufLock);
     m_flush = true;
-    while (!m_writeBuffers.empty())
+    while (!IsBufferEmpty())
     {
         m_bufferHasData.wakeAll();
         if (!m_bufferEmpty.wait(locker.mutex(), 2000))
@@ -319,7 +482,7 @@ void ThreadedFileWriter::Flush(void)
 {
     QMutexLocker locker(&m_bufLock);
     m_flush = true;
-    while (!m_writeBuffers.empty())
+    while (!IsBufferEmpty())
     {
         m_bufferHasData.wakeAll();
         if (!m_bufferEmpty.wait(locker.mutex(), 2000))
@@ -413,6 +576,12 @@ void ThreadedFileWriter::DiskLoop(void)
     signal(SIGXFSZ, SIG_IGN);
 #endif
 
+    if (m_ring)
+    {
+        RingDiskLoop();
+        return;
+    }
+
     QMutexLocker locker(&m_bufLock);
 
     // Even if the bytes buffered is less than the minimum write
@@ -550,35 +719,175 @@ void ThreadedFileWriter::DiskLoop(void)
                     .arg(m_totalBufferUse).arg(writeTimer.elapsed().count()));
         }
 
-        if (!write_ok && ((EFBIG == errno) || (ENOSPC == errno)))
+        if (!write_ok)
+            WriteFailed(errno);
+    }
+}
+
+/** \brief Logs and handles a fatal write error.
+ *
+ *   Must be called with m_bufLock held.
+ *  \return true if no further writes will be done.
+ */
+bool ThreadedFileWriter::WriteFailed(int error)
+{
+    QString msg;
+    switch (error)
+    {
+        case EFBIG:
+            msg =
+                "Maximum file size exceeded by '%1'"
+                "\n\t\t\t"
+                "You must either change the process ulimits, configure"
+                "\n\t\t\t"
+                "your operating system with \"Large File\" support, "
+                "or use"
+                "\n\t\t\t"
+                "a filesystem which supports 64-bit or 128-bit files."
+                "\n\t\t\t"
+                "HINT: FAT32 is a 32-bit filesystem.";
+            break;
+        case ENOSPC:
+            msg =
+                "No space left on the device for file '%1'"
+                "\n\t\t\t"
+                "file will be truncated, no further writing "
+                "will be done.";
+            break;
+        default:
+            return false;
+    }
+
+    LOG(VB_GENERAL, LOG_ERR, LOC + msg.arg(m_filename));
+    m_ignoreWrites = true;
+    return true;
+}
+
+/** \brief DiskLoop() for ring buffer mode.
+ *
+ *   Writes straight out of the ring, releasing m_bufLock for the
+ *   duration of the write() call. Write() only ever touches the free
+ *   part of the ring so the data being written stays valid.
+ */
+void ThreadedFileWriter::RingDiskLoop(void)
+{
+    QMutexLocker locker(&m_bufLock);
+
+    MythTimer minWriteTimer;
+    MythTimer lastRegisterTimer;
+    minWriteTimer.start();
+    lastRegisterTimer.start();
+
+    uint64_t total_written = 0LL;
+    uint errcnt = 0;
+
+    while (!m_inDtor)
+    {
+        if (m_ignoreWrites)
+        {
+            m_totalBufferUse = 0;
+            m_ringRead = m_ringWrite = 0;
+            m_bufferEmpty.wakeAll();
+            m_bufferWasFreed.wakeAll();
+            m_bufferHasData.wait(locker.mutex());
+            continue;
+        }
+
+        if (m_totalBufferUse == 0)
         {
-            QString msg;
-            switch (errno)
+            // Start again at the front of the ring whenever it drains,
+            // so normally only the first few blocks of it are touched.
+            m_ringRead = m_ringWrite = 0;
+            m_bufferEmpty.wakeAll();
+            m_bufferHasData.wait(locker.mutex(), 1000);
+            continue;
+        }
+
+        auto mwte = minWriteTimer.elapsed();
+        if (!m_flush && (mwte < 250ms) && (m_totalBufferUse < kMinWriteSize))
+        {
+            m_bufferHasData.wait(locker.mutex(), (250ms - mwte).count());
+            continue;
+        }
+
+        if (m_fd == -1)
+        {
+            m_bufferHasData.wait(locker.mutex(), 200);
+            continue;
+        }
+
+        minWriteTimer.start();
+
+        uint sz = std::min({m_totalBufferUse, m_ringSize - m_ringRead,
+                            kMaxBlockSize});
+        const char *data = m_ring + m_ringRead;
+
+        LOG(VB_FILE, LOG_DEBUG, LOC + QString("write(%1) ring fill %2")
+                .arg(sz).arg(m_totalBufferUse));
+
+        locker.unlock();
+
+        MythTimer writeTimer;
+        writeTimer.start();
+
+        int ret = write(m_fd, data, sz);
+        int error = errno;
+
+        if (ret < 0)
+        {
+            if (error == EAGAIN)
             {
-                case EFBIG:
-                    msg =
-                        "Maximum file size exceeded by '%1'"
-                        "\n\t\t\t"
-                        "You must either change the process ulimits, configure"
-                        "\n\t\t\t"
-                        "your operating system with \"Large File\" support, "
-                        "or use"
-                        "\n\t\t\t"
-                        "a filesystem which supports 64-bit or 128-bit files."
-                        "\n\t\t\t"
-                        "HINT: FAT32 is a 32-bit filesystem.";
-                    break;
-                case ENOSPC:
-                    msg =
-                        "No space left on the device for file '%1'"
-                        "\n\t\t\t"
-                        "file will be truncated, no further writing "
-                        "will be done.";
-                    break;
+                LOG(VB_GENERAL, LOG_WARNING, LOC + "Got EAGAIN.");
+            }
+            else
+            {
+                errcnt++;
+                LOG(VB_GENERAL, LOG_ERR, LOC + "File I/O " +
+                    QString(" errcnt: %1").arg(errcnt) + ENO);
             }
+        }
+
+        locker.relock();
 
-            LOG(VB_GENERAL, LOG_ERR, LOC + msg.arg(m_filename));
-            m_ignoreWrites = true;
+        if (ret < 0)
+        {
+            if (WriteFailed(error))
+                continue;
+            if (errcnt >= 3)
+            {
+                // give up on this block, like DiskLoop() does
+                ret = sz;
+                errcnt = 0;
+            }
+            else
+            {
+                m_bufferHasData.wait(locker.mutex(), 50);
+                continue;
+            }
+        }
+        else
+        {
+            errcnt = 0;
+            total_written += ret;
+        }
+
+        m_ringRead = (m_ringRead + ret) % m_ringSize;
+        m_totalBufferUse -= ret;
+        m_bufferWasFreed.wakeAll();
+
+        if (lastRegisterTimer.elapsed() >= 10s)
+        {
+            gCoreContext->RegisterFileForWrite(m_filename, total_written);
+            m_registered = true;
+            lastRegisterTimer.restart();
+        }
+
+        if (writeTimer.elapsed() > 1s)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("write(%1) ring fill %2 -- took a long time, %3 ms")
+                    .arg(sz).arg(m_totalBufferUse)
+                    .arg(writeTimer.elapsed().count()));
         }
     }
 }
@@ -15,6 +15,7 @@
 
 // MythTV headers
 #include "mythbaseexp.h"
+#include "mythchrono.h"
 #include "mthread.h"
 
 class ThreadedFileWriter;
@@ -51,6 +52,7 @@ class MBASE_PUBLIC ThreadedFileWriter
         : m_filename(std::move(fname)), m_flags(flags), m_mode(mode) {}
     ~ThreadedFileWriter();
 
+    bool EnableRingBuffer(uint size = kMaxBufferSize * 8);
     bool Open(void);
     bool ReOpen(const QString& newFilename = "");
 
@@ -64,10 +66,19 @@ class MBASE_PUBLIC ThreadedFileWriter
     bool SetBlocking(bool block = true);
     bool WritesFailing(void) const { return m_ignoreWrites; }
 
+    bool IsRingBuffer(void) const { return m_ring != nullptr; }
+    uint GetBufferFill(void) const;
+    uint GetPeakBufferFill(void) const;
+    std::chrono::milliseconds GetStallTime(void) const;
+
   protected:
     void DiskLoop(void);
+    void RingDiskLoop(void);
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
+    bool IsBufferEmpty(void) const;
+    int  RingWrite(const char *data, uint count, QMutexLocker &locker);
+    bool WriteFailed(int error);
 
   private:
     // file info
@@ -94,6 +105,14 @@ class MBASE_PUBLIC ThreadedFileWriter
     QList<TFWBuffer*> m_writeBuffers;     // protected by buflock
     QList<TFWBuffer*> m_emptyBuffers;     // protected by buflock
 
+    // ring buffer mode, see EnableRingBuffer()
+    char           *m_ring               {nullptr};
+    uint            m_ringSize           {0};
+    uint            m_ringRead           {0};             // protected by buflock
+    uint            m_ringWrite          {0};             // protected by buflock
+    uint            m_ringPeak           {0};             // protected by buflock
+    std::chrono::milliseconds m_stallTime {0ms};          // protected by buflock
+
     // threads
     TFWWriteThread *m_writeThread        {nullptr};
     TFWSyncThread  *m_syncThread         {nullptr};
@@ -45,6 +45,7 @@ extern "C" {
 #include "mythdbcon.h"
 #include "iso639.h"
 #include "mpegtables.h"
+#include "bytereader.h"
 #include "atscdescriptors.h"
 #include "dvbdescriptors.h"
 #include "captions/cc608decoder.h"
@@ -57,6 +58,8 @@ extern "C" {
 #include "DVD/mythdvdbuffer.h"
 #include "Bluray/mythbdbuffer.h"
 #include "mythavutil.h"
+#include "decoders/mythdemuxthread.h"
+#include "keyframeindexbuilder.h"
 #include "mythhdrmetadata.h"
 
 #include "lcddevice.h"
@@ -172,6 +175,27 @@ int  get_avf_buffer_dxva2(struct AVCodecContext *c, AVFrame *pic, int flags);
     return false;                                   \
 } while (false)
 
+/*! \brief Copy a software decoded frame into a YV12 frame, if no scaling is needed.
+ *
+ * Returns false if the frame must be converted with libswscale instead.
+*/
+static bool CopySoftwareFrame(MythVideoFrame *Frame, const AVFrame *AvFrame)
+{
+    if ((Frame->m_type != FMT_YV12) || (Frame->m_width != AvFrame->width) ||
+        (Frame->m_height != AvFrame->height) || AvFrame->hw_frames_ctx)
+    {
+        return false;
+    }
+
+    FramePlanes to { Frame->m_buffer + Frame->m_offsets[0], Frame->m_buffer + Frame->m_offsets[1],
+                     Frame->m_buffer + Frame->m_offsets[2] };
+    ConstFramePlanes from { AvFrame->data[0], AvFrame->data[1], AvFrame->data[2] };
+    FramePitches pitches { AvFrame->linesize[0], AvFrame->linesize[1], AvFrame->linesize[2] };
+    auto type = MythAVUtil::PixelFormatToFrameType(static_cast<AVPixelFormat>(AvFrame->format));
+    return MythVideoFrame::CopyPlanes(Frame->m_type, to, Frame->m_pitches, type, from, pitches,
+                                      AvFrame->width, AvFrame->height);
+}
+
 static bool StreamHasRequiredParameters(AVCodecContext *Context, AVStream *Stream)
 {
     switch (Stream->codecpar->codec_type)
@@ -339,6 +363,9 @@ AvFormatDecoder::AvFormatDecoder(MythPlayer *parent,
 
 AvFormatDecoder::~AvFormatDecoder()
 {
+    delete m_readAhead;
+    m_readAhead = nullptr;
+
     while (!m_storedPackets.isEmpty())
     {
         AVPacket *pkt = m_storedPackets.takeFirst();
@@ -392,6 +419,9 @@ void AvFormatDecoder::CloseContext()
 {
     if (m_ic)
     {
+        if (m_readAhead)
+            m_readAhead->Flush();
+
         CloseCodecs();
 
         AVInputFormat *fmt = m_ic->iformat;
@@ -537,6 +567,8 @@ bool AvFormatDecoder::DoRewind(long long desiredFrame, bool discardFrames)
     LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("DoRewind(%1, %2 discard frames)")
             .arg(desiredFrame).arg( discardFrames ? "do" : "don't" ));
 
+    SyncKeyframeIndex();
+
     if (m_recordingHasPositionMap || m_livetv)
         return DecoderBase::DoRewind(desiredFrame, discardFrames);
 
@@ -553,6 +585,8 @@ bool AvFormatDecoder::DoFastForward(long long desiredFrame, bool discardFrames)
             .arg(desiredFrame).arg(m_framesPlayed)
             .arg((discardFrames) ? "do" : "don't"));
 
+    SyncKeyframeIndex();
+
     if (m_recordingHasPositionMap || m_livetv)
         return DecoderBase::DoFastForward(desiredFrame, discardFrames);
 
@@ -594,6 +628,9 @@ bool AvFormatDecoder::DoFastForward(long long desiredFrame, bool discardFrames)
 
     int flags = (m_doRewind || exactseeks) ? AVSEEK_FLAG_BACKWARD : 0;
 
+    if (m_readAhead)
+        m_readAhead->Pause();
+
     if (av_seek_frame(m_ic, -1, ts, flags) < 0)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
@@ -700,6 +737,9 @@ void AvFormatDecoder::SeekReset(long long newKey, uint skipFrames,
         m_ptsDetected = false;
         m_reorderedPtsDetected = false;
 
+        if (m_readAhead)
+            m_readAhead->Flush();
+
         ff_read_frame_flush(m_ic);
 
         // Only reset the internal state if we're using our seeking,
@@ -813,6 +853,10 @@ void AvFormatDecoder::SetEof(bool eof)
 {
     if (!eof && m_ic && m_ic->pb)
     {
+        // Stop reading ahead until the decoder next asks for a packet
+        if (m_readAhead)
+            m_readAhead->Pause();
+        QMutexLocker locker(&m_avCodecLock);
         LOG(VB_GENERAL, LOG_NOTICE, LOC +
             QString("Resetting byte context eof (livetv %1 was eof %2)")
                 .arg(m_livetv).arg(m_ic->pb->eof_reached));
@@ -899,11 +943,17 @@ extern "C" void HandleStreamChange(void *data)
         QString("streams_changed 0x%1 -- stream count %2")
             .arg((uint64_t)data,0,16).arg(cnt));
 
-    decoder->m_streamsChanged = true;
+    // When reading ahead, the decoder is told once it reaches this packet
+    if (decoder->m_readAhead && decoder->m_readAhead->IsDemuxThread())
+        decoder->m_readAhead->StreamsChanged();
+    else
+        decoder->m_streamsChanged = true;
 }
 
 int AvFormatDecoder::FindStreamInfo(void)
 {
+    if (m_readAhead)
+        m_readAhead->Pause();
     m_avCodecLock.lock();
     int retval = avformat_find_stream_info(m_ic, nullptr);
     m_avCodecLock.unlock();
@@ -1136,6 +1186,12 @@ int AvFormatDecoder::OpenFile(MythMediaBuffer *Buffer, bool novideo,
     }
 #endif // USING_MHEG
 
+    // Files without a position map in the database can be given one by
+    // indexing their keyframes, if they can be seeked by byte offset.
+    m_buildKeyframeIndex = !m_livetv && !m_watchingRecording && !m_ringBuffer->IsDisc() &&
+                           KeyframeIndexBuilder::IsIndexable(m_ic->iformat->name) &&
+                           gCoreContext->GetBoolSetting("KeyframeIndexCache", true);
+
     // Try to get a position map from the recorder if we don't have one yet.
     if (!m_recordingHasPositionMap && !m_isDbIgnored)
     {
@@ -1211,6 +1267,21 @@ int AvFormatDecoder::OpenFile(MythMediaBuffer *Buffer, bool novideo,
     else
         m_ic->build_index = 0;
 
+    // Demux on a separate thread, ahead of GetFrame(). LiveTV and discs are
+    // excluded as they act upon the position of each packet as it is read.
+    if (!m_readAhead && !m_livetv && !m_ringBuffer->LiveMode() && !m_ringBuffer->IsDisc())
+    {
+        int readahead = gCoreContext->GetNumSetting("DecoderReadAheadSize",
+                            static_cast<int>(MythDemuxThread::kDefaultMaxBytes >> 20));
+        if (readahead > 0)
+        {
+            m_readAhead = new MythDemuxThread(&m_avCodecLock,
+                [this](AVPacket *Packet) { return av_read_frame(m_ic, Packet); },
+                MythDemuxThread::kDefaultMaxPackets, static_cast<int64_t>(readahead) << 20);
+            m_readAhead->start();
+        }
+    }
+
     av_dump_format(m_ic, 0, filename, 0);
 
     // print some useful information if playback debugging is on
@@ -2545,11 +2616,15 @@ void AvFormatDecoder::UpdateFramesPlayed(void)
 
 bool AvFormatDecoder::DoRewindSeek(long long desiredFrame)
 {
+    if (m_readAhead)
+        m_readAhead->Pause();
     return DecoderBase::DoRewindSeek(desiredFrame);
 }
 
 void AvFormatDecoder::DoFastForwardSeek(long long desiredFrame, bool &needflush)
 {
+    if (m_readAhead)
+        m_readAhead->Pause();
     DecoderBase::DoFastForwardSeek(desiredFrame, needflush);
 }
 
@@ -3112,7 +3187,7 @@ void AvFormatDecoder::MpegPreProcessPkt(AVStream *stream, AVPacket *pkt)
 
     while (bufptr < bufend)
     {
-        bufptr = avpriv_find_start_code(bufptr, bufend, &m_startCodeState);
+        bufptr = ByteReader::FindStartCode(bufptr, bufend, &m_startCodeState);
 
         float aspect_override = -1.0F;
         if (m_ringBuffer->IsDVD())
@@ -3607,7 +3682,8 @@ bool AvFormatDecoder::ProcessVideoFrame(AVStream *Stream, AVFrame *AvFrame)
         frame = m_parent->GetNextVideoFrame();
         frame->m_directRendering = false;
 
-        if (!m_mythCodecCtx->RetrieveFrame(context, frame, AvFrame))
+        if (!m_mythCodecCtx->RetrieveFrame(context, frame, AvFrame) &&
+            !CopySoftwareFrame(frame, AvFrame))
         {
             AVFrame tmppicture;
             av_image_fill_arrays(tmppicture.data, tmppicture.linesize,
@@ -4930,6 +5006,10 @@ bool AvFormatDecoder::GetFrame(DecodeType decodetype, bool &Retry)
                 pkt->pos -= m_readAdjust;
         }
 
+        // The demux thread may add or remove streams while it reads, so
+        // keep it out until this packet has been dealt with
+        QMutexLocker streamLocker(&m_avCodecLock);
+
         if (!m_ic)
         {
             LOG(VB_GENERAL, LOG_ERR, LOC + "No context");
@@ -5100,6 +5180,15 @@ void AvFormatDecoder::StreamChangeCheck(void)
 
 int AvFormatDecoder::ReadPacket(AVFormatContext *ctx, AVPacket *pkt, bool &/*storePacket*/)
 {
+    if (m_readAhead && (ctx == m_ic))
+    {
+        bool changed = false;
+        int result = m_readAhead->GetPacket(pkt, changed);
+        if (changed)
+            m_streamsChanged = true;
+        return result;
+    }
+
     m_avCodecLock.lock();
     int result = av_read_frame(ctx, pkt);
     m_avCodecLock.unlock();
@@ -5162,6 +5251,11 @@ QString AvFormatDecoder::GetCodecDecoderName(void) const
     return get_decoder_name(m_videoCodecId);
 }
 
+QString AvFormatDecoder::GetReadAheadStats(void) const
+{
+    return m_readAhead ? m_readAhead->GetStatsString() : QString();
+}
+
 QString AvFormatDecoder::GetRawEncodingType(void)
 {
     int stream = m_selectedTrack[kTrackTypeVideo].m_av_stream_index;
@@ -34,6 +34,7 @@ class SubtitleReader;
 class InteractiveTV;
 class ProgramInfo;
 class MythSqlDatabase;
+class MythDemuxThread;
 
 struct SwsContext;
 
@@ -137,6 +138,7 @@ class AvFormatDecoder : public DecoderBase
     long UpdateStoredFrameNum(long frame) override { (void)frame; return 0;} // DecoderBase
 
     QString      GetCodecDecoderName(void) const override; // DecoderBase
+    QString      GetReadAheadStats(void) const override; // DecoderBase
     QString      GetRawEncodingType(void) override; // DecoderBase
     MythCodecID  GetVideoCodecID(void) const override { return m_videoCodecId; } // DecoderBase
 
@@ -368,6 +370,12 @@ class AvFormatDecoder : public DecoderBase
     std::chrono::milliseconds  m_audioReadAhead       {100ms};
 
     QMutex             m_avCodecLock                  { QMutex::Recursive };
+
+    /// Reads packets ahead of GetFrame() when playing files. It holds
+    /// m_avCodecLock while it reads, as a read may add or remove streams,
+    /// so hold m_avCodecLock while using m_ic->streams. Anything else that
+    /// uses the demuxer's input must Pause() or Flush() m_readAhead first.
+    MythDemuxThread   *m_readAhead                    { nullptr };
 };
 
 #endif
@@ -6,6 +6,8 @@
 #include "mythplayer.h"
 #include "mythlogging.h"
 #include "decoderbase.h"
+#include "keyframeindex.h"
+#include "keyframeindexbuilder.h"
 #include "programinfo.h"
 #include "iso639.h"
 #include "DVD/mythdvdbuffer.h"
@@ -31,6 +33,8 @@ DecoderBase::DecoderBase(MythPlayer *parent, const ProgramInfo &pginfo)
 DecoderBase::~DecoderBase()
 {
     delete m_playbackInfo;
+    delete m_keyframeBuilder;
+    delete m_keyframeIndex;
 }
 
 void DecoderBase::SetRenderFormats(const VideoFrameTypes* RenderFormats)
@@ -291,6 +295,164 @@ bool DecoderBase::PosMapFromEnc(void)
     return true;
 }
 
+/** \fn DecoderBase::PosMapFromSidecar(void)
+ *  \brief Reads new position map entries from the keyframe index the
+ *         recorder writes next to a recording in progress.
+ *
+ *  \return false if there is no usable index for the current file.
+ */
+bool DecoderBase::PosMapFromSidecar(void)
+{
+    if (!m_ringBuffer || m_ringBuffer->IsDisc())
+        return false;
+
+    QString filename = m_ringBuffer->GetFilename();
+    if (filename.isEmpty() || filename.contains("://"))
+        return false;
+
+    return LoadKeyframeIndex(KeyframeIndex::SidecarFilename(filename));
+}
+
+/** \fn DecoderBase::PosMapFromKeyframeCache(void)
+ *  \brief Reads the position map from a keyframe index built for a file
+ *         that has none in the database.
+ *
+ *  If there is no up to date index, one is built in the background and
+ *  SyncKeyframeIndex() switches to it once it is complete.
+ *
+ *  \return false if there is no usable index for the current file yet.
+ */
+bool DecoderBase::PosMapFromKeyframeCache(void)
+{
+    if (!m_buildKeyframeIndex || !m_ringBuffer || m_ringBuffer->IsDisc())
+        return false;
+
+    QString filename = m_ringBuffer->GetFilename();
+    if (filename.isEmpty() || filename.contains("://"))
+        return false;
+
+    QString index = KeyframeIndexBuilder::CachedIndex(filename);
+    if (!index.isEmpty())
+        return LoadKeyframeIndex(index);
+
+    if (!m_keyframeBuilder)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("No position map, building a keyframe index for '%1'")
+                .arg(filename));
+        m_keyframeBuilder = new KeyframeIndexBuilder(filename);
+        m_keyframeBuilder->start(QThread::LowPriority);
+    }
+    return false;
+}
+
+/** \fn DecoderBase::SyncKeyframeIndex(void)
+ *  \brief Switches from libavformat seeking to the position map once the
+ *         keyframe index started by PosMapFromKeyframeCache() is built.
+ */
+void DecoderBase::SyncKeyframeIndex(void)
+{
+    if (!m_keyframeBuilder || !m_keyframeBuilder->isFinished())
+        return;
+
+    QString index = m_keyframeBuilder->Index();
+    delete m_keyframeBuilder;
+    m_keyframeBuilder = nullptr;
+    m_buildKeyframeIndex = false;
+    if (index.isEmpty() || m_recordingHasPositionMap)
+        return;
+
+    // The map built while playing is numbered by the keyframe distance
+    // guessed for libavformat seeking, the index by frame.
+    MarkTypes type = m_positionMapType;
+    int keyframedist = m_keyframeDist;
+    m_positionMapType = MARK_UNSET;
+    m_keyframeDist = -1;
+    if (!LoadKeyframeIndex(index))
+    {
+        m_positionMapType = type;
+        m_keyframeDist = keyframedist;
+        return;
+    }
+
+    m_recordingHasPositionMap = true;
+    m_hasFullPositionMap = true;
+    m_posmapStarted = true;
+    m_parent->SetKeyframeDistance(m_keyframeDist);
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + "Seeking with the keyframe index from now on");
+}
+
+/** \fn DecoderBase::LoadKeyframeIndex(const QString&)
+ *  \brief Reads new position map entries from the keyframe index in
+ *         \p filename.
+ *
+ *  The first successful call replaces the position map with the whole
+ *  index, later calls only append the keyframes written since.
+ */
+bool DecoderBase::LoadKeyframeIndex(const QString &filename)
+{
+    if (!m_keyframeIndex || m_keyframeIndex->Filename() != filename)
+    {
+        delete m_keyframeIndex;
+        m_keyframeIndex = new KeyframeIndexReader(filename);
+        m_keyframeIndexLoaded = false;
+    }
+
+    if (!m_keyframeIndex->Refresh() || m_keyframeIndex->size() == 0)
+        return false;
+
+    MarkTypes type = m_keyframeIndex->Type();
+    if (m_positionMapType == MARK_UNSET)
+    {
+        m_positionMapType = type;
+        if (m_keyframeDist == -1 && type == MARK_GOP_BYFRAME)
+            m_keyframeDist = 1;
+        else if (m_keyframeDist == -1 && type == MARK_GOP_START)
+            m_keyframeDist = (m_fps < 26 && m_fps > 24) ? 12 : 15;
+    }
+    if (m_positionMapType != type || m_keyframeDist < 1)
+        return false;
+
+    QMutexLocker locker(&m_positionMapLock);
+
+    if (!m_keyframeIndexLoaded)
+    {
+        m_positionMap.clear();
+        m_frameToDurMap.clear();
+        m_durToFrameMap.clear();
+        m_keyframeIndexLoaded = true;
+    }
+
+    size_t first = 0;
+    if (!m_positionMap.empty())
+        first = m_keyframeIndex->LowerBound(m_positionMap.back().index + 1);
+    size_t count = m_keyframeIndex->size();
+
+    m_positionMap.reserve(m_positionMap.size() + (count - first));
+    for (size_t i = first; i < count; ++i)
+    {
+        const KeyframeIndex::Entry &entry = (*m_keyframeIndex)[i];
+        PosMapEntry e = {entry.m_frame, entry.m_frame * m_keyframeDist,
+                         entry.m_offset};
+        m_positionMap.push_back(e);
+        if (entry.m_duration >= 0)
+        {
+            m_frameToDurMap[entry.m_frame] = entry.m_duration;
+            m_durToFrameMap[entry.m_duration] = entry.m_frame;
+        }
+    }
+
+    if (!m_positionMap.empty())
+    {
+        m_indexOffset = m_positionMap[0].index;
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Position map filled from keyframe index to: %1")
+                .arg(m_positionMap.back().index));
+    }
+
+    return true;
+}
+
 unsigned long DecoderBase::GetPositionMapSize(void) const
 {
     QMutexLocker locker(&m_positionMapLock);
@@ -310,10 +472,11 @@ unsigned long DecoderBase::GetPositionMapSize(void) const
  *   decide keyframedist based on samples from remote encoder
  *
  *   watching recording:
- *   1. initial fill from db
- *   2. incremental from remote encoder, until it finishes recording
- *   3. then db again (which should be the final time)
- *   4. stream parsing
+ *   1. keyframe index written next to the recording, when it is local
+ *   2. otherwise initial fill from db
+ *   3. incremental from remote encoder, until it finishes recording
+ *   4. then db again (which should be the final time)
+ *   5. stream parsing
  *   decide keyframedist based on which table in db
  *
  *   watching prerecorded:
@@ -332,7 +495,14 @@ bool DecoderBase::SyncPositionMap(void)
     unsigned long old_posmap_size = GetPositionMapSize();
     unsigned long new_posmap_size = old_posmap_size;
 
-    if (m_livetv || m_watchingRecording)
+    if ((m_livetv || m_watchingRecording) && PosMapFromSidecar())
+    {
+        new_posmap_size = GetPositionMapSize();
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("SyncPositionMap watchingrecording, from keyframe index: "
+                    "%1 entries").arg(new_posmap_size));
+    }
+    else if (m_livetv || m_watchingRecording)
     {
         if (!m_posmapStarted)
         {
@@ -368,6 +538,15 @@ bool DecoderBase::SyncPositionMap(void)
             LOG(VB_PLAYBACK, LOG_INFO, LOC +
                 QString("SyncPositionMap prerecorded, from DB: %1 entries")
                     .arg(new_posmap_size));
+
+            // not a recording ... try the keyframe index we build ourselves
+            if (!new_posmap_size && PosMapFromKeyframeCache())
+            {
+                new_posmap_size = GetPositionMapSize();
+                LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                    QString("SyncPositionMap prerecorded, from keyframe "
+                            "index: %1 entries").arg(new_posmap_size));
+            }
         }
     }
 
@@ -18,6 +18,8 @@ class TeletextViewer;
 class MythPlayer;
 class AudioPlayer;
 class MythCodecContext;
+class KeyframeIndexReader;
+class KeyframeIndexBuilder;
 
 const int kDecoderProbeBufferSize = 256 * 1024;
 using TestBufferVec = std::vector<char>;
@@ -206,12 +208,15 @@ class DecoderBase
 
     virtual QString GetCodecDecoderName(void) const = 0;
     virtual QString GetRawEncodingType(void) { return QString(); }
+    virtual QString GetReadAheadStats(void) const { return QString(); }
     virtual MythCodecID GetVideoCodecID(void) const = 0;
 
     virtual void ResetPosMap(void);
     virtual bool SyncPositionMap(void);
     virtual bool PosMapFromDb(void);
     virtual bool PosMapFromEnc(void);
+    virtual bool PosMapFromSidecar(void);
+    virtual bool PosMapFromKeyframeCache(void);
 
     virtual bool FindPosition(long long desired_value, bool search_adjusted,
                               int &lower_bound, int &upper_bound);
@@ -274,6 +279,8 @@ class DecoderBase
     long long ConditionallyUpdatePosMap(long long desiredFrame);
     long long GetLastFrameInPosMap(void) const;
     unsigned long GetPositionMapSize(void) const;
+    bool LoadKeyframeIndex(const QString &filename);
+    void SyncKeyframeIndex(void);
 
     struct PosMapEntry
     {
@@ -326,6 +333,11 @@ class DecoderBase
     frm_pos_map_t        m_frameToDurMap; // guarded by m_positionMapLock
     frm_pos_map_t        m_durToFrameMap; // guarded by m_positionMapLock
     mutable QDateTime    m_lastPositionMapUpdate; // guarded by m_positionMapLock
+    KeyframeIndexReader *m_keyframeIndex           {nullptr};
+    bool                 m_keyframeIndexLoaded     {false};
+    KeyframeIndexBuilder *m_keyframeBuilder        {nullptr};
+    /// Set if the file may be given a keyframe index when it has no position map
+    bool                 m_buildKeyframeIndex      {false};
 
     uint64_t             m_seekSnap                {UINT64_MAX};
     bool                 m_dontSyncPositionMap     {false};
@@ -0,0 +1,236 @@
+// Qt
+#include <QThread>
+
+// MythTV
+#include "mythlogging.h"
+#include "mythdemuxthread.h"
+
+// Std
+#include <algorithm>
+
+// FFmpeg
+extern "C" {
+#include "libavutil/error.h"
+#include "libavcodec/avcodec.h"
+}
+
+#define LOC QString("DemuxThread: ")
+
+MythDemuxThread::MythDemuxThread(QMutex* DemuxLock, ReadFunc Read,
+                                 int MaxPackets, int64_t MaxBytes)
+  : MThread("Demux"),
+    m_demuxLock(DemuxLock),
+    m_read(std::move(Read)),
+    m_maxPackets(std::max(MaxPackets, 1)),
+    m_maxBytes(std::max(MaxBytes, static_cast<int64_t>(1)))
+{
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Reading ahead up to %1 packets or %2Mb")
+        .arg(m_maxPackets).arg(m_maxBytes >> 20));
+}
+
+MythDemuxThread::~MythDemuxThread()
+{
+    m_lock.lock();
+    m_stop = true;
+    m_wake.wakeAll();
+    m_ready.wakeAll();
+    m_lock.unlock();
+
+    wait();
+    Discard();
+}
+
+/*! \brief Return the next packet, or the error that the demuxer returned in its place.
+ *
+ * Blocks until the demux thread has read something. StreamsChanged is set if
+ * the demuxer signalled a stream change while reading this packet, in which
+ * case any packets read before it have been dropped. Reading then stops until
+ * the caller has dealt with the change and asks for another packet.
+*/
+int MythDemuxThread::GetPacket(AVPacket* Packet, bool& StreamsChanged)
+{
+    StreamsChanged = false;
+    QMutexLocker locker(&m_lock);
+
+    if (!m_active && !m_changeQueued)
+    {
+        m_active = true;
+        m_wake.wakeAll();
+    }
+
+    if (m_queue.empty())
+        m_waits++;
+    while (m_queue.empty() && !m_stop)
+        m_ready.wait(locker.mutex());
+    if (m_queue.empty())
+        return AVERROR_EXIT;
+
+    QueuedPacket queued = m_queue.front();
+    m_queue.pop_front();
+    m_wake.wakeAll();
+
+    if (queued.m_streamsChanged)
+    {
+        StreamsChanged = true;
+        m_changeQueued = false;
+    }
+
+    if (!queued.m_packet)
+    {
+        m_errorQueued = false;
+        return queued.m_error;
+    }
+
+    m_bytes -= queued.m_packet->size;
+    av_packet_unref(Packet);
+    av_packet_move_ref(Packet, queued.m_packet);
+    av_packet_free(&queued.m_packet);
+    return 0;
+}
+
+/*! \brief Stop reading ahead, waiting for any read in progress to complete.
+ *
+ * Queued packets are kept. Call this before touching the demuxer or the
+ * position of its input.
+*/
+void MythDemuxThread::Pause()
+{
+    QMutexLocker locker(&m_lock);
+    m_active = false;
+    while (m_reading)
+        m_ready.wait(locker.mutex());
+}
+
+/*! \brief Stop reading ahead and discard everything that has been queued.
+ *
+ * A read that started before the flush is discarded when it completes, so
+ * the next packet returned is the first one read after the demuxer is reset.
+*/
+void MythDemuxThread::Flush()
+{
+    QMutexLocker locker(&m_lock);
+    m_active = false;
+    m_generation++;
+    while (m_reading)
+        m_ready.wait(locker.mutex());
+    Discard();
+}
+
+/// \brief Note a stream change signalled by the demuxer during the current read.
+void MythDemuxThread::StreamsChanged()
+{
+    m_changePending = true;
+}
+
+bool MythDemuxThread::IsDemuxThread()
+{
+    return QThread::currentThread() == qthread();
+}
+
+QString MythDemuxThread::GetStatsString() const
+{
+    QMutexLocker locker(&m_lock);
+    return QString("%1 pkts %2/%3Mb (peak %4) %5 waits")
+        .arg(m_queue.size())
+        .arg(static_cast<double>(m_bytes) / (1 << 20), 0, 'f', 1)
+        .arg(m_maxBytes >> 20)
+        .arg(static_cast<double>(m_peakBytes) / (1 << 20), 0, 'f', 1)
+        .arg(m_waits);
+}
+
+void MythDemuxThread::run()
+{
+    RunProlog();
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + "Demux thread starting.");
+
+    m_lock.lock();
+    while (!m_stop)
+    {
+        if (!m_active || m_errorQueued || IsFull())
+        {
+            m_wake.wait(&m_lock);
+            continue;
+        }
+        uint64_t generation = m_generation;
+        m_lock.unlock();
+
+        // Check for a flush once we hold the demuxer lock. A thread that
+        // flushes while holding it cannot then have our read straddle its
+        // reset of the demuxer.
+        AVPacket* packet = av_packet_alloc();
+        int result = 0;
+        bool changed = false;
+        m_demuxLock->lock();
+        m_lock.lock();
+        bool current = m_active && !m_stop && (generation == m_generation);
+        m_reading = current;
+        m_lock.unlock();
+        if (current)
+        {
+            m_changePending = false;
+            result = m_read(packet);
+            changed = m_changePending;
+        }
+        m_demuxLock->unlock();
+
+        m_lock.lock();
+        m_reading = false;
+        m_ready.wakeAll();
+        if (!current || (generation != m_generation))
+        {
+            av_packet_free(&packet);
+            continue;
+        }
+
+        // Packets queued before the change refer to streams by their old
+        // index, which may now be another stream or none at all
+        if (changed)
+        {
+            LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Stream change - dropping %1 queued packets")
+                .arg(m_queue.size()));
+            Discard();
+        }
+
+        if (result < 0)
+        {
+            av_packet_free(&packet);
+            m_errorQueued = true;
+            m_queue.push_back({ nullptr, result, changed });
+        }
+        else
+        {
+            m_bytes += packet->size;
+            m_peakBytes = std::max(m_peakBytes, m_bytes);
+            m_queue.push_back({ packet, 0, changed });
+        }
+
+        if (changed)
+        {
+            LOG(VB_PLAYBACK, LOG_INFO, LOC + "Stream change - waiting for decoder");
+            m_changeQueued = true;
+            m_active = false;
+        }
+    }
+    m_lock.unlock();
+
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + "Demux thread exiting.");
+    RunEpilog();
+}
+
+/// \note m_lock must be held.
+bool MythDemuxThread::IsFull() const
+{
+    return (m_queue.size() >= static_cast<size_t>(m_maxPackets)) || (m_bytes >= m_maxBytes);
+}
+
+/// \note m_lock must be held (or the thread stopped).
+void MythDemuxThread::Discard()
+{
+    for (auto & queued : m_queue)
+        av_packet_free(&queued.m_packet);
+    m_queue.clear();
+    m_bytes        = 0;
+    m_errorQueued  = false;
+    m_changeQueued = false;
+    m_wake.wakeAll();
+}
@@ -0,0 +1,91 @@
+#ifndef MYTHDEMUXTHREAD_H
+#define MYTHDEMUXTHREAD_H
+
+// Qt
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// MythTV
+#include "mythtvexp.h"
+#include "mthread.h"
+
+// Std
+#include <deque>
+#include <functional>
+
+struct AVPacket;
+
+/*! \class MythDemuxThread
+ *  \brief Reads packets from a demuxer ahead of the decoder.
+ *
+ *  Packets (and read errors) are queued in the order they are read, up to a
+ *  maximum number of packets and bytes. Each read is made while holding the
+ *  given demuxer lock. As a read may add or remove streams, the consumer
+ *  must hold the same lock while it looks up or uses the demuxer's streams.
+ *
+ *  When the demuxer signals a stream change, the packets queued before it are
+ *  dropped, as their stream indexes refer to the old streams.
+ *
+ *  Reading starts with the first call to GetPacket(). Before the demuxer is
+ *  repositioned, call Pause() (to finish the read in progress) or Flush() (to
+ *  also discard everything already queued); reading resumes with the next
+ *  call to GetPacket().
+*/
+class MTV_PUBLIC MythDemuxThread : public MThread
+{
+  public:
+    using ReadFunc = std::function<int(AVPacket* Packet)>;
+
+    static constexpr int     kDefaultMaxPackets { 2000 };
+    static constexpr int64_t kDefaultMaxBytes   { 16LL << 20 };
+
+    MythDemuxThread(QMutex* DemuxLock, ReadFunc Read,
+                    int MaxPackets = kDefaultMaxPackets,
+                    int64_t MaxBytes = kDefaultMaxBytes);
+    ~MythDemuxThread() override;
+
+    int     GetPacket      (AVPacket* Packet, bool& StreamsChanged);
+    void    Pause          ();
+    void    Flush          ();
+    void    StreamsChanged ();
+    bool    IsDemuxThread  ();
+    QString GetStatsString () const;
+
+  protected:
+    void run() override;
+
+  private:
+    Q_DISABLE_COPY(MythDemuxThread)
+
+    struct QueuedPacket
+    {
+        AVPacket* m_packet         { nullptr };
+        int       m_error          { 0 };
+        bool      m_streamsChanged { false };
+    };
+
+    bool IsFull() const;
+    void Discard();
+
+    QMutex*        m_demuxLock    { nullptr };
+    ReadFunc       m_read;
+    int            m_maxPackets   { kDefaultMaxPackets };
+    int64_t        m_maxBytes     { kDefaultMaxBytes };
+    mutable QMutex m_lock;
+    QWaitCondition m_wake;
+    QWaitCondition m_ready;
+    std::deque<QueuedPacket> m_queue;
+    int64_t        m_bytes        { 0 };
+    bool           m_stop         { false };
+    bool           m_active       { false };
+    bool           m_reading      { false };
+    bool           m_errorQueued  { false };
+    bool           m_changeQueued { false };
+    uint64_t       m_generation   { 0 };
+    bool           m_changePending { false };
+    int64_t        m_peakBytes    { 0 };
+    uint64_t       m_waits        { 0 };
+};
+
+#endif
@@ -5,11 +5,18 @@
  * License: GPL v2
  */
 
+#include <algorithm>
+#include <array>
+
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
 
 #include "eitcache.h"
 #include "mythcontext.h"
 #include "mythdb.h"
+#include "mythdirs.h"
 #include "mythlogging.h"
 #include "mythdate.h"
 
@@ -18,6 +25,9 @@
 // Highest version number. version is 5bits
 const uint EITCache::kVersionMax = 31;
 
+// Maximum number of rows in one REPLACE statement
+static constexpr int kMaxRowsPerWrite = 1000;
+
 EITCache::EITCache()
 {
     // 24 hours ago
@@ -27,6 +37,66 @@ EITCache::EITCache()
 EITCache::~EITCache()
 {
     WriteToDB();
+    CloseSnapshot();
+}
+
+static inline size_t hash_key(uint64_t key)
+{
+    // splitmix64 finalizer, eventids are often sequential
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<size_t>(key);
+}
+
+uint64_t *EITEventTable::Find(uint64_t key)
+{
+    if (m_entries.empty())
+        return nullptr;
+
+    size_t mask = m_entries.size() - 1;
+    for (size_t i = hash_key(key) & mask; m_entries[i].m_key; i = (i + 1) & mask)
+    {
+        if (m_entries[i].m_key == key)
+            return &m_entries[i].m_sig;
+    }
+    return nullptr;
+}
+
+void EITEventTable::Insert(uint64_t key, uint64_t sig)
+{
+    // Keep the load factor below 3/4
+    if ((m_size + 1) * 4 > m_entries.size() * 3)
+        Grow();
+
+    size_t mask = m_entries.size() - 1;
+    size_t i = hash_key(key) & mask;
+    for (; m_entries[i].m_key; i = (i + 1) & mask)
+    {
+        if (m_entries[i].m_key == key)
+        {
+            m_entries[i].m_sig = sig;
+            return;
+        }
+    }
+    m_entries[i].m_key = key;
+    m_entries[i].m_sig = sig;
+    m_size++;
+}
+
+void EITEventTable::Grow(void)
+{
+    std::vector<Entry> old;
+    old.swap(m_entries);
+    m_entries.resize(std::max<size_t>(1024, old.size() * 2));
+    m_size = 0;
+    for (const auto & entry : old)
+    {
+        if (entry.m_key)
+            Insert(entry.m_key, entry.m_sig);
+    }
 }
 
 void EITCache::ResetStatistics(void)
@@ -202,10 +272,13 @@ static void unlock_channel(uint chanid, uint updated)
 }
 
 
-event_map_t * EITCache::LoadChannel(uint chanid)
+bool EITCache::LoadChannel(uint chanid)
 {
     if (!lock_channel(chanid, m_lastPruneTime))
-        return nullptr;
+        return false;
+
+    if (LoadChannelFromSnapshot(chanid))
+        return true;
 
     MSqlQuery query(MSqlQuery::InitCon());
 
@@ -224,11 +297,10 @@ event_map_t * EITCache::LoadChannel(uint chanid)
     if (!query.exec() || !query.isActive())
     {
         MythDB::DBError("Error loading eitcache", query);
-        return nullptr;
+        return false;
     }
 
-    auto *eventMap = new event_map_t();
-
+    uint loaded = 0;
     while (query.next())
     {
         uint eventid = query.value(0).toUInt();
@@ -236,93 +308,273 @@ event_map_t * EITCache::LoadChannel(uint chanid)
         uint version = query.value(2).toUInt();
         uint endtime = query.value(3).toUInt();
 
-        (*eventMap)[eventid] = construct_sig(tableid, version, endtime, false);
+        m_events.Insert(EITEventTable::MakeKey(chanid, eventid),
+                        construct_sig(tableid, version, endtime, false));
+        loaded++;
     }
 
-    if (!eventMap->empty())
+    if (loaded)
         LOG(VB_EIT, LOG_INFO, LOC + QString("Loaded %1 entries for channel %2")
-                .arg(eventMap->size()).arg(chanid));
+                .arg(loaded).arg(chanid));
 
-    m_entryCnt += eventMap->size();
-    return eventMap;
+    m_entryCnt += loaded;
+    return true;
 }
 
-bool EITCache::WriteChannelToDB(QStringList &value_clauses, uint chanid)
+static QString snapshot_path(void)
 {
-    event_map_t * eventMap = m_channelMap[chanid];
+    return GetConfDir() + "/cache/eitcache.bin";
+}
 
-    if (!eventMap)
-        return false;
+struct EITSnapshotHeader
+{
+    std::array<char,8> m_magic;
+    uint32_t           m_version;
+    uint32_t           m_count;
+};
+
+static constexpr std::array<char,8> kSnapshotMagic
+    { 'M', 'Y', 'T', 'H', 'E', 'I', 'T', 'C' };
+static constexpr uint32_t kSnapshotVersion { 1 };
+
+static bool key_less(const EITEventTable::Entry &a,
+                     const EITEventTable::Entry &b)
+{
+    return a.m_key < b.m_key;
+}
 
-    uint size    = eventMap->size();
-    uint updated = 0;
-    uint removed = 0;
+/** \fn EITCache::OpenSnapshot(void)
+ *  \brief Maps the snapshot saved by the last WriteToDB(), so channels
+ *         can be loaded from it instead of row by row from the database.
+ */
+void EITCache::OpenSnapshot(void)
+{
+    m_snapshotOpened = true;
 
-    event_map_t::iterator it = eventMap->begin();
-    while (it != eventMap->end())
+    auto *file = new QFile(snapshot_path());
+    if (!file->open(QIODevice::ReadOnly))
     {
-        if (extract_endtime(*it) > m_lastPruneTime)
-        {
-            if (modified(*it))
-            {
-                replace_in_db(value_clauses, chanid, it.key(), *it);
-                updated++;
-                *it &= ~(uint64_t)0 >> 1; // mark as synced
-            }
-            ++it;
-        }
-        else
-        {
-            // Event is too old; remove from eit cache in memory
-            it = eventMap->erase(it);
-            removed++;
-        }
+        delete file;
+        return;
     }
-    unlock_channel(chanid, updated);
 
-    if (updated)
+    qint64 size = file->size();
+    uchar *data = nullptr;
+    if (size >= static_cast<qint64>(sizeof(EITSnapshotHeader)))
+        data = file->map(0, size);
+
+    const auto *header = reinterpret_cast<const EITSnapshotHeader*>(data);
+    if (!header || header->m_magic != kSnapshotMagic ||
+        header->m_version != kSnapshotVersion ||
+        size != static_cast<qint64>(sizeof(EITSnapshotHeader) +
+                                    header->m_count *
+                                    sizeof(EITEventTable::Entry)))
     {
-        LOG(VB_EIT, LOG_INFO, LOC + QString("Writing %1 modified entries of %2 "
-                                      "for channel %3 to database.")
-                .arg(updated).arg(size).arg(chanid));
+        LOG(VB_EIT, LOG_WARNING, LOC + QString("Ignoring invalid snapshot %1")
+                .arg(file->fileName()));
+        delete file;
+        return;
     }
-    if (removed)
+
+    m_snapshotFile = file;
+    m_snapshot = reinterpret_cast<const EITEventTable::Entry*>(header + 1);
+    m_snapshotSize = header->m_count;
+
+    LOG(VB_EIT, LOG_INFO, LOC + QString("Mapped %1 entries from snapshot %2")
+            .arg(m_snapshotSize).arg(file->fileName()));
+}
+
+void EITCache::CloseSnapshot(void)
+{
+    delete m_snapshotFile;
+    m_snapshotFile = nullptr;
+    m_snapshot = nullptr;
+    m_snapshotSize = 0;
+    m_snapshotOpened = false;
+}
+
+/** \fn EITCache::LoadChannelFromSnapshot(uint)
+ *  \brief Loads the entries of a channel from the snapshot, if the
+ *         database still holds the same number of entries for it.
+ */
+bool EITCache::LoadChannelFromSnapshot(uint chanid)
+{
+    if (!m_snapshotOpened)
+        OpenSnapshot();
+    if (!m_snapshot)
+        return false;
+
+    const EITEventTable::Entry *end = m_snapshot + m_snapshotSize;
+    EITEventTable::Entry lo { EITEventTable::MakeKey(chanid, 0), 0 };
+    EITEventTable::Entry hi { EITEventTable::MakeKey(chanid, 0xffffffff), 0 };
+    const auto *first = std::lower_bound(m_snapshot, end, lo, key_less);
+    const auto *last  = std::upper_bound(first, end, hi, key_less);
+
+    uint live = std::count_if(first, last,
+        [this](const EITEventTable::Entry &entry)
+        { return extract_endtime(entry.m_sig) > m_lastPruneTime; });
+    if (!live)
+        return false;
+
+    // Another backend may have written this channel since the
+    // snapshot was saved.
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT COUNT(*) "
+                  "FROM eit_cache "
+                  "WHERE chanid  = :CHANID   AND "
+                  "      endtime > :ENDTIME  AND "
+                  "      status  = :STATUS");
+    query.bindValue(":CHANID",  chanid);
+    query.bindValue(":ENDTIME", m_lastPruneTime);
+    query.bindValue(":STATUS",  EITDATA);
+    if (!query.exec() || !query.next())
+    {
+        MythDB::DBError("Error counting eitcache entries", query);
+        return false;
+    }
+    if (query.value(0).toUInt() != live)
+        return false;
+
+    for (const auto *entry = first; entry != last; ++entry)
     {
-        LOG(VB_EIT, LOG_INFO, LOC + QString("Removed %1 old entries of %2 "
-                                      "for channel %3 from cache.")
-                .arg(removed).arg(size).arg(chanid));
+        if (extract_endtime(entry->m_sig) > m_lastPruneTime)
+            m_events.Insert(entry->m_key, entry->m_sig);
     }
-    m_pruneCnt += removed;
 
+    LOG(VB_EIT, LOG_INFO, LOC +
+        QString("Loaded %1 entries for channel %2 from snapshot")
+            .arg(live).arg(chanid));
+
+    m_entryCnt += live;
     return true;
 }
 
+/** \fn EITCache::SaveSnapshot(void)
+ *  \brief Saves all synced entries, and those of the channels not
+ *         loaded since the last snapshot, to a new snapshot.
+ */
+void EITCache::SaveSnapshot(void)
+{
+    std::vector<EITEventTable::Entry> entries;
+    entries.reserve(m_events.size());
+    m_events.ForEach([&entries](uint64_t key, uint64_t sig)
+        { entries.push_back({ key, sig }); });
+
+    if (!m_snapshotOpened)
+        OpenSnapshot();
+    for (uint i = 0; i < m_snapshotSize; ++i)
+    {
+        const EITEventTable::Entry &entry = m_snapshot[i];
+        if (!m_channels.contains(EITEventTable::KeyChanID(entry.m_key)) &&
+            extract_endtime(entry.m_sig) > m_lastPruneTime)
+            entries.push_back(entry);
+    }
+    CloseSnapshot();
+
+    std::sort(entries.begin(), entries.end(), key_less);
+
+    EITSnapshotHeader header {};
+    header.m_magic   = kSnapshotMagic;
+    header.m_version = kSnapshotVersion;
+    header.m_count   = entries.size();
+
+    QDir().mkpath(GetConfDir() + "/cache");
+    QSaveFile file(snapshot_path());
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header)) < 0 ||
+        file.write(reinterpret_cast<const char*>(entries.data()),
+                   entries.size() * sizeof(EITEventTable::Entry)) < 0 ||
+        !file.commit())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to save snapshot %1")
+                .arg(file.fileName()));
+    }
+}
+
 void EITCache::WriteToDB(void)
 {
     QMutexLocker locker(&m_eventMapLock);
 
+    struct ChannelCounts
+    {
+        uint m_size    {0};
+        uint m_updated {0};
+        uint m_removed {0};
+    };
+    QMap<uint, ChannelCounts> counts;
+
     QStringList value_clauses;
-    key_map_t::iterator it = m_channelMap.begin();
-    while (it != m_channelMap.end())
+    m_events.ForEach([&](uint64_t key, uint64_t &sig)
     {
-        if (!WriteChannelToDB(value_clauses, it.key()))
-            it = m_channelMap.erase(it);
-        else
-            ++it;
+        uint chanid = EITEventTable::KeyChanID(key);
+        ChannelCounts &count = counts[chanid];
+        count.m_size++;
+        if (extract_endtime(sig) <= m_lastPruneTime)
+        {
+            // Event is too old; removed from eit cache in memory below
+            count.m_removed++;
+        }
+        else if (modified(sig))
+        {
+            replace_in_db(value_clauses, chanid,
+                          EITEventTable::KeyEventID(key), sig);
+            count.m_updated++;
+            sig &= ~(uint64_t)0 >> 1; // mark as synced
+        }
+    });
+    uint removed = m_events.RemoveIf([this](uint64_t /*key*/, uint64_t sig)
+        { return extract_endtime(sig) <= m_lastPruneTime; });
+
+    auto it = m_channels.begin();
+    while (it != m_channels.end())
+    {
+        // Try to lock channels owned by another backend again later
+        if (!*it)
+        {
+            it = m_channels.erase(it);
+            continue;
+        }
+
+        uint chanid = it.key();
+        ChannelCounts count = counts.value(chanid);
+        unlock_channel(chanid, count.m_updated);
+
+        if (count.m_updated)
+        {
+            LOG(VB_EIT, LOG_INFO, LOC + QString("Writing %1 modified entries of %2 "
+                                          "for channel %3 to database.")
+                    .arg(count.m_updated).arg(count.m_size).arg(chanid));
+        }
+        if (count.m_removed)
+        {
+            LOG(VB_EIT, LOG_INFO, LOC + QString("Removed %1 old entries of %2 "
+                                          "for channel %3 from cache.")
+                    .arg(count.m_removed).arg(count.m_size).arg(chanid));
+        }
+        ++it;
     }
+    m_pruneCnt += removed;
+
+    if (!value_clauses.isEmpty() || removed)
+        SaveSnapshot();
 
     if(value_clauses.isEmpty())
     {
         return;
     }
 
+    // Write in bounded statements to stay below max_allowed_packet
     MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare(QString("REPLACE INTO eit_cache "
-                          "(chanid, eventid, tableid, version, endtime) "
-                          "VALUES %1").arg(value_clauses.join(",")));
-    if (!query.exec())
+    for (int i = 0; i < value_clauses.size(); i += kMaxRowsPerWrite)
     {
-        MythDB::DBError("Error updating eitcache", query);
+        query.prepare(QString("REPLACE INTO eit_cache "
+                              "(chanid, eventid, tableid, version, endtime) "
+                              "VALUES %1")
+                      .arg(value_clauses.mid(i, kMaxRowsPerWrite).join(",")));
+        if (!query.exec())
+        {
+            MythDB::DBError("Error updating eitcache", query);
+        }
     }
 }
 
@@ -354,33 +606,32 @@ bool EITCache::IsNewEIT(uint chanid,  uint tableid,   uint version,
     }
 
     QMutexLocker locker(&m_eventMapLock);
-    if (!m_channelMap.contains(chanid))
-    {
-        m_channelMap[chanid] = LoadChannel(chanid);
-    }
+    auto cit = m_channels.constFind(chanid);
+    if (cit == m_channels.constEnd())
+        cit = m_channels.insert(chanid, LoadChannel(chanid));
 
-    if (!m_channelMap[chanid])
+    if (!*cit)
     {
         m_wrongChannelHitCnt++;
         return false;
     }
 
-    event_map_t * eventMap = m_channelMap[chanid];
-    event_map_t::iterator it = eventMap->find(eventid);
-    if (it != eventMap->end())
+    uint64_t key = EITEventTable::MakeKey(chanid, eventid);
+    const uint64_t *sig = m_events.Find(key);
+    if (sig)
     {
-        if (extract_table_id(*it) > tableid)
+        if (extract_table_id(*sig) > tableid)
         {
             // EIT from lower (ie. better) table number
             m_tblChgCnt++;
         }
-        else if ((extract_table_id(*it) == tableid) &&
-                 (extract_version(*it) != version))
+        else if ((extract_table_id(*sig) == tableid) &&
+                 (extract_version(*sig) != version))
         {
             // EIT updated version on current table
             m_verChgCnt++;
         }
-        else if (extract_endtime(*it) != endtime)
+        else if (extract_endtime(*sig) != endtime)
         {
             // Endtime (starttime + duration) changed
             m_endChgCnt++;
@@ -393,7 +644,7 @@ bool EITCache::IsNewEIT(uint chanid,  uint tableid,   uint version,
         }
     }
 
-    eventMap->insert(eventid, construct_sig(tableid, version, endtime, true));
+    m_events.Insert(key, construct_sig(tableid, version, endtime, true));
     m_entryCnt++;
 
     return true;
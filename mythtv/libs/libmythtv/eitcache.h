@@ -7,6 +7,7 @@
 #define EIT_CACHE_H
 
 #include <cstdint>
+#include <vector>
 
 // Qt headers
 #include <QString>
@@ -16,8 +17,66 @@
 // MythTV headers
 #include "mythtvexp.h"
 
-using event_map_t = QMap<uint, uint64_t>;
-using key_map_t = QMap<uint, event_map_t*>;
+class QFile;
+
+/** \brief Open addressing hash table from (chanid, eventid) to the
+ *         packed table id, version and endtime of an event.
+ *
+ *  Uses linear probing, a key of 0 marks an empty slot (chanid 0 is
+ *  never valid).
+ */
+class EITEventTable
+{
+  public:
+    struct Entry
+    {
+        uint64_t m_key {0};
+        uint64_t m_sig {0};
+    };
+
+    static uint64_t MakeKey(uint chanid, uint eventid)
+        { return (static_cast<uint64_t>(chanid) << 32) | eventid; }
+    static uint KeyChanID(uint64_t key)  { return key >> 32; }
+    static uint KeyEventID(uint64_t key) { return key & 0xffffffff; }
+
+    uint64_t *Find(uint64_t key);
+    void Insert(uint64_t key, uint64_t sig);
+    size_t size(void) const { return m_size; }
+
+    /// Calls func(key, sig) for every entry, sig may be changed.
+    template <typename F> void ForEach(F func)
+    {
+        for (auto & entry : m_entries)
+            if (entry.m_key)
+                func(entry.m_key, entry.m_sig);
+    }
+
+    /// Removes every entry for which pred(key, sig) is true.
+    template <typename P> size_t RemoveIf(P pred)
+    {
+        std::vector<Entry> old;
+        old.swap(m_entries);
+        m_entries.resize(old.size());
+        m_size = 0;
+        size_t removed = 0;
+        for (const auto & entry : old)
+        {
+            if (!entry.m_key)
+                continue;
+            if (pred(entry.m_key, entry.m_sig))
+                removed++;
+            else
+                Insert(entry.m_key, entry.m_sig);
+        }
+        return removed;
+    }
+
+  private:
+    void Grow(void);
+
+    std::vector<Entry> m_entries;
+    size_t             m_size {0};
+};
 
 class EITCache
 {
@@ -35,11 +94,22 @@ class EITCache
     QString GetStatistics(void) const;
 
   private:
-    event_map_t * LoadChannel(uint chanid);
-    bool WriteChannelToDB(QStringList &value_clauses, uint chanid);
+    bool LoadChannel(uint chanid);
+    bool LoadChannelFromSnapshot(uint chanid);
+    void OpenSnapshot(void);
+    void CloseSnapshot(void);
+    void SaveSnapshot(void);
 
     // event key cache
-    key_map_t      m_channelMap;
+    EITEventTable  m_events;
+    // channels locked by us (true) or by another backend (false)
+    QMap<uint,bool> m_channels;
+
+    // read only snapshot of the cache from the last write, sorted by key
+    QFile         *m_snapshotFile       {nullptr};
+    const EITEventTable::Entry *m_snapshot {nullptr};
+    uint           m_snapshotSize       {0};
+    bool           m_snapshotOpened     {false};
 
     mutable QMutex m_eventMapLock;
     uint           m_lastPruneTime;
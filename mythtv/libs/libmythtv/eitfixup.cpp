@@ -104,6 +104,60 @@ static const QRegularExpression kUKYear { R"([\[\(]([\d]{4})[\)\]])" };
 static const QRegularExpression kUKYearColon { R"(^[\d]{4}:)" };
 static const QRegularExpression kUnitymediaImdbrating { R"(\s*IMDb Rating: (\d\.\d)\s?/10$)" };
 
+// The expressions used by each provider fixup, JIT compiled as a set the
+// first time an EITFixUp is created instead of on first use mid-scan.
+static const std::array<const QRegularExpression *, 29> kUKRules
+{
+    &kUK24ep, &kUKAllNew, &kUKAlsoInHD, &kUKBBC34, &kUKBBC7rpt, &kUKCC,
+    &kUKCEPQ, &kUKColonPeriod, &kUKCompleteDots, &kUKDescriptionRemove,
+    &kUKDotEnd, &kUKDotSpaceStart, &kUKDoubleDotEnd, &kUKDoubleDotStart,
+    &kUKExclusionFromSubtitle, &kUKLaONoSplit, &kUKNew, &kUKNewTitle,
+    &kUKPart, &kUKQuotedSubtitle, &kUKSeries, &kUKSpaceColonStart,
+    &kUKSpaceStart, &kUKStarring, &kUKThen, &kUKTime, &kUKTitleRemove,
+    &kUKYear, &kUKYearColon,
+};
+static const std::array<const QRegularExpression *, 13> kDeRules
+{
+    &kAtvSubtitle, &kDeDisneyChannelSubtitle, &kDePremiereAirdate,
+    &kDePremiereCredits, &kDePremiereLength, &kDePremiereOTitle,
+    &kDeSkyDescriptionSeasonEpisode, &kPro7Cast, &kPro7CastOne, &kPro7Crew,
+    &kPro7CrewOne, &kPro7Subtitle, &kUnitymediaImdbrating,
+};
+static const std::array<const QRegularExpression *, 2> kGenericRules
+{
+    &kHtml, &kStereo,
+};
+
+template <size_t N>
+static void CompileRules(const std::array<const QRegularExpression *, N> &rules)
+{
+    for (const auto *re : rules)
+    {
+        if (!re->isValid())
+        {
+            LOG(VB_GENERAL, LOG_ERR, QString("EITFixUp: Bad expression '%1': %2")
+                .arg(re->pattern(), re->errorString()));
+            continue;
+        }
+        re->optimize();
+    }
+}
+
+static bool CompileAllRules(void)
+{
+    CompileRules(kUKRules);
+    CompileRules(kDeRules);
+    CompileRules(kGenericRules);
+    return true;
+}
+
+/// True if \a str contains any digit, a precondition of the numeric UK rules.
+static bool HasDigit(const QString &str)
+{
+    return std::any_of(str.cbegin(), str.cend(),
+                       [](QChar ch) { return ch.isDigit(); });
+}
+
 
 EITFixUp::EITFixUp()
     : m_bellYear("[\\(]{1}[0-9]{4}[\\)]{1}"),
@@ -262,6 +316,8 @@ EITFixUp::EITFixUp()
       m_grCategHealth("(?:\\W)?(υγε[ιί]α|υγειιν|ιατρικ|διατροφ)(?:\\W)?",Qt::CaseInsensitive),
       m_grCategSpecial("(?:\\W)?(αφι[εέ]ρωμα)(?:\\W)?",Qt::CaseInsensitive)
 {
+    static const bool s_compiled = CompileAllRules();
+    Q_UNUSED(s_compiled);
 }
 
 void EITFixUp::Fix(DBEventEIT &event) const
@@ -291,7 +347,7 @@ void EITFixUp::Fix(DBEventEIT &event) const
         FixBellExpressVu(event);
 
     if (kFixUK & event.m_fixup)
-        FixUK(event);
+        FixUKCached(event);
 
     if (kFixPBS & event.m_fixup)
         FixPBS(event);
@@ -859,6 +915,91 @@ void EITFixUp::SetUKSubtitle(DBEventEIT &event)
 }
 
 
+/**
+ *  \brief Key for the FixUK() result cache, built from every field that
+ *         FixUK() reads or may leave untouched.
+ */
+QString EITFixUp::UKCacheKey(const DBEventEIT &event)
+{
+    static const QChar kSep(0x1f);
+    return event.m_title + kSep + event.m_subtitle + kSep +
+        event.m_description + kSep + event.m_category + kSep +
+        QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+        .arg(event.m_season).arg(event.m_episode).arg(event.m_totalepisodes)
+        .arg(event.m_partnumber).arg(event.m_parttotal).arg(event.m_airdate)
+        .arg(event.m_originalairdate.toJulianDay())
+        .arg(static_cast<int>(event.m_categoryType))
+        .arg((event.m_subtitleType << 16) | (event.m_audioProps << 8) |
+             event.m_videoProps);
+}
+
+/**
+ *  \brief Run FixUK(), reusing the result of an earlier identical event.
+ */
+void EITFixUp::FixUKCached(DBEventEIT &event) const
+{
+    const QString key = UKCacheKey(event);
+
+    QMutexLocker locker(&m_ukCacheLock);
+    auto it = m_ukCache.constFind(key);
+    if (it != m_ukCache.constEnd())
+    {
+        event.m_title           = it->m_title;
+        event.m_subtitle        = it->m_subtitle;
+        event.m_description     = it->m_description;
+        event.m_season          = it->m_season;
+        event.m_episode         = it->m_episode;
+        event.m_totalepisodes   = it->m_totalepisodes;
+        event.m_partnumber      = it->m_partnumber;
+        event.m_parttotal       = it->m_parttotal;
+        event.m_airdate         = it->m_airdate;
+        event.m_originalairdate = it->m_originalairdate;
+        event.m_categoryType    = it->m_categoryType;
+        event.m_subtitleType    = it->m_subtitleType;
+        event.m_audioProps      = it->m_audioProps;
+        event.m_videoProps      = it->m_videoProps;
+        if (!it->m_credits.empty())
+        {
+            if (!event.m_credits)
+                event.m_credits = new DBCredits;
+            event.m_credits->insert(event.m_credits->end(),
+                                    it->m_credits.cbegin(),
+                                    it->m_credits.cend());
+        }
+        return;
+    }
+    locker.unlock();
+
+    size_t ncredits = event.m_credits ? event.m_credits->size() : 0;
+    FixUK(event);
+
+    UKFixResult result;
+    result.m_title           = event.m_title;
+    result.m_subtitle        = event.m_subtitle;
+    result.m_description     = event.m_description;
+    result.m_season          = event.m_season;
+    result.m_episode         = event.m_episode;
+    result.m_totalepisodes   = event.m_totalepisodes;
+    result.m_partnumber      = event.m_partnumber;
+    result.m_parttotal       = event.m_parttotal;
+    result.m_airdate         = event.m_airdate;
+    result.m_originalairdate = event.m_originalairdate;
+    result.m_categoryType    = event.m_categoryType;
+    result.m_subtitleType    = event.m_subtitleType;
+    result.m_audioProps      = event.m_audioProps;
+    result.m_videoProps      = event.m_videoProps;
+    if (event.m_credits && event.m_credits->size() > ncredits)
+    {
+        result.m_credits.assign(event.m_credits->cbegin() + ncredits,
+                                event.m_credits->cend());
+    }
+
+    locker.relock();
+    if (m_ukCache.size() >= kUKCacheMaxSize)
+        m_ukCache.clear();
+    m_ukCache.insert(key, result);
+}
+
 /** \fn EITFixUp::FixUK(DBEventEIT&) const
  *  \brief Use this in the United Kingdom to standardize DVB-T guide.
  */
@@ -868,29 +1009,46 @@ void EITFixUp::FixUK(DBEventEIT &event)
 
     bool isMovie = event.m_category.startsWith("Movie",Qt::CaseInsensitive) ||
                    event.m_category.startsWith("Film",Qt::CaseInsensitive);
+    // Each of the removals below is only attempted when the text contains
+    // a literal that any match must include. Most events match none of them.
+
     // BBC three case (could add another record here ?)
-    event.m_description = event.m_description.remove(kUKThen);
-    event.m_description = event.m_description.remove(kUKNew);
-    event.m_title = event.m_title.remove(kUKNewTitle);
+    if (event.m_description.contains("60 Seconds", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(kUKThen);
+    if (event.m_description.contains("New", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(kUKNew);
+    if (event.m_title.contains("New", Qt::CaseInsensitive))
+        event.m_title = event.m_title.remove(kUKNewTitle);
 
     // Removal of Class TV, CBBC and CBeebies etc..
-    event.m_title = event.m_title.remove(kUKTitleRemove);
-    event.m_description = event.m_description.remove(kUKDescriptionRemove);
+    if (event.m_title.startsWith("T4:", Qt::CaseInsensitive) ||
+        event.m_title.startsWith("Schools"))
+        event.m_title = event.m_title.remove(kUKTitleRemove);
+    if (event.m_description.startsWith("CB") ||
+        event.m_description.startsWith("Class TV") ||
+        event.m_description.startsWith("BBC Switch."))
+        event.m_description = event.m_description.remove(kUKDescriptionRemove);
 
     // Removal of BBC FOUR and BBC THREE
-    event.m_description = event.m_description.remove(kUKBBC34);
+    if (event.m_description.contains(" on BBC ", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(kUKBBC34);
 
     // BBC 7 [Rpt of ...] case.
-    event.m_description = event.m_description.remove(kUKBBC7rpt);
+    if (event.m_description.contains("[Rpt"))
+        event.m_description = event.m_description.remove(kUKBBC7rpt);
 
     // "All New To 4Music!
-    event.m_description = event.m_description.remove(kUKAllNew);
+    if (event.m_description.contains("All New To 4Music!"))
+        event.m_description = event.m_description.remove(kUKAllNew);
 
     // Removal of 'Also in HD' text
-    event.m_description = event.m_description.remove(kUKAlsoInHD);
+    if (event.m_description.contains("Also in HD.", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(kUKAlsoInHD);
 
     // Remove [AD,S] etc.
-    auto match = kUKCC.match(event.m_description);
+    QRegularExpressionMatch match;
+    if (event.m_description.contains('['))
+        match = kUKCC.match(event.m_description);
     while (match.hasMatch())
     {
         QStringList tmpCCitems = match.captured(0).remove("[").remove("]").split(",");
@@ -916,11 +1074,13 @@ void EITFixUp::FixUK(DBEventEIT &event)
     // Matching pattern "Season 2 Episode|Ep 3 of 14|3/14" etc
     bool series  = false;
     bool fromTitle = true;
-    match = kUKSeries.match(event.m_title);
+    match = HasDigit(event.m_title) ? kUKSeries.match(event.m_title)
+                                    : QRegularExpressionMatch();
     if (!match.hasMatch())
     {
         fromTitle = false;
-        match = kUKSeries.match(event.m_description);
+        if (HasDigit(event.m_description))
+            match = kUKSeries.match(event.m_description);
     }
     if (match.hasMatch())
     {
@@ -987,8 +1147,15 @@ void EITFixUp::FixUK(DBEventEIT &event)
 
     // Multi-part episodes, or films (e.g. ITV film split by news)
     // Matches Part 1, Pt 1/2, Part 1 of 2 etc.
-    match = kUKPart.match(event.m_title);
-    auto match2 = kUKPart.match(event.m_description);
+    auto mayHavePart = [](const QString &str)
+    {
+        return (str.contains("Pt", Qt::CaseInsensitive) ||
+                str.contains("Part", Qt::CaseInsensitive)) && HasDigit(str);
+    };
+    match = mayHavePart(event.m_title) ? kUKPart.match(event.m_title)
+                                       : QRegularExpressionMatch();
+    auto match2 = mayHavePart(event.m_description)
+        ? kUKPart.match(event.m_description) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         event.m_partnumber = match.captured(1).toUInt();
@@ -1020,7 +1187,8 @@ void EITFixUp::FixUK(DBEventEIT &event)
         }
     }
 
-    match = kUKStarring.match(event.m_description);
+    match = event.m_description.contains("tarring ")
+        ? kUKStarring.match(event.m_description) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         // if we match this we've captured 2 actors and an (optional) airdate
@@ -1132,7 +1300,8 @@ void EITFixUp::FixUK(DBEventEIT &event)
     }
 
     // Work out the year (if any)
-    match = kUKYear.match(event.m_description);
+    match = HasDigit(event.m_description)
+        ? kUKYear.match(event.m_description) : QRegularExpressionMatch();
     if (match.hasMatch())
     {
         event.m_description.remove(match.capturedStart(0),
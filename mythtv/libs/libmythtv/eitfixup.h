@@ -5,6 +5,8 @@
 #ifndef EITFIXUP_H
 #define EITFIXUP_H
 
+#include <QHash>
+#include <QMutex>
 #include <QRegExp>
 
 #include "programdata.h"
@@ -92,6 +94,7 @@ class MTV_PUBLIC EITFixUp
   private:
     void FixBellExpressVu(DBEventEIT &event) const; // Canada DVB-S
     static void SetUKSubtitle(DBEventEIT &event);
+    void FixUKCached(DBEventEIT &event) const;
     static void FixUK(DBEventEIT &event);           // UK DVB-T
     static void FixPBS(DBEventEIT &event);          // USA ATSC
     void FixComHem(DBEventEIT &event,
@@ -121,6 +124,34 @@ class MTV_PUBLIC EITFixUp
 
     static QString AddDVBEITAuthority(uint chanid, const QString &id);
 
+    /// Every field FixUK() reads or assigns, as left by one run of it.
+    /// FixUK() is a pure function of these, so repeated descriptions
+    /// (regional variants, +1 channels, repeats) reuse the first result.
+    struct UKFixResult
+    {
+        QString                   m_title;
+        QString                   m_subtitle;
+        QString                   m_description;
+        uint                      m_season        {0};
+        uint                      m_episode       {0};
+        uint                      m_totalepisodes {0};
+        uint16_t                  m_partnumber    {0};
+        uint16_t                  m_parttotal     {0};
+        uint16_t                  m_airdate       {0};
+        QDate                     m_originalairdate;
+        ProgramInfo::CategoryType m_categoryType  {ProgramInfo::kCategoryNone};
+        unsigned char             m_subtitleType  {0};
+        unsigned char             m_audioProps    {0};
+        unsigned char             m_videoProps    {0};
+        DBCredits                 m_credits;      ///< people added by FixUK()
+    };
+    static QString UKCacheKey(const DBEventEIT &event);
+    // max number of FixUK() results kept for reuse
+    static const int kUKCacheMaxSize = 4096;
+
+    mutable QMutex                     m_ukCacheLock;
+    mutable QHash<QString,UKFixResult> m_ukCache;
+
     const QRegExp m_bellYear;
     const QRegExp m_bellActors;
     const QRegExp m_bellPPVTitleAllDayHD;
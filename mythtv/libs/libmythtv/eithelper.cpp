@@ -2,6 +2,7 @@
 
 // Std C++ headers
 #include <algorithm>
+#include <vector>
 
 // MythTV includes
 #include "eithelper.h"
@@ -15,6 +16,7 @@
 #include "premieredescriptors.h"
 #include "channelutil.h"
 #include "mythdate.h"
+#include "mythtimer.h"
 #include "programdata.h"
 #include "programinfo.h"        // for subtitle types and audio and video properties
 #include "scheduledrecording.h" // for ScheduledRecording
@@ -75,46 +77,83 @@ bool EITHelper::EventQueueFull(void) const
  */
 uint EITHelper::ProcessEvents(void)
 {
-    QMutexLocker locker(&m_eitListLock);
-    uint insertCount = 0;
+    std::vector<DBEventEIT*> events;
+    uint queued = 0;
+    {
+        QMutexLocker locker(&m_eitListLock);
+        queued = m_dbEvents.size();
+        while ((events.size() < kChunkSize) && !m_dbEvents.empty())
+            events.push_back(m_dbEvents.dequeue());
+    }
 
-    if (m_dbEvents.empty())
+    if (events.empty())
         return 0;
 
+    MythTimer timer;
+    timer.start();
+
     MSqlQuery query(MSqlQuery::InitCon());
-    for (uint i = 0; (i < kChunkSize) && (!m_dbEvents.empty()); i++)
+    uint insertCount = 0;
+    for (auto *event : events)
     {
-        DBEventEIT *event = m_dbEvents.dequeue();
-        m_eitListLock.unlock();
-
         m_eitFixup->Fix(*event);
 
         insertCount += event->UpdateDB(query, 1000);
         m_maxStarttime = std::max (m_maxStarttime, event->m_starttime);
 
         delete event;
-        m_eitListLock.lock();
+    }
+
+    auto elapsed = timer.elapsed();
+    {
+        QMutexLocker locker(&m_eitListLock);
+        m_statEvents += events.size();
+        m_statTime += elapsed;
+        m_statQueuePeak = std::max(m_statQueuePeak, queued);
     }
 
     if (!insertCount)
         return 0;
 
+    QString rate = QString("in %1 ms, %2 events/sec")
+        .arg(elapsed.count())
+        .arg(events.size() * 1000.0 / std::max(elapsed, 1ms).count(), 0, 'f', 1);
+
+    QMutexLocker locker(&m_eitListLock);
     if (!m_incompleteEvents.empty())
     {
         LOG(VB_EIT, LOG_INFO, LOC_ID +
-            QString("Added %1 events -- complete: %2 incomplete: %3")
-                .arg(insertCount).arg(m_dbEvents.size())
+            QString("Added %1 events %2 -- complete: %3 incomplete: %4")
+                .arg(insertCount).arg(rate).arg(m_dbEvents.size())
                 .arg(m_incompleteEvents.size()));
     }
     else
     {
         LOG(VB_EIT, LOG_INFO, LOC_ID +
-            QString("Added %1 events").arg(insertCount));
+            QString("Added %1 events %2 -- queued: %3")
+                .arg(insertCount).arg(rate).arg(m_dbEvents.size()));
     }
 
     return insertCount;
 }
 
+/// Returns the event throughput and queue depth since the last call.
+QString EITHelper::GetStatistics(void)
+{
+    QMutexLocker locker(&m_eitListLock);
+    QString stats = QString("EITHelper Processed:%1 Time:%2ms Rate:%3/s "
+                            "Queued:%4 Peak Queued:%5")
+        .arg(m_statEvents).arg(m_statTime.count())
+        .arg(m_statEvents * 1000.0 / std::max(m_statTime, 1ms).count(),
+             0, 'f', 1)
+        .arg(m_dbEvents.size()).arg(m_statQueuePeak);
+
+    m_statEvents = 0;
+    m_statTime = 0ms;
+    m_statQueuePeak = 0;
+    return stats;
+}
+
 void EITHelper::SetFixup(uint atsc_major, uint atsc_minor, FixupValue eitfixup)
 {
     QMutexLocker locker(&m_eitListLock);
@@ -100,6 +100,7 @@ class EITHelper
 
     uint GetListSize(void) const;
     uint ProcessEvents(void);
+    QString GetStatistics(void);
     bool EventQueueFull(void) const;
 
     uint GetGPSOffset(void) const { return (uint) (0 - m_gpsOffset); }
@@ -160,6 +161,11 @@ class EITHelper
 
     QMap<uint,uint>         m_languagePreferences;
 
+    // Write throughput statistics
+    uint                    m_statEvents    {0};
+    std::chrono::milliseconds m_statTime    {0ms};
+    uint                    m_statQueuePeak {0};
+
     static const uint kChunkSize;   // Maximum number of DB inserts per ProcessEvents call
     static const uint kMaxSize;     // Maximum number of events waiting to be processed
 };
@@ -96,6 +96,7 @@ void EITScanner::run(void)
         {
             LOG(VB_EIT, LOG_INFO,
                 LOC_ID + QString("Added %1 EIT events in passive scan").arg(eitCount));
+            LOG(VB_EIT, LOG_INFO, LOC_ID + m_eitHelper->GetStatistics());
             eitCount = 0;
             RescheduleRecordings();
         }
@@ -108,6 +109,7 @@ void EITScanner::run(void)
             {
                 LOG(VB_EIT, LOG_INFO,
                     LOC_ID + QString("Added %1 EIT events in active scan").arg(eitCount));
+                LOG(VB_EIT, LOG_INFO, LOC_ID + m_eitHelper->GetStatistics());
                 eitCount = 0;
                 RescheduleRecordings();
             }
@@ -73,6 +73,7 @@ MythFileBuffer::MythFileBuffer(const QString &Filename, bool Write, bool UseRead
         else
         {
             m_tfw = new ThreadedFileWriter(m_filename, O_WRONLY|O_TRUNC|O_CREAT|O_LARGEFILE, 0644);
+            m_tfw->EnableRingBuffer();
             if (!m_tfw->Open())
             {
                 delete m_tfw;
@@ -0,0 +1,195 @@
+// C++ headers
+#include <algorithm>
+#include <cstring>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "keyframeindex.h"
+
+#define LOC QString("KeyframeIndex: ")
+
+const char KeyframeIndex::kMagic[8] = { 'M', 'Y', 'T', 'H', 'K', 'F', 'I', '\0' };
+
+static size_t lower_bound_entry(const KeyframeIndex::Entry *begin,
+                                const KeyframeIndex::Entry *end,
+                                int64_t frame)
+{
+    const KeyframeIndex::Entry *it = std::lower_bound(
+        begin, end, frame,
+        [](const KeyframeIndex::Entry &e, int64_t f) { return e.m_frame < f; });
+    return it - begin;
+}
+
+/**
+ *  \brief Adds a keyframe after the last one.
+ *
+ *  \return false if \p frame is not past the last keyframe, in which
+ *          case nothing is added.
+ */
+bool KeyframeIndex::Append(int64_t frame, int64_t offset, int64_t duration)
+{
+    if (!m_entries.empty() && frame <= m_entries.back().m_frame)
+        return false;
+
+    m_entries.push_back({frame, offset, duration});
+
+    if (m_sidecar.isOpen())
+    {
+        const Entry &entry = m_entries.back();
+        if (m_sidecar.write(reinterpret_cast<const char*>(&entry),
+                            sizeof(entry)) != static_cast<qint64>(sizeof(entry)))
+        {
+            LOG(VB_RECORD, LOG_WARNING, LOC +
+                QString("Failed to write to '%1', dropping it: %2")
+                .arg(m_sidecar.fileName(), m_sidecar.errorString()));
+            CloseSidecar();
+        }
+        else
+        {
+            // Readers map the file, so do not keep entries in our buffer
+            m_sidecar.flush();
+        }
+    }
+
+    return true;
+}
+
+bool KeyframeIndex::Contains(int64_t frame) const
+{
+    size_t i = LowerBound(frame);
+    return i < m_entries.size() && m_entries[i].m_frame == frame;
+}
+
+void KeyframeIndex::Clear(void)
+{
+    CloseSidecar();
+    m_entries.clear();
+}
+
+/// Returns the index of the first keyframe at or after \p frame.
+size_t KeyframeIndex::LowerBound(int64_t frame) const
+{
+    return lower_bound_entry(m_entries.data(),
+                             m_entries.data() + m_entries.size(), frame);
+}
+
+/**
+ *  \brief Starts mirroring the index to \p filename.
+ *
+ *  The file is truncated and the entries already in the index are
+ *  written out before any new ones.
+ */
+bool KeyframeIndex::OpenSidecar(const QString &filename, MarkTypes type)
+{
+    CloseSidecar();
+
+    m_sidecar.setFileName(filename);
+    if (!m_sidecar.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("Unable to create '%1': %2")
+            .arg(filename, m_sidecar.errorString()));
+        return false;
+    }
+
+    Header header {};
+    memcpy(header.m_magic, kMagic, sizeof(header.m_magic));
+    header.m_version = kVersion;
+    header.m_type    = type;
+
+    auto size = static_cast<qint64>(m_entries.size() * sizeof(Entry));
+    if (m_sidecar.write(reinterpret_cast<const char*>(&header),
+                        sizeof(header)) != static_cast<qint64>(sizeof(header)) ||
+        (size && m_sidecar.write(reinterpret_cast<const char*>(m_entries.data()),
+                                 size) != size))
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("Failed to write to '%1': %2")
+            .arg(filename, m_sidecar.errorString()));
+        CloseSidecar();
+        return false;
+    }
+    m_sidecar.flush();
+
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("Writing keyframes to '%1'")
+        .arg(filename));
+    return true;
+}
+
+void KeyframeIndex::CloseSidecar(void)
+{
+    if (m_sidecar.isOpen())
+        m_sidecar.close();
+}
+
+KeyframeIndexReader::KeyframeIndexReader(const QString &filename)
+    : m_file(filename)
+{
+}
+
+KeyframeIndexReader::~KeyframeIndexReader(void)
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+/**
+ *  \brief Maps any entries added since the last call.
+ *
+ *  \return false if the file does not exist or is not a keyframe index
+ *          written by this host, in which case size() is 0.
+ */
+bool KeyframeIndexReader::Refresh(void)
+{
+    if (!m_file.isOpen() && !m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 size = m_file.size();
+    if (size < static_cast<qint64>(sizeof(KeyframeIndex::Header)))
+        return false;
+
+    size_t count = (size - sizeof(KeyframeIndex::Header)) /
+                   sizeof(KeyframeIndex::Entry);
+    if (m_map && count == m_count)
+        return true;
+
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map     = nullptr;
+        m_entries = nullptr;
+        m_count   = 0;
+    }
+
+    m_mapSize = sizeof(KeyframeIndex::Header) +
+                (count * sizeof(KeyframeIndex::Entry));
+    m_map = m_file.map(0, m_mapSize);
+    if (!m_map)
+    {
+        LOG(VB_PLAYBACK, LOG_WARNING, LOC + QString("Unable to map '%1': %2")
+            .arg(m_file.fileName(), m_file.errorString()));
+        return false;
+    }
+
+    KeyframeIndex::Header header {};
+    memcpy(&header, m_map, sizeof(header));
+    if (memcmp(header.m_magic, KeyframeIndex::kMagic, sizeof(header.m_magic)) != 0 ||
+        header.m_version != KeyframeIndex::kVersion)
+    {
+        LOG(VB_PLAYBACK, LOG_WARNING, LOC + QString("'%1' is not usable")
+            .arg(m_file.fileName()));
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        return false;
+    }
+
+    m_type    = static_cast<MarkTypes>(header.m_type);
+    m_entries = reinterpret_cast<const KeyframeIndex::Entry*>(
+        m_map + sizeof(KeyframeIndex::Header));
+    m_count   = count;
+    return true;
+}
+
+/// Returns the index of the first keyframe at or after \p frame.
+size_t KeyframeIndexReader::LowerBound(int64_t frame) const
+{
+    return lower_bound_entry(m_entries, m_entries + m_count, frame);
+}
@@ -0,0 +1,111 @@
+// -*- Mode: c++ -*-
+#ifndef KEYFRAME_INDEX_H
+#define KEYFRAME_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include <QFile>
+#include <QString>
+
+#include "mythtvexp.h"
+#include "programtypes.h"
+
+/** \brief Sorted array of the keyframes in a recording.
+ *
+ *  Each entry holds a keyframe's frame number, its byte offset in the
+ *  file and, when known, the duration up to it in milliseconds.  The
+ *  recorder appends keyframes in frame order, so lookups are a binary
+ *  search over a flat array instead of a walk through a QMap.
+ *
+ *  While a recording is in progress the entries are also appended to a
+ *  sidecar file next to it, which KeyframeIndexReader maps into memory,
+ *  so players can follow the recording without querying recordedseek.
+ *
+ *  The sidecar is a 16 byte header followed by packed entries in host
+ *  byte order.  The header version doubles as a byte order check.
+ */
+class MTV_PUBLIC KeyframeIndex
+{
+  public:
+    struct Entry
+    {
+        int64_t m_frame;
+        int64_t m_offset;
+        int64_t m_duration; ///< -1 if unknown
+    };
+
+    KeyframeIndex(void) = default;
+    ~KeyframeIndex(void) { CloseSidecar(); }
+    KeyframeIndex(const KeyframeIndex &) = delete;
+    KeyframeIndex &operator=(const KeyframeIndex &) = delete;
+
+    static QString SidecarFilename(const QString &recording)
+        { return recording + ".kfidx"; }
+
+    bool   Append(int64_t frame, int64_t offset, int64_t duration = -1);
+    bool   Contains(int64_t frame) const;
+    void   Clear(void);
+
+    size_t size(void) const  { return m_entries.size(); }
+    bool   empty(void) const { return m_entries.empty(); }
+    const Entry &operator[](size_t i) const { return m_entries[i]; }
+    const Entry &front(void) const { return m_entries.front(); }
+    const Entry &back(void) const  { return m_entries.back(); }
+    size_t LowerBound(int64_t frame) const;
+
+    bool OpenSidecar(const QString &filename, MarkTypes type);
+    void CloseSidecar(void);
+    bool HasSidecar(void) const { return m_sidecar.isOpen(); }
+
+    struct Header
+    {
+        char     m_magic[8];
+        uint32_t m_version;
+        int32_t  m_type;
+    };
+
+    static constexpr uint32_t kVersion { 1 };
+    static const char         kMagic[8];
+
+  private:
+    std::vector<Entry> m_entries;
+    QFile              m_sidecar;
+};
+
+static_assert(sizeof(KeyframeIndex::Entry) == 24,
+              "KeyframeIndex::Entry must be packed, it is stored on disk");
+static_assert(sizeof(KeyframeIndex::Header) == 16,
+              "KeyframeIndex::Header must be packed, it is stored on disk");
+
+/** \brief Read only, memory mapped view of a KeyframeIndex sidecar.
+ *
+ *  Refresh() picks up entries the recorder has appended since the last
+ *  call.  Only whole entries are exposed.
+ */
+class MTV_PUBLIC KeyframeIndexReader
+{
+  public:
+    explicit KeyframeIndexReader(const QString &filename);
+    ~KeyframeIndexReader(void);
+    KeyframeIndexReader(const KeyframeIndexReader &) = delete;
+    KeyframeIndexReader &operator=(const KeyframeIndexReader &) = delete;
+
+    bool      Refresh(void);
+    QString   Filename(void) const { return m_file.fileName(); }
+    MarkTypes Type(void) const     { return m_type; }
+
+    size_t size(void) const { return m_count; }
+    const KeyframeIndex::Entry &operator[](size_t i) const { return m_entries[i]; }
+    size_t LowerBound(int64_t frame) const;
+
+  private:
+    QFile                       m_file;
+    uchar                      *m_map     {nullptr};
+    qint64                      m_mapSize {0};
+    const KeyframeIndex::Entry *m_entries {nullptr};
+    size_t                      m_count   {0};
+    MarkTypes                   m_type    {MARK_UNSET};
+};
+
+#endif // KEYFRAME_INDEX_H
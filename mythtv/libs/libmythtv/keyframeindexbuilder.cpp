@@ -0,0 +1,240 @@
+// Qt headers
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+// MythTV headers
+#include "mythdirs.h"
+#include "mythlogging.h"
+#include "keyframeindex.h"
+#include "keyframeindexbuilder.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#define LOC QString("KeyframeIndexBuilder: ")
+
+static QString cached_filename(const QString &filename)
+{
+    QByteArray path = QFileInfo(filename).absoluteFilePath().toUtf8();
+    QString hash = QCryptographicHash::hash(path, QCryptographicHash::Md5).toHex();
+    return GetCacheDir() + "/keyframeindex/" + hash + ".kfidx";
+}
+
+KeyframeIndexBuilder::KeyframeIndexBuilder(QString filename)
+    : MThread("KeyframeIndex"),
+      m_filename(std::move(filename))
+{
+}
+
+KeyframeIndexBuilder::~KeyframeIndexBuilder()
+{
+    Stop();
+    wait();
+}
+
+/// Returns true if files demuxed as \p format can be seeked by byte offset.
+bool KeyframeIndexBuilder::IsIndexable(const QString &format)
+{
+    return format == "mpegts" || format == "mpeg";
+}
+
+/**
+ *  \brief Finds an index built for \p filename since it was last modified.
+ *
+ *  \return the index filename, or an empty string if there is none.
+ */
+QString KeyframeIndexBuilder::CachedIndex(const QString &filename)
+{
+    QFileInfo media(filename);
+    if (!media.exists())
+        return {};
+
+    for (const QString &candidate : { KeyframeIndex::SidecarFilename(filename),
+                                      cached_filename(filename) })
+    {
+        QFileInfo index(candidate);
+        if (index.exists() && index.lastModified() >= media.lastModified())
+            return candidate;
+    }
+    return {};
+}
+
+/**
+ *  \brief Writes \p index for \p filename next to it, or to the cache
+ *         directory if that fails.
+ *
+ *  The index is written to a temporary file first, so CachedIndex() never
+ *  finds an incomplete one.
+ *
+ *  \return the index filename, or an empty string if it could not be saved.
+ */
+QString KeyframeIndexBuilder::SaveIndex(const QString &filename, KeyframeIndex &index)
+{
+    for (const QString &candidate : { KeyframeIndex::SidecarFilename(filename),
+                                      cached_filename(filename) })
+    {
+        QString dir = QFileInfo(candidate).absolutePath();
+        if (!QDir().mkpath(dir) || !QFileInfo(dir).isWritable())
+            continue;
+
+        QString temp = candidate + ".tmp";
+        bool saved = index.OpenSidecar(temp, MARK_GOP_BYFRAME);
+        index.CloseSidecar();
+        QFile::remove(candidate);
+        if (saved && QFile::rename(temp, candidate))
+            return candidate;
+        QFile::remove(temp);
+    }
+
+    LOG(VB_PLAYBACK, LOG_WARNING, LOC +
+        QString("Unable to save a keyframe index for '%1'").arg(filename));
+    return {};
+}
+
+void KeyframeIndexBuilder::run(void)
+{
+    RunProlog();
+
+    QElapsedTimer timer;
+    timer.start();
+    KeyframeIndex index;
+    if (Build(index))
+    {
+        m_index = SaveIndex(m_filename, index);
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Found %1 keyframes in '%2' in %3 ms")
+            .arg(index.size()).arg(m_filename).arg(timer.elapsed()));
+    }
+
+    RunEpilog();
+}
+
+/**
+ *  \brief Numbers the frame decoded at \p dts.
+ *
+ *  Each field of a field coded picture (H.264 PAFF, MPEG-2 field
+ *  pictures) may be a packet of its own, so packets are not counted.
+ *  The time since \p first is rounded to the nearest quarter frame and
+ *  then down, so both fields of a frame share its number.
+ */
+static int64_t frame_number(int64_t dts, int64_t first, AVRational time_base,
+                            AVRational rate)
+{
+    if (dts <= first)
+        return 0;
+    AVRational quarter { rate.den, rate.num * 4 };
+    return av_rescale_q(dts - first, time_base, quarter) / 4;
+}
+
+/**
+ *  \brief Reads every packet of the first video stream, adding its
+ *         keyframes to \p index.
+ *
+ *  Frames are numbered from the start of the file by their decode
+ *  timestamps, or by counting packets if those or the frame rate are
+ *  unknown, and
+ *  durations are measured from the earliest video timestamp seen so far.
+ *  A keyframe is inserted for frame 0 when the stream does not start
+ *  with one.
+ */
+bool KeyframeIndexBuilder::Build(KeyframeIndex &index)
+{
+    AVFormatContext *ic = nullptr;
+    QByteArray filename = m_filename.toLocal8Bit();
+    int ret = avformat_open_input(&ic, filename.constData(), nullptr, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_PLAYBACK, LOG_WARNING, LOC +
+            QString("Unable to open '%1' (%2)").arg(m_filename).arg(ret));
+        return false;
+    }
+
+    if (!IsIndexable(ic->iformat->name))
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Not indexing '%1', it is %2")
+            .arg(m_filename).arg(ic->iformat->name));
+        avformat_close_input(&ic);
+        return false;
+    }
+
+    // For the frame rate
+    ret = avformat_find_stream_info(ic, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("No stream info for '%1' (%2)").arg(m_filename).arg(ret));
+    }
+
+    AVPacket  *pkt = av_packet_alloc();
+    int        video = -1;
+    AVRational rate {0, 1};
+    int64_t    frame = -1;
+    int64_t    first = AV_NOPTS_VALUE;
+    int64_t    firstDts = AV_NOPTS_VALUE;
+    bool       ok = true;
+
+    while (!m_stop)
+    {
+        ret = av_read_frame(ic, pkt);
+        if (ret == AVERROR_EOF)
+            break;
+        if (ret == AVERROR(EAGAIN))
+            continue;
+        if (ret < 0)
+        {
+            LOG(VB_PLAYBACK, LOG_WARNING, LOC +
+                QString("Error reading '%1' (%2)").arg(m_filename).arg(ret));
+            ok = false;
+            break;
+        }
+
+        AVStream *st = ic->streams[pkt->stream_index];
+        if (video < 0 && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            video = pkt->stream_index;
+            rate = st->avg_frame_rate.num ? st->avg_frame_rate : st->r_frame_rate;
+        }
+        if (pkt->stream_index != video)
+        {
+            st->discard = AVDISCARD_ALL;
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+        if (ts != AV_NOPTS_VALUE && (first == AV_NOPTS_VALUE || ts < first))
+            first = ts;
+
+        int64_t dts = (pkt->dts != AV_NOPTS_VALUE) ? pkt->dts : pkt->pts;
+        if (dts != AV_NOPTS_VALUE && firstDts == AV_NOPTS_VALUE)
+            firstDts = dts;
+
+        // Without a timestamp, assume this is the next frame
+        if (dts != AV_NOPTS_VALUE && rate.num > 0 && rate.den > 0)
+            frame = frame_number(dts, firstDts, st->time_base, rate);
+        else
+            frame++;
+
+        if ((pkt->flags & AV_PKT_FLAG_KEY) && pkt->pos >= 0)
+        {
+            if (index.empty() && frame > 0)
+                index.Append(0, 0, 0);
+
+            int64_t duration = -1;
+            if (ts != AV_NOPTS_VALUE)
+                duration = av_rescale_q(ts - first, st->time_base, AVRational {1, 1000});
+            index.Append(frame, pkt->pos, duration);
+        }
+
+        av_packet_unref(pkt);
+    }
+
+    av_packet_free(&pkt);
+    avformat_close_input(&ic);
+    return ok && !m_stop && !index.empty();
+}
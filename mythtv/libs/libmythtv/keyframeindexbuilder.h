@@ -0,0 +1,53 @@
+// -*- Mode: c++ -*-
+#ifndef KEYFRAME_INDEX_BUILDER_H
+#define KEYFRAME_INDEX_BUILDER_H
+
+#include <atomic>
+
+#include <QString>
+
+#include "mythtvexp.h"
+#include "mthread.h"
+
+class KeyframeIndex;
+
+/** \brief Builds a KeyframeIndex for a file that has no position map.
+ *
+ *  The file is demuxed in a background thread, with its own format
+ *  context, noting the frame number, byte offset and time of each video
+ *  keyframe.  The index is saved next to the file, or in the cache
+ *  directory when that is not writable, and is reused until the file
+ *  is modified.
+ *
+ *  Only MPEG program and transport streams are indexed, as only those
+ *  can be seeked by byte offset.  Other containers carry their own
+ *  index, which libavformat already searches.
+ */
+class MTV_PUBLIC KeyframeIndexBuilder : public MThread
+{
+  public:
+    explicit KeyframeIndexBuilder(QString filename);
+    ~KeyframeIndexBuilder() override;
+    KeyframeIndexBuilder(const KeyframeIndexBuilder &) = delete;
+    KeyframeIndexBuilder &operator=(const KeyframeIndexBuilder &) = delete;
+
+    static bool    IsIndexable(const QString &format);
+    static QString CachedIndex(const QString &filename);
+    static QString SaveIndex(const QString &filename, KeyframeIndex &index);
+
+    void    Stop(void) { m_stop = true; }
+    /// The saved index, once the thread has finished.  Empty on failure.
+    QString Index(void) const { return m_index; }
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    bool Build(KeyframeIndex &index);
+
+    QString          m_filename;
+    QString          m_index;
+    std::atomic_bool m_stop {false};
+};
+
+#endif // KEYFRAME_INDEX_BUILDER_H
@@ -120,6 +120,8 @@ QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
 # Headers needed by frontend & backend
 HEADERS += format.h
 HEADERS += mythframe.h
+HEADERS += mythframepool.h
+HEADERS += mythsliceworkers.h
 
 # Misc. needed by backend/frontend
 HEADERS += mythtvexp.h
@@ -157,6 +159,7 @@ HEADERS += io/mythopticalbuffer.h
 HEADERS += metadataimagehelper.h
 HEADERS += mythavutil.h
 HEADERS += recordingfile.h
+HEADERS += keyframeindex.h keyframeindexbuilder.h
 HEADERS += driveroption.h
 HEADERS += mythhdrmetadata.h
 HEADERS += mythhdrtracker.h
@@ -194,8 +197,11 @@ SOURCES += io/mythinteractivebuffer.cpp
 SOURCES += io/mythopticalbuffer.cpp
 SOURCES += metadataimagehelper.cpp
 SOURCES += mythframe.cpp
+SOURCES += mythframepool.cpp
+SOURCES += mythsliceworkers.cpp
 SOURCES += mythavutil.cpp
 SOURCES += recordingfile.cpp
+SOURCES += keyframeindex.cpp keyframeindexbuilder.cpp
 SOURCES += mythhdrmetadata.cpp
 SOURCES += mythhdrtracker.cpp
 
@@ -235,6 +241,7 @@ HEADERS += mpeg/freesat_huffman.h
 HEADERS += mpeg/iso6937tables.h
 HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
 HEADERS += mpeg/H2645Parser.h mpeg/AVCParser.h mpeg/HEVCParser.h
+HEADERS += mpeg/bytereader.h
 HEADERS += mpeg/tablestatus.h
 HEADERS += mpeg/tsstreamdata.h
 
@@ -252,6 +259,7 @@ SOURCES += mpeg/atsc_huffman.cpp    mpeg/freesat_tables.cpp
 SOURCES += mpeg/freesat_huffman.cpp
 SOURCES += mpeg/iso6937tables.cpp
 SOURCES += mpeg/H2645Parser.cpp mpeg/AVCParser.cpp mpeg/HEVCParser.cpp
+SOURCES += mpeg/bytereader.cpp
 SOURCES += mpeg/tablestatus.cpp
 SOURCES += mpeg/tsstreamdata.cpp
 
@@ -445,10 +453,12 @@ using_frontend {
     HEADERS += decoders/avformatdecoder.h
     HEADERS += decoders/mythcodeccontext.h
     HEADERS += decoders/mythdecoderthread.h
+    HEADERS += decoders/mythdemuxthread.h
     SOURCES += decoders/decoderbase.cpp
     SOURCES += decoders/avformatdecoder.cpp
     SOURCES += decoders/mythcodeccontext.cpp
     SOURCES += decoders/mythdecoderthread.cpp
+    SOURCES += decoders/mythdemuxthread.cpp
 
     using_libass {
         DEFINES += USING_LIBASS
@@ -935,6 +945,13 @@ using_backend {
     SOURCES += recorders/rtp/packetbuffer.cpp
     SOURCES += recorders/rtp/rtppacketbuffer.cpp
 
+    # Batched UDP receive for IPTV and SAT>IP
+    linux {
+        HEADERS += recorders/rtp/udpbatchreader.h
+        SOURCES += recorders/rtp/udpbatchreader.cpp
+        DEFINES += USING_RECVMMSG
+    }
+
     # Support for HTTP TS streams
     HEADERS += recorders/httptsstreamhandler.h
     SOURCES += recorders/httptsstreamhandler.cpp
@@ -946,12 +963,14 @@ using_backend {
     HEADERS += recorders/HLS/HLSPlaylistWorker.h
     HEADERS += recorders/HLS/HLSReader.h
     HEADERS += recorders/HLS/HLSSegment.h
+    HEADERS += recorders/HLS/HLSSegmentPrefetcher.h
     HEADERS += recorders/HLS/HLSStream.h
     HEADERS += recorders/HLS/HLSStreamWorker.h
 
     SOURCES += recorders/HLS/HLSPlaylistWorker.cpp
     SOURCES += recorders/HLS/HLSReader.cpp
     SOURCES += recorders/HLS/HLSSegment.cpp
+    SOURCES += recorders/HLS/HLSSegmentPrefetcher.cpp
     SOURCES += recorders/HLS/HLSStream.cpp
     SOURCES += recorders/HLS/HLSStreamWorker.cpp
 
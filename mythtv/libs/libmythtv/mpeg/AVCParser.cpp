@@ -1,5 +1,6 @@
 // MythTV headers
 #include "AVCParser.h"
+#include "bytereader.h"
 #include <iostream>
 
 #include "mythlogging.h"
@@ -298,9 +299,9 @@ uint32_t AVCParser::addBytes(const uint8_t  *bytes,
 
     while (startP < bytes + byte_count && !m_onFrame)
     {
-        const uint8_t *endP = avpriv_find_start_code(startP,
-                                                     bytes + byte_count,
-                                                     &m_syncAccumulator);
+        const uint8_t *endP = ByteReader::FindStartCode(startP,
+                                                        bytes + byte_count,
+                                                        &m_syncAccumulator);
 
         bool found_start_code = ((m_syncAccumulator & 0xffffff00) == 0x00000100);
 
@@ -0,0 +1,144 @@
+// -*- Mode: c++ -*-
+/*******************************************************************
+ * ByteReader
+ *
+ * Distributed as part of MythTV (www.mythtv.org)
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ ********************************************************************/
+
+// MythTV headers
+#include "config.h"
+#include "bytereader.h"
+
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include <emmintrin.h>
+static const bool s_haveSIMD = (av_get_cpu_flags() & AV_CPU_FLAG_SSE2) != 0;
+#elif HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+static const bool s_haveSIMD = have_neon(av_get_cpu_flags());
+#endif
+
+/// Byte positions tested per vector compare.
+static constexpr std::ptrdiff_t kBlock = 16;
+
+/**
+ *  Returns the first p such that p[0..2] is 00 00 01 and p + 2 < end,
+ *  or end if there is none. A byte greater than one can't be in any
+ *  prefix, so the scan steps over up to three positions at a time.
+ */
+static const uint8_t *ScanScalar(const uint8_t *p, const uint8_t *end)
+{
+    while (p + 2 < end)
+    {
+        if (p[2] > 1)
+            p += 3;
+        else if (p[1])
+            p += 2;
+        else if (p[0] || p[2] != 1)
+            p++;
+        else
+            return p;
+    }
+    return end;
+}
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+static const uint8_t *ScanSIMD(const uint8_t *p, const uint8_t *end)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8(1);
+
+    // Compare the 16 windows starting in [p, p + 16) at once
+    while (end - p >= kBlock + 2)
+    {
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+        __m128i hit = _mm_and_si128(
+            _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+            _mm_cmpeq_epi8(b2, one));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask)
+        {
+            while (!(mask & 1))
+            {
+                mask >>= 1;
+                p++;
+            }
+            return p;
+        }
+        p += kBlock;
+    }
+    return ScanScalar(p, end);
+}
+#elif HAVE_INTRINSICS_NEON
+static const uint8_t *ScanSIMD(const uint8_t *p, const uint8_t *end)
+{
+    const uint8x16_t zero = vdupq_n_u8(0);
+    const uint8x16_t one  = vdupq_n_u8(1);
+
+    // Compare the 16 windows starting in [p, p + 16) at once
+    while (end - p >= kBlock + 2)
+    {
+        uint8x16_t hit = vandq_u8(
+            vandq_u8(vceqq_u8(vld1q_u8(p), zero), vceqq_u8(vld1q_u8(p + 1), zero)),
+            vceqq_u8(vld1q_u8(p + 2), one));
+        uint64x2_t hit64 = vreinterpretq_u64_u8(hit);
+        if (vgetq_lane_u64(hit64, 0) | vgetq_lane_u64(hit64, 1))
+            return ScanScalar(p, p + kBlock + 2);
+        p += kBlock;
+    }
+    return ScanScalar(p, end);
+}
+#endif
+
+const uint8_t *ByteReader::FindStartCode(const uint8_t *p, const uint8_t *end,
+                                         uint32_t *state)
+{
+    if (p >= end)
+        return end;
+
+    // A start code straddling the previous buffer and this one
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t tmp = *state << 8;
+        *state = tmp + *(p++);
+        if (tmp == 0x100 || p == end)
+            return p;
+    }
+
+    // Windows starting at p - 3 onwards have not been tested yet
+    const uint8_t *found = nullptr;
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+        found = ScanSIMD(p - 3, end);
+    else
+#endif
+        found = ScanScalar(p - 3, end);
+
+    p = (end - found > 4) ? found + 4 : end;
+    *state = (static_cast<uint32_t>(p[-4]) << 24) |
+             (static_cast<uint32_t>(p[-3]) << 16) |
+             (static_cast<uint32_t>(p[-2]) <<  8) |
+              static_cast<uint32_t>(p[-1]);
+    return p;
+}
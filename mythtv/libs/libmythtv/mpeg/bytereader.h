@@ -0,0 +1,44 @@
+// -*- Mode: c++ -*-
+/*******************************************************************
+ * ByteReader
+ *
+ * Distributed as part of MythTV (www.mythtv.org)
+ *
+ *      This program is free software; you can redistribute it and/or modify
+ *      it under the terms of the GNU General Public License as published by
+ *      the Free Software Foundation; either version 2 of the License, or
+ *      (at your option) any later version.
+ *
+ *      This program is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *      GNU General Public License for more details.
+ *
+ ********************************************************************/
+
+#ifndef BYTEREADER_H
+#define BYTEREADER_H
+
+#include <cstdint>
+
+#include "mythtvexp.h"
+
+namespace ByteReader
+{
+/**
+ *  \brief Find the next MPEG start code (00 00 01 xx) in [p, end).
+ *
+ *  A drop in replacement for FFmpeg's avpriv_find_start_code(), with the
+ *  same contract: \a state carries the last four bytes seen across calls
+ *  so start codes split between buffers are found. On return \a state
+ *  holds the four bytes before the returned pointer; it is a start code
+ *  when <tt>(state & 0xffffff00) == 0x100</tt>, and the pointer is then
+ *  just past the start code's fourth byte. Otherwise \a end is returned.
+ *
+ *  Uses SSE2 or NEON to test 16 byte positions at a time when available.
+ */
+MTV_PUBLIC const uint8_t *FindStartCode(const uint8_t *p, const uint8_t *end,
+                                        uint32_t *state);
+}
+
+#endif // BYTEREADER_H
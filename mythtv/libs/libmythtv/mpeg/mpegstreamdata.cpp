@@ -2,6 +2,7 @@
 // Copyright (c) 2003-2004, Daniel Thor Kristjansson
 
 #include <algorithm> // for find & max
+#include <cstring>   // for memchr
 
 // POSIX headers
 #include <sys/time.h> // for gettimeofday
@@ -140,8 +141,10 @@ void MPEGStreamData::Reset(int desiredProgram)
     m_pidsWriting.clear();
     m_pidsAudio.clear();
     m_pidsConditionalAccess.clear();
+    m_pidLookup.fill(0);
 
     m_pidVideoSingleProgram = m_pidPmtSingleProgram = 0xffffffff;
+    ++m_pidLookupGeneration;
 
     m_patStatus.clear();
 
@@ -597,12 +600,13 @@ bool MPEGStreamData::CreatePMTSingleProgram(const ProgramMapTable &pmt)
         }
     }
 
-    m_pidsAudio.clear();
+    ClearPIDs(m_pidsAudio, kPIDAudio);
     for (uint pid : audioPIDs)
         AddAudioPID(pid);
 
-    m_pidsWriting.clear();
+    ClearPIDs(m_pidsWriting, kPIDWriting);
     m_pidVideoSingleProgram = !videoPIDs.empty() ? videoPIDs[0] : 0xffffffff;
+    ++m_pidLookupGeneration;
     for (size_t i = 1; i < videoPIDs.size(); i++)
         AddWritingPID(videoPIDs[i]);
 
@@ -1076,26 +1080,40 @@ int MPEGStreamData::ResyncStream(const unsigned char *buffer, int curr_pos,
     if (nextpos >= len)
         return -1; // not enough bytes; caller should try again
 
-    while (buffer[pos] != SYNC_BYTE || buffer[nextpos] != SYNC_BYTE)
-    {
+    // Let memchr(), which the C library vectorises, find each
+    // candidate sync byte rather than stepping through byte by byte.
+    int last = len - TSPacket::kSize; // one past the last candidate
+    while (pos < last)
+    {
+        const auto *sync = static_cast<const unsigned char*>(
+            memchr(buffer + pos, SYNC_BYTE, last - pos));
+        if (sync == nullptr)
+            break;
+        pos = sync - buffer;
+        if (buffer[pos + TSPacket::kSize] == SYNC_BYTE)
+            return pos;
         pos++;
-        nextpos++;
-        if (nextpos == len)
-            return -2; // not found
     }
 
-    return pos;
+    return -2; // not found
 }
 
 bool MPEGStreamData::IsConditionalAccessPID(uint pid) const
 {
+    if (pid < m_pidLookup.size())
+        return (m_pidLookup[pid] & kPIDConditionalAccess) != 0;
     pid_map_t::const_iterator it = m_pidsConditionalAccess.find(pid);
     return it != m_pidsConditionalAccess.end();
 }
 
 bool MPEGStreamData::IsListeningPID(uint pid) const
 {
-    if (m_listeningDisabled || IsNotListeningPID(pid))
+    if (m_listeningDisabled)
+        return false;
+    if (pid < m_pidLookup.size())
+        return (m_pidLookup[pid] & (kPIDListening | kPIDNotListening)) ==
+            kPIDListening;
+    if (IsNotListeningPID(pid))
         return false;
     pid_map_t::const_iterator it = m_pidsListening.find(pid);
     return it != m_pidsListening.end();
@@ -1103,22 +1121,56 @@ bool MPEGStreamData::IsListeningPID(uint pid) const
 
 bool MPEGStreamData::IsNotListeningPID(uint pid) const
 {
+    if (pid < m_pidLookup.size())
+        return (m_pidLookup[pid] & kPIDNotListening) != 0;
     pid_map_t::const_iterator it = m_pidsNotListening.find(pid);
     return it != m_pidsNotListening.end();
 }
 
 bool MPEGStreamData::IsWritingPID(uint pid) const
 {
+    if (pid < m_pidLookup.size())
+        return (m_pidLookup[pid] & kPIDWriting) != 0;
     pid_map_t::const_iterator it = m_pidsWriting.find(pid);
     return it != m_pidsWriting.end();
 }
 
 bool MPEGStreamData::IsAudioPID(uint pid) const
 {
+    if (pid < m_pidLookup.size())
+        return (m_pidLookup[pid] & kPIDAudio) != 0;
     pid_map_t::const_iterator it = m_pidsAudio.find(pid);
     return it != m_pidsAudio.end();
 }
 
+/** \brief Removes all PIDs from one of the pid_map_t's.
+ *  \param pids The map to clear
+ *  \param flag The m_pidLookup flag corresponding to that map
+ */
+void MPEGStreamData::ClearPIDs(pid_map_t &pids, uint8_t flag)
+{
+    pids.clear();
+    for (auto & lookup : m_pidLookup)
+        lookup &= ~flag;
+    ++m_pidLookupGeneration;
+}
+
+/** \brief Returns true if ProcessTSPacket() may do anything with this PID.
+ *
+ *  This is used by StreamHandler to avoid handing packets to listeners
+ *  that will just ignore them. It may return true for PIDs that end up
+ *  being ignored, but must never return false for a PID that is used.
+ */
+bool MPEGStreamData::IsWantedPID(uint pid) const
+{
+    if (IsVideoPID(pid))
+        return true;
+    if (pid < m_pidLookup.size())
+        return (m_pidLookup[pid] &
+                (kPIDListening | kPIDWriting | kPIDAudio)) != 0;
+    return true;
+}
+
 uint MPEGStreamData::GetPIDs(pid_map_t &pids) const
 {
     uint sz = pids.size();
@@ -4,6 +4,8 @@
 #define MPEGSTREAMDATA_H_
 
 // C++
+#include <array>
+#include <atomic>
 #include <cstdint>  // uint64_t
 #include <vector>
 
@@ -113,29 +115,36 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     virtual void HandleTSTables(const TSPacket* tspacket);
     virtual bool ProcessTSPacket(const TSPacket& tspacket);
     virtual int  ProcessData(const unsigned char *buffer, int len);
+    static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
     inline  void HandleAdaptationFieldControl(const TSPacket* tspacket);
 
     // Listening
     virtual void AddListeningPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { m_pidsListening[pid] = priority; }
+        { m_pidsListening[pid] = priority; SetPIDFlag(pid, kPIDListening); }
     virtual void AddNotListeningPID(uint pid)
-        { m_pidsNotListening[pid] = kPIDPriorityNormal; }
+        { m_pidsNotListening[pid] = kPIDPriorityNormal;
+          SetPIDFlag(pid, kPIDNotListening); }
     virtual void AddWritingPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { m_pidsWriting[pid] = priority; }
+        { m_pidsWriting[pid] = priority; SetPIDFlag(pid, kPIDWriting); }
     virtual void AddAudioPID(
         uint pid, PIDPriority priority = kPIDPriorityHigh)
-        { m_pidsAudio[pid] = priority; }
+        { m_pidsAudio[pid] = priority; SetPIDFlag(pid, kPIDAudio); }
     virtual void AddConditionalAccessPID(
         uint pid, PIDPriority priority = kPIDPriorityNormal)
-        { m_pidsConditionalAccess[pid] = priority; }
+        { m_pidsConditionalAccess[pid] = priority;
+          SetPIDFlag(pid, kPIDConditionalAccess); }
 
-    virtual void RemoveListeningPID(uint pid) { m_pidsListening.remove(pid);  }
+    virtual void RemoveListeningPID(uint pid)
+        { m_pidsListening.remove(pid); ClearPIDFlag(pid, kPIDListening); }
     virtual void RemoveNotListeningPID(uint pid)
-        { m_pidsNotListening.remove(pid); }
-    virtual void RemoveWritingPID(uint pid) { m_pidsWriting.remove(pid);    }
-    virtual void RemoveAudioPID(uint pid)   { m_pidsAudio.remove(pid);      }
+        { m_pidsNotListening.remove(pid);
+          ClearPIDFlag(pid, kPIDNotListening); }
+    virtual void RemoveWritingPID(uint pid)
+        { m_pidsWriting.remove(pid); ClearPIDFlag(pid, kPIDWriting); }
+    virtual void RemoveAudioPID(uint pid)
+        { m_pidsAudio.remove(pid); ClearPIDFlag(pid, kPIDAudio); }
 
     virtual bool IsListeningPID(uint pid) const;
     virtual bool IsNotListeningPID(uint pid) const;
@@ -144,6 +153,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
         { return m_pidVideoSingleProgram == pid; }
     virtual bool IsAudioPID(uint pid) const;
     virtual bool IsConditionalAccessPID(uint pid) const;
+    virtual bool IsWantedPID(uint pid) const;
+    /// \brief Changes whenever the result of IsWantedPID() may have changed.
+    uint PIDLookupGeneration(void) const { return m_pidLookupGeneration; }
 
     const pid_map_t& ListeningPIDs(void) const
         { return m_pidsListening; }
@@ -292,10 +304,27 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void ProcessPMT(const ProgramMapTable *pmt);
     void ProcessEncryptedPacket(const TSPacket &tspacket);
 
-    static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
-
     void UpdateTimeOffset(uint64_t si_utc_time);
 
+    // PID lookup table
+    void SetPIDFlag(uint pid, uint8_t flag)
+    {
+        if ((pid < m_pidLookup.size()) && !(m_pidLookup[pid] & flag))
+        {
+            m_pidLookup[pid] |= flag;
+            ++m_pidLookupGeneration;
+        }
+    }
+    void ClearPIDFlag(uint pid, uint8_t flag)
+    {
+        if ((pid < m_pidLookup.size()) && (m_pidLookup[pid] & flag))
+        {
+            m_pidLookup[pid] &= ~flag;
+            ++m_pidLookupGeneration;
+        }
+    }
+    void ClearPIDs(pid_map_t &pids, uint8_t flag);
+
     // Caching
     void IncrementRefCnt(const PSIPTable *psip) const;
     virtual bool DeleteCachedTable(const PSIPTable *psip) const;
@@ -326,6 +355,16 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     pid_map_t                 m_pidsConditionalAccess;
     bool                      m_listeningDisabled           {false};
 
+    // Flat lookup table mirroring the pid_map_t's above, so that
+    // classifying a packet's PID does not need any QMap lookups.
+    static constexpr uint8_t  kPIDListening                 {0x01};
+    static constexpr uint8_t  kPIDNotListening              {0x02};
+    static constexpr uint8_t  kPIDWriting                   {0x04};
+    static constexpr uint8_t  kPIDAudio                     {0x08};
+    static constexpr uint8_t  kPIDConditionalAccess         {0x10};
+    std::array<uint8_t,0x2000> m_pidLookup                  {};
+    std::atomic<uint>         m_pidLookupGeneration         {0};
+
     // Encryption monitoring
     mutable QMutex            m_encryptionLock              {QMutex::Recursive};
     QMap<uint, CryptInfo>     m_encryptionPidToInfo;
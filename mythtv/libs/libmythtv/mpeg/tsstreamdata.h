@@ -15,6 +15,8 @@ class MTV_PUBLIC TSStreamData : public MPEGStreamData
     ~TSStreamData() override { ; }
 
     bool ProcessTSPacket(const TSPacket& tspacket) override; // MPEGStreamData
+    bool IsWantedPID(uint /* pid */) const override // MPEGStreamData
+        { return true; }
 
     using MPEGStreamData::Reset;
     void Reset(int /* desiredProgram */) override { ; } // MPEGStreamData
@@ -3,6 +3,7 @@
 #include "mythlogging.h"
 #include "mythavutil.h"
 #include "mythvideoprofile.h"
+#include "mythsliceworkers.h"
 #include "mythdeinterlacer.h"
 
 extern "C" {
@@ -10,6 +11,10 @@ extern "C" {
 #include "libavfilter/buffersink.h"
 }
 
+// Std
+#include <algorithm>
+#include <array>
+
 #if (HAVE_SSE2 && ARCH_X86_64)
 #include "libavutil/x86/cpu.h"
 #include <emmintrin.h>
@@ -36,15 +41,29 @@ bool MythDeinterlacer::s_haveSIMD = false;
  * quality and using single or double frame rate.
  *
  * The following deinterlacers are used:
- * Basic - onefield/bob using libswcale
+ * Basic - linear bob with custom code (SSE2 and Neon assisted where available)
  * Medium - linearblend with custom code (SSE2 and Neon assisted where available)
  * High - libavfilter's yadif (with multithreading)
  *
+ * Basic and Medium split each frame into horizontal slices that are processed
+ * concurrently by MythSliceWorkers, using the same thread count as yadif.
+ *
  * \note libavfilter frame doubling filters expect frames to be presented
  * in the correct order and will break if they do not receive a frame followed
  * by the retrieval of 2 'fields'.
  * \note There is no support for deinterlacig NV12 frame formats in libavilter
 */
+
+/*! \brief Create a deinterlacer.
+ *
+ * \param Threads The number of threads to use. If 0, the maximum CPUs setting
+ * from the video profile passed to Filter is used.
+*/
+MythDeinterlacer::MythDeinterlacer(uint Threads)
+  : m_maxThreads(Threads)
+{
+}
+
 MythDeinterlacer::~MythDeinterlacer()
 {
     Cleanup();
@@ -112,7 +131,7 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
     }
 
     // libavfilter will not deinterlace NV12 frames. Allow shaders in this case.
-    // libswscale (for bob/onefield) is fine, as is our linearblend.
+    // Our bob and linearblend are fine.
     if ((deinterlacer == DEINT_HIGH) && MythVideoFrame::FormatIsNV12(Frame->m_type))
     {
         Cleanup();
@@ -189,10 +208,10 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
     Frame->m_deinterlaceInuse = m_deintType | DEINT_CPU;
     Frame->m_deinterlaceInuse2x = m_doubleRate;
 
-    // onefield or bob
+    // bob
     if (m_deintType == DEINT_BASIC)
     {
-        OneField(Frame, Scan);
+        Bob(Frame, Scan);
         return;
     }
 
@@ -273,12 +292,11 @@ void MythDeinterlacer::Filter(MythVideoFrame *Frame, FrameScanType Scan,
 
 void MythDeinterlacer::Cleanup()
 {
-    if (m_graph || m_swsContext)
+    if (m_deintType != DEINT_NONE)
         LOG(VB_PLAYBACK, LOG_INFO, LOC + "Removing CPU deinterlacer");
 
     avfilter_graph_free(&m_graph);
-    sws_freeContext(m_swsContext);
-    m_swsContext = nullptr;
+    m_workers = nullptr;
     m_discontinuityCounter = 0;
     m_autoFieldOrder = false;
     m_lastFieldChange = 0;
@@ -312,21 +330,21 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
     m_inputFmt  = MythAVUtil::FrameTypeToPixelFormat(Frame->m_type);
     auto name   = MythVideoFrame::DeinterlacerName(Deinterlacer | DEINT_CPU, DoubleRate);
 
-    // simple onefield/bob?
+    uint threads = m_maxThreads;
+    if (!threads && Profile)
+        threads = Profile->GetMaxCPUs();
+    if (threads < 1 || threads > 8)
+        threads = 1;
+
+    // simple bob/linearblend?
     if (Deinterlacer == DEINT_BASIC || Deinterlacer == DEINT_MEDIUM)
     {
         m_deintType  = Deinterlacer;
         m_doubleRate = DoubleRate;
         m_topFirst   = TopFieldFirst;
-        if (Deinterlacer == DEINT_BASIC)
-        {
-            m_swsContext = sws_getCachedContext(m_swsContext, m_width, m_height >> 1, m_inputFmt,
-                                                m_width, m_height, m_inputFmt, SWS_FAST_BILINEAR,
-                                                nullptr, nullptr, nullptr);
-            if (m_swsContext == nullptr)
-                return false;
-        }
-        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1'").arg(name));
+        m_workers    = std::make_unique<MythSliceWorkers>("Deint", static_cast<int>(threads));
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Using deinterlacer '%1' (%2 threads)")
+            .arg(name).arg(threads));
         return true;
     }
 
@@ -341,14 +359,6 @@ bool MythDeinterlacer::Initialise(MythVideoFrame *Frame, MythDeintType Deinterla
     if (!m_graph)
         return false;
 
-    uint threads = 1;
-    if (Profile)
-    {
-        threads = Profile->GetMaxCPUs();
-        if (threads < 1 || threads > 8)
-            threads = 1;
-    }
-
     AVFilterInOut* inputs = nullptr;
     AVFilterInOut* outputs = nullptr;
 
@@ -410,63 +420,23 @@ bool MythDeinterlacer::SetUpCache(MythVideoFrame *Frame)
     return m_bobFrame && m_bobFrame->m_buffer != nullptr;
 }
 
-void MythDeinterlacer::OneField(MythVideoFrame *Frame, FrameScanType Scan)
+/// \brief Copy Frame to the 'bob' cache, one slice per thread.
+void MythDeinterlacer::CacheFrame(MythVideoFrame *Frame)
 {
-    if (!m_swsContext)
-        return;
-
-    // we need a frame for caching - both to preserve the second field if
-    // needed and ensure we are not filtering in place (i.e. from src to src).
-    if (!SetUpCache(Frame))
-        return;
-
-    // copy/cache on first pass
-    if (kScan_Interlaced == Scan)
-        memcpy(m_bobFrame->m_buffer, Frame->m_buffer, m_bobFrame->m_bufferSize);
-
-    // Convert VideoFrame to AVFrame - no copy
-    AVFrame dstframe;
-    if ((MythAVUtil::FillAVFrame(m_frame, m_bobFrame, m_inputFmt) < 1) ||
-        (MythAVUtil::FillAVFrame(&dstframe, Frame, m_inputFmt) < 1))
+    size_t size = std::min(m_bobFrame->m_bufferSize, Frame->m_bufferSize);
+    int slices = m_workers->Threads();
+    m_workers->Run(slices, [&](int Slice)
     {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "Error converting frame");
-        return;
-    }
-
-    bool topfield   = Scan == kScan_Interlaced ? m_topFirst : !m_topFirst;
-    dstframe.width  = Frame->m_width;
-    dstframe.height = Frame->m_height;
-    dstframe.format = Frame->m_pixFmt;
-
-    m_frame->width  = m_bobFrame->m_width;
-    m_frame->format = m_bobFrame->m_pixFmt;
-
-    // Fake the frame height and stride to simulate a single field
-    m_frame->height = Frame->m_height >> 1;
-    m_frame->interlaced_frame = 0;
-    uint nbplanes = MythVideoFrame::GetNumPlanes(m_inputType);
-    for (uint i = 0; i < nbplanes; i++)
-    {
-        if (!topfield)
-            m_frame->data[i] = m_frame->data[i] + m_frame->linesize[i];
-        m_frame->linesize[i] = m_frame->linesize[i] << 1;
-    }
-
-    // and scale to full height
-    int result = sws_scale(m_swsContext, m_frame->data, m_frame->linesize, 0, m_frame->height,
-                           dstframe.data, dstframe.linesize);
-
-    if (result != Frame->m_height)
-    {
-        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Error scaling frame: height %1 expected %2")
-            .arg(result).arg(Frame->m_height));
-    }
-    Frame->m_alreadyDeinterlaced = true;
+        size_t start = (size * static_cast<size_t>(Slice)) / static_cast<size_t>(slices);
+        size_t end   = (size * static_cast<size_t>(Slice + 1)) / static_cast<size_t>(slices);
+        memcpy(m_bobFrame->m_buffer + start, Frame->m_buffer + start, end - start);
+    });
 }
 
+// Per byte average, rounding up to match _mm_avg_epu8 and vrhaddq_u8
 inline static uint32_t avg(uint32_t A, uint32_t B)
 {
-    return (((A ^ B) & 0xFEFEFEFEUL) >> 1) + (A & B);
+    return (A | B) - (((A ^ B) & 0xFEFEFEFEUL) >> 1);
 }
 
 // Optimised version with 4x4 alignment
@@ -626,9 +596,170 @@ static inline void BlendSIMD8x4(unsigned char *Src, int Width, int FirstRow, int
 }
 #endif
 
+// Average two rows of 8bit samples, rounding up
+static inline void AverageRow8(const unsigned char *A, const unsigned char *B,
+                               unsigned char *Dst, int Width, bool SIMD)
+{
+    int col = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (SIMD)
+    {
+        for ( ; col + 16 <= Width; col += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&A[col]));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&B[col]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&Dst[col]), _mm_avg_epu8(a, b));
+        }
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (SIMD)
+        for ( ; col + 16 <= Width; col += 16)
+            vst1q_u8(&Dst[col], vrhaddq_u8(vld1q_u8(&A[col]), vld1q_u8(&B[col])));
+#else
+    (void)SIMD;
+#endif
+    for ( ; col < Width; ++col)
+        Dst[col] = static_cast<unsigned char>((A[col] + B[col] + 1) >> 1);
+}
+
+// Average two rows of 9 to 16bit samples, rounding up. Width is in bytes.
+static inline void AverageRow16(const unsigned char *A, const unsigned char *B,
+                                unsigned char *Dst, int Width, bool SIMD)
+{
+    int col = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (SIMD)
+    {
+        for ( ; col + 16 <= Width; col += 16)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&A[col]));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&B[col]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&Dst[col]), _mm_avg_epu16(a, b));
+        }
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (SIMD)
+    {
+        for ( ; col + 16 <= Width; col += 16)
+        {
+            uint16x8_t a = vld1q_u16(reinterpret_cast<const uint16_t*>(&A[col]));
+            uint16x8_t b = vld1q_u16(reinterpret_cast<const uint16_t*>(&B[col]));
+            vst1q_u16(reinterpret_cast<uint16_t*>(&Dst[col]), vrhaddq_u16(a, b));
+        }
+    }
+#else
+    (void)SIMD;
+#endif
+    for ( ; col + 1 < Width; col += 2)
+    {
+        uint16_t a = 0;
+        uint16_t b = 0;
+        memcpy(&a, &A[col], sizeof(a));
+        memcpy(&b, &B[col], sizeof(b));
+        auto res = static_cast<uint16_t>((a + b + 1) >> 1);
+        memcpy(&Dst[col], &res, sizeof(res));
+    }
+}
+
+/*! \brief Linear bob for rows FirstRow to LastRow - 1 of a plane.
+ *
+ * Rows from the current field are copied from Src (if Copy is set) and the
+ * rows of the other field are interpolated from the rows above and below. Only
+ * rows of the current field are read from Src, so Src and Dst may be the same.
+*/
+static void BobRows(const unsigned char *Src, int Pitch, unsigned char *Dst, int DstPitch,
+                    int Width, int Height, int FirstRow, int LastRow, bool TopField,
+                    bool Copy, bool HighDepth, bool SIMD)
+{
+    int fieldparity = TopField ? 0 : 1;
+    for (int row = FirstRow; row < LastRow; ++row)
+    {
+        unsigned char* dst = Dst + (row * DstPitch);
+        if ((row & 1) == fieldparity)
+        {
+            if (Copy)
+                memcpy(dst, Src + (row * Pitch), static_cast<size_t>(Width));
+            continue;
+        }
+
+        int above = row > 0 ? row - 1 : row + 1;
+        int below = row < (Height - 1) ? row + 1 : row - 1;
+        if (HighDepth)
+            AverageRow16(Src + (above * Pitch), Src + (below * Pitch), dst, Width, SIMD);
+        else
+            AverageRow8(Src + (above * Pitch), Src + (below * Pitch), dst, Width, SIMD);
+    }
+}
+
+/*! \brief Deinterlace by interpolating the missing field from the current field.
+ *
+ * Single rate deinterlacing is done in place. For double rate, the original
+ * frame is cached on the first pass so that the second field is still available
+ * for the second pass.
+*/
+void MythDeinterlacer::Bob(MythVideoFrame *Frame, FrameScanType Scan)
+{
+    if (!m_workers || Frame->m_height < 16 || Frame->m_width < 16)
+        return;
+
+    bool second = false;
+    MythVideoFrame *src = Frame;
+
+    if (m_doubleRate)
+    {
+        if (!SetUpCache(Frame))
+            return;
+        if (kScan_Interlaced == Scan)
+            CacheFrame(Frame);
+        else
+            second = true;
+        src = m_bobFrame;
+    }
+
+    bool hidepth = MythVideoFrame::ColorDepth(src->m_type) > 8;
+    bool top     = second ? !m_topFirst : m_topFirst;
+    bool copy    = src != Frame;
+    uint count   = MythVideoFrame::GetNumPlanes(src->m_type);
+    int slices   = m_workers->Threads();
+
+    m_workers->Run(slices, [&](int Slice)
+    {
+        for (uint plane = 0; plane < count; plane++)
+        {
+            int height = MythVideoFrame::GetHeightForPlane(src->m_type, src->m_height, plane);
+            BobRows(src->m_buffer + src->m_offsets[plane], src->m_pitches[plane],
+                    Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
+                    MythVideoFrame::GetPitchForPlane(src->m_type, src->m_width, plane),
+                    height, (height * Slice) / slices, (height * (Slice + 1)) / slices,
+                    top, copy, hidepth, s_haveSIMD);
+        }
+    });
+    Frame->m_alreadyDeinterlaced = true;
+}
+
+// Fallback for 10/12/16bit video without SIMD
+static void BlendC16x4(unsigned char *Src, int Width, int FirstRow, int LastRow, int Pitch,
+                       unsigned char *Dst, int DstPitch, bool Second)
+{
+    for (int row = FirstRow; row < LastRow - 3; row += 4)
+    {
+        unsigned char *above  = Src + ((row - 1) * Pitch);
+        unsigned char *middle = above + (Pitch << 1);
+        unsigned char *below  = middle + (Pitch << 1);
+        if (Second)
+        {
+            // On second pass, copy over the original, current field
+            memcpy(Dst + ((row - 1) * DstPitch), above,  static_cast<size_t>(DstPitch));
+            memcpy(Dst + ((row + 1) * DstPitch), middle, static_cast<size_t>(DstPitch));
+        }
+        AverageRow16(above,  middle, Dst + (row * DstPitch), Width, false);
+        AverageRow16(middle, below,  Dst + ((row + 2) * DstPitch), Width, false);
+    }
+}
+
 void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
 {
-    if (Frame->m_height < 16 || Frame->m_width < 16)
+    if (!m_workers || Frame->m_height < 16 || Frame->m_width < 16)
         return;
 
     bool second = false;
@@ -640,58 +771,78 @@ void MythDeinterlacer::Blend(MythVideoFrame *Frame, FrameScanType Scan)
             return;
         // copy/cache on first pass.
         if (kScan_Interlaced == Scan)
-            memcpy(m_bobFrame->m_buffer, Frame->m_buffer, m_bobFrame->m_bufferSize);
+            CacheFrame(Frame);
         else
             second = true;
         src = m_bobFrame;
     }
 
+    using BlendFunc = void(*)(unsigned char*, int, int, int, int, unsigned char*, int, bool);
+    struct BlendPlane
+    {
+        BlendFunc      m_func     { nullptr };
+        unsigned char* m_src      { nullptr };
+        unsigned char* m_dst      { nullptr };
+        int            m_width    { 0 };
+        int            m_pitch    { 0 };
+        int            m_dstPitch { 0 };
+        int            m_firstRow { 0 };
+        int            m_quads    { 0 };
+    };
+    std::array<BlendPlane,3> planes {};
+
     bool hidepth = MythVideoFrame::ColorDepth(src->m_type) > 8;
     bool top = second ? !m_topFirst : m_topFirst;
-    uint count = MythVideoFrame::GetNumPlanes(src->m_type);
+    uint count = std::min(MythVideoFrame::GetNumPlanes(src->m_type), static_cast<uint>(planes.size()));
     for (uint plane = 0; plane < count; plane++)
     {
         int  height  = MythVideoFrame::GetHeightForPlane(src->m_type, src->m_height, plane);
         int firstrow = top ? 1 : 2;
         bool height4 = (height % 4) == 0;
         bool width4  = (src->m_pitches[plane] % 4) == 0;
+        BlendPlane& job = planes[plane];
+        job.m_width = MythVideoFrame::GetPitchForPlane(src->m_type, src->m_width, plane);
         // N.B. all frames allocated by MythTV should have 16 byte alignment
         // for all planes
 #if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
         bool width16 = (src->m_pitches[plane] % 16) == 0;
         // profiling SSE2 suggests it is usually 4x faster - as expected
         if (s_haveSIMD && height4 && width16)
-        {
-            if (hidepth)
-            {
-                BlendSIMD8x4(src->m_buffer + src->m_offsets[plane],
-                             MythVideoFrame::GetPitchForPlane(src->m_type, src->m_width, plane),
-                             firstrow, height, src->m_pitches[plane],
-                             Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                             second);
-            }
-            else
-            {
-                BlendSIMD16x4(src->m_buffer + src->m_offsets[plane],
-                              MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
-                              firstrow, height, src->m_pitches[plane],
-                              Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                              second);
-            }
-        }
+            job.m_func = hidepth ? BlendSIMD8x4 : BlendSIMD16x4;
         else
 #endif
-        // N.B. There is no 10bit support here - but it shouldn't be necessary
-        // as everything should be 16byte aligned and 10/12bit interlaced video
-        // is virtually unheard of.
-        if (width4 && height4 && !hidepth)
+        if (width4 && height4)
+            job.m_func = hidepth ? BlendC16x4 : BlendC4x4;
+
+        if (!job.m_func)
+            continue;
+        job.m_src      = src->m_buffer + src->m_offsets[plane];
+        job.m_dst      = Frame->m_buffer + Frame->m_offsets[plane];
+        job.m_pitch    = src->m_pitches[plane];
+        job.m_dstPitch = Frame->m_pitches[plane];
+        job.m_firstRow = firstrow;
+        // Each pass of a blend function processes 4 rows
+        job.m_quads    = (height - firstrow) / 4;
+    }
+
+    // Slices are aligned to the 4 row passes, so the field parity of the first
+    // row in each slice is unchanged
+    int slices = m_workers->Threads();
+    m_workers->Run(slices, [&](int Slice)
+    {
+        for (uint plane = 0; plane < count; plane++)
         {
-            BlendC4x4(src->m_buffer + src->m_offsets[plane],
-                      MythVideoFrame::GetWidthForPlane(src->m_type, src->m_width, plane),
-                      firstrow, height, src->m_pitches[plane],
-                      Frame->m_buffer + Frame->m_offsets[plane], Frame->m_pitches[plane],
-                      second);
+            BlendPlane& job = planes[plane];
+            if (!job.m_func)
+                continue;
+            int first = (job.m_quads * Slice) / slices;
+            int last  = (job.m_quads * (Slice + 1)) / slices;
+            if (last <= first)
+                continue;
+            job.m_func(job.m_src, job.m_width, job.m_firstRow + (first * 4),
+                       job.m_firstRow + (last * 4) + 3, job.m_pitch,
+                       job.m_dst, job.m_dstPitch, second);
         }
-    }
+    });
     Frame->m_alreadyDeinterlaced = true;
 }
@@ -7,15 +7,18 @@
 
 extern "C" {
 #include "libavfilter/avfilter.h"
-#include "libswscale/swscale.h"
 }
 
+// Std
+#include <memory>
+
 class MythVideoProfile;
+class MythSliceWorkers;
 
-class MythDeinterlacer
+class MTV_PUBLIC MythDeinterlacer
 {
   public:
-    MythDeinterlacer() = default;
+    explicit MythDeinterlacer(uint Threads = 0);
    ~MythDeinterlacer();
 
     void             Filter       (MythVideoFrame *Frame, FrameScanType Scan,
@@ -27,9 +30,10 @@ class MythDeinterlacer
                                    bool DoubleRate, bool TopFieldFirst,
                                    MythVideoProfile *Profile);
     inline void      Cleanup      ();
-    void             OneField     (MythVideoFrame *Frame, FrameScanType Scan);
+    void             Bob          (MythVideoFrame *Frame, FrameScanType Scan);
     void             Blend        (MythVideoFrame *Frame, FrameScanType Scan);
     bool             SetUpCache   (MythVideoFrame *Frame);
+    void             CacheFrame   (MythVideoFrame *Frame);
 
     VideoFrameType   m_inputType  { FMT_NONE };
     AVPixelFormat    m_inputFmt   { AV_PIX_FMT_NONE };
@@ -43,7 +47,8 @@ class MythDeinterlacer
     AVFilterContext* m_source     { nullptr };
     AVFilterContext* m_sink       { nullptr };
     MythVideoFrame*  m_bobFrame   { nullptr };
-    SwsContext*      m_swsContext { nullptr };
+    uint             m_maxThreads { 0 };
+    std::unique_ptr<MythSliceWorkers> m_workers;
     uint64_t         m_discontinuityCounter { 0 };
     bool             m_autoFieldOrder  { false };
     uint64_t         m_lastFieldChange { 0 };
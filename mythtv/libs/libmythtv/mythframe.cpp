@@ -1,13 +1,37 @@
+// Qt
+#include <QThread>
+
 // MythTV
+#include "config.h"
 #include "mythlogging.h"
 #include "mythvideoprofile.h"
+#include "mythsliceworkers.h"
 #include "mythframe.h"
+#include "mythframepool.h"
 
 // FFmpeg - for av_malloc/av_free
 extern "C" {
 #include "libavcodec/avcodec.h"
 }
 
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include "libavutil/x86/cpu.h"
+#include <emmintrin.h>
+static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_SSE2;
+#elif HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+static const bool s_haveSIMD = have_neon(av_get_cpu_flags());
+#endif
+
+// Std
+#include <algorithm>
+#include <functional>
+
 #define LOC QString("VideoFrame: ")
 
 /*! \class MythVideoFrame
@@ -24,7 +48,7 @@ MythVideoFrame::~MythVideoFrame()
     if (m_buffer && HardwareFormat(m_type))
         LOG(VB_GENERAL, LOG_ERR, LOC + "Frame still contains a hardware buffer!");
     else if (m_buffer)
-        av_freep(&m_buffer);
+        MythFramePool::Global()->Release(m_buffer);
 }
 
 MythVideoFrame::MythVideoFrame(VideoFrameType Type, int Width, int Height, const VideoFrameTypes* RenderFormats)
@@ -47,7 +71,7 @@ void MythVideoFrame::Init(VideoFrameType Type, int Width, int Height, const Vide
     {
         newsize = GetBufferSize(Type, Width, Height);
         bool reallocate = !((Width == m_width) && (Height == m_height) && (newsize == m_bufferSize) && (Type == m_type));
-        newbuffer = reallocate ? GetAlignedBuffer(newsize) : m_buffer;
+        newbuffer = reallocate ? MythFramePool::Global()->Get(newsize) : m_buffer;
         newsize   = reallocate ? newsize : m_bufferSize;
     }
     Init(Type, newbuffer, newsize, Width, Height, (RenderFormats == nullptr) ? &kDefaultRenderFormats : RenderFormats);
@@ -77,7 +101,8 @@ void MythVideoFrame::Init(VideoFrameType Type, uint8_t *Buffer, size_t BufferSiz
     if (m_buffer && (m_buffer != Buffer))
     {
         LOG(VB_GENERAL, LOG_DEBUG, LOC + "Deleting old frame buffer");
-        av_freep(&m_buffer);
+        MythFramePool::Global()->Release(m_buffer);
+        m_buffer = nullptr;
     }
 
     m_type         = Type;
@@ -185,23 +210,428 @@ void MythVideoFrame::ClearMetadata()
     m_deinterlaceInuse2x  = false;
 }
 
-void MythVideoFrame::CopyPlane(uint8_t *To, int ToPitch, const uint8_t *From, int FromPitch,
-                               int PlaneWidth, int PlaneHeight)
+// Frame copies are split into bands of rows and shared between these threads
+// while there are users (i.e. VideoBuffers)
+static QMutex s_copyLock;
+static std::shared_ptr<MythSliceWorkers> s_copyWorkers;
+static int s_copyUsers = 0;
+// Copies are limited by memory bandwidth, so more threads do not help
+static constexpr int kMaxCopyThreads { 4 };
+// Smaller copies are faster on the calling thread
+static constexpr size_t kMinThreadedCopy { 1024 * 1024 };
+
+/// \brief Enable threaded copies, until a matching call to RemoveCopyUser.
+void MythVideoFrame::AddCopyUser()
+{
+    QMutexLocker locker(&s_copyLock);
+    if (s_copyUsers++ > 0)
+        return;
+    int threads = std::clamp(QThread::idealThreadCount(), 1, kMaxCopyThreads);
+    if (threads > 1)
+        s_copyWorkers = std::make_shared<MythSliceWorkers>("FrameCopy", threads);
+}
+
+void MythVideoFrame::RemoveCopyUser()
+{
+    QMutexLocker locker(&s_copyLock);
+    if (--s_copyUsers > 0)
+        return;
+    s_copyUsers = 0;
+    // Any copy still in progress holds its own reference
+    s_copyWorkers = nullptr;
+}
+
+namespace {
+using CopyRowsFunc = std::function<void(int FirstRow, int Rows)>;
+struct CopyTask
 {
-    if ((ToPitch == PlaneWidth) && (FromPitch == PlaneWidth))
+    CopyRowsFunc m_func;
+    int          m_rows { 0 };
+};
+using CopyTasks = std::vector<CopyTask>;
+} // namespace
+
+static void RunCopyTasks(const CopyTasks& Tasks, size_t Bytes)
+{
+    std::shared_ptr<MythSliceWorkers> workers;
+    if (Bytes >= kMinThreadedCopy)
+    {
+        QMutexLocker locker(&s_copyLock);
+        workers = s_copyWorkers;
+    }
+
+    // Each slice handles the same band of every plane, so the chroma for the
+    // rows of luma being copied is processed by the same thread
+    int slices = workers ? workers->Threads() : 1;
+    auto work = [&](int Slice)
     {
-        memcpy(To, From, static_cast<size_t>(PlaneWidth * PlaneHeight));
+        for (const auto & task : Tasks)
+        {
+            int first = (task.m_rows * Slice) / slices;
+            int last  = (task.m_rows * (Slice + 1)) / slices;
+            if (last > first)
+                task.m_func(first, last - first);
+        }
+    };
+
+    if (workers)
+        workers->Run(slices, work);
+    else
+        work(0);
+}
+
+static void CopyRows(uint8_t *To, int ToPitch, const uint8_t *From, int FromPitch,
+                     int Width, int Rows)
+{
+    if ((ToPitch == Width) && (FromPitch == Width))
+    {
+        memcpy(To, From, static_cast<size_t>(Width) * static_cast<size_t>(Rows));
         return;
     }
 
-    for (int y = 0; y < PlaneHeight; y++)
+    for (int y = 0; y < Rows; y++)
     {
-        memcpy(To, From, static_cast<size_t>(PlaneWidth));
+        memcpy(To, From, static_cast<size_t>(Width));
         From += FromPitch;
         To += ToPitch;
     }
 }
 
+// NV12 chroma to YV12. Width is in samples per plane.
+static void SplitRows8(uint8_t *ToU, int UPitch, uint8_t *ToV, int VPitch,
+                       const uint8_t *From, int FromPitch, int Width, int Rows)
+{
+    for (int y = 0; y < Rows; y++)
+    {
+        int x = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+        if (s_haveSIMD)
+        {
+            const __m128i mask = _mm_set1_epi16(0x00FF);
+            for ( ; x + 16 <= Width; x += 16)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(From + (x * 2)));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(From + (x * 2) + 16));
+                __m128i u = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+                __m128i v = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ToU + x), u);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ToV + x), v);
+            }
+        }
+#elif HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            for ( ; x + 16 <= Width; x += 16)
+            {
+                uint8x16x2_t uv = vld2q_u8(From + (x * 2));
+                vst1q_u8(ToU + x, uv.val[0]);
+                vst1q_u8(ToV + x, uv.val[1]);
+            }
+        }
+#endif
+        for ( ; x < Width; x++)
+        {
+            ToU[x] = From[x * 2];
+            ToV[x] = From[(x * 2) + 1];
+        }
+        From += FromPitch;
+        ToU  += UPitch;
+        ToV  += VPitch;
+    }
+}
+
+// YV12 chroma to NV12. Width is in samples per plane.
+static void MergeRows8(uint8_t *To, int ToPitch, const uint8_t *FromU, int UPitch,
+                       const uint8_t *FromV, int VPitch, int Width, int Rows)
+{
+    for (int y = 0; y < Rows; y++)
+    {
+        int x = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+        if (s_haveSIMD)
+        {
+            for ( ; x + 16 <= Width; x += 16)
+            {
+                __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(FromU + x));
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(FromV + x));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(To + (x * 2)), _mm_unpacklo_epi8(u, v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(To + (x * 2) + 16), _mm_unpackhi_epi8(u, v));
+            }
+        }
+#elif HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            for ( ; x + 16 <= Width; x += 16)
+            {
+                uint8x16x2_t uv { { vld1q_u8(FromU + x), vld1q_u8(FromV + x) } };
+                vst2q_u8(To + (x * 2), uv);
+            }
+        }
+#endif
+        for ( ; x < Width; x++)
+        {
+            To[x * 2]       = FromU[x];
+            To[(x * 2) + 1] = FromV[x];
+        }
+        To    += ToPitch;
+        FromU += UPitch;
+        FromV += VPitch;
+    }
+}
+
+// P010 stores samples in the most significant 10 bits, YUV420P10 in the least
+static constexpr int kP010Shift { 6 };
+
+static inline uint16_t Load16(const uint8_t *Src)
+{
+    uint16_t value = 0;
+    memcpy(&value, Src, sizeof(value));
+    return value;
+}
+
+static inline void Store16(uint8_t *Dst, uint16_t Value)
+{
+    memcpy(Dst, &Value, sizeof(Value));
+}
+
+// P010 luma to YUV420P10 (Left is false) and back. Width is in samples.
+static void ShiftRows16(uint8_t *To, int ToPitch, const uint8_t *From, int FromPitch,
+                        int Width, int Rows, bool Left)
+{
+    for (int y = 0; y < Rows; y++)
+    {
+        int x = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+        if (s_haveSIMD)
+        {
+            for ( ; x + 8 <= Width; x += 8)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(From + (x * 2)));
+                a = Left ? _mm_slli_epi16(a, kP010Shift) : _mm_srli_epi16(a, kP010Shift);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(To + (x * 2)), a);
+            }
+        }
+#elif HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            for ( ; x + 8 <= Width; x += 8)
+            {
+                uint16x8_t a = vld1q_u16(reinterpret_cast<const uint16_t*>(From + (x * 2)));
+                a = Left ? vshlq_n_u16(a, kP010Shift) : vshrq_n_u16(a, kP010Shift);
+                vst1q_u16(reinterpret_cast<uint16_t*>(To + (x * 2)), a);
+            }
+        }
+#endif
+        for ( ; x < Width; x++)
+        {
+            uint16_t value = Load16(From + (x * 2));
+            Store16(To + (x * 2), static_cast<uint16_t>(Left ? value << kP010Shift : value >> kP010Shift));
+        }
+        To   += ToPitch;
+        From += FromPitch;
+    }
+}
+
+// P010 chroma to YUV420P10. Width is in samples per plane.
+static void SplitRows16(uint8_t *ToU, int UPitch, uint8_t *ToV, int VPitch,
+                        const uint8_t *From, int FromPitch, int Width, int Rows)
+{
+    for (int y = 0; y < Rows; y++)
+    {
+        int x = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+        if (s_haveSIMD)
+        {
+            for ( ; x + 8 <= Width; x += 8)
+            {
+                // Shifted values are 10bit, so the signed pack cannot saturate
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(From + (x * 4)));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(From + (x * 4) + 16));
+                __m128i u = _mm_packs_epi32(_mm_srli_epi32(_mm_slli_epi32(a, 16), 16 + kP010Shift),
+                                            _mm_srli_epi32(_mm_slli_epi32(b, 16), 16 + kP010Shift));
+                __m128i v = _mm_packs_epi32(_mm_srli_epi32(a, 16 + kP010Shift),
+                                            _mm_srli_epi32(b, 16 + kP010Shift));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ToU + (x * 2)), u);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ToV + (x * 2)), v);
+            }
+        }
+#elif HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            for ( ; x + 8 <= Width; x += 8)
+            {
+                uint16x8x2_t uv = vld2q_u16(reinterpret_cast<const uint16_t*>(From + (x * 4)));
+                vst1q_u16(reinterpret_cast<uint16_t*>(ToU + (x * 2)), vshrq_n_u16(uv.val[0], kP010Shift));
+                vst1q_u16(reinterpret_cast<uint16_t*>(ToV + (x * 2)), vshrq_n_u16(uv.val[1], kP010Shift));
+            }
+        }
+#endif
+        for ( ; x < Width; x++)
+        {
+            Store16(ToU + (x * 2), Load16(From + (x * 4)) >> kP010Shift);
+            Store16(ToV + (x * 2), Load16(From + (x * 4) + 2) >> kP010Shift);
+        }
+        From += FromPitch;
+        ToU  += UPitch;
+        ToV  += VPitch;
+    }
+}
+
+// YUV420P10 chroma to P010. Width is in samples per plane.
+static void MergeRows16(uint8_t *To, int ToPitch, const uint8_t *FromU, int UPitch,
+                        const uint8_t *FromV, int VPitch, int Width, int Rows)
+{
+    for (int y = 0; y < Rows; y++)
+    {
+        int x = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+        if (s_haveSIMD)
+        {
+            for ( ; x + 8 <= Width; x += 8)
+            {
+                __m128i u = _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(FromU + (x * 2))), kP010Shift);
+                __m128i v = _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(FromV + (x * 2))), kP010Shift);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(To + (x * 4)), _mm_unpacklo_epi16(u, v));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(To + (x * 4) + 16), _mm_unpackhi_epi16(u, v));
+            }
+        }
+#elif HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            for ( ; x + 8 <= Width; x += 8)
+            {
+                uint16x8x2_t uv { {
+                    vshlq_n_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(FromU + (x * 2))), kP010Shift),
+                    vshlq_n_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(FromV + (x * 2))), kP010Shift) } };
+                vst2q_u16(reinterpret_cast<uint16_t*>(To + (x * 4)), uv);
+            }
+        }
+#endif
+        for ( ; x < Width; x++)
+        {
+            Store16(To + (x * 4),     static_cast<uint16_t>(Load16(FromU + (x * 2)) << kP010Shift));
+            Store16(To + (x * 4) + 2, static_cast<uint16_t>(Load16(FromV + (x * 2)) << kP010Shift));
+        }
+        To    += ToPitch;
+        FromU += UPitch;
+        FromV += VPitch;
+    }
+}
+
+void MythVideoFrame::CopyPlane(uint8_t *To, int ToPitch, const uint8_t *From, int FromPitch,
+                               int PlaneWidth, int PlaneHeight)
+{
+    auto copy = [=](int FirstRow, int Rows)
+    {
+        CopyRows(To + (FirstRow * ToPitch), ToPitch, From + (FirstRow * FromPitch), FromPitch,
+                 PlaneWidth, Rows);
+    };
+    RunCopyTasks({{ copy, PlaneHeight }},
+                 static_cast<size_t>(PlaneWidth) * static_cast<size_t>(PlaneHeight));
+}
+
+/// \brief Return true if CopyPlanes can copy frames of type From to frames of type To.
+bool MythVideoFrame::CanCopy(VideoFrameType From, VideoFrameType To)
+{
+    if (From == FMT_NONE || HardwareFormat(From))
+        return false;
+    if (From == To)
+        return true;
+    return ((From == FMT_NV12) && (To == FMT_YV12)) || ((From == FMT_YV12) && (To == FMT_NV12)) ||
+           ((From == FMT_P010) && (To == FMT_YUV420P10)) || ((From == FMT_YUV420P10) && (To == FMT_P010));
+}
+
+/*! \brief Copy, and if needed convert, the planes of a Width x Height image.
+ *
+ * Large images are copied by several threads while there are copy users (see
+ * AddCopyUser). NV12 and YV12 can be converted to each other, as can P010 and
+ * YUV420P10.
+ *
+ * \returns false if the formats are not supported by CanCopy.
+*/
+bool MythVideoFrame::CopyPlanes(VideoFrameType ToType, const FramePlanes& To, const FramePitches& ToPitches,
+                                VideoFrameType FromType, const ConstFramePlanes& From,
+                                const FramePitches& FromPitches, int Width, int Height)
+{
+    if (!CanCopy(FromType, ToType) || Width < 1 || Height < 1)
+        return false;
+
+    CopyTasks tasks;
+    size_t bytes = 0;
+    auto addtask = [&](int Rows, int RowBytes, CopyRowsFunc Func)
+    {
+        tasks.push_back({ std::move(Func), Rows });
+        bytes += static_cast<size_t>(Rows) * static_cast<size_t>(RowBytes);
+    };
+
+    auto copyplane = [&](uint Plane)
+    {
+        int rows = GetHeightForPlane(FromType, Height, Plane);
+        int width = GetPitchForPlane(FromType, Width, Plane);
+        uint8_t* to = To[Plane];
+        const uint8_t* from = From[Plane];
+        int topitch = ToPitches[Plane];
+        int frompitch = FromPitches[Plane];
+        addtask(rows, width, [=](int FirstRow, int Rows)
+        {
+            CopyRows(to + (FirstRow * topitch), topitch, from + (FirstRow * frompitch), frompitch,
+                     width, Rows);
+        });
+    };
+
+    if (FromType == ToType)
+    {
+        for (uint plane = 0; plane < GetNumPlanes(FromType); ++plane)
+            copyplane(plane);
+        RunCopyTasks(tasks, bytes);
+        return true;
+    }
+
+    int chromawidth  = GetWidthForPlane(FMT_YV12, Width, 1);
+    int chromaheight = GetHeightForPlane(FMT_YV12, Height, 1);
+    bool hidepth     = ColorDepth(FromType) > 8;
+
+    // Luma
+    if (hidepth)
+    {
+        bool left = ToType == FMT_P010;
+        addtask(Height, Width * 2, [=](int FirstRow, int Rows)
+        {
+            ShiftRows16(To[0] + (FirstRow * ToPitches[0]), ToPitches[0],
+                        From[0] + (FirstRow * FromPitches[0]), FromPitches[0], Width, Rows, left);
+        });
+    }
+    else
+    {
+        copyplane(0);
+    }
+
+    // Chroma
+    if (FormatIsNV12(FromType))
+    {
+        auto split = hidepth ? SplitRows16 : SplitRows8;
+        addtask(chromaheight, chromawidth * (hidepth ? 4 : 2), [=](int FirstRow, int Rows)
+        {
+            split(To[1] + (FirstRow * ToPitches[1]), ToPitches[1],
+                  To[2] + (FirstRow * ToPitches[2]), ToPitches[2],
+                  From[1] + (FirstRow * FromPitches[1]), FromPitches[1], chromawidth, Rows);
+        });
+    }
+    else
+    {
+        auto merge = hidepth ? MergeRows16 : MergeRows8;
+        addtask(chromaheight, chromawidth * (hidepth ? 4 : 2), [=](int FirstRow, int Rows)
+        {
+            merge(To[1] + (FirstRow * ToPitches[1]), ToPitches[1],
+                  From[1] + (FirstRow * FromPitches[1]), FromPitches[1],
+                  From[2] + (FirstRow * FromPitches[2]), FromPitches[2], chromawidth, Rows);
+        });
+    }
+
+    RunCopyTasks(tasks, bytes);
+    return true;
+}
+
 void MythVideoFrame::ClearBufferToBlank()
 {
     if (!m_buffer)
@@ -278,7 +708,7 @@ bool MythVideoFrame::CopyFrame(MythVideoFrame *From)
     if (!From || (this == From))
         return false;
 
-    if (m_type != From->m_type)
+    if ((m_type != From->m_type) && !CanCopy(From->m_type, m_type))
     {
         LOG(VB_GENERAL, LOG_ERR, "Cannot copy frames of differing types");
         return false;
@@ -304,33 +734,32 @@ bool MythVideoFrame::CopyFrame(MythVideoFrame *From)
     }
 
     // N.B. Minimum based on zero width alignment but will apply height alignment
-    size_t minsize = GetBufferSize(m_type, m_width, m_height, 0);
-    if ((m_bufferSize < minsize) || (From->m_bufferSize < minsize))
+    if ((m_bufferSize < GetBufferSize(m_type, m_width, m_height, 0)) ||
+        (From->m_bufferSize < GetBufferSize(From->m_type, m_width, m_height, 0)))
     {
         LOG(VB_GENERAL, LOG_ERR, "Invalid buffer size");
         return false;
     }
 
-    // We have 2 frames of the same valid size and format, they are not hardware frames
-    // and both have buffers reported to satisfy a minimal size.
+    // We have 2 frames of the same valid size and compatible formats, they are not
+    // hardware frames and both have buffers reported to satisfy a minimal size.
 
     // Copy data
-    uint count = GetNumPlanes(From->m_type);
-    for (uint plane = 0; plane < count; plane++)
+    FramePlanes to {};
+    ConstFramePlanes from {};
+    for (uint plane = 0; plane < 3; plane++)
     {
-        CopyPlane(m_buffer + m_offsets[plane], m_pitches[plane],
-                  From->m_buffer + From->m_offsets[plane], From->m_pitches[plane],
-                  GetPitchForPlane(From->m_type, From->m_width, plane),
-                  GetHeightForPlane(From->m_type, From->m_height, plane));
+        to[plane]   = m_buffer + m_offsets[plane];
+        from[plane] = From->m_buffer + From->m_offsets[plane];
     }
+    CopyPlanes(m_type, to, m_pitches, From->m_type, from, From->m_pitches, m_width, m_height);
 
     // Copy metadata
-    // Not copied: codec, width, height - should already be the same
+    // Not copied: codec, width, height, bits per pixel - should already be the same or follow the codec
     // Not copied: buf, size, pitches, offsets - should/could be different
     // Not copied: priv - hardware frames only
     m_aspect              = From->m_aspect;
     m_frameRate           = From->m_frameRate;
-    m_bitsPerPixel        = From->m_bitsPerPixel;
     m_frameNumber         = From->m_frameNumber;
     m_frameCounter        = From->m_frameCounter;
     m_timecode            = From->m_timecode;
@@ -351,7 +780,7 @@ bool MythVideoFrame::CopyFrame(MythVideoFrame *From)
     m_colorprimaries      = From->m_colorprimaries;
     m_colortransfer       = From->m_colortransfer;
     m_chromalocation      = From->m_chromalocation;
-    m_colorshifted        = From->m_colorshifted;
+    m_colorshifted        = (m_type == From->m_type) ? From->m_colorshifted : (m_type == FMT_P010);
     m_alreadyDeinterlaced = From->m_alreadyDeinterlaced;
     m_rotation            = From->m_rotation;
     m_stereo3D            = From->m_stereo3D;
@@ -83,6 +83,8 @@ inline MythDeintType operator~ (MythDeintType a) { return static_cast<MythDeintT
 using VideoFrameTypes = std::vector<VideoFrameType>;
 using FramePitches = std::array<int,3>;
 using FrameOffsets = std::array<int,3>;
+using FramePlanes = std::array<uint8_t*,3>;
+using ConstFramePlanes = std::array<const uint8_t*,3>;
 using MythHDRPtr = std::shared_ptr<class MythHDRMetadata>;
 
 class MTV_PUBLIC MythVideoFrame
@@ -108,6 +110,12 @@ class MTV_PUBLIC MythVideoFrame
 
     static void     CopyPlane(uint8_t* To, int ToPitch, const uint8_t* From, int FromPitch,
                               int PlaneWidth, int PlaneHeight);
+    static bool     CanCopy(VideoFrameType From, VideoFrameType To);
+    static bool     CopyPlanes(VideoFrameType ToType, const FramePlanes& To, const FramePitches& ToPitches,
+                               VideoFrameType FromType, const ConstFramePlanes& From,
+                               const FramePitches& FromPitches, int Width, int Height);
+    static void     AddCopyUser();
+    static void     RemoveCopyUser();
     static QString  FormatDescription(VideoFrameType Type);
     static uint8_t* GetAlignedBuffer(size_t Size);
     static uint8_t* CreateBuffer(VideoFrameType Type, int Width, int Height);
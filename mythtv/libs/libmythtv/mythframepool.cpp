@@ -0,0 +1,213 @@
+// MythTV
+#include "mythlogging.h"
+#include "mythframepool.h"
+
+// FFmpeg - for av_malloc/av_free
+extern "C" {
+#include "libavutil/mem.h"
+}
+
+// Std
+#include <algorithm>
+#include <iterator>
+
+#define LOC QString("FramePool: ")
+
+/*! \brief The pool used by MythVideoFrame.
+ *
+ * \note This is deliberately never deleted, as frames may still be released
+ * during static destruction.
+*/
+MythFramePool* MythFramePool::Global()
+{
+    static auto * s_pool = new MythFramePool;
+    return s_pool;
+}
+
+MythFramePool::MythFramePool(size_t Capacity)
+  : m_capacity(Capacity)
+{
+    m_stats.m_capacity = Capacity;
+}
+
+MythFramePool::~MythFramePool()
+{
+    QMutexLocker locker(&m_lock);
+    FreeCached(0);
+    if (m_stats.m_inUse)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC + QString("Deleted with %1 bytes still in use")
+            .arg(m_stats.m_inUse));
+    }
+}
+
+/*! \brief Round Size up to its size class.
+ *
+ * There are eight classes per power of two, so no more than 12.5% is wasted,
+ * and nothing is smaller than a page.
+*/
+size_t MythFramePool::SizeClass(size_t Size)
+{
+    static constexpr size_t kMinStep = 4096;
+    size_t top = 1;
+    while ((top << 1) != 0 && (top << 1) <= Size)
+        top <<= 1;
+    size_t step = std::max(kMinStep, top >> 3);
+    return (Size + step - 1) & ~(step - 1);
+}
+
+/*! \brief Return a buffer of at least Size bytes, allocated as by MythVideoFrame::GetAlignedBuffer.
+ *
+ * Returns a cached buffer of the same size class if there is one.
+*/
+uint8_t* MythFramePool::Get(size_t Size)
+{
+    if (!Size)
+        return nullptr;
+
+    size_t sizeclass = SizeClass(Size);
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_free.find(sizeclass);
+    if (it != m_free.end())
+    {
+        // Most recently released first, it is the most likely to still be in cache
+        auto age = it->second.back();
+        uint8_t* buffer = *age;
+        it->second.pop_back();
+        if (it->second.empty())
+            m_free.erase(it);
+        m_age.erase(age);
+        m_stats.m_cached -= sizeclass;
+        m_stats.m_cachedCount--;
+        m_stats.m_inUse += sizeclass;
+        m_stats.m_hits++;
+        return buffer;
+    }
+
+    m_stats.m_misses++;
+    locker.unlock();
+    auto * buffer = static_cast<uint8_t*>(av_malloc(sizeclass + 64));
+    if (!buffer)
+        return nullptr;
+    locker.relock();
+    m_owned[buffer] = sizeclass;
+    m_stats.m_inUse += sizeclass;
+    return buffer;
+}
+
+/*! \brief Return Buffer to the pool.
+ *
+ * Buffers that were not allocated by the pool are freed, as are all buffers
+ * when the pool has no users.
+*/
+void MythFramePool::Release(uint8_t* Buffer)
+{
+    if (!Buffer)
+        return;
+
+    QMutexLocker locker(&m_lock);
+    auto owned = m_owned.find(Buffer);
+    if (owned == m_owned.end())
+    {
+        locker.unlock();
+        av_free(Buffer);
+        return;
+    }
+
+    size_t sizeclass = owned->second;
+    m_stats.m_inUse -= sizeclass;
+    if ((m_users < 1) || (sizeclass > m_capacity))
+    {
+        m_owned.erase(owned);
+        locker.unlock();
+        av_free(Buffer);
+        return;
+    }
+
+    m_age.push_back(Buffer);
+    m_free[sizeclass].push_back(std::prev(m_age.end()));
+    m_stats.m_cached += sizeclass;
+    m_stats.m_cachedCount++;
+
+    size_t count = m_stats.m_cachedCount;
+    FreeCached(m_capacity);
+    m_stats.m_evictions += count - m_stats.m_cachedCount;
+}
+
+/// \brief Set the maximum number of bytes held in the pool.
+void MythFramePool::SetCapacity(size_t Capacity)
+{
+    QMutexLocker locker(&m_lock);
+    if (Capacity == m_capacity)
+        return;
+    LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Capacity %1MB").arg(Capacity >> 20));
+    m_capacity = Capacity;
+    m_stats.m_capacity = Capacity;
+    FreeCached(Capacity);
+}
+
+void MythFramePool::AddUser()
+{
+    QMutexLocker locker(&m_lock);
+    m_users++;
+}
+
+/// \brief Free all cached buffers once the last user has gone.
+void MythFramePool::RemoveUser()
+{
+    QMutexLocker locker(&m_lock);
+    if (--m_users > 0)
+        return;
+    m_users = 0;
+    if (m_stats.m_cachedCount)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Releasing %1 buffers (%2MB)")
+            .arg(m_stats.m_cachedCount).arg(m_stats.m_cached >> 20));
+    }
+    FreeCached(0);
+}
+
+void MythFramePool::Flush()
+{
+    QMutexLocker locker(&m_lock);
+    FreeCached(0);
+}
+
+MythFramePool::Stats MythFramePool::GetStats() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_stats;
+}
+
+QString MythFramePool::GetStatsString() const
+{
+    Stats stats = GetStats();
+    uint64_t total = stats.m_hits + stats.m_misses;
+    return QString("%1/%2Mb %3% reused")
+        .arg(stats.m_cached >> 20).arg(stats.m_capacity >> 20)
+        .arg(total ? (stats.m_hits * 100) / total : 0);
+}
+
+/// \note m_lock must be held.
+void MythFramePool::FreeCached(size_t Limit)
+{
+    while ((m_stats.m_cached > Limit) && !m_age.empty())
+    {
+        uint8_t* buffer = m_age.front();
+        auto owned = m_owned.find(buffer);
+        size_t sizeclass = owned->second;
+        m_owned.erase(owned);
+
+        auto it = m_free.find(sizeclass);
+        auto & ages = it->second;
+        ages.erase(std::find(ages.begin(), ages.end(), m_age.begin()));
+        if (ages.empty())
+            m_free.erase(it);
+        m_age.pop_front();
+
+        m_stats.m_cached -= sizeclass;
+        m_stats.m_cachedCount--;
+        av_free(buffer);
+    }
+}
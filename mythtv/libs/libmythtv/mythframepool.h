@@ -0,0 +1,83 @@
+#ifndef MYTHFRAMEPOOL_H
+#define MYTHFRAMEPOOL_H
+
+// Qt
+#include <QMutex>
+#include <QString>
+
+// MythTV
+#include "mythtvexp.h"
+
+// Std
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/*! \class MythFramePool
+ *  \brief A cache of aligned video frame allocations.
+ *
+ *  Allocations are rounded up to a size class (eight classes per power of two)
+ *  so that buffers can be reused across small changes in frame geometry. Buffers
+ *  released while the pool is in use are kept, up to a memory cap, and handed
+ *  out again instead of hitting the allocator when VideoBuffers are recreated
+ *  after a resolution or channel change. The least recently released buffers are
+ *  freed first when the cap is exceeded.
+ *
+ *  Release() accepts any buffer allocated with av_malloc - buffers the pool does
+ *  not own are freed immediately.
+ *
+ *  The pool only retains buffers while it has users (see AddUser()), so memory
+ *  is returned once playback has finished.
+*/
+class MTV_PUBLIC MythFramePool
+{
+  public:
+    struct Stats
+    {
+        uint64_t m_hits        { 0 };
+        uint64_t m_misses      { 0 };
+        uint64_t m_evictions   { 0 };
+        size_t   m_cached      { 0 }; ///< bytes held in the pool
+        size_t   m_cachedCount { 0 }; ///< buffers held in the pool
+        size_t   m_inUse       { 0 }; ///< bytes handed out and not yet released
+        size_t   m_capacity    { 0 };
+    };
+
+    static constexpr size_t kDefaultCapacity { 128ULL << 20 };
+
+    static MythFramePool* Global();
+
+    explicit MythFramePool(size_t Capacity = kDefaultCapacity);
+   ~MythFramePool();
+    MythFramePool(const MythFramePool&) = delete;
+    MythFramePool& operator=(const MythFramePool&) = delete;
+
+    uint8_t* Get(size_t Size);
+    void     Release(uint8_t* Buffer);
+    void     SetCapacity(size_t Capacity);
+    void     AddUser();
+    void     RemoveUser();
+    void     Flush();
+    Stats    GetStats() const;
+    QString  GetStatsString() const;
+
+    static size_t SizeClass(size_t Size);
+
+  private:
+    using AgeList = std::list<uint8_t*>;
+
+    void FreeCached(size_t Limit);
+
+    mutable QMutex m_lock;
+    size_t         m_capacity { kDefaultCapacity };
+    int            m_users    { 0 };
+    Stats          m_stats;
+    // Every buffer allocated by the pool, cached or in use, and its size class
+    std::unordered_map<uint8_t*,size_t> m_owned;
+    // Cached buffers, least recently released first
+    AgeList        m_age;
+    std::map<size_t,std::vector<AgeList::iterator>> m_free;
+};
+
+#endif // MYTHFRAMEPOOL_H
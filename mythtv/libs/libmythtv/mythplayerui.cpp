@@ -11,6 +11,7 @@
 #include "interactivescreen.h"
 #include "tv_play.h"
 #include "livetvchain.h"
+#include "mythframepool.h"
 #include "mythplayerui.h"
 
 #define LOC QString("PlayerUI: ")
@@ -819,8 +820,12 @@ void MythPlayerUI::GetPlaybackData(InfoMap& Map)
                                          .arg(m_videoOutput->FreeVideoFrames());
         Map.insert("videoframes", frames);
     }
+    Map.insert("framepool", MythFramePool::Global()->GetStatsString());
     if (m_decoder)
+    {
         Map["videodecoder"] = m_decoder->GetCodecDecoderName();
+        Map["demuxqueue"] = m_decoder->GetReadAheadStats();
+    }
 
     Map["framerate"] = QString("%1%2%3")
             .arg(static_cast<double>(m_outputJmeter.GetLastFPS()), 0, 'f', 2).arg(QChar(0xB1, 0))
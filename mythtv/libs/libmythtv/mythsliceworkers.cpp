@@ -0,0 +1,129 @@
+// MythTV
+#include "mthread.h"
+#include "mythlogging.h"
+#include "mythsliceworkers.h"
+
+#define LOC QString("SliceWorkers: ")
+
+class MythSliceWorker : public MThread
+{
+  public:
+    MythSliceWorker(MythSliceWorkers* Parent, const QString& Name)
+      : MThread(Name),
+        m_parent(Parent)
+    {
+    }
+
+  protected:
+    void run() override // MThread
+    {
+        RunProlog();
+        m_parent->WorkerLoop();
+        RunEpilog();
+    }
+
+  private:
+    MythSliceWorkers* m_parent { nullptr };
+};
+
+/*! \brief Start Threads - 1 worker threads, the caller of Run() being the last.
+*/
+MythSliceWorkers::MythSliceWorkers(const QString& Name, int Threads)
+{
+    for (int i = 1; i < Threads; ++i)
+    {
+        auto * worker = new MythSliceWorker(this, QString("%1%2").arg(Name).arg(i));
+        m_workers.push_back(worker);
+        worker->start();
+    }
+
+    if (Threads > 1)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Started %1 threads for %2")
+            .arg(Threads).arg(Name));
+    }
+}
+
+MythSliceWorkers::~MythSliceWorkers()
+{
+    m_lock.lock();
+    m_stop = true;
+    m_wake.wakeAll();
+    m_lock.unlock();
+
+    for (auto * worker : m_workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+/*! \brief Call Work once for each slice from 0 to Slices - 1.
+ *
+ * Slices are processed concurrently and in no particular order, so they must
+ * not depend upon each other. Returns once all slices are complete.
+ *
+ * If another thread is already running a job, the slices are processed by the
+ * calling thread alone rather than waiting for the workers.
+*/
+void MythSliceWorkers::Run(int Slices, const SliceFunc& Work)
+{
+    if (Slices < 1)
+        return;
+
+    if (m_workers.empty() || Slices == 1 || !m_runLock.tryLock())
+    {
+        for (int slice = 0; slice < Slices; ++slice)
+            Work(slice);
+        return;
+    }
+
+    m_lock.lock();
+    m_work   = &Work;
+    m_slices = Slices;
+    m_next   = 0;
+    m_generation++;
+    m_wake.wakeAll();
+    m_lock.unlock();
+
+    int slice = 0;
+    while ((slice = m_next++) < Slices)
+        Work(slice);
+
+    // Workers that have not picked up this job yet must not see it now
+    m_lock.lock();
+    m_work = nullptr;
+    while (m_busy > 0)
+        m_done.wait(&m_lock);
+    m_lock.unlock();
+    m_runLock.unlock();
+}
+
+void MythSliceWorkers::WorkerLoop()
+{
+    uint64_t seen = 0;
+    m_lock.lock();
+    while (!m_stop)
+    {
+        if (!m_work || (seen == m_generation))
+        {
+            m_wake.wait(&m_lock);
+            continue;
+        }
+
+        seen = m_generation;
+        const SliceFunc* work = m_work;
+        int slices = m_slices;
+        m_busy++;
+        m_lock.unlock();
+
+        int slice = 0;
+        while ((slice = m_next++) < slices)
+            (*work)(slice);
+
+        m_lock.lock();
+        if (--m_busy == 0)
+            m_done.wakeAll();
+    }
+    m_lock.unlock();
+}
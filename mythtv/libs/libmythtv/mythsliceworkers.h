@@ -0,0 +1,58 @@
+#ifndef MYTHSLICEWORKERS_H
+#define MYTHSLICEWORKERS_H
+
+// Qt
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// MythTV
+#include "mythtvexp.h"
+
+// Std
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class MythSliceWorker;
+
+/*! \class MythSliceWorkers
+ *  \brief A small set of threads that split per frame work into slices.
+ *
+ *  Run() hands out slice numbers to the worker threads and to the calling
+ *  thread, and only returns once every slice has been processed. Work is
+ *  expected to take no more than a few milliseconds, so there is no queueing;
+ *  one job runs at a time and Run() may be called from any thread.
+*/
+class MTV_PUBLIC MythSliceWorkers
+{
+    friend class MythSliceWorker;
+
+  public:
+    using SliceFunc = std::function<void(int Slice)>;
+
+    MythSliceWorkers(const QString& Name, int Threads);
+   ~MythSliceWorkers();
+    MythSliceWorkers(const MythSliceWorkers&) = delete;
+    MythSliceWorkers& operator=(const MythSliceWorkers&) = delete;
+
+    int  Threads() const { return static_cast<int>(m_workers.size()) + 1; }
+    void Run(int Slices, const SliceFunc& Work);
+
+  private:
+    void WorkerLoop();
+
+    std::vector<MythSliceWorker*> m_workers;
+    QMutex           m_runLock;
+    QMutex           m_lock;
+    QWaitCondition   m_wake;
+    QWaitCondition   m_done;
+    bool             m_stop       { false };
+    uint64_t         m_generation { 0 };
+    const SliceFunc* m_work       { nullptr };
+    int              m_slices     { 0 };
+    int              m_busy       { 0 };
+    std::atomic_int  m_next       { 0 };
+};
+
+#endif // MYTHSLICEWORKERS_H
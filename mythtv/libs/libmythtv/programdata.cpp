@@ -35,25 +35,60 @@ static QVariant denullify(const QDateTime &dt)
     return dt.isNull() ? QVariant("0000-00-00 00:00:00") : QVariant(dt);
 }
 
+// Insert all genres of a program with a single statement.
 static void add_genres(MSqlQuery &query, const QStringList &genres,
                 uint chanid, const QDateTime &starttime)
 {
     QString relevance = QString("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
-    for (auto it = genres.constBegin(); (it != genres.constEnd()) &&
-             ((it - genres.constBegin()) < relevance.size()); ++it)
+    int count = std::min(genres.size(), relevance.size());
+    if (count <= 0)
+        return;
+
+    QStringList values;
+    for (int i = 0; i < count; ++i)
+        values << QString("(:CHANID, :START, :GENRE%1, :RELEVANCE%1)").arg(i);
+
+    query.prepare(
+       "INSERT INTO programgenres "
+       "       ( chanid,  starttime, genre,  relevance) "
+       "VALUES " + values.join(", "));
+    query.bindValue(":CHANID",    chanid);
+    query.bindValue(":START",     starttime);
+    for (int i = 0; i < count; ++i)
     {
-        query.prepare(
-           "INSERT INTO programgenres "
-           "       ( chanid,  starttime, genre,  relevance) "
-           "VALUES (:CHANID, :START,    :genre, :relevance)");
-        query.bindValue(":CHANID",    chanid);
-        query.bindValue(":START",     starttime);
-        query.bindValue(":genre",     *it);
-        query.bindValue(":relevance", relevance.at(it - genres.constBegin()));
+        query.bindValue(QString(":GENRE%1").arg(i),     genres.at(i));
+        query.bindValue(QString(":RELEVANCE%1").arg(i), relevance.at(i));
+    }
 
-        if (!query.exec())
-            MythDB::DBError("programgenres insert", query);
+    if (!query.exec())
+        MythDB::DBError("programgenres insert", query);
+}
+
+// Insert all ratings of a program with a single statement.
+static void add_ratings(MSqlQuery &query, const QList<EventRating> &ratings,
+                        uint chanid, const QDateTime &starttime)
+{
+    if (ratings.isEmpty())
+        return;
+
+    QStringList values;
+    for (int i = 0; i < ratings.size(); ++i)
+        values << QString("(:CHANID, :START, :SYS%1, :RATING%1)").arg(i);
+
+    query.prepare(
+        "INSERT IGNORE INTO programrating "
+        "       ( chanid, starttime, `system`, rating) "
+        "VALUES " + values.join(", "));
+    query.bindValue(":CHANID", chanid);
+    query.bindValue(":START",  starttime);
+    for (int i = 0; i < ratings.size(); ++i)
+    {
+        query.bindValue(QString(":SYS%1").arg(i),    ratings.at(i).m_system);
+        query.bindValue(QString(":RATING%1").arg(i), ratings.at(i).m_rating);
     }
+
+    if (!query.exec())
+        MythDB::DBError("programrating insert", query);
 }
 
 DBPerson::DBPerson(const DBPerson &other) :
@@ -833,20 +868,7 @@ uint DBEvent::UpdateDB(
             credit.InsertDB(query, chanid, m_starttime);
     }
 
-    for (const auto & rating : qAsConst(m_ratings))
-    {
-        query.prepare(
-            "INSERT IGNORE INTO programrating "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    add_ratings(query, m_ratings, chanid, m_starttime);
 
     add_genres(query, m_genres, chanid, m_starttime);
 
@@ -1134,20 +1156,7 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
         return 0;
     }
 
-    for (const auto & rating : qAsConst(m_ratings))
-    {
-        query.prepare(
-            "INSERT IGNORE INTO programrating "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
-
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    add_ratings(query, m_ratings, chanid, m_starttime);
 
     if (m_credits)
     {
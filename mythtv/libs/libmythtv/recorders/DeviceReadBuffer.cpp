@@ -9,11 +9,9 @@
 
 #ifndef _WIN32
 #include <sys/poll.h>
+#include <sys/uio.h>
 #endif
 
-/// Set this to 1 to report on statistics
-#define REPORT_RING_STATS 0
-
 #define LOC QString("DevRdB(%1): ").arg(m_videoDevice)
 
 DeviceReadBuffer::DeviceReadBuffer(
@@ -48,6 +46,7 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
                              uint readQuanta, uint deviceBufferSize,
                              uint deviceBufferCount)
 {
+    QMutexLocker readLocker(&m_readLock);
     QMutexLocker locker(&m_lock);
 
     delete[] m_buffer;
@@ -89,11 +88,15 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
     memset(m_buffer, 0xFF, m_size + m_readQuanta);
 
     // Initialize statistics
-    m_maxUsed        = 0;
-    m_avgUsed        = 0;
-    m_avgBufWriteCnt = 0;
-    m_avgBufReadCnt  = 0;
-    m_avgBufSleepCnt = 0;
+    m_statBytes         = 0;
+    m_statReads         = 0;
+    m_statOverflows     = 0;
+    m_statRingFull      = 0;
+    m_maxUsed           = 0;
+    m_lastStatBytes     = 0;
+    m_lastStatReads     = 0;
+    m_lastStatOverflows = 0;
+    m_lastStatRingFull  = 0;
     m_lastReport.start();
 
     LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB").arg(m_size/1024));
@@ -131,6 +134,7 @@ void DeviceReadBuffer::Start(void)
 
 void DeviceReadBuffer::Reset(const QString &streamName, int streamfd)
 {
+    QMutexLocker readLocker(&m_readLock);
     QMutexLocker locker(&m_lock);
 
     m_videoDevice   = streamName;
@@ -257,45 +261,51 @@ bool DeviceReadBuffer::IsRunning(void) const
 
 uint DeviceReadBuffer::GetUnused(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_size - m_used;
+    return m_size - m_used.load(std::memory_order_acquire);
 }
 
 uint DeviceReadBuffer::GetUsed(void) const
 {
-    QMutexLocker locker(&m_lock);
-    return m_used;
+    return m_used.load(std::memory_order_acquire);
 }
 
+/// \note Only valid on the device reading thread.
 uint DeviceReadBuffer::GetContiguousUnused(void) const
 {
-    QMutexLocker locker(&m_lock);
     return m_endPtr - m_writePtr;
 }
 
+/** \brief Publishes len bytes written at m_writePtr to the consumer.
+ *
+ *  Only called by the device reading thread.
+ */
 void DeviceReadBuffer::IncrWritePointer(uint len)
 {
-    QMutexLocker locker(&m_lock);
-    m_used     += len;
     m_writePtr += len;
     m_writePtr  = (m_writePtr >= m_endPtr) ? m_buffer + (m_writePtr - m_endPtr) : m_writePtr;
-#if REPORT_RING_STATS
-    m_maxUsed = std::max(m_used, m_maxUsed);
-    m_avgUsed = ((m_avgUsed * m_avgBufWriteCnt) + m_used) / (m_avgBufWriteCnt+1);
-    ++m_avgBufWriteCnt;
-#endif
-    m_dataWait.wakeAll();
+
+    size_t used = m_used.fetch_add(len) + len;
+    if (used > m_maxUsed.load(std::memory_order_relaxed))
+        m_maxUsed.store(used, std::memory_order_relaxed);
+    m_statBytes.fetch_add(len, std::memory_order_relaxed);
+
+    // Only take the lock when the consumer is actually sleeping.
+    if (m_readerWaiting)
+    {
+        QMutexLocker locker(&m_lock);
+        m_dataWait.wakeAll();
+    }
 }
 
+/** \brief Hands len bytes at m_readPtr back to the producer.
+ *
+ *  Only called with m_readLock held.
+ */
 void DeviceReadBuffer::IncrReadPointer(uint len)
 {
-    QMutexLocker locker(&m_lock);
-    m_used    -= len;
     m_readPtr += len;
     m_readPtr  = (m_readPtr == m_endPtr) ? m_buffer : m_readPtr;
-#if REPORT_RING_STATS
-    ++m_avgBufReadCnt;
-#endif
+    m_used.fetch_sub(len, std::memory_order_release);
 }
 
 void DeviceReadBuffer::run(void)
@@ -346,18 +356,21 @@ void DeviceReadBuffer::run(void)
             // Limit read size for faster return from read
             auto unused = static_cast<size_t>(WaitForUnused(m_readQuanta));
             size_t read_size = std::min(m_devReadSize, unused);
+            if (m_doRun && (unused <= m_readQuanta))
+                m_statRingFull.fetch_add(1, std::memory_order_relaxed);
 
             // if read_size > 0 do the read...
             if (read_size)
             {
-                len = read(m_streamFd, m_writePtr, read_size);
+                bool split = false;
+                len = ReadDevice(read_size, split);
                 if (!CheckForErrors(len, read_size, errcnt))
                     break;
                 errcnt = 0;
 
                 // if we wrote past the official end of the buffer,
                 // copy to start
-                if (m_writePtr + len > m_endPtr)
+                if (!split && (m_writePtr + len > m_endPtr))
                     memcpy(m_buffer, m_endPtr, m_writePtr + len - m_endPtr);
                 IncrWritePointer(len);
                 total += len;
@@ -384,6 +397,36 @@ void DeviceReadBuffer::run(void)
     RunEpilog();
 }
 
+/** \brief Reads up to read_size bytes from the device into the ring.
+ *
+ *  When the read would run past the end of the ring it is split
+ *  between the end and the start of the ring with a single readv(),
+ *  instead of reading into the overhang and copying it to the start.
+ *
+ *  \param read_size Maximum number of bytes to read
+ *  \param split     Set to true if the read was split
+ *  \return the result of the read
+ */
+ssize_t DeviceReadBuffer::ReadDevice(size_t read_size, bool &split)
+{
+    m_statReads.fetch_add(1, std::memory_order_relaxed);
+
+#ifndef _WIN32
+    size_t contiguous = GetContiguousUnused();
+    if (read_size > contiguous)
+    {
+        std::array<struct iovec,2> iov {{
+            { m_writePtr, contiguous },
+            { m_buffer,   read_size - contiguous } }};
+        split = true;
+        return readv(m_streamFd, iov.data(), iov.size());
+    }
+#endif
+
+    split = false;
+    return read(m_streamFd, m_writePtr, read_size);
+}
+
 bool DeviceReadBuffer::HandlePausing(void)
 {
     if (IsPauseRequested())
@@ -567,6 +610,7 @@ bool DeviceReadBuffer::CheckForErrors(
         }
         if (EOVERFLOW == errno)
         {
+            m_statOverflows.fetch_add(1, std::memory_order_relaxed);
             LOG(VB_GENERAL, LOG_ERR, LOC + "Driver buffers overflowed");
             return false;
         }
@@ -613,6 +657,8 @@ bool DeviceReadBuffer::CheckForErrors(
  */
 uint DeviceReadBuffer::Read(unsigned char *buf, const uint count)
 {
+    QMutexLocker readLocker(&m_readLock);
+
     uint avail = WaitForUsed(std::min(count, (uint)m_readThreshold), 20ms);
     size_t cnt = std::min(count, avail);
 
@@ -642,9 +688,7 @@ uint DeviceReadBuffer::Read(unsigned char *buf, const uint count)
         IncrReadPointer(cnt);
     }
 
-#if REPORT_RING_STATS
     ReportStats();
-#endif
 
     return cnt;
 }
@@ -684,8 +728,13 @@ uint DeviceReadBuffer::WaitForUsed(uint needed, std::chrono::milliseconds max_wa
     MythTimer timer;
     timer.start();
 
+    size_t avail = m_used.load(std::memory_order_acquire);
+    if (needed <= avail)
+        return avail;
+
     QMutexLocker locker(&m_lock);
-    size_t avail = m_used;
+    m_readerWaiting = true;
+    avail = m_used;
     while ((needed > avail) && isRunning() &&
            !m_requestPause && !m_error && !m_eof &&
            (timer.elapsed() < max_wait))
@@ -693,34 +742,45 @@ uint DeviceReadBuffer::WaitForUsed(uint needed, std::chrono::milliseconds max_wa
         m_dataWait.wait(locker.mutex(), 10);
         avail = m_used;
     }
+    m_readerWaiting = false;
     return avail;
 }
 
+/** \brief Logs throughput and overflow statistics every 20 seconds.
+ *
+ *  Only called with m_readLock held.
+ */
 void DeviceReadBuffer::ReportStats(void)
 {
-#if REPORT_RING_STATS
     static constexpr std::chrono::seconds secs { 20s }; // msg every 20 seconds
-    static constexpr double d1_s = 1.0 / secs.count();
-    if (m_lastReport.elapsed() > duration_cast<std::chrono::milliseconds>(secs))
-    {
-        QMutexLocker locker(&m_lock);
-        double rsize = 100.0 / m_size;
-        QString msg  = QString("fill avg(%1%) ").arg(m_avgUsed*rsize,5,'f',2);
-        msg         += QString("fill max(%1%) ").arg(m_maxUsed*rsize,5,'f',2);
-        msg         += QString("writes/sec(%1) ").arg(m_avgBufWriteCnt*d1_s);
-        msg         += QString("reads/sec(%1) ").arg(m_avgBufReadCnt*d1_s);
-        msg         += QString("sleeps/sec(%1)").arg(m_avgBufSleepCnt*d1_s);
-
-        m_avgUsed        = 0;
-        m_avgBufWriteCnt = 0;
-        m_avgBufReadCnt  = 0;
-        m_avgBufSleepCnt = 0;
-        m_maxUsed        = 0;
-        m_lastReport.start();
-
-        LOG(VB_GENERAL, LOG_INFO, LOC + msg);
-    }
-#endif
+    std::chrono::milliseconds elapsed = m_lastReport.elapsed();
+    if (elapsed < duration_cast<std::chrono::milliseconds>(secs))
+        return;
+
+    uint64_t bytes     = m_statBytes.load(std::memory_order_relaxed);
+    uint64_t reads     = m_statReads.load(std::memory_order_relaxed);
+    uint64_t overflows = m_statOverflows.load(std::memory_order_relaxed);
+    uint64_t ringfull  = m_statRingFull.load(std::memory_order_relaxed);
+    size_t   maxused   = m_maxUsed.exchange(0, std::memory_order_relaxed);
+
+    uint64_t dbytes = bytes - m_lastStatBytes;
+    uint64_t dreads = reads - m_lastStatReads;
+    double   d1_s   = 1000.0 / elapsed.count();
+
+    QString msg = QString("throughput %1 KB/s ").arg(dbytes * d1_s / 1024,0,'f',1);
+    msg += QString("reads/sec(%1) ").arg(dreads * d1_s,0,'f',1);
+    msg += QString("bytes/read(%1) ").arg(dreads ? dbytes / dreads : 0);
+    msg += QString("fill max(%1%) ").arg(maxused * 100.0 / m_size,5,'f',2);
+    msg += QString("driver overflows(%1) ").arg(overflows - m_lastStatOverflows);
+    msg += QString("ring full(%1)").arg(ringfull - m_lastStatRingFull);
+
+    m_lastStatBytes     = bytes;
+    m_lastStatReads     = reads;
+    m_lastStatOverflows = overflows;
+    m_lastStatRingFull  = ringfull;
+    m_lastReport.start();
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC + msg);
 }
 
 /*
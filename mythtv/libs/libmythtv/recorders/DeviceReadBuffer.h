@@ -4,6 +4,7 @@
 #ifndef DEVICEREADBUFFER_H
 #define DEVICEREADBUFFER_H
 
+#include <atomic>
 #include <unistd.h>
 
 #include <QMutex>
@@ -30,6 +31,12 @@ class DeviceReaderCB
  *  This allows us to read the device regularly even in the presence
  *  of long blocking conditions on writing to disk or accessing the
  *  database.
+ *
+ *  The ring has a single producer (the device reading thread) and a
+ *  single consumer (the caller of Read()), which only share the
+ *  atomic fill count. Neither side takes a lock to hand data over,
+ *  m_lock is only used for the state flags and for waking a consumer
+ *  that is waiting for data.
  */
 class DeviceReadBuffer : protected MThread
 {
@@ -81,6 +88,7 @@ class DeviceReadBuffer : protected MThread
     uint GetContiguousUnused(void) const;
 
     bool CheckForErrors(ssize_t read_len, size_t requested_len, uint &errcnt);
+    ssize_t ReadDevice(size_t read_size, bool &split);
     void ReportStats(void);
 
     QString                 m_videoDevice;
@@ -102,27 +110,39 @@ class DeviceReadBuffer : protected MThread
     std::chrono::milliseconds m_maxPollWait         {2500ms};
 
     size_t                  m_size                  {0};
-    size_t                  m_used                  {0};
     size_t                  m_readQuanta            {0};
     size_t                  m_devBufferCount        {1};
     size_t                  m_devReadSize           {0};
     size_t                  m_readThreshold         {0};
     unsigned char          *m_buffer                {nullptr};
-    unsigned char          *m_readPtr               {nullptr};
-    unsigned char          *m_writePtr              {nullptr};
     unsigned char          *m_endPtr                {nullptr};
 
+    // Producer side, only touched by the device reading thread.
+    alignas(64) unsigned char *m_writePtr           {nullptr};
+    // Consumer side, protected by m_readLock which is only
+    // contended when the ring is reset.
+    alignas(64) unsigned char *m_readPtr            {nullptr};
+    QMutex                  m_readLock;
+    // Shared between the two sides.
+    alignas(64) std::atomic<size_t> m_used          {0};
+    std::atomic<bool>       m_readerWaiting         {false};
+
     mutable QWaitCondition  m_dataWait;
     QWaitCondition          m_runWait;
     QWaitCondition          m_pauseWait;
     QWaitCondition          m_unpauseWait;
 
-    // statistics
-    size_t                  m_maxUsed               {0};
-    size_t                  m_avgUsed               {0};
-    size_t                  m_avgBufWriteCnt        {0};
-    size_t                  m_avgBufReadCnt         {0};
-    size_t                  m_avgBufSleepCnt        {0};
+    // statistics, updated by the device reading thread
+    std::atomic<uint64_t>   m_statBytes             {0};
+    std::atomic<uint64_t>   m_statReads             {0};
+    std::atomic<uint64_t>   m_statOverflows         {0};
+    std::atomic<uint64_t>   m_statRingFull          {0};
+    std::atomic<size_t>     m_maxUsed               {0};
+    // statistics, only used by ReportStats()
+    uint64_t                m_lastStatBytes         {0};
+    uint64_t                m_lastStatReads         {0};
+    uint64_t                m_lastStatOverflows     {0};
+    uint64_t                m_lastStatRingFull      {0};
     MythTimer               m_lastReport;
 };
 
@@ -782,13 +782,9 @@ void ExternalStreamHandler::run(void)
         if (!m_listenerLock.tryLock())
             continue;
 
-        for (auto sit = m_streamDataList.cbegin();
-             sit != m_streamDataList.cend(); ++sit)
-        {
-            remainder = sit.key()->ProcessData
-                        (reinterpret_cast<const uint8_t *>
-                         (buffer.constData()), buffer.size());
-        }
+        remainder = ProcessStreamData
+                    (reinterpret_cast<const uint8_t *>
+                     (buffer.constData()), buffer.size());
 
         m_listenerLock.unlock();
 
@@ -1094,13 +1090,9 @@ void ExternalStreamHandler::ReplayStream(void)
 
         if (!m_streamDataList.empty())
         {
-            for (auto sit = m_streamDataList.cbegin();
-                 sit != m_streamDataList.cend(); ++sit)
-            {
-                sit.key()->ProcessData(reinterpret_cast<const uint8_t *>
-                                       (m_replayBuffer.constData()),
-                                       m_replayBuffer.size());
-            }
+            ProcessStreamData(reinterpret_cast<const uint8_t *>
+                              (m_replayBuffer.constData()),
+                              m_replayBuffer.size());
         }
         LOG(VB_RECORD, LOG_INFO, LOC + QString("Replayed %1 bytes")
             .arg(m_replayBuffer.size()));
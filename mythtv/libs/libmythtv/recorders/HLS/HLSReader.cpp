@@ -6,6 +6,14 @@
 
 #define LOC QString("%1: ").arg(m_curstream ? m_curstream->M3U8Url() : "HLSReader")
 
+// A stream is only switched to if the estimated bandwidth exceeds
+// its bitrate by this factor, so a small dip doesn't cause a switch.
+static constexpr double kBitrateHeadroom { 1.25 };
+// Weight of the newest sample in the bandwidth estimate
+static constexpr double kBandwidthWeight { 0.25 };
+// How often to log the segment download statistics
+static constexpr uint kStatsInterval { 30 };
+
 /**
  * Handles relative URLs without breaking URI encoded parameters by avoiding
  * storing the decoded URL in a QString.
@@ -118,6 +126,9 @@ bool HLSReader::Open(const QString & m3u, int bitrate_index)
 
     QMutexLocker worker_lock(&m_workerLock);
 
+    if (m_prefetchCount > 1)
+        m_prefetcher = new HLSSegmentPrefetcher(m_prefetchCount);
+
     m_playlistWorker = new HLSPlaylistWorker(this);
     m_playlistWorker->start();
 
@@ -148,6 +159,8 @@ void HLSReader::Close(bool quiet)
     m_streamWorker = nullptr;
     delete m_playlistWorker;
     m_playlistWorker = nullptr;
+    delete m_prefetcher;
+    m_prefetcher = nullptr;
 
     LOG(VB_RECORD, (quiet ? LOG_DEBUG : LOG_INFO), LOC + "Close -- end");
 }
@@ -170,6 +183,10 @@ void HLSReader::Cancel(bool quiet)
     if (m_playlistWorker)
         m_playlistWorker->Cancel();
 
+    // Release the stream worker if it is waiting on a segment
+    if (m_prefetcher)
+        m_prefetcher->Cancel();
+
     if (m_streamWorker)
         m_streamWorker->Cancel();
 
@@ -605,6 +622,8 @@ bool HLSReader::ParseM3U8(const QByteArray& buffer, HLSRecStream* stream)
             m_workerLock.lock();
             if (m_streamWorker)
                 m_streamWorker->CancelCurrentDownload();
+            if (m_prefetcher)
+                m_prefetcher->Cancel();
             m_workerLock.unlock();
 
             EnableDebugging();
@@ -647,7 +666,19 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
                 QString("playlist size %1, queued %2")
                 .arg(m_playlistSize).arg(m_segments.size()));
             EnableDebugging();
-            DecreaseBitrate(m_curstream->Id());
+            DecreaseBitrate(m_curstream->Id(), m_bandwidthEstimate);
+            m_bandwidthCheck = false;
+        }
+        else if (m_bandwidthEstimate > 0 &&
+                 m_bandwidthEstimate < m_curstream->Bitrate())
+        {
+            // Still buffered, but the download rate can't sustain this
+            // stream.  Step down before the buffer drains.
+            LOG(VB_RECORD, LOG_WARNING, LOC +
+                QString("Bandwidth %1 below bitrate %2 with %3% buffered")
+                .arg(m_bandwidthEstimate).arg(m_curstream->Bitrate())
+                .arg(buffered));
+            DecreaseBitrate(m_curstream->Id(), m_bandwidthEstimate);
             m_bandwidthCheck = false;
         }
         else if (buffered > 85)
@@ -660,7 +691,7 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("playlist size %1, queued %2")
                 .arg(m_playlistSize).arg(m_segments.size()));
-            IncreaseBitrate(m_curstream->Id());
+            IncreaseBitrate(m_curstream->Id(), m_bandwidthEstimate);
             m_bandwidthCheck = false;
         }
     }
@@ -696,18 +727,28 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
     return true;
 }
 
-void HLSReader::DecreaseBitrate(int progid)
+/**
+ * Switches to a lower bitrate stream.  With a bandwidth estimate, the
+ * highest stream which fits within it is picked, which may skip several
+ * steps.  If none fit, or there is no estimate, the next lower stream
+ * is used.
+ */
+void HLSReader::DecreaseBitrate(int progid, uint64_t bandwidth)
 {
     HLSRecStream *hls = nullptr;
+    HLSRecStream *next = nullptr;
     uint64_t bitrate = m_curstream->Bitrate();
     uint64_t candidate = 0;
 
     for (auto Istream = m_streams.cbegin(); Istream != m_streams.cend(); ++Istream)
     {
-        if ((*Istream)->Id() != progid)
+        if ((*Istream)->Id() != progid || (*Istream)->Bitrate() >= bitrate)
+            continue;
+        if (!next || next->Bitrate() < (*Istream)->Bitrate())
+            next = *Istream;
+        if ((*Istream)->Bitrate() * kBitrateHeadroom > bandwidth)
             continue;
-        if (bitrate > (*Istream)->Bitrate() &&
-            candidate < (*Istream)->Bitrate())
+        if (candidate < (*Istream)->Bitrate())
         {
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("candidate stream '%1' bitrate %2 >= %3")
@@ -717,6 +758,12 @@ void HLSReader::DecreaseBitrate(int progid)
         }
     }
 
+    if (!hls && next)
+    {
+        hls = next;
+        candidate = hls->Bitrate();
+    }
+
     if (hls)
     {
         LOG(VB_RECORD, LOG_INFO, LOC +
@@ -731,7 +778,11 @@ void HLSReader::DecreaseBitrate(int progid)
     }
 }
 
-void HLSReader::IncreaseBitrate(int progid)
+/**
+ * Switches to the next higher bitrate stream, as long as the bandwidth
+ * estimate, when there is one, leaves some headroom at that bitrate.
+ */
+void HLSReader::IncreaseBitrate(int progid, uint64_t bandwidth)
 {
     HLSRecStream *hls = nullptr;
     uint64_t bitrate = m_curstream->Bitrate();
@@ -741,6 +792,8 @@ void HLSReader::IncreaseBitrate(int progid)
     {
         if ((*Istream)->Id() != progid)
             continue;
+        if (bandwidth > 0 && (*Istream)->Bitrate() * kBitrateHeadroom > bandwidth)
+            continue;
         if (bitrate < (*Istream)->Bitrate() &&
             candidate > (*Istream)->Bitrate())
         {
@@ -762,10 +815,29 @@ void HLSReader::IncreaseBitrate(int progid)
     else
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC +
-            QString("Already at highest bitrate %1").arg(bitrate));
+            QString("Already at highest bitrate %1 for bandwidth %2")
+            .arg(bitrate).arg(bandwidth));
     }
 }
 
+void HLSReader::UpdateBandwidthEstimate(uint64_t bandwidth)
+{
+    if (m_bandwidthEstimate == 0)
+        m_bandwidthEstimate = bandwidth;
+    else
+        m_bandwidthEstimate = static_cast<uint64_t>(
+            (kBandwidthWeight * bandwidth) +
+            ((1.0 - kBandwidthWeight) * m_bandwidthEstimate));
+}
+
+HLSSegmentPrefetcher::Stats HLSReader::SegmentStats(void) const
+{
+    QMutexLocker lock(&m_workerLock);
+    if (m_prefetcher)
+        return m_prefetcher->GetStats();
+    return {};
+}
+
 bool HLSReader::LoadSegments(MythSingleDownload& downloader)
 {
     LOG(VB_RECORD, LOG_DEBUG, LOC + "LoadSegment -- start");
@@ -788,6 +860,9 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
         }
 
         seg = m_segments.front();
+        SegmentContainer ahead;
+        if (m_prefetcher)
+            ahead = m_segments.mid(0, m_prefetchCount);
         if (m_segments.size() > m_playlistSize)
         {
             LOG(VB_RECORD, (m_debug ? LOG_INFO : LOG_DEBUG), LOC +
@@ -806,6 +881,9 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
         }
         m_seqLock.unlock();
 
+        if (m_prefetcher)
+            m_prefetcher->Prefetch(ahead);
+
         m_streamLock.lock();
         HLSRecStream *hls = m_curstream;
         m_streamLock.unlock();
@@ -835,6 +913,14 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
 
         m_seqLock.unlock();
 
+        if (m_prefetcher && (++m_statsCnt % kStatsInterval) == 0)
+        {
+            LOG(VB_RECORD, LOG_INFO, LOC + QString("Segment downloads: %1, "
+                                                   "bandwidth %2kiB/s")
+                .arg(m_prefetcher->StatsString())
+                .arg(m_bandwidthEstimate / 8192));
+        }
+
         if (m_throttle && throttle == 0)
             throttle = 2;
         else if (throttle > 8)
@@ -904,6 +990,7 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
 
     QByteArray buffer;
     auto start = nowAsDuration<std::chrono::milliseconds>();
+    std::chrono::milliseconds latency = 0ms;
 
 #ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
                                    // and can only handle six download at a time
@@ -924,7 +1011,17 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
             return 0;
     }
 #else
-    if (!downloader.DownloadURL(segment.Url(), &buffer))
+    QString error;
+    if (m_prefetcher)
+    {
+        if (!m_prefetcher->Take(segment, buffer, latency, error))
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
+                .arg(segment.Sequence()).arg(error));
+            return -1;
+        }
+    }
+    else if (!downloader.DownloadURL(segment.Url(), &buffer))
     {
         LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
             .arg(segment.Sequence()).arg(downloader.ErrorString()));
@@ -932,7 +1029,9 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
     }
 #endif
 
-    auto downloadduration = nowAsDuration<std::chrono::milliseconds>() - start;
+    // A prefetched segment reports how long its own download took
+    auto downloadduration = m_prefetcher ? latency :
+        nowAsDuration<std::chrono::milliseconds>() - start;
 
 #ifdef USING_LIBCRYPTO
     /* If the segment is encrypted, decode it */
@@ -988,7 +1087,16 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
 
     /* bits/sec */
     bandwidth = segment_len * 8 * 1000ULL / downloadduration.count();
+    if (m_prefetcher)
+    {
+        // Segments download side by side, so one segment's rate
+        // understates what the connection delivers.
+        uint64_t throughput = m_prefetcher->TakeThroughput();
+        if (throughput > 0)
+            bandwidth = throughput;
+    }
     hls->AverageBandwidth(bandwidth);
+    UpdateBandwidthEstimate(bandwidth);
     hls->SetCurrentByteRate(static_cast<uint64_t>
                             ((static_cast<double>(segment_len) /
                               static_cast<double>(segment.Duration().count()))));
@@ -1,6 +1,8 @@
 #ifndef HLS_READER_H
 #define HLS_READER_H
 
+#include <algorithm>
+
 #include <QObject>
 #include <QString>
 #include <QUrl>
@@ -26,6 +28,7 @@
 #include "mythtvexp.h"
 
 #include "HLSSegment.h"
+#include "HLSSegmentPrefetcher.h"
 #include "HLSStream.h"
 #include "HLSStreamWorker.h"
 #include "HLSPlaylistWorker.h"
@@ -40,6 +43,8 @@ class MTV_PUBLIC  HLSReader
     using StreamContainer = QMap<QString, HLSRecStream* >;
     using SegmentContainer = QVector<HLSRecSegment>;
 
+    static constexpr int kDefaultPrefetchCount { 3 };
+
     HLSReader(void) = default;
     ~HLSReader(void);
 
@@ -52,6 +57,12 @@ class MTV_PUBLIC  HLSReader
     { return m_curstream && m_m3u8 == url; }
     bool FatalError(void) const { return m_fatal; }
 
+    /// Number of segments downloaded at the same time, takes effect on
+    /// the next Open().  1 downloads segments one after the other.
+    void SetPrefetchCount(int count) { m_prefetchCount = std::max(count, 1); }
+    int  PrefetchCount(void) const { return m_prefetchCount; }
+    HLSSegmentPrefetcher::Stats SegmentStats(void) const;
+
     bool LoadMetaPlaylists(MythSingleDownload& downloader);
     void ResetStream(void)
       { QMutexLocker lock(&m_streamLock); m_curstream = nullptr; }
@@ -83,8 +94,9 @@ class MTV_PUBLIC  HLSReader
 
   private:
     bool ParseM3U8(const QByteArray & buffer, HLSRecStream* stream = nullptr);
-    void DecreaseBitrate(int progid);
-    void IncreaseBitrate(int progid);
+    void DecreaseBitrate(int progid, uint64_t bandwidth);
+    void IncreaseBitrate(int progid, uint64_t bandwidth);
+    void UpdateBandwidthEstimate(uint64_t bandwidth);
 
     // Downloading
     bool LoadSegments(HLSRecStream & hlsstream);
@@ -111,6 +123,8 @@ class MTV_PUBLIC  HLSReader
 
     HLSPlaylistWorker *m_playlistWorker {nullptr};
     HLSStreamWorker   *m_streamWorker   {nullptr};
+    HLSSegmentPrefetcher *m_prefetcher  {nullptr};
+    int                m_prefetchCount  {kDefaultPrefetchCount};
 
     int                m_playlistSize   {0};
     bool               m_bandwidthCheck {false};
@@ -125,6 +139,9 @@ class MTV_PUBLIC  HLSReader
 
     // Downloading
     int                m_slowCnt        {0};
+    uint               m_statsCnt       {0};
+    // Smoothed download bandwidth across bitrate switches (bits/s)
+    uint64_t           m_bandwidthEstimate {0};
     QByteArray         m_buffer;
     QMutex             m_bufLock;
 };
@@ -0,0 +1,327 @@
+#include <algorithm>
+
+#include "mythlogging.h"
+
+#include "HLSSegmentPrefetcher.h"
+
+#define LOC QString("HLSPrefetch: ")
+
+HLSPrefetchWorker::HLSPrefetchWorker(HLSSegmentPrefetcher* parent, int num)
+    : MThread(QString("HLSPrefetch%1").arg(num)),
+      m_parent(parent)
+{
+}
+
+void HLSPrefetchWorker::CancelCurrentDownload(void)
+{
+    QMutexLocker locker(&m_downloaderLock);
+    if (m_downloader)
+        m_downloader->Cancel();
+}
+
+void HLSPrefetchWorker::run(void)
+{
+    RunProlog();
+
+    m_downloaderLock.lock();
+    m_downloader = new MythSingleDownload;
+    m_downloaderLock.unlock();
+
+    int64_t sequence = -1;
+    QUrl    url;
+    while (m_parent->NextFetch(this, sequence, url))
+    {
+        QByteArray buffer;
+        auto start = nowAsDuration<std::chrono::milliseconds>();
+        bool ok = m_downloader->DownloadURL(url, &buffer);
+        auto latency = nowAsDuration<std::chrono::milliseconds>() - start;
+
+        QString error;
+        if (!ok)
+        {
+            error = m_downloader->ErrorString();
+
+            // Asking QNetworkAccessManager to redownload after a
+            // failure seems to result in another failure, even if the
+            // segment is now available.  So, create a new instance.
+            m_downloaderLock.lock();
+            delete m_downloader;
+            m_downloader = new MythSingleDownload;
+            m_downloaderLock.unlock();
+        }
+
+        m_parent->FetchDone(this, sequence, ok, buffer, latency, error);
+    }
+
+    m_downloaderLock.lock();
+    delete m_downloader;
+    m_downloader = nullptr;
+    m_downloaderLock.unlock();
+
+    RunEpilog();
+}
+
+HLSSegmentPrefetcher::HLSSegmentPrefetcher(int connections)
+    : m_connections(std::max(connections, 1))
+{
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Prefetching over %1 connections").arg(m_connections));
+
+    for (int i = 0; i < m_connections; ++i)
+    {
+        auto *worker = new HLSPrefetchWorker(this, i);
+        m_workers.push_back(worker);
+        worker->start();
+    }
+}
+
+HLSSegmentPrefetcher::~HLSSegmentPrefetcher(void)
+{
+    m_lock.lock();
+    m_stop = true;
+    m_fetches.clear();
+    m_workCond.wakeAll();
+    m_doneCond.wakeAll();
+    m_lock.unlock();
+
+    for (auto *worker : m_workers)
+    {
+        worker->CancelCurrentDownload();
+        worker->wait();
+        delete worker;
+    }
+    m_workers.clear();
+
+    LOG(VB_RECORD, LOG_INFO, LOC + StatsString());
+}
+
+/**
+ *  \brief Queues downloads for the segments the reader needs next.
+ *
+ *  \p segments are the queued segments in playlist order.  Anything
+ *  before the first of them has been skipped by the reader and is
+ *  dropped.  Downloads are only started while fewer than Connections()
+ *  segments are downloading or waiting to be taken.
+ */
+void HLSSegmentPrefetcher::Prefetch(const QVector<HLSRecSegment>& segments)
+{
+    if (segments.empty())
+        return;
+
+    QMutexLocker locker(&m_lock);
+
+    int64_t first = segments.front().Sequence();
+    while (!m_fetches.empty() && m_fetches.firstKey() < first)
+        Drop(m_fetches.begin());
+
+    for (const auto & segment : segments)
+    {
+        if (m_fetches.size() >= m_connections)
+            break;
+        auto it = m_fetches.find(segment.Sequence());
+        if (it != m_fetches.end() && it->m_url != segment.Url())
+            Drop(it);
+        if (!m_fetches.contains(segment.Sequence()))
+            Enqueue(segment);
+    }
+}
+
+/**
+ *  \brief Waits for \p segment to finish downloading and hands over
+ *         its data.
+ *
+ *  If the segment was never prefetched it is downloaded ahead of
+ *  anything else queued.
+ *
+ *  \return false if the download failed or was canceled.
+ */
+bool HLSSegmentPrefetcher::Take(const HLSRecSegment& segment,
+                                QByteArray& buffer,
+                                std::chrono::milliseconds& latency,
+                                QString& error)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_fetches.find(segment.Sequence());
+    if (it != m_fetches.end() && it->m_url != segment.Url())
+    {
+        Drop(it);
+        it = m_fetches.end();
+    }
+    if (it == m_fetches.end())
+    {
+        Enqueue(segment);
+        it = m_fetches.find(segment.Sequence());
+    }
+
+    while (!m_stop && (it->m_state == kPending || it->m_state == kRunning))
+    {
+        m_doneCond.wait(&m_lock);
+        it = m_fetches.find(segment.Sequence());
+        if (it == m_fetches.end())
+            break;
+    }
+
+    if (m_stop || it == m_fetches.end())
+    {
+        error = "canceled";
+        return false;
+    }
+
+    bool ok  = (it->m_state == kDone);
+    buffer   = it->m_data;
+    latency  = it->m_latency;
+    error    = it->m_error;
+    m_fetches.erase(it);
+
+    // There is room for another prefetch now
+    m_workCond.wakeOne();
+
+    return ok;
+}
+
+/// Aborts all downloads and forgets everything queued.
+void HLSSegmentPrefetcher::Cancel(void)
+{
+    QMutexLocker locker(&m_lock);
+    while (!m_fetches.empty())
+        Drop(m_fetches.begin());
+    m_doneCond.wakeAll();
+}
+
+/**
+ *  \brief Returns the combined download rate, in bits per second,
+ *         since the last call.
+ *
+ *  Only time during which at least one connection was busy counts, so
+ *  idle time spent throttled does not lower the estimate.
+ *  Returns 0 if nothing finished since the last call.
+ */
+uint64_t HLSSegmentPrefetcher::TakeThroughput(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto now  = nowAsDuration<std::chrono::milliseconds>();
+    auto busy = m_busyTime;
+    if (m_running > 0)
+    {
+        busy += now - m_busyStart;
+        m_busyStart = now;
+    }
+
+    uint64_t bytes = m_busyBytes;
+    m_busyTime  = 0ms;
+    m_busyBytes = 0;
+
+    if (bytes == 0 || busy < 1ms)
+        return 0;
+    return bytes * 8 * 1000ULL / busy.count();
+}
+
+HLSSegmentPrefetcher::Stats HLSSegmentPrefetcher::GetStats(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_stats;
+}
+
+QString HLSSegmentPrefetcher::StatsString(void) const
+{
+    Stats stats = GetStats();
+    return QString("%1 segments, %2 failed, latency last %3ms "
+                   "average %4ms max %5ms")
+        .arg(stats.m_segments).arg(stats.m_failures)
+        .arg(stats.m_last.count()).arg(stats.m_average.count())
+        .arg(stats.m_max.count());
+}
+
+/// Hands the lowest queued sequence to \p worker, waiting if there is none.
+bool HLSSegmentPrefetcher::NextFetch(HLSPrefetchWorker* worker,
+                                     int64_t& sequence, QUrl& url)
+{
+    QMutexLocker locker(&m_lock);
+    for (;;)
+    {
+        if (m_stop)
+            return false;
+
+        for (auto it = m_fetches.begin(); it != m_fetches.end(); ++it)
+        {
+            if (it->m_state != kPending)
+                continue;
+
+            it->m_state  = kRunning;
+            it->m_worker = worker;
+            sequence = it.key();
+            url      = it->m_url;
+
+            if (m_running++ == 0)
+                m_busyStart = nowAsDuration<std::chrono::milliseconds>();
+            return true;
+        }
+
+        m_workCond.wait(&m_lock);
+    }
+}
+
+void HLSSegmentPrefetcher::FetchDone(HLSPrefetchWorker* worker,
+                                     int64_t sequence, bool ok,
+                                     const QByteArray& data,
+                                     std::chrono::milliseconds latency,
+                                     const QString& error)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_busyBytes += data.size();
+    if (--m_running == 0)
+        m_busyTime += nowAsDuration<std::chrono::milliseconds>() - m_busyStart;
+
+    // The segment may have been dropped, or dropped and queued again,
+    // while this download was in progress.
+    auto it = m_fetches.find(sequence);
+    if (it == m_fetches.end() || it->m_worker != worker ||
+        it->m_state != kRunning)
+    {
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("Discarding canceled segment %1").arg(sequence));
+        return;
+    }
+
+    it->m_state   = ok ? kDone : kFailed;
+    it->m_data    = data;
+    it->m_error   = error;
+    it->m_latency = latency;
+
+    m_stats.m_segments++;
+    if (!ok)
+        m_stats.m_failures++;
+    m_stats.m_last = latency;
+    m_stats.m_max  = std::max(m_stats.m_max, latency);
+    // Moving average over roughly the last eight segments
+    if (m_stats.m_segments == 1)
+        m_stats.m_average = latency;
+    else
+        m_stats.m_average = (m_stats.m_average * 7 + latency) / 8;
+
+    if (!ok)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC + QString("%1 failed after %2ms: %3")
+            .arg(sequence).arg(latency.count()).arg(error));
+    }
+
+    m_doneCond.wakeAll();
+}
+
+void HLSSegmentPrefetcher::Enqueue(const HLSRecSegment& segment)
+{
+    Fetch fetch;
+    fetch.m_url = segment.Url();
+    m_fetches.insert(segment.Sequence(), fetch);
+    m_workCond.wakeOne();
+}
+
+void HLSSegmentPrefetcher::Drop(QMap<int64_t, Fetch>::iterator it)
+{
+    if (it->m_state == kRunning && it->m_worker)
+        it->m_worker->CancelCurrentDownload();
+    m_fetches.erase(it);
+}
@@ -0,0 +1,116 @@
+#ifndef HLS_SEGMENT_PREFETCHER_H
+#define HLS_SEGMENT_PREFETCHER_H
+
+#include <vector>
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "mthread.h"
+#include "mythchrono.h"
+#include "mythsingledownload.h"
+#include "mythtvexp.h"
+
+#include "HLSSegment.h"
+
+class HLSSegmentPrefetcher;
+
+class HLSPrefetchWorker : public MThread
+{
+  public:
+    HLSPrefetchWorker(HLSSegmentPrefetcher* parent, int num);
+    ~HLSPrefetchWorker(void) override = default;
+
+    void CancelCurrentDownload(void);
+
+  protected:
+    void run() override; // MThread
+
+  private:
+    HLSSegmentPrefetcher *m_parent     {nullptr};
+    MythSingleDownload   *m_downloader {nullptr};
+    QMutex                m_downloaderLock;
+};
+
+/**
+ *  \brief Downloads upcoming HLS segments over several connections.
+ *
+ *  The segment worker hands over the segments it is about to need with
+ *  Prefetch(), and collects them in playlist order with Take().  At
+ *  most the configured number of segments are downloading or waiting
+ *  to be taken at any time, so a single slow segment no longer holds
+ *  up the ones behind it.
+ */
+class MTV_PUBLIC HLSSegmentPrefetcher
+{
+    friend class HLSPrefetchWorker;
+
+  public:
+    struct Stats
+    {
+        uint64_t                  m_segments {0};
+        uint64_t                  m_failures {0};
+        std::chrono::milliseconds m_last     {0ms};
+        std::chrono::milliseconds m_average  {0ms};
+        std::chrono::milliseconds m_max      {0ms};
+    };
+
+    explicit HLSSegmentPrefetcher(int connections);
+    ~HLSSegmentPrefetcher(void);
+
+    int  Connections(void) const { return m_connections; }
+
+    void Prefetch(const QVector<HLSRecSegment>& segments);
+    bool Take(const HLSRecSegment& segment, QByteArray& buffer,
+              std::chrono::milliseconds& latency, QString& error);
+    void Cancel(void);
+
+    uint64_t TakeThroughput(void);
+    Stats    GetStats(void) const;
+    QString  StatsString(void) const;
+
+  private:
+    enum FetchState : std::uint8_t { kPending, kRunning, kDone, kFailed };
+
+    struct Fetch
+    {
+        QUrl                      m_url;
+        FetchState                m_state   {kPending};
+        HLSPrefetchWorker        *m_worker  {nullptr};
+        QByteArray                m_data;
+        QString                   m_error;
+        std::chrono::milliseconds m_latency {0ms};
+    };
+
+    bool NextFetch(HLSPrefetchWorker* worker, int64_t& sequence, QUrl& url);
+    void FetchDone(HLSPrefetchWorker* worker, int64_t sequence, bool ok,
+                   const QByteArray& data, std::chrono::milliseconds latency,
+                   const QString& error);
+    void Enqueue(const HLSRecSegment& segment);
+    void Drop(QMap<int64_t, Fetch>::iterator it);
+
+    int                             m_connections {1};
+    bool                            m_stop        {false};
+    std::vector<HLSPrefetchWorker*> m_workers;
+
+    mutable QMutex                  m_lock;
+    QWaitCondition                  m_workCond;
+    QWaitCondition                  m_doneCond;
+    /// Reassembly buffer, keyed by media sequence number
+    QMap<int64_t, Fetch>            m_fetches;
+
+    // Throughput across all connections while any are busy
+    int                             m_running     {0};
+    std::chrono::milliseconds       m_busyStart   {0ms};
+    std::chrono::milliseconds       m_busyTime    {0ms};
+    uint64_t                        m_busyBytes   {0};
+
+    Stats                           m_stats;
+};
+
+#endif // HLS_SEGMENT_PREFETCHER_H
@@ -908,8 +908,7 @@ void NuppelVideoRecorder::run(void)
     StreamAllocate();
 
     m_positionMapLock.lock();
-    m_positionMap.clear();
-    m_positionMapDelta.clear();
+    ClearPositionMap();
     m_positionMapLock.unlock();
 
     m_useAvCodec = (m_videocodec.toLower() != "rtjpeg");
@@ -2101,12 +2100,8 @@ void NuppelVideoRecorder::UpdateSeekTable(int frame_num, long offset)
     m_seekTable->push_back(ste);
 
     m_positionMapLock.lock();
-    if (!m_positionMap.contains(ste.keyframe_number))
-    {
-        m_positionMapDelta[ste.keyframe_number] = position;
-        m_positionMap[ste.keyframe_number] = position;
+    if (AddPositionMapEntry(ste.keyframe_number, position))
         m_lastPositionMapPos = position;
-    }
     m_positionMapLock.unlock();
 }
 
@@ -2623,8 +2618,7 @@ void NuppelVideoRecorder::ResetForNewFile(void)
     ClearStatistics();
 
     m_positionMapLock.lock();
-    m_positionMap.clear();
-    m_positionMapDelta.clear();
+    ClearPositionMap();
     m_positionMapLock.unlock();
 
     if (m_go7007)
@@ -2645,8 +2639,7 @@ void NuppelVideoRecorder::FinishRecording(void)
     V4LRecorder::FinishRecording();
     
     m_positionMapLock.lock();
-    m_positionMap.clear();
-    m_positionMapDelta.clear();
+    ClearPositionMap();
     m_positionMapLock.unlock();
 }
 
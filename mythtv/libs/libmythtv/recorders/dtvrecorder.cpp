@@ -30,6 +30,7 @@
 #include "mythsystemevent.h"
 
 #include "AVCParser.h"
+#include "bytereader.h"
 #include "HEVCParser.h"
 
 #define LOC ((m_tvrec) ? \
@@ -165,10 +166,7 @@ void DTVRecorder::ResetForNewFile(void)
 
     //m_pes_synced
     //m_seen_sps
-    m_positionMap.clear();
-    m_positionMapDelta.clear();
-    m_durationMap.clear();
-    m_durationMapDelta.clear();
+    ClearPositionMap();
 
     m_primaryVideoCodec = AV_CODEC_ID_NONE;
     m_primaryAudioCodec = AV_CODEC_ID_NONE;
@@ -437,7 +435,7 @@ bool DTVRecorder::FindMPEG2Keyframes(const TSPacket* tspacket)
 
     while (bufptr < bufend)
     {
-        bufptr = avpriv_find_start_code(bufptr, bufend, &m_startCode);
+        bufptr = ByteReader::FindStartCode(bufptr, bufend, &m_startCode);
         int bytes_left = bufend - bufptr;
         if ((m_startCode & 0xffffff00) == 0x00000100)
         {
@@ -800,21 +798,13 @@ void DTVRecorder::HandleKeyframe(int64_t extra)
 
     // Add key frame to position map
     m_positionMapLock.lock();
-    if (!m_positionMap.contains(frameNum))
-    {
-        int64_t startpos = m_ringBuffer->GetWritePosition() + extra;
+    int64_t startpos = m_ringBuffer->GetWritePosition() + extra;
 
-        // Don't put negative offsets into the database, they get munged into
-        // MAX_INT64 - offset, which is an exceedingly large number, and
-        // certainly not valid.
-        if (startpos >= 0)
-        {
-            m_positionMapDelta[frameNum] = startpos;
-            m_positionMap[frameNum]      = startpos;
-            m_durationMap[frameNum]      = llround(m_totalDuration);
-            m_durationMapDelta[frameNum] = llround(m_totalDuration);
-        }
-    }
+    // Don't put negative offsets into the database, they get munged into
+    // MAX_INT64 - offset, which is an exceedingly large number, and
+    // certainly not valid.
+    if (startpos >= 0)
+        AddPositionMapEntry(frameNum, startpos, llround(m_totalDuration));
     m_positionMapLock.unlock();
 }
 
@@ -1054,13 +1044,7 @@ void DTVRecorder::HandleH2645Keyframe(void)
 
     // Add key frame to position map
     m_positionMapLock.lock();
-    if (!m_positionMap.contains(frameNum))
-    {
-        m_positionMapDelta[frameNum] = startpos;
-        m_positionMap[frameNum]      = startpos;
-        m_durationMap[frameNum]      = llround(m_totalDuration);
-        m_durationMapDelta[frameNum] = llround(m_totalDuration);
-    }
+    AddPositionMapEntry(frameNum, startpos, llround(m_totalDuration));
     m_positionMapLock.unlock();
 }
 
@@ -1085,7 +1069,7 @@ void DTVRecorder::FindPSKeyFrames(const uint8_t *buffer, uint len)
 
         const uint8_t *tmp = bufptr;
         bufptr =
-            avpriv_find_start_code(bufptr + skip, bufend, &m_startCode);
+            ByteReader::FindStartCode(bufptr + skip, bufend, &m_startCode);
         m_audioBytesRemaining = 0;
         m_otherBytesRemaining = 0;
         m_videoBytesRemaining -= std::min(
@@ -170,8 +170,7 @@ void HDHRStreamHandler::run(void)
             continue;
         }
 
-        for (auto sit = m_streamDataList.cbegin(); sit != m_streamDataList.cend(); ++sit)
-            remainder = sit.key()->ProcessData(data_buffer, data_length);
+        remainder = ProcessStreamData(data_buffer, data_length);
 
         WriteMPTS(data_buffer, data_length - remainder);
 
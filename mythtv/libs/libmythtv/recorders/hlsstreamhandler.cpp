@@ -10,6 +10,7 @@
 
 // MythTV headers
 #include "hlsstreamhandler.h"
+#include "mythcorecontext.h"
 #include "mythlogging.h"
 #include "recorders/HLS/HLSReader.h"
 
@@ -102,6 +103,8 @@ HLSStreamHandler::HLSStreamHandler(const IPTVTuningData& tuning, int inputid)
 {
     LOG(VB_GENERAL, LOG_INFO, LOC + "ctor");
     m_hls        = new HLSReader();
+    m_hls->SetPrefetchCount(gCoreContext->GetNumSetting(
+        "HLSPrefetchSegments", HLSReader::kDefaultPrefetchCount));
     m_readbuffer = new uint8_t[BUFFER_SIZE];
 }
 
@@ -187,8 +190,7 @@ void HLSStreamHandler::run(void)
 
         {
             QMutexLocker locker(&m_listenerLock);
-            for (auto sit = m_streamDataList.cbegin(); sit != m_streamDataList.cend(); ++sit)
-                remainder = sit.key()->ProcessData(m_readbuffer, size);
+            remainder = ProcessStreamData(m_readbuffer, size);
         }
 
         if (remainder > 0)
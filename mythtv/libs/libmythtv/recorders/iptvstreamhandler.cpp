@@ -25,6 +25,9 @@
 #include "rtcpdatapacket.h"
 #include "mythlogging.h"
 #include "cetonrtsp.h"
+#ifdef USING_RECVMMSG
+#include "udpbatchreader.h"
+#endif
 
 #define LOC QString("IPTVSH[%1](%2): ").arg(m_inputId).arg(m_device)
 
@@ -217,7 +220,9 @@ void IPTVStreamHandler::run(void)
             // the requested server
             m_sender[i] = dest_addr;
         }
+#ifndef USING_RECVMMSG
         m_readHelpers[i] = new IPTVStreamHandlerReadHelper(this,m_sockets[i],i);
+#endif
 
         // we need to open the descriptor ourselves so we
         // can set some socket options
@@ -279,6 +284,21 @@ void IPTVStreamHandler::run(void)
             m_buffer = new UDPPacketBuffer(tuning.GetBitrate(0));
         m_writeHelper = new IPTVStreamHandlerWriteHelper(this);
         m_writeHelper->Start();
+
+#ifdef USING_RECVMMSG
+        // Receive on dedicated threads, in batches, outside the event loop.
+        // Nothing reads through the QUdpSockets, so after the first
+        // readyRead Qt stops polling them.
+        for (uint i = 0; i < IPTV_SOCKET_COUNT; i++)
+        {
+            if (!m_sockets[i] || m_sockets[i]->socketDescriptor() < 0)
+                continue;
+            m_batchReaders[i] = new UDPBatchReader(
+                QString("IPTVRead%1").arg(i), m_sockets[i]->socketDescriptor(),
+                m_buffer, m_bufferLock, i, m_sender[i]);
+            m_batchReaders[i]->start();
+        }
+#endif
     }
 
     if (!error && rtsp)
@@ -306,6 +326,13 @@ void IPTVStreamHandler::run(void)
     }
 
     // Clean up
+#ifdef USING_RECVMMSG
+    for (auto & reader : m_batchReaders)
+    {
+        delete reader;
+        reader = nullptr;
+    }
+#endif
     for (uint i = 0; i < IPTV_SOCKET_COUNT; i++)
     {
         if (m_sockets[i])
@@ -347,6 +374,7 @@ void IPTVStreamHandlerReadHelper::ReadPending(void)
     QHostAddress sender;
     quint16 senderPort = 0;
     bool sender_null = m_sender.isNull();
+    QMutexLocker locker(&m_parent->m_bufferLock);
 
     if (0 == m_stream)
     {
@@ -419,12 +447,16 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
         return;
     }
 
+    QMutexLocker bufferLocker(&m_parent->m_bufferLock);
     if (!m_parent->m_buffer->HasAvailablePacket())
         return;
+    bufferLocker.unlock();
 
     while (!m_parent->m_useRtpStreaming)
     {
+        bufferLocker.relock();
         UDPPacket packet(m_parent->m_buffer->PopDataPacket());
+        bufferLocker.unlock();
 
         if (packet.GetDataReference().isEmpty())
             break;
@@ -433,13 +465,9 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
         {
             QMutexLocker locker(&m_parent->m_listenerLock);
             QByteArray &data = packet.GetDataReference();
-            for (auto sit = m_parent->m_streamDataList.cbegin();
-                 sit != m_parent->m_streamDataList.cend(); ++sit)
-            {
-                remainder = sit.key()->ProcessData(
-                    reinterpret_cast<const unsigned char*>(data.data()),
-                    data.size());
-            }
+            remainder = m_parent->ProcessStreamData(
+                reinterpret_cast<const unsigned char*>(data.data()),
+                data.size());
         }
 
         if (remainder != 0)
@@ -449,12 +477,15 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
                 .arg(packet.GetDataReference().size()).arg(remainder));
         }
 
+        QMutexLocker locker(&m_parent->m_bufferLock);
         m_parent->m_buffer->FreePacket(packet);
     }
 
     while (m_parent->m_useRtpStreaming)
     {
+        bufferLocker.relock();
         RTPDataPacket packet(m_parent->m_buffer->PopDataPacket());
+        bufferLocker.unlock();
 
         if (!packet.IsValid())
             break;
@@ -465,6 +496,7 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
 
             if (!ts_packet.IsValid())
             {
+                QMutexLocker locker(&m_parent->m_bufferLock);
                 m_parent->m_buffer->FreePacket(packet);
                 continue;
             }
@@ -491,13 +523,8 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
 
             m_parent->m_listenerLock.lock();
 
-            int remainder = 0;
-            for (auto sit = m_parent->m_streamDataList.cbegin();
-                 sit != m_parent->m_streamDataList.cend(); ++sit)
-            {
-                remainder = sit.key()->ProcessData(
-                    ts_packet.GetTSData(), ts_packet.GetTSDataSize());
-            }
+            int remainder = m_parent->ProcessStreamData(
+                ts_packet.GetTSData(), ts_packet.GetTSDataSize());
 
             m_parent->m_listenerLock.unlock();
 
@@ -508,6 +535,7 @@ void IPTVStreamHandlerWriteHelper::timerEvent(QTimerEvent* event)
                     .arg(ts_packet.GetTSDataSize()).arg(remainder));
             }
         }
+        QMutexLocker locker(&m_parent->m_bufferLock);
         m_parent->m_buffer->FreePacket(packet);
     }
 }
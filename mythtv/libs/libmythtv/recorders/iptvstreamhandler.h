@@ -25,6 +25,7 @@ class DTVSignalMonitor;
 class MPEGStreamData;
 class PacketBuffer;
 class IPTVChannel;
+class UDPBatchReader;
 
 class IPTVStreamHandlerReadHelper : public QObject
 {
@@ -106,6 +107,11 @@ class IPTVStreamHandler : public StreamHandler
     std::array<QHostAddress,IPTV_SOCKET_COUNT>                 m_sender;
     IPTVStreamHandlerWriteHelper *m_writeHelper       {nullptr};
     PacketBuffer                 *m_buffer            {nullptr};
+    /// Held for all m_buffer access, it is filled from the batch readers
+    QMutex                        m_bufferLock;
+#ifdef USING_RECVMMSG
+    std::array<UDPBatchReader*,IPTV_SOCKET_COUNT>              m_batchReaders {};
+#endif
 
     bool                          m_useRtpStreaming;
     ushort                        m_rtspRtpPort       {0};
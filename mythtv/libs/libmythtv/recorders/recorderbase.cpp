@@ -483,6 +483,11 @@ void RecorderBase::FinishRecording(void)
 
         SavePositionMap(true, true); // Save Position Map only, not file size
 
+        // The DB is authoritative once the recording is finished
+        m_positionMapLock.lock();
+        m_keyframeIndex.CloseSidecar();
+        m_positionMapLock.unlock();
+
         if (m_ringBuffer)
             m_curRecording->SaveFilesize(m_ringBuffer->GetRealFileSize());
     }
@@ -518,20 +523,19 @@ RecordingQuality *RecorderBase::GetRecordingQuality(
 long long RecorderBase::GetKeyframePosition(long long desired) const
 {
     QMutexLocker locker(&m_positionMapLock);
-    long long ret = -1;
 
-    if (m_positionMap.empty())
-        return ret;
+    if (m_keyframeIndex.empty())
+        return -1;
 
     // find closest exact or previous keyframe position...
-    frm_pos_map_t::const_iterator it = m_positionMap.lowerBound(desired);
-    if (it == m_positionMap.end())
-        ret = *m_positionMap.begin();
-    else if ((it.key() == desired) ||
-             (--it != m_positionMap.end()))
-        ret = *it;
-
-    return ret;
+    size_t i = m_keyframeIndex.LowerBound(desired);
+    if (i == m_keyframeIndex.size())
+        return m_keyframeIndex.front().m_offset;
+    if (m_keyframeIndex[i].m_frame == desired)
+        return m_keyframeIndex[i].m_offset;
+    if (i > 0)
+        return m_keyframeIndex[i - 1].m_offset;
+    return -1;
 }
 
 bool RecorderBase::GetKeyframePositions(
@@ -540,18 +544,19 @@ bool RecorderBase::GetKeyframePositions(
     map.clear();
 
     QMutexLocker locker(&m_positionMapLock);
-    if (m_positionMap.empty())
+    if (m_keyframeIndex.empty())
         return true;
 
-    frm_pos_map_t::const_iterator it = m_positionMap.lowerBound(start);
     end = (end < 0) ? INT64_MAX : end;
-    for (; (it != m_positionMap.end()) &&
-             (it.key() <= end); ++it)
-        map[it.key()] = *it;
+    for (size_t i = m_keyframeIndex.LowerBound(start);
+         i < m_keyframeIndex.size() && m_keyframeIndex[i].m_frame <= end; ++i)
+    {
+        map[m_keyframeIndex[i].m_frame] = m_keyframeIndex[i].m_offset;
+    }
 
     LOG(VB_GENERAL, LOG_DEBUG, LOC +
         QString("GetKeyframePositions(%1,%2,#%3) out of %4")
-            .arg(start).arg(end).arg(map.size()).arg(m_positionMap.size()));
+            .arg(start).arg(end).arg(map.size()).arg(m_keyframeIndex.size()));
 
     return true;
 }
@@ -562,22 +567,50 @@ bool RecorderBase::GetKeyframeDurations(
     map.clear();
 
     QMutexLocker locker(&m_positionMapLock);
-    if (m_durationMap.empty())
+    if (m_keyframeIndex.empty())
         return true;
 
-    frm_pos_map_t::const_iterator it = m_durationMap.lowerBound(start);
     end = (end < 0) ? INT64_MAX : end;
-    for (; (it != m_durationMap.end()) &&
-             (it.key() <= end); ++it)
-        map[it.key()] = *it;
+    for (size_t i = m_keyframeIndex.LowerBound(start);
+         i < m_keyframeIndex.size() && m_keyframeIndex[i].m_frame <= end; ++i)
+    {
+        if (m_keyframeIndex[i].m_duration >= 0)
+            map[m_keyframeIndex[i].m_frame] = m_keyframeIndex[i].m_duration;
+    }
 
     LOG(VB_GENERAL, LOG_DEBUG, LOC +
         QString("GetKeyframeDurations(%1,%2,#%3) out of %4")
-            .arg(start).arg(end).arg(map.size()).arg(m_durationMap.size()));
+            .arg(start).arg(end).arg(map.size()).arg(m_keyframeIndex.size()));
 
     return true;
 }
 
+bool RecorderBase::AddPositionMapEntry(int64_t frame, int64_t offset,
+                                       int64_t duration)
+{
+    // Mirror the index next to the recording so players following it
+    // can read keyframes straight from disk instead of recordedseek.
+    if (!m_keyframeSidecarTried && m_curRecording && m_ringBuffer)
+    {
+        m_keyframeSidecarTried = true;
+        QString filename = m_ringBuffer->GetFilename();
+        if (!filename.isEmpty() && !filename.contains("://"))
+        {
+            m_keyframeIndex.OpenSidecar(
+                KeyframeIndex::SidecarFilename(filename), m_positionMapType);
+        }
+    }
+
+    return m_keyframeIndex.Append(frame, offset, duration);
+}
+
+void RecorderBase::ClearPositionMap(void)
+{
+    m_keyframeIndex.Clear();
+    m_keyframeIndexSaved   = 0;
+    m_keyframeSidecarTried = false;
+}
+
 /**
  *  \brief This saves the postition map delta to the database if force
  *         is true or there are 30 frames in the map or there are five
@@ -591,38 +624,43 @@ void RecorderBase::SavePositionMap(bool force, bool finished)
     bool needToSave = force;
     m_positionMapLock.lock();
 
-    bool has_delta = !m_positionMapDelta.empty();
+    bool has_delta = m_keyframeIndex.size() > m_keyframeIndexSaved;
     // set pm_elapsed to a fake large value if the timer hasn't yet started
     std::chrono::milliseconds pm_elapsed = (m_positionMapTimer.isRunning()) ?
         m_positionMapTimer.elapsed() : std::chrono::milliseconds::max();
     // save on every 1.5 seconds if in the first few frames of a recording
-    needToSave |= (m_positionMap.size() < 30) &&
+    needToSave |= (m_keyframeIndex.size() < 30) &&
         has_delta && (pm_elapsed >= 1.5s);
     // save every 10 seconds later on
     needToSave |= has_delta && (pm_elapsed >= 10s);
-    // Assume that m_durationMapDelta is the same size as
-    // m_positionMapDelta and implicitly use the same logic about when
-    // to same m_durationMapDelta.
 
     if (m_curRecording && needToSave)
     {
         m_positionMapTimer.start();
         if (has_delta)
         {
-            // copy the delta map because most times we are called it will be in
-            // another thread and we don't want to lock the main recorder thread
-            // which is populating the delta map
-            frm_pos_map_t deltaCopy(m_positionMapDelta);
-            m_positionMapDelta.clear();
-            frm_pos_map_t durationDeltaCopy(m_durationMapDelta);
-            m_durationMapDelta.clear();
+            // copy the unsaved entries because most times we are called it
+            // will be in another thread and we don't want to lock the main
+            // recorder thread which is appending to the index
+            frm_pos_map_t deltaCopy;
+            frm_pos_map_t durationDeltaCopy;
+            for (size_t i = m_keyframeIndexSaved; i < m_keyframeIndex.size(); ++i)
+            {
+                const KeyframeIndex::Entry &entry = m_keyframeIndex[i];
+                deltaCopy[entry.m_frame] = entry.m_offset;
+                if (entry.m_duration >= 0)
+                    durationDeltaCopy[entry.m_frame] = entry.m_duration;
+            }
+            m_keyframeIndexSaved = m_keyframeIndex.size();
             m_positionMapLock.unlock();
 
             m_curRecording->SavePositionMapDelta(deltaCopy, m_positionMapType);
-            m_curRecording->SavePositionMapDelta(durationDeltaCopy,
-                                               MARK_DURATION_MS);
-
-            TryWriteProgStartMark(durationDeltaCopy);
+            if (!durationDeltaCopy.empty())
+            {
+                m_curRecording->SavePositionMapDelta(durationDeltaCopy,
+                                                     MARK_DURATION_MS);
+                TryWriteProgStartMark(durationDeltaCopy);
+            }
         }
         else
         {
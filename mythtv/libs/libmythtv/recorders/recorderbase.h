@@ -14,6 +14,7 @@
 
 #include "recordingquality.h"
 #include "programtypes.h" // for MarkTypes, frm_pos_map_t
+#include "keyframeindex.h"
 #include "mythtimer.h"
 #include "mythtvexp.h"
 #include "recordingfile.h"
@@ -311,6 +312,17 @@ class MTV_PUBLIC RecorderBase : public QRunnable
 
     void TryWriteProgStartMark(const frm_pos_map_t &durationDeltaCopy);
 
+    /** \brief Adds a keyframe to the position map.
+     *
+     *  Must be called with m_positionMapLock held.
+     *  \param duration time to the keyframe in ms, or -1 if not known.
+     *  \return false if the frame was already in the map.
+     */
+    bool AddPositionMapEntry(int64_t frame, int64_t offset,
+                             int64_t duration = -1);
+    /// Must be called with m_positionMapLock held.
+    void ClearPositionMap(void);
+
     TVRec         *m_tvrec                {nullptr};
     MythMediaBuffer *m_ringBuffer         {nullptr};
     bool           m_weMadeBuffer         {true};
@@ -355,10 +367,10 @@ class MTV_PUBLIC RecorderBase : public QRunnable
     // Seektable  support
     MarkTypes      m_positionMapType      {MARK_GOP_BYFRAME};
     mutable QMutex m_positionMapLock;
-    frm_pos_map_t  m_positionMap;
-    frm_pos_map_t  m_positionMapDelta;
-    frm_pos_map_t  m_durationMap;
-    frm_pos_map_t  m_durationMapDelta;
+    KeyframeIndex  m_keyframeIndex;
+    /// Number of m_keyframeIndex entries already saved to the DB
+    size_t         m_keyframeIndexSaved   {0};
+    bool           m_keyframeSidecarTried {false};
     MythTimer      m_positionMapTimer;
 
     // ProgStart mark support
@@ -21,41 +21,97 @@ PacketBuffer::PacketBuffer(unsigned int bitrate) :
             (MythRandom() << 24) ^ (MythRandom() << 16) ^
             (MythRandom() << 8) ^ MythRandom();
     }
+    m_first_packet_key = m_next_empty_packet_key;
+
+    m_empty_packets.reserve(kMaxPoolSize);
+    m_in_pool.reserve(kMaxPoolSize);
+    for (uint i = 0; i < kInitialPoolSize; i++)
+    {
+        m_empty_packets.push_back(NewPacket());
+        m_in_pool[i] = true;
+    }
+
+    m_available_packets.resize(kInitialPoolSize);
+}
+
+UDPPacket PacketBuffer::NewPacket(void)
+{
+    UDPPacket packet(m_next_empty_packet_key++);
+    packet.GetDataReference().reserve(kPacketCapacity);
+    m_in_pool.push_back(false);
+    return packet;
 }
 
 bool PacketBuffer::HasAvailablePacket(void) const
 {
-    return !m_available_packets.empty();
+    return m_available_count > 0;
 }
 
 UDPPacket PacketBuffer::PopDataPacket(void)
 {
-    if (m_available_packets.empty())
+    if (!m_available_count)
         return UDPPacket(0);
 
-    UDPPacket packet(m_available_packets.front());
-    m_available_packets.pop_front();
+    // Clear the slot so the ring does not hold a second reference
+    // to the data, which would force a copy when the packet is reused.
+    UDPPacket &slot = m_available_packets[m_available_head];
+    UDPPacket packet(slot);
+    slot = UDPPacket();
+
+    m_available_head = (m_available_head + 1) & (m_available_packets.size() - 1);
+    m_available_count--;
 
     return packet;
 }
 
+void PacketBuffer::PushAvailablePacket(const UDPPacket &packet)
+{
+    size_t size = m_available_packets.size();
+    if (m_available_count == size)
+    {
+        // Consumer has fallen behind, double the ring and unwrap it.
+        std::vector<UDPPacket> ring(size * 2);
+        for (size_t i = 0; i < m_available_count; i++)
+        {
+            UDPPacket &slot = m_available_packets[(m_available_head + i) & (size - 1)];
+            ring[i] = slot;
+            slot = UDPPacket();
+        }
+        m_available_packets.swap(ring);
+        m_available_head = 0;
+        size *= 2;
+    }
+
+    m_available_packets[(m_available_head + m_available_count) & (size - 1)] = packet;
+    m_available_count++;
+}
+
 UDPPacket PacketBuffer::GetEmptyPacket(void)
 {
-    QMap<uint64_t, UDPPacket>::iterator it = m_empty_packets.begin();
-    if (it == m_empty_packets.end())
+    if (m_empty_packets.empty())
     {
-        return UDPPacket(m_next_empty_packet_key++);
+        m_poolMisses++;
+        return NewPacket();
     }
 
-    UDPPacket packet(*it);
-    m_empty_packets.erase(it);
+    UDPPacket packet(m_empty_packets.back());
+    m_empty_packets.pop_back();
+    m_in_pool[packet.GetKey() - m_first_packet_key] = false;
 
     return packet;
 }
 
 void PacketBuffer::FreePacket(const UDPPacket &packet)
 {
-    uint64_t top = packet.GetKey() & (0xFFFFFFFFULL<<32);
-    if (top == (m_next_empty_packet_key & (0xFFFFFFFFULL<<32)))
-        m_empty_packets[packet.GetKey()] = packet;
+    // Ignore packets from other buffers and packets freed twice,
+    // handing out the same QByteArray twice would corrupt both.
+    uint64_t index = packet.GetKey() - m_first_packet_key;
+    if (index >= m_in_pool.size() || m_in_pool[index])
+        return;
+
+    if (m_empty_packets.size() < kMaxPoolSize)
+    {
+        m_empty_packets.push_back(packet);
+        m_in_pool[index] = true;
+    }
 }
@@ -7,11 +7,22 @@
 #ifndef PACKET_BUFFER_H
 #define PACKET_BUFFER_H
 
-#include <QList>
-#include <QMap>
+#include <vector>
 
 #include "udppacket.h"
 
+/** \brief Base class for the UDP and RTP receive buffers.
+ *
+ *  Packets handed out by GetEmptyPacket() come from a fixed capacity
+ *  pool whose QByteArrays are allocated once, up front, with room for
+ *  kPacketCapacity bytes. As long as the consumers call FreePacket()
+ *  on every packet they are done with, and no datagram is larger than
+ *  kPacketCapacity, the steady state receive path does not touch the
+ *  heap at all.
+ *
+ *  Ordered packets waiting for the consumer are kept in a ring, which
+ *  only grows if the consumer falls far behind.
+ */
 class PacketBuffer
 {
   public:
@@ -40,17 +51,44 @@ class PacketBuffer
      */
     void FreePacket(const UDPPacket &packet);
 
+    /// Number of packets allocated after the initial pool ran dry.
+    uint64_t GetPoolMissCount(void) const { return m_poolMisses; }
+
+    /// Bytes reserved in each pooled packet's QByteArray
+    static constexpr int      kPacketCapacity { 2048 };
+    /// Packets allocated when the buffer is created
+    static constexpr uint     kInitialPoolSize { 512 };
+    /// Most packets kept for reuse, anything freed beyond this is released
+    static constexpr uint     kMaxPoolSize { 4096 };
+
   protected:
+    /// Appends a packet to the ordered list handed to the consumer.
+    void PushAvailablePacket(const UDPPacket &packet);
+
+    /// Allocates a new pooled packet with a pre-reserved QByteArray.
+    UDPPacket NewPacket(void);
+
     uint m_bitrate;
 
     /// Packets key to use for next empty packet
     uint64_t m_next_empty_packet_key;
-    
-    /// Packets ready for reuse
-    QMap<uint64_t, UDPPacket> m_empty_packets;
 
-    /// Ordered list of available packets
-    QList<UDPPacket> m_available_packets;
+    /// Packets ready for reuse, used as a stack so recently used
+    /// (and cache warm) packets are handed out first.
+    std::vector<UDPPacket> m_empty_packets;
+
+    /// Ordered ring of available packets, size is always a power of two
+    std::vector<UDPPacket> m_available_packets;
+    size_t m_available_head  { 0 };
+    size_t m_available_count { 0 };
+
+    /// Key of the first packet allocated by this buffer
+    uint64_t m_first_packet_key { 0ULL };
+    /// Which of our packets are currently in m_empty_packets,
+    /// indexed by key - m_first_packet_key
+    std::vector<bool> m_in_pool;
+
+    uint64_t m_poolMisses { 0 };
 };
 
 #endif // PACKET_BUFFER_H
@@ -4,69 +4,145 @@
  * Distributed as part of MythTV under GPL v2 and later.
  */
 
-#include <algorithm>
-
 #include "rtppacketbuffer.h"
 #include "rtpdatapacket.h"
 #include "rtpfecpacket.h"
 
+static_assert((RTPPacketBuffer::kWindowSize & (RTPPacketBuffer::kWindowSize - 1)) == 0,
+              "RTPPacketBuffer::kWindowSize must be a power of two");
+
+static constexpr uint64_t kWindowMask { RTPPacketBuffer::kWindowSize - 1 };
+
+RTPPacketBuffer::RTPPacketBuffer(unsigned int bitrate) :
+    PacketBuffer(bitrate),
+    m_window(kWindowSize),
+    m_windowUsed(kWindowSize, false)
+{
+}
+
 void RTPPacketBuffer::PushDataPacket(const UDPPacket &udp_packet)
 {
     RTPDataPacket packet(udp_packet);
+    if (!packet.IsValid())
+    {
+        FreePacket(udp_packet);
+        return;
+    }
 
-    uint key = packet.GetSequenceNumber();
+    auto seq = static_cast<uint16_t>(packet.GetSequenceNumber());
 
-    bool large_was_seen_recently = m_largeSequenceNumberSeenRecently > 0;
-    m_largeSequenceNumberSeenRecently = 
-        (key > (1U<<15)) ? 500 : m_largeSequenceNumberSeenRecently - 1;
-    m_largeSequenceNumberSeenRecently =
-        std::max(m_largeSequenceNumberSeenRecently, 0);
+    if (!m_haveSequence)
+    {
+        // Start one cycle in so the extended number never goes negative
+        m_haveSequence    = true;
+        m_nextSequence    = (1ULL<<16) + seq;
+        m_highestSequence = m_nextSequence;
+    }
 
-    if (m_largeSequenceNumberSeenRecently > 0)
+    // Extend the 16 bit sequence number to the value closest to the
+    // highest one seen so far, as in RFC 3550 Appendix A.1.
+    auto delta = static_cast<int16_t>(
+        seq - static_cast<uint16_t>(m_highestSequence));
+    uint64_t key = m_highestSequence + delta;
+
+    if (key < m_nextSequence)
     {
-        if (key < 500) 
-            key += 1ULL<<16;
+        // A packet far behind the window followed by its successor
+        // means the sender has restarted with a new sequence number.
+        if ((m_nextSequence - key > kWindowSize) && (seq == m_resyncSequence))
+        {
+            FlushWindow();
+            key = (((m_highestSequence >> 16) + 1) << 16) | seq;
+            m_nextSequence    = key;
+            m_highestSequence = key;
+        }
+        else
+        {
+            m_resyncSequence = (seq + 1) & 0xFFFF;
+            m_latePackets++;
+            FreePacket(udp_packet);
+            return;
+        }
     }
-    else if (large_was_seen_recently)
+    m_resyncSequence = -1;
+
+    if (key - m_nextSequence >= 2ULL * kWindowSize)
     {
-        m_currentSequence += 1ULL<<16;
+        // Large jump forward, don't count the gap as lost packets
+        FlushWindow();
+        m_nextSequence = key;
     }
+    while (key - m_nextSequence >= kWindowSize)
+        ReleaseSlot();
 
-    key += m_currentSequence;
+    uint64_t slot = key & kWindowMask;
+    if (m_windowUsed[slot])
+    {
+        m_latePackets++;
+        FreePacket(udp_packet);
+        return;
+    }
 
-/*
-    LOG(VB_RECORD, LOG_DEBUG, QString("Pushing %1 as %2 (lr %3)")
-        .arg(packet.GetSequenceNumber()).arg(key)
-        .arg(m_largeSequenceNumberSeenRecently));
-*/
+    m_window[slot]     = udp_packet;
+    m_windowUsed[slot] = true;
+    m_pendingCount++;
+    if (key > m_highestSequence)
+        m_highestSequence = key;
 
-    m_unorderedPackets[key] = packet;
+    ReleasePackets();
+}
 
-    // TODO pushing packets onto the ordered list should be based on
-    // the bitrate and the M+N of the FEC.. but for now...
-    const int kHighWaterMark = 500;
-    const int kLowWaterMark  = 100;
-    if (m_unorderedPackets.size() > kHighWaterMark)
+/// Hands contiguous packets to the consumer, skipping over
+/// holes which have been waited on long enough.
+void RTPPacketBuffer::ReleasePackets(void)
+{
+    while (m_pendingCount)
     {
-        while (m_unorderedPackets.size() > kLowWaterMark)
+        if (!m_windowUsed[m_nextSequence & kWindowMask])
         {
-            QMap<uint64_t, RTPDataPacket>::iterator it =
-                m_unorderedPackets.begin();
-/*
-            LOG(VB_RECORD, LOG_DEBUG, QString("Popping %1 as %2")
-                .arg((*it).GetSequenceNumber()).arg(it.key()));
-*/
-            m_available_packets.push_back(*it);
-            m_unorderedPackets.erase(it);
+            if (m_highestSequence - m_nextSequence < kMaxHoleWait)
+                break;
+            // Give up on the whole run of missing packets
+            while (!m_windowUsed[m_nextSequence & kWindowMask])
+                ReleaseSlot();
         }
+        ReleaseSlot();
     }
 }
 
+/// Releases the packet at the head of the window, if any, and
+/// advances the head.
+void RTPPacketBuffer::ReleaseSlot(void)
+{
+    uint64_t slot = m_nextSequence & kWindowMask;
+    if (m_windowUsed[slot])
+    {
+        PushAvailablePacket(m_window[slot]);
+        m_window[slot]     = UDPPacket();
+        m_windowUsed[slot] = false;
+        m_pendingCount--;
+    }
+    else
+    {
+        m_lostPackets++;
+    }
+    m_nextSequence++;
+}
+
+/// Releases every packet held in the window in sequence order.
+void RTPPacketBuffer::FlushWindow(void)
+{
+    while (m_pendingCount)
+        ReleaseSlot();
+}
+
 void RTPPacketBuffer::PushFECPacket(
     const UDPPacket &packet, uint fec_stream_num)
 {
     (void) fec_stream_num;
     // TODO IMPLEMENT
-    // for now just free the packet for immediate reuse
+    // Recovered packets belong in the reorder window slot of the
+    // missing sequence number, which is held for kMaxHoleWait packets.
+    // For now just free the packet for immediate reuse.
     FreePacket(packet);
 }
@@ -7,16 +7,23 @@
 #ifndef RTP_PACKET_BUFFER_H
 #define RTP_PACKET_BUFFER_H
 
-#include <QMap>
+#include <vector>
 
 #include "rtpdatapacket.h"
 #include "packetbuffer.h"
 
+/** \brief Reorders RTP data packets by sequence number.
+ *
+ *  Packets are placed in a circular window indexed by the low bits of
+ *  their (extended) sequence number. Contiguous packets are released
+ *  to the consumer as soon as they are complete; a missing packet is
+ *  waited for until kMaxHoleWait newer packets have arrived, which
+ *  leaves room for FEC recovery to fill the hole, and then skipped.
+ */
 class RTPPacketBuffer : public PacketBuffer
 {
   public:
-    explicit RTPPacketBuffer(unsigned int bitrate) :
-        PacketBuffer(bitrate) {}
+    explicit RTPPacketBuffer(unsigned int bitrate);
 
     /// Adds RFC 3550 RTP data packet
     void PushDataPacket(const UDPPacket &udp_packet) override; // PacketBuffer
@@ -24,12 +31,36 @@ class RTPPacketBuffer : public PacketBuffer
     /// Adds SMPTE 2022 Forward Error Correction Stream packet
     void PushFECPacket(const UDPPacket &packet, unsigned int fec_stream_num) override; // PacketBuffer
 
+    /// Number of packets skipped because they never arrived
+    uint64_t GetLostPacketCount(void) const { return m_lostPackets; }
+    /// Number of packets dropped because they arrived too late or twice
+    uint64_t GetLatePacketCount(void) const { return m_latePackets; }
+
+    /// Number of sequence numbers the reorder window covers
+    static constexpr uint kWindowSize { 1024 };
+    /// Newer packets received before a missing packet is given up on
+    static constexpr uint kMaxHoleWait { 100 };
+
   private:
-    int      m_largeSequenceNumberSeenRecently { 0   };
-    uint64_t m_currentSequence                 { 0LL };
+    void ReleasePackets(void);
+    void ReleaseSlot(void);
+    void FlushWindow(void);
+
+    bool     m_haveSequence    { false };
+    /// Extended sequence number of the next packet to release
+    uint64_t m_nextSequence    { 0ULL };
+    /// Highest extended sequence number received
+    uint64_t m_highestSequence { 0ULL };
+    /// Sequence number which confirms a sender restart, if any
+    int      m_resyncSequence  { -1 };
+    uint     m_pendingCount    { 0 };
+
+    uint64_t m_lostPackets     { 0ULL };
+    uint64_t m_latePackets     { 0ULL };
 
-    /// The key is the RTP sequence number + sequence if applicable
-    QMap<uint64_t, RTPDataPacket> m_unorderedPackets;
+    /// Reorder window, indexed by extended sequence number % kWindowSize
+    std::vector<UDPPacket> m_window;
+    std::vector<bool>      m_windowUsed;
 };
 
 #endif // RTP_PACKET_BUFFER_H
@@ -0,0 +1,228 @@
+/* -*- Mode: c++ -*-
+ * UDPBatchReader
+ * Distributed as part of MythTV under GPL v2 and later.
+ */
+
+// C++ headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+// POSIX headers
+#include <poll.h>
+
+// MythTV headers
+#include "udpbatchreader.h"
+#include "packetbuffer.h"
+#include "mythlogging.h"
+#include "mythtimer.h"
+
+#define LOC QString("UDPBatchReader(%1): ").arg(m_name)
+
+/// How long to wait for data before checking whether to stop.
+static constexpr int kPollTimeoutMs = 100;
+/// How often statistics are logged while running.
+static constexpr std::chrono::milliseconds kStatsInterval { 60s };
+
+UDPBatchReader::UDPBatchReader(const QString &name, int fd,
+                               PacketBuffer *buffer, QMutex &bufferLock,
+                               uint stream, QHostAddress sender)
+    : MThread(name),
+      m_name(name), m_fd(fd), m_buffer(buffer), m_bufferLock(bufferLock),
+      m_stream(stream), m_sender(std::move(sender))
+{
+    // Have the kernel report its drop count for this socket with each
+    // datagram, so packet loss before we ever see it is visible.
+    int one = 1;
+    if (setsockopt(m_fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) < 0)
+        LOG(VB_RECORD, LOG_INFO, LOC + "Kernel drop counts unavailable" + ENO);
+}
+
+UDPBatchReader::~UDPBatchReader()
+{
+    Stop();
+}
+
+void UDPBatchReader::Stop(void)
+{
+    m_running = false;
+    wait();
+}
+
+void UDPBatchReader::run(void)
+{
+    RunProlog();
+    LOG(VB_RECORD, LOG_INFO, LOC + "run() -- begin");
+
+    m_running = true;
+    MythTimer statsTimer(MythTimer::kStartRunning);
+
+    while (m_running)
+    {
+        if (statsTimer.elapsed() >= kStatsInterval)
+        {
+            LogStatistics(false);
+            statsTimer.restart();
+        }
+
+        pollfd pfd { m_fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, kPollTimeoutMs);
+        if (ret < 0 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "poll() failed" + ENO);
+            break;
+        }
+        if (ret <= 0)
+            continue;
+
+        if (ReadBatch() < 0)
+            break;
+    }
+
+    // Hand unused packets back for reuse
+    {
+        QMutexLocker locker(&m_bufferLock);
+        for (auto & packet : m_packets)
+        {
+            if (packet.GetKey())
+                m_buffer->FreePacket(packet);
+            packet = UDPPacket();
+        }
+    }
+
+    LogStatistics(true);
+    LOG(VB_RECORD, LOG_INFO, LOC + "run() -- end");
+    RunEpilog();
+}
+
+/**
+ *  \brief Receives all datagrams queued on the socket, up to kBatchSize.
+ *  \return Number of datagrams received, or -1 on a socket error.
+ */
+int UDPBatchReader::ReadBatch(void)
+{
+    // Take empty packets from the pool for the slots used last time
+    {
+        QMutexLocker locker(&m_bufferLock);
+        for (auto & packet : m_packets)
+        {
+            if (!packet.GetKey())
+                packet = m_buffer->GetEmptyPacket();
+        }
+    }
+
+    for (uint i = 0; i < kBatchSize; i++)
+    {
+        QByteArray &data = m_packets[i].GetDataReference();
+        data.resize(static_cast<int>(m_datagramSize));
+        m_iovecs[i].iov_base = data.data();
+        m_iovecs[i].iov_len  = m_datagramSize;
+
+        msghdr &hdr = m_msgs[i].msg_hdr;
+        hdr.msg_name       = &m_addrs[i];
+        hdr.msg_namelen    = sizeof(sockaddr_storage);
+        hdr.msg_iov        = &m_iovecs[i];
+        hdr.msg_iovlen     = 1;
+        hdr.msg_control    = m_controls[i].data();
+        hdr.msg_controllen = m_controls[i].size();
+        hdr.msg_flags      = 0;
+        m_msgs[i].msg_len  = 0;
+    }
+
+    int count = recvmmsg(m_fd, m_msgs.data(), kBatchSize, MSG_DONTWAIT, nullptr);
+    if (count < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return 0;
+        LOG(VB_GENERAL, LOG_ERR, LOC + "recvmmsg() failed" + ENO);
+        return -1;
+    }
+
+    bool sender_null = m_sender.isNull();
+    bool truncated = false;
+
+    QMutexLocker locker(&m_bufferLock);
+    for (int i = 0; i < count; i++)
+    {
+        msghdr &hdr = m_msgs[i].msg_hdr;
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+             cmsg = CMSG_NXTHDR(&hdr, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
+                memcpy(&m_kernelDrops, CMSG_DATA(cmsg), sizeof(m_kernelDrops));
+        }
+
+        UDPPacket &packet = m_packets[i];
+        if (hdr.msg_flags & MSG_TRUNC)
+        {
+            m_truncatedCount++;
+            truncated = true;
+            continue; // the slot's packet is reused next time
+        }
+
+        if (!sender_null &&
+            QHostAddress(reinterpret_cast<const sockaddr*>(&m_addrs[i])) != m_sender)
+        {
+            m_foreignCount++;
+            continue;
+        }
+
+        packet.GetDataReference().resize(static_cast<int>(m_msgs[i].msg_len));
+        m_byteCount += m_msgs[i].msg_len;
+        if (0 == m_stream)
+            m_buffer->PushDataPacket(packet);
+        else
+            m_buffer->PushFECPacket(packet, m_stream - 1);
+        packet = UDPPacket();
+    }
+    locker.unlock();
+
+    if (truncated && m_datagramSize < kMaxDatagramSize)
+    {
+        m_datagramSize = kMaxDatagramSize;
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Datagram larger than %1 bytes truncated, "
+                    "receiving up to %2 bytes from now on")
+            .arg(kMinDatagramSize).arg(kMaxDatagramSize));
+    }
+
+    m_packetCount += count;
+    m_batchCount++;
+    m_batchMax = std::max(m_batchMax, static_cast<uint>(count));
+    return count;
+}
+
+void UDPBatchReader::LogStatistics(bool final)
+{
+    m_totalPackets += m_packetCount;
+    m_totalBatches += m_batchCount;
+
+    uint32_t drops = m_kernelDrops - m_kernelDropsLastReport;
+    m_kernelDropsLastReport = m_kernelDrops;
+
+    if (m_packetCount || drops || final)
+    {
+        double avg = m_batchCount ? static_cast<double>(m_packetCount) / m_batchCount : 0.0;
+        LOG(VB_RECORD, (drops || m_truncatedCount) ? LOG_WARNING : LOG_INFO, LOC +
+            QString("%1 datagrams (%2 kB) in %3 batches, %4 per batch "
+                    "(max %5), kernel dropped %6, truncated %7, "
+                    "from other senders %8")
+            .arg(m_packetCount).arg(m_byteCount / 1024).arg(m_batchCount)
+            .arg(avg, 0, 'f', 1).arg(m_batchMax).arg(drops)
+            .arg(m_truncatedCount).arg(m_foreignCount));
+    }
+    if (final)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Total %1 datagrams in %2 batches, kernel dropped %3")
+            .arg(m_totalPackets).arg(m_totalBatches).arg(m_kernelDrops));
+    }
+
+    m_packetCount    = 0;
+    m_byteCount      = 0;
+    m_batchCount     = 0;
+    m_batchMax       = 0;
+    m_truncatedCount = 0;
+    m_foreignCount   = 0;
+}
@@ -0,0 +1,92 @@
+/* -*- Mode: c++ -*-
+ * UDPBatchReader
+ * Distributed as part of MythTV under GPL v2 and later.
+ */
+
+#ifndef UDP_BATCH_READER_H
+#define UDP_BATCH_READER_H
+
+// C++ headers
+#include <array>
+#include <atomic>
+
+// POSIX headers
+#include <sys/socket.h>
+
+// Qt headers
+#include <QHostAddress>
+#include <QMutex>
+#include <QString>
+
+// MythTV headers
+#include "mthread.h"
+#include "udppacket.h"
+
+class PacketBuffer;
+
+/** \class UDPBatchReader
+ *  \brief Drains a UDP socket into a PacketBuffer from its own thread.
+ *
+ *  Instead of one readDatagram() call and one Qt event dispatch per
+ *  datagram, this waits on the socket with poll() and then receives up
+ *  to kBatchSize datagrams per recvmmsg() call directly into packets
+ *  taken from the PacketBuffer's free list. Every access to the buffer,
+ *  including the consumer's, must hold the lock passed in.
+ *
+ *  Datagrams go to PushDataPacket() for stream 0 and to PushFECPacket()
+ *  for the FEC streams. Statistics on batch sizes and kernel drops
+ *  (SO_RXQ_OVFL) are logged once a minute and when the reader stops.
+ */
+class UDPBatchReader : public MThread
+{
+  public:
+    UDPBatchReader(const QString &name, int fd, PacketBuffer *buffer,
+                   QMutex &bufferLock, uint stream,
+                   QHostAddress sender = QHostAddress());
+    ~UDPBatchReader() override;
+
+    void Stop(void);
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    int  ReadBatch(void);
+    void LogStatistics(bool final);
+
+    static constexpr uint kBatchSize = 64;
+    static constexpr size_t kMinDatagramSize = 2048;
+    static constexpr size_t kMaxDatagramSize = 65536;
+
+    QString           m_name;
+    int               m_fd;
+    PacketBuffer     *m_buffer        {nullptr};
+    QMutex           &m_bufferLock;
+    uint              m_stream;
+    QHostAddress      m_sender;
+    std::atomic<bool> m_running       {false};
+
+    /// Current receive size, grows if a datagram was truncated.
+    size_t            m_datagramSize  {kMinDatagramSize};
+
+    std::array<UDPPacket,kBatchSize>        m_packets;
+    std::array<mmsghdr,kBatchSize>          m_msgs      {};
+    std::array<iovec,kBatchSize>            m_iovecs    {};
+    std::array<sockaddr_storage,kBatchSize> m_addrs     {};
+    std::array<std::array<char,CMSG_SPACE(sizeof(uint32_t))>,kBatchSize>
+                                            m_controls  {};
+
+    // Statistics, since the last report and in total
+    uint64_t          m_packetCount    {0};
+    uint64_t          m_byteCount      {0};
+    uint64_t          m_batchCount     {0};
+    uint              m_batchMax       {0};
+    uint64_t          m_truncatedCount {0};
+    uint64_t          m_foreignCount   {0};
+    uint32_t          m_kernelDrops    {0};
+    uint32_t          m_kernelDropsLastReport {0};
+    uint64_t          m_totalPackets   {0};
+    uint64_t          m_totalBatches   {0};
+};
+
+#endif // UDP_BATCH_READER_H
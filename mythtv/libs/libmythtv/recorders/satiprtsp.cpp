@@ -21,6 +21,9 @@
 #include "satipstreamhandler.h"
 #include "rtcpdatapacket.h"
 #include "satiprtcppacket.h"
+#ifdef USING_RECVMMSG
+#include "udpbatchreader.h"
+#endif
 
 #define LOC  QString("SatIPRTSP[%1]: ").arg(m_streamHandler->m_inputId)
 #define LOC2 QString("SatIPRTSP[%1](%2): ").arg(m_streamHandler->m_inputId).arg(m_requestUrl.toString())
@@ -86,10 +89,24 @@ SatIPRTSP::SatIPRTSP(SatIPStreamHandler *handler)
             QString("\tsudo sysctl -w net.core.rmem_max=%1\n").arg(desiredsize) +
             QString("\tand restart mythbackend."));
     }
+
+#ifdef USING_RECVMMSG
+    // Receive RTP on a dedicated thread, in batches, outside the event loop
+    if (m_readHelper->m_socket->socketDescriptor() >= 0)
+    {
+        m_batchReader = new UDPBatchReader(
+            "SatIPRead", m_readHelper->m_socket->socketDescriptor(),
+            m_buffer, m_bufferLock, 0);
+        m_batchReader->start();
+    }
+#endif
 }
 
 SatIPRTSP::~SatIPRTSP()
 {
+#ifdef USING_RECVMMSG
+    delete m_batchReader;
+#endif
     delete m_rtcpReadHelper;
     delete m_writeHelper;
     delete m_readHelper;
@@ -425,8 +442,10 @@ SatIPRTSPReadHelper::SatIPRTSPReadHelper(SatIPRTSP* p)
     LOG(VB_RECORD, LOG_INFO, LOC_RH +
         QString("Starting read helper for UDP (RTP) socket"));
 
+#ifndef USING_RECVMMSG
     // Call ReadPending when there is a message received on m_socket
     connect(m_socket, &QUdpSocket::readyRead, this, &SatIPRTSPReadHelper::ReadPending);
+#endif
 }
 
 SatIPRTSPReadHelper::~SatIPRTSPReadHelper()
@@ -436,6 +455,7 @@ SatIPRTSPReadHelper::~SatIPRTSPReadHelper()
 
 void SatIPRTSPReadHelper::ReadPending()
 {
+    QMutexLocker locker(&m_parent->m_bufferLock);
     while (m_socket->hasPendingDatagrams())
     {
         QHostAddress sender;
@@ -540,9 +560,11 @@ SatIPRTSPWriteHelper::SatIPRTSPWriteHelper(SatIPRTSP* parent, SatIPStreamHandler
 
 void SatIPRTSPWriteHelper::timerEvent(QTimerEvent* /*event*/)
 {
+    QMutexLocker bufferLocker(&m_parent->m_bufferLock);
     while (m_parent->m_buffer->HasAvailablePacket())
     {
         RTPDataPacket pkt(m_parent->m_buffer->PopDataPacket());
+        bufferLocker.unlock();
 
         if (pkt.GetPayloadType() == RTPDataPacket::kPayLoadTypeTS)
         {
@@ -550,6 +572,7 @@ void SatIPRTSPWriteHelper::timerEvent(QTimerEvent* /*event*/)
 
             if (!ts_packet.IsValid())
             {
+                bufferLocker.relock();
                 m_parent->m_buffer->FreePacket(pkt);
                 continue;
             }
@@ -561,12 +584,13 @@ void SatIPRTSPWriteHelper::timerEvent(QTimerEvent* /*event*/)
                 ((exp_seq_num & 0xFFFF) != (seq_num & 0xFFFF)))
             {
                 // Discard all pending packets to recover from buffer overflow
+                bufferLocker.relock();
                 m_parent->m_buffer->FreePacket(pkt);
                 uint discarded = 1;
                 while (m_parent->m_buffer->HasAvailablePacket())
                 {
                     RTPDataPacket pkt_next(m_parent->m_buffer->PopDataPacket());
-                    m_parent->m_buffer->FreePacket(pkt);
+                    m_parent->m_buffer->FreePacket(pkt_next);
                     discarded++;
                 }
                 m_lastSequenceNumber = 0;
@@ -589,16 +613,12 @@ void SatIPRTSPWriteHelper::timerEvent(QTimerEvent* /*event*/)
                 int remainder = 0;
                 {
                     QMutexLocker locker(&m_streamHandler->m_listenerLock);
-                    auto streamDataList = m_streamHandler->m_streamDataList;
-                    if (!streamDataList.isEmpty())
+                    if (!m_streamHandler->m_streamDataList.isEmpty())
                     {
                         const unsigned char *data_buffer = ts_packet.GetTSData();
                         size_t data_length = ts_packet.GetTSDataSize();
 
-                        for (auto sit = streamDataList.cbegin(); sit != streamDataList.cend(); ++sit)
-                        {
-                            remainder = sit.key()->ProcessData(data_buffer, data_length);
-                        }
+                        remainder = m_streamHandler->ProcessStreamData(data_buffer, data_length);
 
                         m_streamHandler->WriteMPTS(data_buffer, data_length - remainder);
                     }
@@ -612,8 +632,10 @@ void SatIPRTSPWriteHelper::timerEvent(QTimerEvent* /*event*/)
                 }
             }
         }
+        bufferLocker.relock();
         m_parent->m_buffer->FreePacket(pkt);
     }
+    bufferLocker.unlock();
     m_parent->m_validOld = m_parent->m_valid;
 }
 
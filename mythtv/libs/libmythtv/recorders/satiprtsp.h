@@ -22,6 +22,7 @@
 
 class SatIPRTSP;
 class SatIPStreamHandler;
+class UDPBatchReader;
 using Headers = QMap<QString, QString>;
 
 // --- SatIPRTSPReadHelper ---------------------------------------------------
@@ -124,6 +125,7 @@ class SatIPRTSP : public QObject
   protected:
     QUrl m_requestUrl;
     PacketBuffer *m_buffer  {nullptr};
+    QMutex        m_bufferLock;  ///< held for all m_buffer access
 
   private:
     bool sendMessage(const QUrl& url, const QString& msg, QStringList* additionalHeaders = nullptr);
@@ -150,6 +152,9 @@ class SatIPRTSP : public QObject
     SatIPRTSPReadHelper  *m_readHelper        {nullptr};
     SatIPRTSPWriteHelper *m_writeHelper       {nullptr};
     SatIPRTCPReadHelper  *m_rtcpReadHelper    {nullptr};
+#ifdef USING_RECVMMSG
+    UDPBatchReader       *m_batchReader       {nullptr};
+#endif
 };
 
 #endif // SATIPRTSP_H
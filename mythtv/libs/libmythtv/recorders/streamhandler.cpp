@@ -66,6 +66,7 @@ void StreamHandler::AddListener(MPEGStreamData *data,
     }
 
     m_streamDataList[data] = output_file;
+    m_demuxDirty = true;
 
     m_listenerLock.unlock();
 
@@ -101,6 +102,7 @@ void StreamHandler::RemoveListener(MPEGStreamData *data)
         if (!(*it).isEmpty())
             RemoveNamedOutputFile(*it);
         m_streamDataList.erase(it);
+        m_demuxDirty = true;
     }
 
     m_listenerLock.unlock();
@@ -346,6 +348,128 @@ PIDPriority StreamHandler::GetPIDPriority(uint pid) const
     return tmp;
 }
 
+/** \brief Hands a buffer of TS packets to every listener.
+ *
+ *  With a single listener this is just MPEGStreamData::ProcessData().
+ *  When several recordings share a multiplex, the buffer is instead
+ *  walked once here and each packet is only handed to the listeners
+ *  that want its PID, rather than every listener resyncing on and
+ *  classifying every packet of the whole multiplex itself.
+ *
+ *  \note m_listenerLock must be held when this is called.
+ *  \return number of bytes at the end of the buffer that were not
+ *          processed, as with MPEGStreamData::ProcessData().
+ */
+int StreamHandler::ProcessStreamData(const unsigned char *buffer, int len)
+{
+    if (m_streamDataList.size() == 1)
+        return m_streamDataList.cbegin().key()->ProcessData(buffer, len);
+
+    if (m_streamDataList.size() > static_cast<int>(kMaxDemuxListeners))
+    {
+        int remainder = 0;
+        for (auto sit = m_streamDataList.cbegin();
+             sit != m_streamDataList.cend(); ++sit)
+            remainder = sit.key()->ProcessData(buffer, len);
+        return remainder;
+    }
+
+    UpdateDemuxMap();
+
+    int pos = 0;
+    bool resync = false;
+
+    while (pos + int(TSPacket::kSize) <= len)
+    { // while we have a whole packet left...
+        if (buffer[pos] != SYNC_BYTE || resync)
+        {
+            int newpos = MPEGStreamData::ResyncStream(buffer, pos+1, len);
+            LOG(VB_RECORD, LOG_DEBUG, LOC +
+                QString("Resyncing @ %1+1 w/len %2 -> %3")
+                .arg(pos).arg(len).arg(newpos));
+            if (newpos == -1)
+                return len - pos;
+            if (newpos == -2)
+                return TSPacket::kSize;
+            pos = newpos;
+        }
+
+        const auto *pkt = reinterpret_cast<const TSPacket*>(&buffer[pos]);
+        pos += TSPacket::kSize; // Advance to next TS packet
+        resync = false;
+
+        uint64_t mask = m_demuxMap[pkt->PID()];
+        for (uint i = 0; mask != 0; ++i, mask >>= 1)
+        {
+            if ((mask & 1) == 0)
+                continue;
+            MPEGStreamData *data = m_demuxListeners[i];
+            data->ProcessTSPacket(*pkt);
+            // A new PAT or PMT may have changed the PIDs it wants
+            if (data->PIDLookupGeneration() != m_demuxGenerations[i])
+                m_demuxDirty = true;
+        }
+
+        if (m_demuxDirty)
+            UpdateDemuxMap();
+
+        if (pkt->TransportError() && (pos + int(TSPacket::kSize) <= len) &&
+            (buffer[pos] != SYNC_BYTE))
+        {
+            // As in MPEGStreamData::ProcessData(), resync if we don't
+            // appear to be in sync after a bad packet.
+            pos -= TSPacket::kSize;
+            resync = true;
+        }
+    }
+
+    return len - pos;
+}
+
+/** \brief Rebuilds the PID to listener bitmap if needed.
+ *
+ *  \note m_listenerLock must be held when this is called.
+ */
+void StreamHandler::UpdateDemuxMap(void)
+{
+    if (!m_demuxDirty)
+    {
+        for (size_t i = 0; i < m_demuxListeners.size(); ++i)
+        {
+            if (m_demuxListeners[i]->PIDLookupGeneration() !=
+                m_demuxGenerations[i])
+            {
+                m_demuxDirty = true;
+                break;
+            }
+        }
+        if (!m_demuxDirty)
+            return;
+    }
+
+    m_demuxListeners.clear();
+    m_demuxGenerations.clear();
+    for (auto sit = m_streamDataList.cbegin();
+         sit != m_streamDataList.cend(); ++sit)
+    {
+        m_demuxListeners.push_back(sit.key());
+        m_demuxGenerations.push_back(sit.key()->PIDLookupGeneration());
+    }
+
+    for (uint pid = 0; pid < m_demuxMap.size(); ++pid)
+    {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < m_demuxListeners.size(); ++i)
+        {
+            if (m_demuxListeners[i]->IsWantedPID(pid))
+                mask |= (1ULL << i);
+        }
+        m_demuxMap[pid] = mask;
+    }
+
+    m_demuxDirty = false;
+}
+
 void StreamHandler::WriteMPTS(const unsigned char * buffer, uint len)
 {
     if (m_mptsTfw == nullptr)
@@ -367,6 +491,7 @@ bool StreamHandler::AddNamedOutputFile(const QString &file)
         m_mptsTfw = new ThreadedFileWriter(fn,
                                            O_WRONLY|O_TRUNC|O_CREAT|O_LARGEFILE,
                                            0644);
+        m_mptsTfw->EnableRingBuffer();
         if (!m_mptsTfw->Open())
         {
             delete m_mptsTfw;
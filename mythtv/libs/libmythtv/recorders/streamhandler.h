@@ -3,6 +3,7 @@
 #ifndef STREAM_HANDLER_H
 #define STREAM_HANDLER_H
 
+#include <array>
 #include <utility>
 #include <vector>
 
@@ -98,6 +99,8 @@ class StreamHandler : protected MThread, public DeviceReaderCB
         { return new PIDInfo(pid, stream_type, pes_type); }
 
   protected:
+    /// Hand TS packets to all listeners, m_listenerLock must be held
+    int ProcessStreamData(const unsigned char *buffer, int len);
     /// Write out a copy of the raw MPTS
     void WriteMPTS(const unsigned char * buffer, uint len);
     /// At minimum this sets _running_desired, this may also send
@@ -140,6 +143,17 @@ class StreamHandler : protected MThread, public DeviceReaderCB
     using StreamDataList = QHash<MPEGStreamData*,QString>;
     mutable QMutex      m_listenerLock         {QMutex::Recursive};
     StreamDataList      m_streamDataList;
+
+  private:
+    void UpdateDemuxMap(void);
+
+    // PID to listener bitmap used by ProcessStreamData(),
+    // protected by m_listenerLock
+    static constexpr uint kMaxDemuxListeners    {64};
+    bool                          m_demuxDirty  {true};
+    std::vector<MPEGStreamData*>  m_demuxListeners;
+    std::vector<uint>             m_demuxGenerations;
+    std::array<uint64_t,0x2000>   m_demuxMap    {};
 };
 
 #endif // STREAM_HANDLER_H
@@ -0,0 +1,184 @@
+/*
+ *  Class TestByteReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <algorithm>
+#include <random>
+
+#include "test_bytereader.h"
+#include "bytereader.h"
+
+static constexpr int kTSPacketSize = 188;
+
+QByteArray TestByteReader::s_packets;
+
+/// The byte at a time scan from FFmpeg's avpriv_find_start_code().
+static const uint8_t *reference_find_start_code(
+    const uint8_t *p, const uint8_t *end, uint32_t *state)
+{
+    if (p >= end)
+        return end;
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t tmp = *state << 8;
+        *state = tmp + *(p++);
+        if (tmp == 0x100 || p == end)
+            return p;
+    }
+    while (p < end)
+    {
+        if      (p[-1] > 1      ) p += 3;
+        else if (p[-2]          ) p += 2;
+        else if (p[-3]|(p[-1]-1)) p++;
+        else { p++; break; }
+    }
+    p = std::min(p, end) - 4;
+    *state = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    return p + 4;
+}
+
+void TestByteReader::initTestCase(void)
+{
+    // Benchmark over a captured transport stream when one is given,
+    // otherwise over random payloads with a start code every 4kB or so.
+    QString tsfile = qgetenv("MYTHTV_TEST_TS_FILE");
+    if (!tsfile.isEmpty())
+    {
+        QFile file(tsfile);
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(tsfile));
+        s_packets = file.read(64LL * 1024 * 1024);
+        s_packets.truncate(s_packets.size() - s_packets.size() % kTSPacketSize);
+        return;
+    }
+
+    std::mt19937 gen(4242); // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::uniform_int_distribution<int> byte(0, 255);
+    s_packets.resize(kTSPacketSize * 50000);
+    for (char & ch : s_packets)
+        ch = static_cast<char>(byte(gen));
+    for (int i = 0; i + 4 < s_packets.size(); i += 4099)
+    {
+        s_packets[i]     = 0x00;
+        s_packets[i + 1] = 0x00;
+        s_packets[i + 2] = 0x01;
+    }
+}
+
+void TestByteReader::test_findstartcode_data(void)
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<uint>("state");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<uint>("result");
+
+    QTest::newRow("empty")
+        << QByteArray() << 0xffffffffU << 0 << 0xffffffffU;
+    QTest::newRow("at start")
+        << QByteArray::fromHex("000001b3ffff") << 0xffffffffU << 4 << 0x000001b3U;
+    QTest::newRow("after 20 bytes")
+        << QByteArray::fromHex("ffffffffffffffffffffffffffffffffffffffff000001b8ff")
+        << 0xffffffffU << 24 << 0x000001b8U;
+    QTest::newRow("split from previous buffer")
+        << QByteArray::fromHex("0100ffffffff") << 0xff000000U << 2 << 0x00000100U;
+    QTest::newRow("prefix at end")
+        << QByteArray::fromHex("ffffffffffffffffffffffffffffffffffffffff000001")
+        << 0xffffffffU << 23 << 0xff000001U;
+    QTest::newRow("none")
+        << QByteArray(100, '\x02') << 0xffffffffU << 100 << 0x02020202U;
+}
+
+void TestByteReader::test_findstartcode(void)
+{
+    QFETCH(QByteArray, data);
+    QFETCH(uint, state);
+    QFETCH(int, offset);
+    QFETCH(uint, result);
+
+    const auto *start = reinterpret_cast<const uint8_t *>(data.constData());
+    const uint8_t *p = ByteReader::FindStartCode(start, start + data.size(), &state);
+    QCOMPARE(static_cast<int>(p - start), offset);
+    QCOMPARE(state, result);
+}
+
+void TestByteReader::test_reference(void)
+{
+    // Mostly zeros and ones, so there are many near misses.
+    std::mt19937 gen(1234); // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::uniform_int_distribution<int> pick(0, 9);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> length(0, 400);
+
+    for (int i = 0; i < 20000; i++)
+    {
+        QByteArray data(length(gen), '\0');
+        for (char & ch : data)
+        {
+            int r = pick(gen);
+            ch = static_cast<char>((r < 5) ? 0 : (r < 7) ? 1 : byte(gen));
+        }
+
+        const auto *start = reinterpret_cast<const uint8_t *>(data.constData());
+        const uint8_t *end = start + data.size();
+        uint32_t expstate = (i % 3) ? static_cast<uint32_t>(byte(gen)) : 0xffffffff;
+        uint32_t state = expstate;
+        const uint8_t *expp = start;
+        const uint8_t *p = start;
+        while (expp < end)
+        {
+            expp = reference_find_start_code(expp, end, &expstate);
+            p = ByteReader::FindStartCode(p, end, &state);
+            QCOMPARE(p - start, expp - start);
+            QCOMPARE(state, expstate);
+        }
+    }
+}
+
+void TestByteReader::benchmark_tspackets_data(void)
+{
+    QTest::addColumn<bool>("reference");
+    QTest::newRow("byte at a time") << true;
+    QTest::newRow("ByteReader")     << false;
+}
+
+void TestByteReader::benchmark_tspackets(void)
+{
+    QFETCH(bool, reference);
+
+    // Scan each packet's payload separately, as DTVRecorder does.
+    const auto *data = reinterpret_cast<const uint8_t *>(s_packets.constData());
+    const int packets = s_packets.size() / kTSPacketSize;
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        uint32_t state = 0xffffffff;
+        for (int i = 0; i < packets; i++)
+        {
+            const uint8_t *p   = data + (i * kTSPacketSize) + 4;
+            const uint8_t *end = data + ((i + 1) * kTSPacketSize);
+            while (p < end)
+            {
+                p = reference ? reference_find_start_code(p, end, &state)
+                              : ByteReader::FindStartCode(p, end, &state);
+                if ((state & 0xffffff00) == 0x100)
+                    found++;
+            }
+        }
+    }
+    qInfo() << packets << "packets," << found << "start codes per iteration";
+}
+
+QTEST_APPLESS_MAIN(TestByteReader)
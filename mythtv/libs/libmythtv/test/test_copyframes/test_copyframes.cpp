@@ -251,4 +251,158 @@ void TestCopyFrames::TestCopy()
     }
 }
 
+// Fill the visible area of each plane with valid samples for the format
+static void FillPlanes(MythVideoFrame* Frame)
+{
+    int depth = MythVideoFrame::ColorDepth(Frame->m_type);
+    int shift = (Frame->m_type == FMT_P010) ? 6 : 0;
+    uint count = MythVideoFrame::GetNumPlanes(Frame->m_type);
+    for (uint plane = 0; plane < count; ++plane)
+    {
+        int width  = MythVideoFrame::GetPitchForPlane(Frame->m_type, Frame->m_width, plane);
+        int height = MythVideoFrame::GetHeightForPlane(Frame->m_type, Frame->m_height, plane);
+        for (int row = 0; row < height; ++row)
+        {
+            uint8_t* line = Frame->m_buffer + Frame->m_offsets[plane] + (row * Frame->m_pitches[plane]);
+            if (depth > 8)
+            {
+                for (int col = 0; col < width; col += 2)
+                {
+                    auto value = static_cast<uint16_t>((MythRandom() & ((1 << depth) - 1)) << shift);
+                    memcpy(line + col, &value, sizeof(value));
+                }
+            }
+            else
+            {
+                for (int col = 0; col < width; ++col)
+                    line[col] = MythRandom() & 0xFF;
+            }
+        }
+    }
+}
+
+static bool ComparePlanes(const MythVideoFrame* First, const MythVideoFrame* Second)
+{
+    uint count = MythVideoFrame::GetNumPlanes(First->m_type);
+    for (uint plane = 0; plane < count; ++plane)
+    {
+        int width  = MythVideoFrame::GetPitchForPlane(First->m_type, First->m_width, plane);
+        int height = MythVideoFrame::GetHeightForPlane(First->m_type, First->m_height, plane);
+        for (int row = 0; row < height; ++row)
+        {
+            if (memcmp(First->m_buffer + First->m_offsets[plane] + (row * First->m_pitches[plane]),
+                       Second->m_buffer + Second->m_offsets[plane] + (row * Second->m_pitches[plane]),
+                       static_cast<size_t>(width)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TestCopyFrames::TestConvert_data()
+{
+    QTest::addColumn<int>("From");
+    QTest::addColumn<int>("To");
+    QTest::addColumn<int>("Width");
+    QTest::addColumn<int>("Height");
+    QTest::newRow("NV12 to YV12 SD")     << static_cast<int>(FMT_NV12) << static_cast<int>(FMT_YV12) << 720 << 576;
+    QTest::newRow("NV12 to YV12 odd")    << static_cast<int>(FMT_NV12) << static_cast<int>(FMT_YV12) << 718 << 574;
+    QTest::newRow("YV12 to NV12 HD")     << static_cast<int>(FMT_YV12) << static_cast<int>(FMT_NV12) << 1920 << 1080;
+    QTest::newRow("P010 to P10 UHD")     << static_cast<int>(FMT_P010) << static_cast<int>(FMT_YUV420P10) << 3840 << 2160;
+    QTest::newRow("P10 to P010 SD")      << static_cast<int>(FMT_YUV420P10) << static_cast<int>(FMT_P010) << 720 << 576;
+    QTest::newRow("YUV420P10 copy UHD")  << static_cast<int>(FMT_YUV420P10) << static_cast<int>(FMT_YUV420P10) << 3840 << 2160;
+}
+
+void TestCopyFrames::TestConvert()
+{
+    QFETCH(int, From);
+    QFETCH(int, To);
+    QFETCH(int, Width);
+    QFETCH(int, Height);
+
+    // Use the copy threads, as VideoBuffers would
+    MythVideoFrame::AddCopyUser();
+    auto fromtype = static_cast<VideoFrameType>(From);
+    auto totype   = static_cast<VideoFrameType>(To);
+    QVERIFY(MythVideoFrame::CanCopy(fromtype, totype));
+    MythVideoFrame from(fromtype, Width, Height);
+    MythVideoFrame to(totype, Width, Height);
+    MythVideoFrame back(fromtype, Width, Height);
+    FillPlanes(&from);
+    from.m_colorshifted = fromtype == FMT_P010;
+    QVERIFY(to.CopyFrame(&from));
+    QCOMPARE(to.m_colorshifted, totype == FMT_P010);
+    QVERIFY(back.CopyFrame(&to));
+    MythVideoFrame::RemoveCopyUser();
+    QVERIFY(ComparePlanes(&from, &back));
+
+    // Check the first chroma sample ended up in the right place
+    bool hidepth = MythVideoFrame::ColorDepth(fromtype) > 8;
+    if (fromtype != totype)
+    {
+        const MythVideoFrame* nv12 = MythVideoFrame::FormatIsNV12(fromtype) ? &from : &to;
+        const MythVideoFrame* yv12 = MythVideoFrame::FormatIsNV12(fromtype) ? &to : &from;
+        int size = hidepth ? 2 : 1;
+        uint16_t u = 0;
+        uint16_t v = 0;
+        uint16_t nvu = 0;
+        uint16_t nvv = 0;
+        memcpy(&u, yv12->m_buffer + yv12->m_offsets[1], static_cast<size_t>(size));
+        memcpy(&v, yv12->m_buffer + yv12->m_offsets[2], static_cast<size_t>(size));
+        memcpy(&nvu, nv12->m_buffer + nv12->m_offsets[1], static_cast<size_t>(size));
+        memcpy(&nvv, nv12->m_buffer + nv12->m_offsets[1] + size, static_cast<size_t>(size));
+        int shift = hidepth ? 6 : 0;
+        QCOMPARE(u, static_cast<uint16_t>(nvu >> shift));
+        QCOMPARE(v, static_cast<uint16_t>(nvv >> shift));
+    }
+
+    // Formats that cannot be converted
+    QVERIFY(!MythVideoFrame::CanCopy(FMT_YV12, FMT_YUV420P10));
+    QVERIFY(!MythVideoFrame::CanCopy(FMT_NV12, FMT_P010));
+    QVERIFY(!MythVideoFrame::CanCopy(FMT_VAAPI, FMT_VAAPI));
+}
+
+void TestCopyFrames::BenchmarkCopy_data()
+{
+    QTest::addColumn<int>("From");
+    QTest::addColumn<int>("To");
+    QTest::addColumn<bool>("Threads");
+    for (bool threads : { false, true })
+    {
+        QString suffix = threads ? " threaded" : "";
+        QTest::newRow(qPrintable("YV12 copy" + suffix))
+            << static_cast<int>(FMT_YV12) << static_cast<int>(FMT_YV12) << threads;
+        QTest::newRow(qPrintable("YUV420P10 copy" + suffix))
+            << static_cast<int>(FMT_YUV420P10) << static_cast<int>(FMT_YUV420P10) << threads;
+        QTest::newRow(qPrintable("NV12 to YV12" + suffix))
+            << static_cast<int>(FMT_NV12) << static_cast<int>(FMT_YV12) << threads;
+        QTest::newRow(qPrintable("P010 to YUV420P10" + suffix))
+            << static_cast<int>(FMT_P010) << static_cast<int>(FMT_YUV420P10) << threads;
+    }
+}
+
+/// \brief Throughput for 4K frames, with and without the copy threads.
+void TestCopyFrames::BenchmarkCopy()
+{
+    QFETCH(int, From);
+    QFETCH(int, To);
+    QFETCH(bool, Threads);
+
+    MythVideoFrame from(static_cast<VideoFrameType>(From), 3840, 2160);
+    MythVideoFrame to(static_cast<VideoFrameType>(To), 3840, 2160);
+    FillPlanes(&from);
+    if (Threads)
+        MythVideoFrame::AddCopyUser();
+    bool result = true;
+    QBENCHMARK
+    {
+        result &= to.CopyFrame(&from);
+    }
+    if (Threads)
+        MythVideoFrame::RemoveCopyUser();
+    QVERIFY(result);
+}
+
 QTEST_APPLESS_MAIN(TestCopyFrames)
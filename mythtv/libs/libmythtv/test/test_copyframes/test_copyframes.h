@@ -31,4 +31,8 @@ class TestCopyFrames : public QObject
     static void TestInvalidSizes();
     static void TestInvalidBuffers();
     static void TestCopy();
+    static void TestConvert_data();
+    static void TestConvert();
+    static void BenchmarkCopy_data();
+    static void BenchmarkCopy();
 };
@@ -0,0 +1,292 @@
+/*
+ *  Class TestDeinterlacer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_deinterlacer.h"
+#include "mythframe.h"
+#include "mythdeinterlacer.h"
+#include "mythsliceworkers.h"
+
+#include <atomic>
+
+static constexpr int kWidth  { 1920 };
+static constexpr int kHeight { 1080 };
+
+// Fill every plane with noise, so that each row differs from its neighbours
+static void FillFrame(MythVideoFrame& Frame, uint32_t Seed)
+{
+    int depth = MythVideoFrame::ColorDepth(Frame.m_type);
+    auto mask = static_cast<uint32_t>((1 << depth) - 1);
+    for (uint plane = 0; plane < MythVideoFrame::GetNumPlanes(Frame.m_type); ++plane)
+    {
+        int height = MythVideoFrame::GetHeightForPlane(Frame.m_type, Frame.m_height, plane);
+        int width  = MythVideoFrame::GetPitchForPlane(Frame.m_type, Frame.m_width, plane);
+        for (int row = 0; row < height; ++row)
+        {
+            uint8_t* line = Frame.m_buffer + Frame.m_offsets[plane] + (row * Frame.m_pitches[plane]);
+            for (int col = 0; col < width; col += (depth > 8) ? 2 : 1)
+            {
+                Seed = (Seed * 1664525) + 1013904223;
+                auto value = (Seed >> 16) & mask;
+                if (depth > 8)
+                {
+                    auto sample = static_cast<uint16_t>(value);
+                    memcpy(line + col, &sample, sizeof(sample));
+                }
+                else
+                {
+                    line[col] = static_cast<uint8_t>(value);
+                }
+            }
+        }
+    }
+}
+
+static int Sample(const MythVideoFrame& Frame, uint Plane, int Row, int Col, bool HighDepth)
+{
+    const uint8_t* line = Frame.m_buffer + Frame.m_offsets[Plane] + (Row * Frame.m_pitches[Plane]);
+    if (!HighDepth)
+        return line[Col];
+    uint16_t sample = 0;
+    memcpy(&sample, line + (Col * 2), sizeof(sample));
+    return sample;
+}
+
+/*! \brief Check Result against a linear interpolation of the field in Original.
+ *
+ * For linearblend, rows of the other field at the top and bottom of each plane,
+ * that are not processed, must be left as they were.
+*/
+static QString CheckFrame(const MythVideoFrame& Original, const MythVideoFrame& Result,
+                          bool TopField, bool Blend)
+{
+    bool hidepth = MythVideoFrame::ColorDepth(Original.m_type) > 8;
+    for (uint plane = 0; plane < MythVideoFrame::GetNumPlanes(Original.m_type); ++plane)
+    {
+        int height  = MythVideoFrame::GetHeightForPlane(Original.m_type, Original.m_height, plane);
+        int samples = MythVideoFrame::GetPitchForPlane(Original.m_type, Original.m_width, plane);
+        if (hidepth)
+            samples >>= 1;
+        int firstrow = TopField ? 1 : 2;
+        int lastrow  = firstrow + (((height - firstrow) / 4) * 4) - 2;
+        for (int row = 0; row < height; ++row)
+        {
+            bool current = ((row & 1) == 0) == TopField;
+            bool unchanged = current || (Blend && ((row < firstrow) || (row > lastrow)));
+            int above = row > 0 ? row - 1 : row + 1;
+            int below = row < (height - 1) ? row + 1 : row - 1;
+            for (int col = 0; col < samples; ++col)
+            {
+                int expected = Sample(Original, plane, row, col, hidepth);
+                if (!unchanged)
+                {
+                    expected = (Sample(Original, plane, above, col, hidepth) +
+                                Sample(Original, plane, below, col, hidepth) + 1) >> 1;
+                }
+                int actual = Sample(Result, plane, row, col, hidepth);
+                if (actual != expected)
+                {
+                    return QString("Plane %1 row %2 col %3: %4 expected %5")
+                        .arg(plane).arg(row).arg(col).arg(actual).arg(expected);
+                }
+            }
+        }
+    }
+    return {};
+}
+
+static void SetUpFrame(MythVideoFrame& Frame, MythDeintType Type, bool DoubleRate, bool TopFieldFirst)
+{
+    Frame.m_interlaced = 1;
+    Frame.m_topFieldFirst = TopFieldFirst;
+    Frame.m_deinterlaceAllowed = DEINT_ALL;
+    Frame.m_deinterlaceSingle = DEINT_CPU | Type;
+    Frame.m_deinterlaceDouble = DoubleRate ? (DEINT_CPU | Type) : DEINT_NONE;
+}
+
+void TestDeinterlacer::test_slices(void)
+{
+    for (int threads = 1; threads <= 4; ++threads)
+    {
+        MythSliceWorkers workers("TestSlice", threads);
+        QCOMPARE(workers.Threads(), threads);
+        for (int slices : { 1, 2, 3, 4, 7, 16 })
+        {
+            for (int run = 0; run < 50; ++run)
+            {
+                std::vector<std::atomic_int> counts(static_cast<size_t>(slices));
+                workers.Run(slices, [&](int Slice) { counts[static_cast<size_t>(Slice)]++; });
+                for (const auto & count : counts)
+                    QCOMPARE(count.load(), 1);
+            }
+        }
+    }
+}
+
+void TestDeinterlacer::test_bob_data(void)
+{
+    QTest::addColumn<int>("Type");
+    QTest::addColumn<bool>("TopFieldFirst");
+    QTest::addColumn<uint>("Threads");
+    QTest::newRow("YV12 top 1 thread")     << static_cast<int>(FMT_YV12)      << true  << 1U;
+    QTest::newRow("YV12 top 4 threads")    << static_cast<int>(FMT_YV12)      << true  << 4U;
+    QTest::newRow("YV12 bottom 4 threads") << static_cast<int>(FMT_YV12)      << false << 4U;
+    QTest::newRow("NV12 top 3 threads")    << static_cast<int>(FMT_NV12)      << true  << 3U;
+    QTest::newRow("P10 top 1 thread")      << static_cast<int>(FMT_YUV420P10) << true  << 1U;
+    QTest::newRow("P10 bottom 4 threads")  << static_cast<int>(FMT_YUV420P10) << false << 4U;
+}
+
+void TestDeinterlacer::test_bob(void)
+{
+    QFETCH(int, Type);
+    QFETCH(bool, TopFieldFirst);
+    QFETCH(uint, Threads);
+
+    auto type = static_cast<VideoFrameType>(Type);
+    MythVideoFrame original(type, kWidth, kHeight);
+    MythVideoFrame frame(type, kWidth, kHeight);
+    QVERIFY(original.m_buffer && frame.m_buffer);
+    FillFrame(original, 1);
+    memcpy(frame.m_buffer, original.m_buffer, frame.m_bufferSize);
+    SetUpFrame(frame, DEINT_BASIC, false, TopFieldFirst);
+
+    MythDeinterlacer deinterlacer(Threads);
+    deinterlacer.Filter(&frame, kScan_Interlaced, nullptr);
+    QVERIFY(frame.m_alreadyDeinterlaced);
+    QCOMPARE(frame.m_deinterlaceInuse, DEINT_CPU | DEINT_BASIC);
+    QString error = CheckFrame(original, frame, TopFieldFirst, false);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+}
+
+void TestDeinterlacer::test_bobdoublerate(void)
+{
+    MythVideoFrame original(FMT_YV12, kWidth, kHeight);
+    MythVideoFrame frame(FMT_YV12, kWidth, kHeight);
+    QVERIFY(original.m_buffer && frame.m_buffer);
+    FillFrame(original, 2);
+    memcpy(frame.m_buffer, original.m_buffer, frame.m_bufferSize);
+    SetUpFrame(frame, DEINT_BASIC, true, true);
+
+    MythDeinterlacer deinterlacer(4);
+    deinterlacer.Filter(&frame, kScan_Interlaced, nullptr);
+    QVERIFY(frame.m_deinterlaceInuse2x);
+    QString error = CheckFrame(original, frame, true, false);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+
+    // The second field comes from the cached original, not the first result
+    frame.m_alreadyDeinterlaced = false;
+    deinterlacer.Filter(&frame, kScan_Intr2ndField, nullptr);
+    error = CheckFrame(original, frame, false, false);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+}
+
+void TestDeinterlacer::test_blend_data(void)
+{
+    QTest::addColumn<int>("Type");
+    QTest::addColumn<bool>("DoubleRate");
+    QTest::addColumn<uint>("Threads");
+    QTest::newRow("YV12 1 thread")          << static_cast<int>(FMT_YV12)      << false << 1U;
+    QTest::newRow("YV12 4 threads")         << static_cast<int>(FMT_YV12)      << false << 4U;
+    QTest::newRow("YV12 double 3 threads")  << static_cast<int>(FMT_YV12)      << true  << 3U;
+    QTest::newRow("P10 1 thread")           << static_cast<int>(FMT_YUV420P10) << false << 1U;
+    QTest::newRow("P10 double 4 threads")   << static_cast<int>(FMT_YUV420P10) << true  << 4U;
+}
+
+void TestDeinterlacer::test_blend(void)
+{
+    QFETCH(int, Type);
+    QFETCH(bool, DoubleRate);
+    QFETCH(uint, Threads);
+
+    auto type = static_cast<VideoFrameType>(Type);
+    MythVideoFrame original(type, kWidth, kHeight);
+    MythVideoFrame frame(type, kWidth, kHeight);
+    QVERIFY(original.m_buffer && frame.m_buffer);
+    FillFrame(original, 3);
+    memcpy(frame.m_buffer, original.m_buffer, frame.m_bufferSize);
+    SetUpFrame(frame, DEINT_MEDIUM, DoubleRate, true);
+
+    MythDeinterlacer deinterlacer(Threads);
+    deinterlacer.Filter(&frame, kScan_Interlaced, nullptr);
+    QVERIFY(frame.m_alreadyDeinterlaced);
+    QString error = CheckFrame(original, frame, true, true);
+    QVERIFY2(error.isEmpty(), qPrintable(error));
+
+    if (DoubleRate)
+    {
+        // Rows that the second pass does not touch keep the first pass result
+        MythVideoFrame first(type, kWidth, kHeight);
+        memcpy(first.m_buffer, frame.m_buffer, frame.m_bufferSize);
+        frame.m_alreadyDeinterlaced = false;
+        deinterlacer.Filter(&frame, kScan_Intr2ndField, nullptr);
+        bool hidepth = MythVideoFrame::ColorDepth(type) > 8;
+        int samples = MythVideoFrame::GetPitchForPlane(type, kWidth, 0) >> (hidepth ? 1 : 0);
+        for (int col = 0; col < samples; ++col)
+        {
+            // Row 2 is interpolated from the bottom field of the original
+            int expected = (Sample(original, 0, 1, col, hidepth) +
+                            Sample(original, 0, 3, col, hidepth) + 1) >> 1;
+            QCOMPARE(Sample(frame, 0, 2, col, hidepth), expected);
+            // Row 1 is restored from the original
+            QCOMPARE(Sample(frame, 0, 1, col, hidepth), Sample(original, 0, 1, col, hidepth));
+        }
+    }
+}
+
+void TestDeinterlacer::benchmark_data(void)
+{
+    QTest::addColumn<int>("Deinterlacer");
+    QTest::addColumn<int>("Type");
+    QTest::addColumn<uint>("Threads");
+
+    auto ideal = static_cast<uint>(qBound(1, QThread::idealThreadCount(), 8));
+    for (uint threads : { 1U, ideal })
+    {
+        QTest::newRow(qPrintable(QString("Bob 8bit %1 threads").arg(threads)))
+            << static_cast<int>(DEINT_BASIC) << static_cast<int>(FMT_YV12) << threads;
+        QTest::newRow(qPrintable(QString("Bob 10bit %1 threads").arg(threads)))
+            << static_cast<int>(DEINT_BASIC) << static_cast<int>(FMT_YUV420P10) << threads;
+        QTest::newRow(qPrintable(QString("Blend 8bit %1 threads").arg(threads)))
+            << static_cast<int>(DEINT_MEDIUM) << static_cast<int>(FMT_YV12) << threads;
+        QTest::newRow(qPrintable(QString("Blend 10bit %1 threads").arg(threads)))
+            << static_cast<int>(DEINT_MEDIUM) << static_cast<int>(FMT_YUV420P10) << threads;
+        if (ideal == 1)
+            break;
+    }
+}
+
+void TestDeinterlacer::benchmark(void)
+{
+    QFETCH(int, Deinterlacer);
+    QFETCH(int, Type);
+    QFETCH(uint, Threads);
+
+    MythVideoFrame frame(static_cast<VideoFrameType>(Type), kWidth, kHeight);
+    QVERIFY(frame.m_buffer);
+    FillFrame(frame, 4);
+    SetUpFrame(frame, static_cast<MythDeintType>(Deinterlacer), false, true);
+
+    MythDeinterlacer deinterlacer(Threads);
+    QBENCHMARK
+    {
+        frame.m_alreadyDeinterlaced = false;
+        deinterlacer.Filter(&frame, kScan_Interlaced, nullptr);
+    }
+    QVERIFY(frame.m_alreadyDeinterlaced);
+}
+
+QTEST_APPLESS_MAIN(TestDeinterlacer)
@@ -0,0 +1,288 @@
+/*
+ *  Class TestDemuxThread
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_demuxthread.h"
+#include "decoders/mythdemuxthread.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include <QSemaphore>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// Stands in for av_read_frame, returning packets numbered from m_next and
+// spread over m_streams streams.
+class FakeDemuxer
+{
+  public:
+    int Read(AVPacket* Packet)
+    {
+        if (m_next == m_blockAt)
+            m_gate.acquire();
+        m_reads++;
+        if (m_next >= m_end)
+            return AVERROR_EOF;
+        if (av_new_packet(Packet, m_size) < 0)
+            return AVERROR(ENOMEM);
+        if (m_thread && (m_next == m_changeAt))
+        {
+            m_streams = std::max(m_streams - m_removeStreams, 1);
+            m_thread->StreamsChanged();
+        }
+        Packet->pts = m_next;
+        Packet->stream_index = static_cast<int>(m_next % m_streams);
+        m_next++;
+        return 0;
+    }
+
+    // Wait for the demux thread to read Count packets, then make sure it stops.
+    bool WaitForReads(int Count) const
+    {
+        for (int i = 0; (i < 500) && (m_reads < Count); ++i)
+            std::this_thread::sleep_for(10ms);
+        std::this_thread::sleep_for(50ms);
+        return m_reads == Count;
+    }
+
+    std::atomic_int  m_reads    { 0 };
+    int64_t          m_next     { 0 };
+    int64_t          m_end      { 1000000 };
+    int              m_size     { 188 };
+    int64_t          m_changeAt { -1 };
+    int              m_streams  { 1 };
+    int              m_removeStreams { 0 };
+    int64_t          m_blockAt  { -1 };
+    QSemaphore       m_gate;
+    MythDemuxThread* m_thread   { nullptr };
+};
+
+static int64_t NextPts(MythDemuxThread& Thread, bool* Changed = nullptr)
+{
+    AVPacket* packet = av_packet_alloc();
+    bool changed = false;
+    int64_t result = Thread.GetPacket(packet, changed);
+    if (result == 0)
+        result = packet->pts;
+    av_packet_free(&packet);
+    if (Changed)
+        *Changed = changed;
+    return result;
+}
+
+void TestDemuxThread::test_order(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    demuxer.m_end = 50;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); });
+    thread.start();
+
+    for (int64_t i = 0; i < 50; ++i)
+        QCOMPARE(NextPts(thread), i);
+    QCOMPARE(NextPts(thread), int64_t(AVERROR_EOF));
+
+    // Errors are not sticky. Once one has been returned, the demuxer is tried again.
+    QVERIFY(demuxer.WaitForReads(52));
+    QCOMPARE(NextPts(thread), int64_t(AVERROR_EOF));
+    QVERIFY(demuxer.WaitForReads(53));
+}
+
+void TestDemuxThread::test_maxpackets(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); }, 10);
+    thread.start();
+
+    QCOMPARE(NextPts(thread), int64_t(0));
+    QVERIFY(demuxer.WaitForReads(11));
+    QVERIFY(thread.GetStatsString().startsWith("10 pkts"));
+
+    QCOMPARE(NextPts(thread), int64_t(1));
+    QCOMPARE(NextPts(thread), int64_t(2));
+    QVERIFY(demuxer.WaitForReads(13));
+}
+
+void TestDemuxThread::test_maxbytes(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    demuxer.m_size = 1000;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); },
+                           MythDemuxThread::kDefaultMaxPackets, 4096);
+    thread.start();
+
+    // Reading stops once the limit is reached, so the last packet may cross it
+    QCOMPARE(NextPts(thread), int64_t(0));
+    QVERIFY(demuxer.WaitForReads(6));
+    QCOMPARE(NextPts(thread), int64_t(1));
+    QVERIFY(demuxer.WaitForReads(7));
+}
+
+void TestDemuxThread::test_pause(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); }, 5);
+    thread.start();
+
+    QCOMPARE(NextPts(thread), int64_t(0));
+    QVERIFY(demuxer.WaitForReads(6));
+    thread.Pause();
+
+    // Queued packets survive a pause, and reading resumes with the next request
+    for (int64_t i = 1; i < 6; ++i)
+        QCOMPARE(NextPts(thread), i);
+    QCOMPARE(NextPts(thread), int64_t(6));
+    QVERIFY(demuxer.WaitForReads(12));
+}
+
+void TestDemuxThread::test_flush(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); }, 20);
+    thread.start();
+
+    for (int64_t i = 0; i < 3; ++i)
+        QCOMPARE(NextPts(thread), i);
+
+    // Flush while holding the demuxer lock
+    lock.lock();
+    thread.Flush();
+    demuxer.m_next = 1000;
+    lock.unlock();
+    QVERIFY(thread.GetStatsString().startsWith("0 pkts"));
+
+    QCOMPARE(NextPts(thread), int64_t(1000));
+    QCOMPARE(NextPts(thread), int64_t(1001));
+
+    // And without it
+    thread.Flush();
+    demuxer.m_next = 2000;
+    QCOMPARE(NextPts(thread), int64_t(2000));
+}
+
+void TestDemuxThread::test_streamchange(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    demuxer.m_changeAt = 3;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); });
+    demuxer.m_thread = &thread;
+    thread.start();
+
+    bool changed = true;
+    QCOMPARE(NextPts(thread, &changed), int64_t(0));
+    QVERIFY(!changed);
+
+    // Nothing is read beyond the packet that changed the streams, and
+    // what was read before it is dropped...
+    QVERIFY(demuxer.WaitForReads(4));
+    QCOMPARE(NextPts(thread, &changed), int64_t(3));
+    QVERIFY(changed);
+    QVERIFY(demuxer.WaitForReads(4));
+
+    // ...until the decoder has reset and asks for more
+    thread.Flush();
+    QCOMPARE(NextPts(thread, &changed), int64_t(4));
+    QVERIFY(!changed);
+}
+
+void TestDemuxThread::test_streamremoved(void)
+{
+    QMutex lock;
+    FakeDemuxer demuxer;
+    demuxer.m_streams = 3;
+    demuxer.m_removeStreams = 1;
+    demuxer.m_changeAt = 20;
+    MythDemuxThread thread(&lock, [&](AVPacket* Packet) { return demuxer.Read(Packet); }, 10);
+    demuxer.m_thread = &thread;
+    thread.start();
+
+    QCOMPARE(NextPts(thread), int64_t(0));
+    QVERIFY(demuxer.WaitForReads(11));
+
+    // Nothing is read while the consumer holds the lock to use the streams
+    lock.lock();
+    QCOMPARE(NextPts(thread), int64_t(1));
+    std::this_thread::sleep_for(50ms);
+    QCOMPARE(demuxer.m_reads.load(), 11);
+    QCOMPARE(demuxer.m_streams, 3);
+    lock.unlock();
+    QVERIFY(demuxer.WaitForReads(12));
+
+    // The third stream goes away while reading packet 20. The packets
+    // queued ahead of it, some of them for that stream, are dropped.
+    for (int64_t i = 2; i < 11; ++i)
+        QCOMPARE(NextPts(thread), i);
+    QVERIFY(demuxer.WaitForReads(21));
+    QCOMPARE(demuxer.m_streams, 2);
+
+    bool changed = false;
+    AVPacket* packet = av_packet_alloc();
+    QCOMPARE(thread.GetPacket(packet, changed), 0);
+    QVERIFY(changed);
+    QCOMPARE(packet->pts, int64_t(20));
+    QCOMPARE(packet->stream_index, 0);
+
+    thread.Flush();
+    for (int64_t i = 21; i < 31; ++i)
+    {
+        QCOMPARE(thread.GetPacket(packet, changed), 0);
+        QVERIFY(!changed);
+        QCOMPARE(packet->pts, i);
+        QVERIFY(packet->stream_index < demuxer.m_streams);
+    }
+    av_packet_free(&packet);
+}
+
+void TestDemuxThread::test_slowread(void)
+{
+    QMutex demuxLock;
+    QMutex decodeLock;
+    FakeDemuxer demuxer;
+    demuxer.m_blockAt = 5;
+    MythDemuxThread thread(&demuxLock, [&](AVPacket* Packet) { return demuxer.Read(Packet); });
+    thread.start();
+
+    QCOMPARE(NextPts(thread), int64_t(0));
+    QVERIFY(demuxer.WaitForReads(5));
+
+    // The read of packet 5 is stuck, as on slow storage. Decoding, which
+    // holds its own lock, carries on with what has been queued.
+    for (int64_t i = 1; i < 5; ++i)
+    {
+        QVERIFY(decodeLock.tryLock(1000));
+        QCOMPARE(NextPts(thread), i);
+        decodeLock.unlock();
+    }
+    QCOMPARE(demuxer.m_reads.load(), 5);
+
+    demuxer.m_gate.release();
+    QCOMPARE(NextPts(thread), int64_t(5));
+}
+
+QTEST_APPLESS_MAIN(TestDemuxThread)
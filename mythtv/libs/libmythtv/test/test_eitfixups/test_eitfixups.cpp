@@ -18,6 +18,7 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <array>
 #include <cstdio>
 #include "test_eitfixups.h"
 #include "eitfixup.h"
@@ -822,4 +823,87 @@ void TestEITFixups::test64BitEnum(void)
     QVERIFY(1<<31 & 1ULL<<32);
 }
 
+void TestEITFixups::testUKCachedFixups(void)
+{
+    // The second, identical event is served from the FixUK() result cache
+    // and must come out exactly as the first one did.
+    EITFixUp fixup;
+
+    DBEventEIT *first = SimpleDBEventEIT (EITFixUp::kFixUK,
+                                         "Rio Bravo",
+                                         "",
+                                         "Western starring John Wayne and Dean Martin. A sheriff holds a killer in jail. (1959) [AD,S]");
+    DBEventEIT *second = SimpleDBEventEIT (EITFixUp::kFixUK,
+                                          first->m_title,
+                                          first->m_subtitle,
+                                          first->m_description);
+
+    fixup.Fix(*first);
+    fixup.Fix(*second);
+    PRINT_EVENT(*second);
+
+    QCOMPARE(second->m_title,        first->m_title);
+    QCOMPARE(second->m_subtitle,     first->m_subtitle);
+    QCOMPARE(second->m_description,  first->m_description);
+    QCOMPARE(second->m_airdate,      (uint16_t)1959U);
+    QCOMPARE(second->m_airdate,      first->m_airdate);
+    QCOMPARE(second->m_audioProps,   first->m_audioProps);
+    QCOMPARE(second->m_subtitleType, first->m_subtitleType);
+    QVERIFY(first->HasCredits());
+    QVERIFY(second->HasCredits());
+    QCOMPARE(second->m_credits->size(), first->m_credits->size());
+
+    delete first;
+    delete second;
+}
+
+void TestEITFixups::benchmarkUKFixups_data(void)
+{
+    QTest::addColumn<bool>("cached");
+    QTest::newRow("first sight") << false;
+    QTest::newRow("repeats")     << true;
+}
+
+void TestEITFixups::benchmarkUKFixups(void)
+{
+    QFETCH(bool, cached);
+
+    // Titles and descriptions from the UK tests above.
+    static const std::array<std::array<const char *, 2>, 7> kEvents
+    {{
+        { "Book of the Week",
+          "Girl in the Dark: Anna Lyndsey's account of finding light in the darkness after illness changed her life. 3/5. A Descent into Darkness: The disquieting persistence of the light." },
+        { "Hoarders",
+          "Fascinating series chronicling the lives of serial hoarders. Often facing loss of their children, career, or divorce, can people with this disorder be helped? S3, Ep1" },
+        { "Yu-Gi-Oh! ZEXAL",
+          "It's a duelling disaster for Yuma when Astral, a mysterious visitor from another galaxy, suddenly appears, putting his duel with Shark in serious jeopardy! S01 Ep02 (Part 2 of 2)" },
+        { "The World at War",
+          "12/26. Whirlwind: Acclaimed documentary series about World War II. This episode focuses on the Allied bombing campaign which inflicted grievous damage upon Germany, both day and night. [S]" },
+        { "Suffragettes Forever! The Story of...",
+          "...Women and Power. 2/3. Documentary series presented by Amanda Vickery. During Victoria's reign extraordinary women gradually changed the lives and opportunities of their sex. [HD] [AD,S]" },
+        { "Brooklyn's Finest",
+          "Three unconnected Brooklyn cops wind up at the same deadly location. Contains very strong language, sexual content and some violence.  Also in HD. [2009] [AD,S]" },
+        { "Channel 4 News",
+          "Includes sport and weather." },
+    }};
+
+    const QDateTime start = QDateTime::fromString("2015-02-28T19:40:00Z", Qt::ISODate);
+    const QDateTime end   = QDateTime::fromString("2015-02-28T20:00:00Z", Qt::ISODate);
+    auto *fixup = new EITFixUp();
+    QBENCHMARK {
+        if (!cached)
+        {
+            delete fixup;
+            fixup = new EITFixUp();
+        }
+        for (const auto & ev : kEvents)
+        {
+            // No kFixGenericDVB, that would time the database lookups.
+            DBEventEIT event(1, ev[0], ev[1], start, end, EITFixUp::kFixUK, SUB_UNKNOWN, AUD_STEREO, VID_UNKNOWN);
+            fixup->Fix(event);
+        }
+    }
+    delete fixup;
+}
+
 QTEST_APPLESS_MAIN(TestEITFixups)
@@ -47,6 +47,9 @@ class TestEITFixups : public QObject
     static void testDeDisneyChannel(void);
     static void testATV(void);
     static void test64BitEnum(void);
+    static void testUKCachedFixups(void);
+    static void benchmarkUKFixups_data(void);
+    static void benchmarkUKFixups(void);
 
   private:
     static DBEventEIT *SimpleDBEventEIT (FixupValue fix, const QString& title, const QString& subtitle, const QString& description);
@@ -0,0 +1,179 @@
+/*
+ *  Class TestFramePool
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_framepool.h"
+#include "mythframe.h"
+#include "mythframepool.h"
+
+extern "C" {
+#include "libavutil/mem.h"
+}
+
+void TestFramePool::test_sizeclass_data(void)
+{
+    QTest::addColumn<size_t>("Size");
+    QTest::addColumn<size_t>("Class");
+    QTest::newRow("One")        << size_t(1)       << size_t(4096);
+    QTest::newRow("Page")       << size_t(4096)    << size_t(4096);
+    QTest::newRow("Page+1")     << size_t(4097)    << size_t(8192);
+    QTest::newRow("1MiB")       << size_t(1 << 20) << size_t(1 << 20);
+    QTest::newRow("1MiB+1")     << size_t((1 << 20) + 1) << size_t((1 << 20) + (1 << 17));
+    // 720x576 and 1920x1088 YV12 with MythTV's alignment
+    QTest::newRow("SD")         << MythVideoFrame::GetBufferSize(FMT_YV12, 720, 576)
+                                << size_t(720896);
+    QTest::newRow("HD")         << MythVideoFrame::GetBufferSize(FMT_YV12, 1920, 1088)
+                                << size_t(3145728);
+}
+
+void TestFramePool::test_sizeclass(void)
+{
+    QFETCH(size_t, Size);
+    QFETCH(size_t, Class);
+    size_t sizeclass = MythFramePool::SizeClass(Size);
+    QCOMPARE(sizeclass, Class);
+    QVERIFY(sizeclass >= Size);
+    // No more than one eighth wasted once classes are wider than a page
+    if (Size >= 32768)
+        QVERIFY(sizeclass - Size <= Size / 8);
+}
+
+void TestFramePool::test_reuse(void)
+{
+    MythFramePool pool(16ULL << 20);
+    pool.AddUser();
+
+    uint8_t* first = pool.Get(1000000);
+    QVERIFY(first != nullptr);
+    pool.Release(first);
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(1));
+
+    // A slightly different size in the same class gets the same buffer back
+    uint8_t* second = pool.Get(1000000 + 4000);
+    QCOMPARE(second, first);
+    MythFramePool::Stats stats = pool.GetStats();
+    QCOMPARE(stats.m_hits, uint64_t(1));
+    QCOMPARE(stats.m_misses, uint64_t(1));
+    QCOMPARE(stats.m_cachedCount, size_t(0));
+    QCOMPARE(stats.m_inUse, MythFramePool::SizeClass(1000000));
+
+    // A different class does not
+    uint8_t* third = pool.Get(3000000);
+    QVERIFY(third != second);
+    pool.Release(second);
+    pool.Release(third);
+    QCOMPARE(pool.GetStats().m_inUse, size_t(0));
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(2));
+
+    // Releasing the last user frees everything
+    pool.RemoveUser();
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(0));
+    QCOMPARE(pool.GetStats().m_cached, size_t(0));
+}
+
+void TestFramePool::test_nousers(void)
+{
+    MythFramePool pool;
+    uint8_t* buffer = pool.Get(65536);
+    QVERIFY(buffer != nullptr);
+    pool.Release(buffer);
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(0));
+    QCOMPARE(pool.GetStats().m_inUse, size_t(0));
+}
+
+void TestFramePool::test_capacity(void)
+{
+    static constexpr size_t kSize = 1 << 20;
+    MythFramePool pool(3 * kSize);
+    pool.AddUser();
+
+    std::vector<uint8_t*> buffers;
+    for (int i = 0; i < 5; ++i)
+        buffers.push_back(pool.Get(kSize));
+    for (auto * buffer : buffers)
+        pool.Release(buffer);
+
+    // The two released first are evicted
+    MythFramePool::Stats stats = pool.GetStats();
+    QCOMPARE(stats.m_cachedCount, size_t(3));
+    QCOMPARE(stats.m_cached, 3 * kSize);
+    QCOMPARE(stats.m_evictions, uint64_t(2));
+
+    // and the most recently released comes back first
+    uint8_t* buffer = pool.Get(kSize);
+    QCOMPARE(buffer, buffers[4]);
+    pool.Release(buffer);
+
+    // Shrinking the capacity frees the oldest
+    pool.SetCapacity(kSize);
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(1));
+    buffer = pool.Get(kSize);
+    QCOMPARE(buffer, buffers[4]);
+    pool.Release(buffer);
+
+    // Buffers larger than the capacity are never kept
+    pool.Release(pool.Get(2 * kSize));
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(1));
+
+    pool.RemoveUser();
+}
+
+void TestFramePool::test_foreign(void)
+{
+    MythFramePool pool;
+    pool.AddUser();
+    auto * buffer = static_cast<uint8_t*>(av_malloc(1 << 20));
+    pool.Release(buffer);
+    QCOMPARE(pool.GetStats().m_cachedCount, size_t(0));
+    pool.RemoveUser();
+}
+
+/// Changing resolution and back reuses the first set of buffers.
+void TestFramePool::test_frames(void)
+{
+    MythFramePool* pool = MythFramePool::Global();
+    pool->AddUser();
+    pool->Flush();
+    MythFramePool::Stats before = pool->GetStats();
+
+    std::vector<MythVideoFrame> frames(8);
+    std::vector<uint8_t*> sd;
+    for (auto & frame : frames)
+    {
+        frame.Init(FMT_YV12, 720, 576);
+        QVERIFY(frame.m_buffer != nullptr);
+        sd.push_back(frame.m_buffer);
+    }
+    for (auto & frame : frames)
+        frame.Init(FMT_YV12, 1920, 1080);
+    for (auto & frame : frames)
+    {
+        frame.Init(FMT_YV12, 720, 576);
+        QVERIFY(std::find(sd.cbegin(), sd.cend(), frame.m_buffer) != sd.cend());
+    }
+
+    MythFramePool::Stats after = pool->GetStats();
+    QCOMPARE(after.m_misses - before.m_misses, uint64_t(16));
+    QCOMPARE(after.m_hits - before.m_hits, uint64_t(8));
+
+    frames.clear();
+    pool->RemoveUser();
+    QCOMPARE(pool->GetStats().m_cachedCount, size_t(0));
+    QCOMPARE(pool->GetStats().m_inUse, size_t(0));
+}
+
+QTEST_APPLESS_MAIN(TestFramePool)
@@ -0,0 +1,3 @@
+#include "test_hlsreader.h"
+
+QTEST_GUILESS_MAIN(TestHLSReader)
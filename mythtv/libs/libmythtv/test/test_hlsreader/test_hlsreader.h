@@ -0,0 +1,265 @@
+/*
+ *  Class TestHLSReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include "recorders/HLS/HLSReader.h"
+#include "recorders/HLS/HLSSegmentPrefetcher.h"
+
+/**
+ * Serves canned files over HTTP from its own thread.  Each file can be
+ * given a delay before it is sent, to stand in for a slow CDN.
+ */
+class CannedHTTPServer : public QTcpServer
+{
+    Q_OBJECT
+
+  public:
+    struct File
+    {
+        QByteArray                m_data;
+        std::chrono::milliseconds m_delay {0ms};
+    };
+
+    void AddFile(const QString &path, const QByteArray &data,
+                 std::chrono::milliseconds delay = 0ms)
+    {
+        m_files[path] = { data, delay };
+    }
+
+    int MaxConcurrent(void) const { return m_maxConcurrent; }
+    int Requests(void) const { return m_requests; }
+
+  public slots:
+    bool Listen(void) { return listen(QHostAddress::LocalHost); }
+
+  protected:
+    void incomingConnection(qintptr descriptor) override // QTcpServer
+    {
+        auto *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(descriptor);
+        connect(socket, &QTcpSocket::readyRead, this,
+                [this, socket]() { HandleRequest(socket); });
+        connect(socket, &QTcpSocket::disconnected,
+                socket, &QObject::deleteLater);
+    }
+
+  private:
+    void HandleRequest(QTcpSocket *socket)
+    {
+        QByteArray &request = m_pending[socket];
+        request += socket->readAll();
+        if (!request.contains("\r\n\r\n"))
+            return;
+
+        QString path = QString::fromLatin1(request.split(' ').value(1));
+        m_pending.remove(socket);
+        m_requests++;
+        m_concurrent++;
+        m_maxConcurrent = std::max(m_maxConcurrent, m_concurrent);
+
+        auto it = m_files.constFind(path);
+        std::chrono::milliseconds delay =
+            (it == m_files.constEnd()) ? 0ms : it->m_delay;
+        QTimer::singleShot(delay, socket, [this, socket, it]()
+        {
+            m_concurrent--;
+            if (it == m_files.constEnd())
+            {
+                socket->write("HTTP/1.1 404 Not Found\r\n"
+                              "Content-Length: 0\r\n"
+                              "Connection: close\r\n\r\n");
+            }
+            else
+            {
+                socket->write(QString("HTTP/1.1 200 OK\r\n"
+                                      "Content-Length: %1\r\n"
+                                      "Connection: close\r\n\r\n")
+                              .arg(it->m_data.size()).toLatin1());
+                socket->write(it->m_data);
+            }
+            socket->disconnectFromHost();
+        });
+    }
+
+    QMap<QString, File>             m_files;
+    QMap<QTcpSocket*, QByteArray>   m_pending;
+    int                             m_concurrent    {0};
+    int                             m_maxConcurrent {0};
+    int                             m_requests      {0};
+};
+
+class TestHLSReader : public QObject
+{
+    Q_OBJECT
+
+  private:
+    static constexpr int kSegments { 8 };
+
+    CannedHTTPServer *m_server {nullptr};
+    QThread          *m_thread {nullptr};
+    QByteArray        m_expected;
+
+    QString Url(const QString &path) const
+    {
+        return QString("http://127.0.0.1:%1%2")
+            .arg(m_server->serverPort()).arg(path);
+    }
+
+    static QByteArray SegmentData(int seq)
+    {
+        // Segments of different sizes, each with recognisable content
+        return QByteArray(4000 + (seq * 188), static_cast<char>('a' + seq));
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        m_server = new CannedHTTPServer;
+
+        QString playlist = "#EXTM3U\n"
+                           "#EXT-X-VERSION:3\n"
+                           "#EXT-X-TARGETDURATION:2\n"
+                           "#EXT-X-MEDIA-SEQUENCE:100\n";
+        for (int i = 0; i < kSegments; ++i)
+        {
+            QString name = QString("/seg%1.ts").arg(100 + i);
+            playlist += QString("#EXTINF:2,\n%1\n").arg(name.mid(1));
+            // Early segments are the slowest, so with more than one
+            // connection the later ones finish first.
+            m_server->AddFile(name, SegmentData(i),
+                              std::chrono::milliseconds((kSegments - i) * 60));
+            m_expected += SegmentData(i);
+        }
+        playlist += "#EXT-X-ENDLIST\n";
+        m_server->AddFile("/live.m3u8", playlist.toLatin1());
+
+        m_thread = new QThread;
+        m_server->moveToThread(m_thread);
+        m_thread->start();
+
+        bool listening = false;
+        QMetaObject::invokeMethod(m_server, "Listen",
+                                  Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, listening));
+        QVERIFY(listening);
+    }
+
+    void cleanupTestCase(void)
+    {
+        m_thread->quit();
+        m_thread->wait();
+        delete m_server;
+        delete m_thread;
+    }
+
+    /**
+     * Segments must come out in playlist order, even though they are
+     * downloaded side by side and finish in reverse order.
+     */
+    void PrefetchInOrder(void)
+    {
+        HLSSegmentPrefetcher prefetcher(3);
+
+        QVector<HLSRecSegment> segments;
+        for (int i = 0; i < kSegments; ++i)
+        {
+            segments.push_back(HLSRecSegment(100 + i, 2s, "",
+                               QUrl(Url(QString("/seg%1.ts").arg(100 + i)))));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QByteArray received;
+        while (!segments.empty())
+        {
+            prefetcher.Prefetch(segments);
+
+            QByteArray buffer;
+            std::chrono::milliseconds latency = 0ms;
+            QString error;
+            QVERIFY2(prefetcher.Take(segments.front(), buffer, latency, error),
+                     qPrintable(error));
+            QVERIFY(latency > 0ms);
+            received += buffer;
+            segments.pop_front();
+        }
+
+        QCOMPARE(received, m_expected);
+        QVERIFY(m_server->MaxConcurrent() > 1);
+
+        // Sequential downloads would take the sum of all the delays
+        qint64 sequential = 0;
+        for (int i = 0; i < kSegments; ++i)
+            sequential += (kSegments - i) * 60;
+        QVERIFY(timer.elapsed() < sequential);
+
+        HLSSegmentPrefetcher::Stats stats = prefetcher.GetStats();
+        QCOMPARE(stats.m_segments, (uint64_t)kSegments);
+        QCOMPARE(stats.m_failures, (uint64_t)0);
+        QVERIFY(stats.m_max >= std::chrono::milliseconds(kSegments * 60));
+        QVERIFY(prefetcher.TakeThroughput() > 0);
+    }
+
+    /**
+     * A missing segment is reported as a failure.
+     */
+    void PrefetchFailure(void)
+    {
+        HLSSegmentPrefetcher prefetcher(2);
+        HLSRecSegment missing(1, 2s, "", QUrl(Url("/missing.ts")));
+
+        QByteArray buffer;
+        std::chrono::milliseconds latency = 0ms;
+        QString error;
+        QVERIFY(!prefetcher.Take(missing, buffer, latency, error));
+        QVERIFY(!error.isEmpty());
+        QCOMPARE(prefetcher.GetStats().m_failures, (uint64_t)1);
+    }
+
+    /**
+     * Record the whole canned playlist through HLSReader.
+     */
+    void ReaderEndToEnd(void)
+    {
+        HLSReader reader;
+        reader.SetPrefetchCount(3);
+        reader.Throttle(false);
+        QVERIFY(reader.Open(Url("/live.m3u8"), 0));
+
+        QByteArray received;
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<uint8_t> buffer(64 * 1024);
+        while (received.size() < m_expected.size() && timer.elapsed() < 20000)
+        {
+            int len = reader.Read(buffer.data(), buffer.size());
+            if (len > 0)
+                received.append(reinterpret_cast<char*>(buffer.data()), len);
+            else
+                QThread::msleep(20);
+        }
+        reader.Close();
+
+        QCOMPARE(received, m_expected);
+        QCOMPARE(reader.PrefetchCount(), 3);
+    }
+};
@@ -18,13 +18,62 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include <QtTest/QtTest>
 
 #include "iptvtuningdata.h"
 #include "channelscan/iptvchannelfetcher.h"
 #include "recorders/rtp/rtpdatapacket.h"
+#include "recorders/rtp/rtppacketbuffer.h"
 #include "recorders/rtp/rtptsdatapacket.h"
 
+/**
+ * Builds the arrival order of a synthetic RTP stream of count packets.
+ * Packets are shuffled within windows of jitter packets and each one
+ * is lost with a probability of loss_pct percent, in bursts of burst.
+ */
+static std::vector<uint> RTPArrivalOrder(uint count, uint jitter,
+                                         uint loss_pct, uint burst)
+{
+    std::mt19937 rng(count); // NOLINT(cert-msc51-cpp) repeatable on purpose
+    std::vector<uint> order;
+    order.reserve(count);
+    for (uint i = 0; i < count; i++)
+        order.push_back(i);
+    for (uint i = 0; jitter > 1 && i + jitter <= count; i += jitter)
+        std::shuffle(order.begin() + i, order.begin() + i + jitter, rng);
+
+    std::vector<uint> arrived;
+    arrived.reserve(count);
+    for (uint i = 0; i < count; i++)
+    {
+        if ((rng() % 100) < loss_pct)
+            i += burst - 1;
+        else
+            arrived.push_back(order[i]);
+    }
+    return arrived;
+}
+
+/**
+ * Pushes an RTP packet carrying seven TS packets with sequence number
+ * seq into buffer, using a packet from the buffer's pool.
+ */
+static void PushRTPPacket(RTPPacketBuffer &buffer, uint seq)
+{
+    UDPPacket packet(buffer.GetEmptyPacket());
+    QByteArray &data = packet.GetDataReference();
+    data.resize(12 + (7 * 188));
+    data[0] = static_cast<char>(0x80);
+    data[1] = static_cast<char>(RTPDataPacket::kPayLoadTypeTS);
+    data[2] = static_cast<char>((seq >> 8) & 0xFF);
+    data[3] = static_cast<char>(seq & 0xFF);
+    buffer.PushDataPacket(packet);
+}
+
 class TestIPTVRecorder: public QObject
 {
     Q_OBJECT
@@ -486,4 +535,105 @@ class TestIPTVRecorder: public QObject
         QCOMPARE (ts_packet2.GetTSData()[0], (uint8_t)0x47);
         QCOMPARE (ts_packet2.GetTSDataSize(), (unsigned int)7 * 188);
     }
+
+    /**
+     * Replay a jittered, lossy RTP stream starting just before the
+     * sequence number wraps and check that it comes out in order.
+     */
+    static void RTPReorder(void)
+    {
+        const uint kCount = 20000;
+        const uint kStart = 65000;
+        std::vector<uint> arrived = RTPArrivalOrder(kCount, 8, 1, 1);
+        // Don't let the first packet be a late one
+        std::sort(arrived.begin(), arrived.begin() + 8);
+
+        RTPPacketBuffer buffer(0);
+        uint delivered = 0;
+        uint64_t last = 0;
+        for (uint i : arrived)
+        {
+            PushRTPPacket(buffer, (kStart + i) & 0xFFFF);
+            while (buffer.HasAvailablePacket())
+            {
+                RTPDataPacket packet(buffer.PopDataPacket());
+                QVERIFY(packet.IsValid());
+                uint64_t seq = packet.GetSequenceNumber();
+                if (seq < (kStart & 0xFFFF))
+                    seq += 1ULL<<16;
+                if (delivered)
+                    QVERIFY(seq > last);
+                last = seq;
+                delivered++;
+                buffer.FreePacket(packet);
+            }
+        }
+
+        QCOMPARE(buffer.GetLatePacketCount(), (uint64_t)0);
+        QVERIFY(arrived.size() - delivered <= RTPPacketBuffer::kMaxHoleWait);
+        QVERIFY(buffer.GetLostPacketCount() <= kCount - arrived.size());
+        QCOMPARE(buffer.GetPoolMissCount(), (uint64_t)0);
+    }
+
+    /**
+     * Check that duplicates are dropped and that a sender restarting
+     * with a new sequence number is followed.
+     */
+    static void RTPReorderRestart(void)
+    {
+        RTPPacketBuffer buffer(0);
+        for (uint seq = 30000; seq < 30200; seq++)
+            PushRTPPacket(buffer, seq);
+        PushRTPPacket(buffer, 30100);
+        QCOMPARE(buffer.GetLatePacketCount(), (uint64_t)1);
+
+        for (uint seq = 1000; seq < 1200; seq++)
+            PushRTPPacket(buffer, seq);
+        QCOMPARE(buffer.GetLatePacketCount(), (uint64_t)2);
+
+        uint delivered = 0;
+        while (buffer.HasAvailablePacket())
+        {
+            buffer.FreePacket(buffer.PopDataPacket());
+            delivered++;
+        }
+        QCOMPARE(delivered, 200U + 199U);
+        QCOMPARE(buffer.GetLostPacketCount(), (uint64_t)0);
+    }
+
+    static void RTPReorderBenchmark_data(void)
+    {
+        QTest::addColumn<uint>("jitter");
+        QTest::addColumn<uint>("loss");
+        QTest::addColumn<uint>("burst");
+        QTest::newRow("in order")      <<  1U << 0U <<  1U;
+        QTest::newRow("jitter")        << 16U << 0U <<  1U;
+        QTest::newRow("jitter 1% loss") << 16U << 1U <<  1U;
+        QTest::newRow("burst loss")    << 16U << 1U << 20U;
+    }
+
+    /**
+     * Measure reordering throughput over a synthetic stream.
+     */
+    static void RTPReorderBenchmark(void)
+    {
+        QFETCH(uint, jitter);
+        QFETCH(uint, loss);
+        QFETCH(uint, burst);
+        std::vector<uint> arrived = RTPArrivalOrder(100000, jitter, loss, burst);
+
+        RTPPacketBuffer buffer(0);
+        uint seq = 0;
+        QBENCHMARK
+        {
+            for (uint i : arrived)
+            {
+                PushRTPPacket(buffer, (seq + i) & 0xFFFF);
+                while (buffer.HasAvailablePacket())
+                    buffer.FreePacket(buffer.PopDataPacket());
+            }
+            seq += 100000;
+        }
+        QCOMPARE(buffer.GetPoolMissCount(), (uint64_t)0);
+    }
 };
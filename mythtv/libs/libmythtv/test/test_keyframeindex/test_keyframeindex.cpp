@@ -0,0 +1,418 @@
+/*
+ *  Class TestKeyframeIndex
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QTemporaryDir>
+
+#include "test_keyframeindex.h"
+#include "keyframeindex.h"
+#include "keyframeindexbuilder.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+void TestKeyframeIndex::test_append(void)
+{
+    KeyframeIndex index;
+    QVERIFY(index.empty());
+    QVERIFY(index.Append(0, 0, 0));
+    QVERIFY(index.Append(12, 18800, 480));
+    QVERIFY(index.Append(24, 37600));
+
+    // Keyframes must be added in order, and only once
+    QVERIFY(!index.Append(24, 40000, 960));
+    QVERIFY(!index.Append(6, 9400, 240));
+
+    QCOMPARE(index.size(), (size_t)3);
+    QCOMPARE(index.back().m_offset, (int64_t)37600);
+    QCOMPARE(index.back().m_duration, (int64_t)-1);
+    QVERIFY(index.Contains(12));
+    QVERIFY(!index.Contains(13));
+
+    index.Clear();
+    QVERIFY(index.empty());
+    QVERIFY(index.Append(6, 9400, 240));
+}
+
+void TestKeyframeIndex::test_lowerbound(void)
+{
+    KeyframeIndex index;
+    for (int64_t i = 1; i <= 1000; i++)
+        index.Append(i * 15, i * 188 * 100, i * 500);
+
+    QCOMPARE(index.LowerBound(0), (size_t)0);
+    QCOMPARE(index.LowerBound(15), (size_t)0);
+    QCOMPARE(index.LowerBound(16), (size_t)1);
+    QCOMPARE(index.LowerBound(7500), (size_t)499);
+    QCOMPARE(index.LowerBound(15000), (size_t)999);
+    QCOMPARE(index.LowerBound(15001), (size_t)1000);
+}
+
+/**
+ * A reader must follow the sidecar as the recorder appends to it.
+ */
+void TestKeyframeIndex::test_sidecar(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString filename = KeyframeIndex::SidecarFilename(dir.filePath("1234.ts"));
+    QCOMPARE(filename, dir.filePath("1234.ts.kfidx"));
+
+    KeyframeIndex index;
+    QVERIFY(index.OpenSidecar(filename, MARK_GOP_BYFRAME));
+    QVERIFY(index.HasSidecar());
+
+    KeyframeIndexReader reader(filename);
+    QVERIFY(reader.Refresh());
+    QCOMPARE(reader.size(), (size_t)0);
+    QCOMPARE(reader.Type(), MARK_GOP_BYFRAME);
+
+    for (int64_t i = 0; i < 100; i++)
+        index.Append(i * 12, i * 188 * 50, i * 480);
+    QVERIFY(reader.Refresh());
+    QCOMPARE(reader.size(), (size_t)100);
+
+    for (int64_t i = 100; i < 250; i++)
+        index.Append(i * 12, i * 188 * 50, i * 480);
+    QVERIFY(reader.Refresh());
+    QCOMPARE(reader.size(), (size_t)250);
+
+    for (size_t i = 0; i < reader.size(); i++)
+    {
+        QCOMPARE(reader[i].m_frame,    index[i].m_frame);
+        QCOMPARE(reader[i].m_offset,   index[i].m_offset);
+        QCOMPARE(reader[i].m_duration, index[i].m_duration);
+    }
+    QCOMPARE(reader.LowerBound(1201), (size_t)101);
+
+    // Closing leaves the file for later readers
+    index.CloseSidecar();
+    QVERIFY(!index.HasSidecar());
+    KeyframeIndexReader later(filename);
+    QVERIFY(later.Refresh());
+    QCOMPARE(later.size(), (size_t)250);
+}
+
+/**
+ * Opening the sidecar late writes out what is already in the index.
+ */
+void TestKeyframeIndex::test_sidecar_reopen(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString filename = dir.filePath("1234.nuv.kfidx");
+
+    KeyframeIndex index;
+    index.Append(0, 0);
+    index.Append(30, 1000);
+    QVERIFY(index.OpenSidecar(filename, MARK_KEYFRAME));
+    index.Append(60, 2000);
+
+    KeyframeIndexReader reader(filename);
+    QVERIFY(reader.Refresh());
+    QCOMPARE(reader.Type(), MARK_KEYFRAME);
+    QCOMPARE(reader.size(), (size_t)3);
+    QCOMPARE(reader[1].m_offset, (int64_t)1000);
+    QCOMPARE(reader[2].m_frame, (int64_t)60);
+
+    // Clearing starts a new file, which truncates the old one
+    index.Clear();
+    QVERIFY(index.OpenSidecar(filename, MARK_KEYFRAME));
+    KeyframeIndexReader fresh(filename);
+    QVERIFY(fresh.Refresh());
+    QCOMPARE(fresh.size(), (size_t)0);
+}
+
+void TestKeyframeIndex::test_sidecar_invalid(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    KeyframeIndexReader missing(dir.filePath("missing.kfidx"));
+    QVERIFY(!missing.Refresh());
+    QCOMPARE(missing.size(), (size_t)0);
+
+    QFile file(dir.filePath("garbage.kfidx"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(64, 'x'));
+    file.close();
+    KeyframeIndexReader garbage(file.fileName());
+    QVERIFY(!garbage.Refresh());
+    QCOMPARE(garbage.size(), (size_t)0);
+}
+
+void TestKeyframeIndex::test_cached(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QFile media(dir.filePath("video.ts"));
+    QVERIFY(media.open(QIODevice::WriteOnly));
+    media.write(QByteArray(188, 'G'));
+    media.close();
+    QVERIFY(KeyframeIndexBuilder::CachedIndex(media.fileName()).isEmpty());
+
+    KeyframeIndex index;
+    QVERIFY(index.Append(0, 0, 0));
+    QVERIFY(index.Append(12, 18800, 480));
+    QString saved = KeyframeIndexBuilder::SaveIndex(media.fileName(), index);
+    QCOMPARE(saved, KeyframeIndex::SidecarFilename(media.fileName()));
+    QCOMPARE(KeyframeIndexBuilder::CachedIndex(media.fileName()), saved);
+    QVERIFY(!QFile::exists(saved + ".tmp"));
+
+    KeyframeIndexReader reader(saved);
+    QVERIFY(reader.Refresh());
+    QCOMPARE(reader.size(), (size_t)2);
+
+    // An index older than the file it describes is stale
+    QVERIFY(media.open(QIODevice::ReadWrite));
+    QVERIFY(media.setFileTime(QFileInfo(saved).lastModified().addSecs(10),
+                              QFileDevice::FileModificationTime));
+    media.close();
+    QVERIFY(KeyframeIndexBuilder::CachedIndex(media.fileName()).isEmpty());
+}
+
+// Writes an H.264 NAL unit, with a start code and emulation prevention.
+class NalWriter
+{
+  public:
+    explicit NalWriter(uint8_t Header)
+      : m_bytes(QByteArray("\x00\x00\x00\x01", 4))
+    {
+        m_bytes.append(static_cast<char>(Header));
+    }
+
+    void Bits(uint32_t Value, int Count)
+    {
+        for (int i = Count - 1; i >= 0; i--)
+        {
+            m_current = static_cast<uint8_t>((m_current << 1) | ((Value >> i) & 1));
+            if (++m_count == 8)
+            {
+                Byte(m_current);
+                m_current = 0;
+                m_count = 0;
+            }
+        }
+    }
+
+    void Ue(uint32_t Value)
+    {
+        int length = 0;
+        for (uint32_t v = Value + 1; v > 1; v >>= 1)
+            length++;
+        Bits(0, length);
+        Bits(Value + 1, length + 1);
+    }
+
+    void Align(void)
+    {
+        while (m_count)
+            Bits(0, 1);
+    }
+
+    QByteArray Finish(void)
+    {
+        Bits(1, 1); // rbsp_stop_one_bit
+        Align();
+        return m_bytes;
+    }
+
+  private:
+    void Byte(uint8_t Value)
+    {
+        if (m_zeros >= 2 && Value <= 3)
+        {
+            m_bytes.append('\x03');
+            m_zeros = 0;
+        }
+        m_bytes.append(static_cast<char>(Value));
+        m_zeros = Value ? 0 : m_zeros + 1;
+    }
+
+    QByteArray m_bytes;
+    uint8_t    m_current {0};
+    int        m_count   {0};
+    int        m_zeros   {0};
+};
+
+/**
+ * Returns one field of a 32x32 field coded (PAFF) H.264 stream at 25 frames
+ * a second. The top field of the first frame of each GOP is an IDR slice,
+ * preceded by the SPS and PPS, and every other field is a P slice with
+ * every macroblock skipped.
+ */
+static QByteArray paff_field(int Frame, bool Bottom, int GopSize)
+{
+    QByteArray field;
+    bool idr = !Bottom && (Frame % GopSize == 0);
+    if (idr)
+    {
+        NalWriter sps(0x67);
+        sps.Bits(77, 8);    // profile_idc, Main
+        sps.Bits(0, 8);     // constraint flags
+        sps.Bits(30, 8);    // level_idc
+        sps.Ue(0);          // seq_parameter_set_id
+        sps.Ue(0);          // log2_max_frame_num_minus4
+        sps.Ue(2);          // pic_order_cnt_type
+        sps.Ue(1);          // max_num_ref_frames
+        sps.Bits(0, 1);     // gaps_in_frame_num_value_allowed_flag
+        sps.Ue(1);          // pic_width_in_mbs_minus1
+        sps.Ue(0);          // pic_height_in_map_units_minus1
+        sps.Bits(0, 1);     // frame_mbs_only_flag
+        sps.Bits(0, 1);     // mb_adaptive_frame_field_flag
+        sps.Bits(1, 1);     // direct_8x8_inference_flag
+        sps.Bits(0, 1);     // frame_cropping_flag
+        sps.Bits(1, 1);     // vui_parameters_present_flag
+        sps.Bits(0, 4);     // no aspect ratio, overscan, signal type or chroma location
+        sps.Bits(1, 1);     // timing_info_present_flag
+        sps.Bits(1, 32);    // num_units_in_tick
+        sps.Bits(50, 32);   // time_scale
+        sps.Bits(1, 1);     // fixed_frame_rate_flag
+        sps.Bits(0, 4);     // no HRD, pic_struct or bitstream restriction
+        field.append(sps.Finish());
+
+        NalWriter pps(0x68);
+        pps.Ue(0);          // pic_parameter_set_id
+        pps.Ue(0);          // seq_parameter_set_id
+        pps.Bits(0, 1);     // entropy_coding_mode_flag, CAVLC
+        pps.Bits(0, 1);     // bottom_field_pic_order_in_frame_present_flag
+        pps.Ue(0);          // num_slice_groups_minus1
+        pps.Ue(0);          // num_ref_idx_l0_default_active_minus1
+        pps.Ue(0);          // num_ref_idx_l1_default_active_minus1
+        pps.Bits(0, 3);     // no weighted prediction
+        pps.Ue(0);          // pic_init_qp_minus26
+        pps.Ue(0);          // pic_init_qs_minus26
+        pps.Ue(0);          // chroma_qp_index_offset
+        pps.Bits(1, 1);     // deblocking_filter_control_present_flag
+        pps.Bits(0, 2);     // no constrained intra pred or redundant_pic_cnt
+        field.append(pps.Finish());
+    }
+
+    NalWriter slice(idr ? 0x65 : 0x21);
+    slice.Ue(0);                        // first_mb_in_slice
+    slice.Ue(idr ? 7 : 5);              // slice_type, I or P
+    slice.Ue(0);                        // pic_parameter_set_id
+    slice.Bits(Frame % GopSize, 4);     // frame_num
+    slice.Bits(1, 1);                   // field_pic_flag
+    slice.Bits(Bottom ? 1 : 0, 1);      // bottom_field_flag
+    if (idr)
+    {
+        slice.Ue(0);                    // idr_pic_id
+        slice.Bits(0, 2);               // no_output_of_prior_pics, long_term_reference
+    }
+    else
+    {
+        slice.Bits(0, 2);               // no num_ref_idx override or list modification
+        slice.Bits(0, 1);               // adaptive_ref_pic_marking_mode_flag
+    }
+    slice.Ue(0);                        // slice_qp_delta
+    slice.Ue(1);                        // disable_deblocking_filter_idc
+    if (idr)
+    {
+        // Both macroblocks of the field as I_PCM
+        for (int mb = 0; mb < 2; mb++)
+        {
+            slice.Ue(25);
+            slice.Align();
+            for (int i = 0; i < 384; i++)
+                slice.Bits(0x80, 8);
+        }
+    }
+    else
+    {
+        slice.Ue(2);                    // mb_skip_run
+    }
+    field.append(slice.Finish());
+    return field;
+}
+
+/**
+ * Writes \p Frames frames of field coded H.264 to an MPEG-TS file, with
+ * each field in a packet of its own.
+ */
+static bool write_paff_ts(const QString &Filename, int Frames, int GopSize)
+{
+    AVFormatContext *oc = nullptr;
+    QByteArray filename = Filename.toLocal8Bit();
+    if (avformat_alloc_output_context2(&oc, nullptr, "mpegts", filename.constData()) < 0)
+        return false;
+
+    AVStream *st = avformat_new_stream(oc, nullptr);
+    st->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    st->codecpar->codec_id   = AV_CODEC_ID_H264;
+    st->codecpar->width      = 32;
+    st->codecpar->height     = 32;
+    st->time_base            = AVRational {1, 90000};
+
+    bool ok = (avio_open(&oc->pb, filename.constData(), AVIO_FLAG_WRITE) >= 0) &&
+              (avformat_write_header(oc, nullptr) >= 0);
+
+    AVPacket *pkt = av_packet_alloc();
+    for (int i = 0; ok && i < Frames * 2; i++)
+    {
+        QByteArray field = paff_field(i / 2, (i % 2) != 0, GopSize);
+        ok = av_new_packet(pkt, field.size()) >= 0;
+        if (!ok)
+            break;
+        memcpy(pkt->data, field.constData(), field.size());
+        pkt->pts = pkt->dts = av_rescale_q(i * 1800, AVRational {1, 90000}, st->time_base);
+        pkt->duration = av_rescale_q(1800, AVRational {1, 90000}, st->time_base);
+        if ((i % 2) == 0 && (i / 2) % GopSize == 0)
+            pkt->flags |= AV_PKT_FLAG_KEY;
+        ok = av_write_frame(oc, pkt) >= 0;
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+
+    if (ok)
+        ok = av_write_trailer(oc) >= 0;
+    avio_closep(&oc->pb);
+    avformat_free_context(oc);
+    return ok;
+}
+
+/**
+ * Each field of a field coded stream is a packet of its own, but keyframes
+ * must still be numbered by frame.
+ */
+void TestKeyframeIndex::test_build_fields(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString filename = dir.filePath("paff.ts");
+    QVERIFY(write_paff_ts(filename, 48, 12));
+
+    KeyframeIndexBuilder builder(filename);
+    builder.start();
+    QVERIFY(builder.wait(std::chrono::seconds(30)));
+    QCOMPARE(builder.Index(), KeyframeIndex::SidecarFilename(filename));
+
+    KeyframeIndexReader reader(builder.Index());
+    QVERIFY(reader.Refresh());
+    QCOMPARE(reader.size(), (size_t)4);
+    for (size_t i = 0; i < reader.size(); i++)
+    {
+        QCOMPARE(reader[i].m_frame, (int64_t)(i * 12));
+        QCOMPARE(reader[i].m_duration, (int64_t)(i * 480));
+        if (i > 0)
+            QVERIFY(reader[i].m_offset > reader[i - 1].m_offset);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestKeyframeIndex)
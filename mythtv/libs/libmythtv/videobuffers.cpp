@@ -8,6 +8,7 @@
 #include "compat.h"
 #include "mythlogging.h"
 #include "mythcodecid.h"
+#include "mythframepool.h"
 #include "videobuffers.h"
 
 // FFmpeg
@@ -132,6 +133,24 @@ static inline void DoDiscard(const std::vector<AVBufferRef *> &Discards)
  * \see VideoOutput
  */
 
+/*! \brief Keep frame allocations in MythFramePool while we exist.
+ *
+ * When buffers are recreated for a new resolution, the previous buffers stay
+ * in the pool (up to VideoFramePoolSize MB) and are reused when the stream
+ * changes back, rather than going back to the allocator.
+*/
+VideoBuffers::VideoBuffers()
+{
+    MythFramePool::Global()->AddUser();
+    MythVideoFrame::AddCopyUser();
+}
+
+VideoBuffers::~VideoBuffers()
+{
+    MythVideoFrame::RemoveCopyUser();
+    MythFramePool::Global()->RemoveUser();
+}
+
 uint VideoBuffers::GetNumBuffers(int PixelFormat, int MaxReferenceFrames, bool Decoder /*=false*/)
 {
     uint refs = static_cast<uint>(MaxReferenceFrames);
@@ -179,6 +198,10 @@ void VideoBuffers::Init(uint NumDecode, uint NeedFree,
 
     Reset();
 
+    int poolsize = gCoreContext->GetNumSetting("VideoFramePoolSize",
+                       static_cast<int>(MythFramePool::kDefaultCapacity >> 20));
+    MythFramePool::Global()->SetCapacity(static_cast<size_t>(std::max(poolsize, 0)) << 20);
+
     // make a big reservation, so that things that depend on
     // pointer to VideoFrames work even after a few push_backs
     m_buffers.reserve(std::max(NumDecode, 128U));
@@ -38,8 +38,8 @@ enum BufferType
 class MTV_PUBLIC VideoBuffers
 {
   public:
-    VideoBuffers() = default;
-   ~VideoBuffers() = default;
+    VideoBuffers();
+   ~VideoBuffers();
 
     static uint GetNumBuffers(int PixelFormat, int MaxReferenceFrames = 16, bool Decoder = false);
     void Init(uint NumDecode,
@@ -47,6 +47,7 @@
 #include "mythcorecontext.h"
 #include "mythtimer.h"
 #include "mythcoreutil.h"
+#include "mythmiscutil.h"
 
 #include "serializers/xmlSerializer.h"
 #include "serializers/soapSerializer.h"
@@ -152,8 +153,8 @@ static QString StaticPage =
     "</HTML>";
 
 #ifdef USE_SETSOCKOPT
-//static const int g_on          = 1;
-//static const int g_off         = 0;
+static const int g_on          = 1;
+static const int g_off         = 0;
 #endif
 
 const char *HTTPRequest::s_szServerHeaders = "Accept-Ranges: bytes\r\n";
@@ -509,15 +510,15 @@ qint64 HTTPRequest::SendResponseFile( const QString& sFileName )
     // ----------------------------------------------------------------------
 
 #ifdef USE_SETSOCKOPT
-//     // Never send out partially complete segments
-//     if (setsockopt(getSocketHandle(), SOL_TCP, TCP_CORK,
-//                    &g_on, sizeof( g_on )) < 0)
-//     {
-//         LOG(VB_HTTP, LOG_INFO,
-//             QString("HTTPRequest::SendResponseFile(%1) "
-//                     "setsockopt error setting TCP_CORK on " ).arg(sFileName) +
-//             ENO);
-//     }
+    // Never send out partially complete segments
+    if (setsockopt(getSocketHandle(), SOL_TCP, TCP_CORK,
+                   &g_on, sizeof( g_on )) < 0)
+    {
+        LOG(VB_HTTP, LOG_INFO,
+            QString("HTTPRequest::SendResponseFile(%1) "
+                    "setsockopt error setting TCP_CORK on " ).arg(sFileName) +
+            ENO);
+    }
 #endif
 
     QFile tmpFile( sFileName );
@@ -646,14 +647,14 @@ qint64 HTTPRequest::SendResponseFile( const QString& sFileName )
     // ----------------------------------------------------------------------
 
 #ifdef USE_SETSOCKOPT
-//     if (setsockopt(getSocketHandle(), SOL_TCP, TCP_CORK,
-//                    &g_off, sizeof( g_off )) < 0)
-//     {
-//         LOG(VB_HTTP, LOG_INFO,
-//             QString("HTTPRequest::SendResponseFile(%1) "
-//                     "setsockopt error setting TCP_CORK off ").arg(sFileName) +
-//             ENO);
-//     }
+    if (setsockopt(getSocketHandle(), SOL_TCP, TCP_CORK,
+                   &g_off, sizeof( g_off )) < 0)
+    {
+        LOG(VB_HTTP, LOG_INFO,
+            QString("HTTPRequest::SendResponseFile(%1) "
+                    "setsockopt error setting TCP_CORK off ").arg(sFileName) +
+            ENO);
+    }
 #endif
 
     // -=>TODO: Only returns header length...
@@ -720,6 +721,20 @@ qint64 HTTPRequest::SendData( QIODevice *pDevice, qint64 llStart, qint64 llBytes
 
 qint64 HTTPRequest::SendFile( QFile &file, qint64 llStart, qint64 llBytes )
 {
+    // ----------------------------------------------------------------------
+    // Let the kernel copy the file to the socket if it can, anything that
+    // has already been written must go out before it.  Encrypted
+    // connections have to go through the socket.
+    // ----------------------------------------------------------------------
+
+    if (!IsEncrypted() && (file.handle() >= 0) && FlushBlock())
+    {
+        long long sent = sendFileToSocket( getSocketHandle(), file.handle(),
+                                           llStart, llBytes, 30s );
+        if (sent >= 0)
+            return( (sent < llBytes) ? -1 : sent );
+    }
+
     qint64 sent = SendData( (QIODevice *)(&file), llStart, llBytes );
 
     return( sent );
@@ -1266,7 +1281,7 @@ bool HTTPRequest::ParseRequest()
     try
     {
         // Read first line to determine requestType
-        QString sRequestLine = ReadLine( 2s );
+        QString sRequestLine = QString::fromUtf8( ReadLine( 2s ) );
 
         if ( sRequestLine.isEmpty() )
         {
@@ -1299,24 +1314,31 @@ bool HTTPRequest::ParseRequest()
         }
 
         // Read Header
-        bool    bDone = false;
-        QString sLine = ReadLine( 2s );
+        //
+        // The lines are split up as bytes, only the names and values are
+        // converted to strings.  Names are ASCII, values may be UTF-8.
+        bool       bDone = false;
+        QByteArray aLine = ReadLine( 2s );
 
-        while (( !sLine.isEmpty() ) && !bDone )
+        while (( !aLine.isEmpty() ) && !bDone )
         {
-            if (sLine != "\r\n")
+            if ((aLine != "\r\n") && (aLine != "\n"))
             {
-                QString sName  = sLine.section( ':', 0, 0 ).trimmed();
-                QString sValue = sLine.section( ':', 1 );
-
-                sValue.truncate( sValue.length() - 2 );
+                int nColon = aLine.indexOf( ':' );
 
-                if (!sName.isEmpty() && !sValue.isEmpty())
+                if (nColon > 0)
                 {
-                    m_mapHeaders.insert(sName.toLower(), sValue.trimmed());
+                    QByteArray aName  = aLine.left( nColon ).trimmed().toLower();
+                    QByteArray aValue = aLine.mid( nColon + 1 ).trimmed();
+
+                    if (!aName.isEmpty() && !aValue.isEmpty())
+                    {
+                        m_mapHeaders.insert( QString::fromLatin1( aName ),
+                                             QString::fromUtf8( aValue ));
+                    }
                 }
 
-                sLine = ReadLine( 2s );
+                aLine = ReadLine( 2s );
             }
             else
                 bDone = true;
@@ -2383,9 +2405,9 @@ void HTTPRequest::AddCORSHeaders( const QString &sOrigin )
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
-QString BufferedSocketDeviceRequest::ReadLine( std::chrono::milliseconds msecs )
+QByteArray BufferedSocketDeviceRequest::ReadLine( std::chrono::milliseconds msecs )
 {
-    QString sLine;
+    QByteArray aLine;
 
     if (m_pSocket && m_pSocket->isValid() &&
         m_pSocket->state() == QAbstractSocket::ConnectedState)
@@ -2405,10 +2427,10 @@ QString BufferedSocketDeviceRequest::ReadLine( std::chrono::milliseconds msecs )
         }
 
         if (!timeout)
-            sLine = m_pSocket->readLine();
+            aLine = m_pSocket->readLine();
     }
 
-    return( sLine );
+    return( aLine );
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -2467,6 +2489,24 @@ qint64 BufferedSocketDeviceRequest::WriteBlock(const char *pData, qint64 nLen)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+bool BufferedSocketDeviceRequest::FlushBlock()
+{
+    if (!m_pSocket || m_pSocket->state() != QAbstractSocket::ConnectedState)
+        return false;
+
+    while (m_pSocket->bytesToWrite() > 0)
+    {
+        if (!m_pSocket->waitForBytesWritten())
+            return false;
+    }
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString BufferedSocketDeviceRequest::GetHostAddress()
 {
     return( m_pSocket->localAddress().toString() );
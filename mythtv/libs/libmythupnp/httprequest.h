@@ -258,10 +258,12 @@ class UPNP_PUBLIC HTTPRequest
 
         // ------------------------------------------------------------------
 
-        virtual QString ReadLine        ( std::chrono::milliseconds msecs ) = 0;
+        virtual QByteArray ReadLine     ( std::chrono::milliseconds msecs ) = 0;
         virtual qint64  ReadBlock       ( char *pData, qint64 nMaxLen, std::chrono::milliseconds msecs = 0ms ) = 0;
         virtual qint64  WriteBlock      ( const char *pData,
                                           qint64 nLen    ) = 0;
+        /// Waits for everything written so far to reach the socket.
+        virtual bool    FlushBlock      () { return true; }
         virtual QString  GetHostName     ();  // RFC 3875 - The name in the client request
         virtual QString  GetHostAddress  () = 0;
         virtual quint16  GetHostPort     () = 0;
@@ -285,9 +287,10 @@ class BufferedSocketDeviceRequest : public HTTPRequest
             : m_pSocket(pSocket) {}
         ~BufferedSocketDeviceRequest() override = default;
 
-        QString  ReadLine        ( std::chrono::milliseconds msecs ) override; // HTTPRequest
+        QByteArray ReadLine      ( std::chrono::milliseconds msecs ) override; // HTTPRequest
         qint64   ReadBlock       ( char *pData, qint64 nMaxLen, std::chrono::milliseconds msecs = 0ms ) override; // HTTPRequest
         qint64   WriteBlock      ( const char *pData, qint64 nLen    ) override; // HTTPRequest
+        bool     FlushBlock      () override; // HTTPRequest
         QString  GetHostAddress  () override; // HTTPRequest
         quint16  GetHostPort     () override; // HTTPRequest
         QString  GetPeerAddress  () override; // HTTPRequest
@@ -15,16 +15,22 @@
 // Own headers
 #include "httpserver.h"
 
+// C++ headers
+#include <algorithm>
+
 // ANSI C headers
 #include <cmath>
 
 // POSIX headers
 #ifndef _WIN32
 #include <sys/utsname.h> 
+#include <unistd.h> // for dup, close
 #endif
 
 // Qt headers
 #include <QScriptEngine>
+#include <QSocketNotifier>
+#include <QTimer>
 #include <QSslConfiguration>
 #include <QSslSocket>
 #include <QSslCipher>
@@ -40,6 +46,7 @@
 #include "htmlserver.h"
 #include "mythversion.h"
 #include "mythcorecontext.h"
+#include "mthread.h"
 
 #include "serviceHosts/rttiServiceHost.h"
 
@@ -158,6 +165,8 @@ HttpServer::HttpServer() :
     RegisterExtension( new RttiServiceHost( m_sSharePath ));
 
     LoadSSLConfig();
+
+    m_idleConnections = new HttpIdleConnections(*this);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -172,6 +181,9 @@ HttpServer::~HttpServer()
 
     m_threadPool.Stop();
 
+    delete m_idleConnections;
+    m_idleConnections = nullptr;
+
     while (!m_extensions.empty())
     {
         delete m_extensions.takeFirst();
@@ -302,12 +314,22 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
     if (server)
         type = server->GetServerType();
 
+    StartWorker(socket, type, false);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::StartWorker(qt_socket_fd_t socket, PoolServerType type,
+                             bool bResumed)
+{
     m_threadPool.startReserved(
         new HttpWorker(*this, socket, type
 #ifndef QT_NO_OPENSSL
                        , m_sslConfig
 #endif
-                       ),
+                       , bResumed),
         QString("HttpServer%1").arg(socket));
 }
 
@@ -315,6 +337,43 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+/**
+ * \brief Waits for the next request on an unencrypted keep-alive connection
+ *        without holding on to a worker thread.
+ *
+ * \param socket  A descriptor for the connection, which is now owned by the
+ *                HttpServer.  Nothing may be buffered on it.
+ * \param timeout How long to wait for the next request before closing it.
+ */
+void HttpServer::KeepAlive(qt_socket_fd_t socket,
+                           std::chrono::milliseconds timeout)
+{
+    if (IsRunning() && m_idleConnections)
+        m_idleConnections->Add(socket, timeout);
+#ifndef _WIN32
+    else
+        close(socket);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ResumeConnection(qt_socket_fd_t socket)
+{
+    if (IsRunning())
+        StartWorker(socket, kTCPServer, true);
+#ifndef _WIN32
+    else
+        close(socket);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 void HttpServer::RegisterExtension( HttpServerExtension *pExtension )
 {
     if (pExtension != nullptr )
@@ -434,6 +493,177 @@ uint HttpServer::GetSocketTimeout(HTTPRequest* pRequest) const
     return timeout;
 }
 
+/// How long an HttpWorker waits for another request before handing the
+/// connection to HttpIdleConnections.
+static constexpr std::chrono::milliseconds kIdleWait { 100ms };
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpIdleConnections Class Implementation
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+HttpIdleConnections::HttpIdleConnections(HttpServer &httpServer)
+    : m_httpServer(httpServer),
+      m_thread(new MThread("HttpIdleConnections")),
+      m_expiry(new QTimer(this))
+{
+    m_expiry->setInterval(1s);
+    connect(m_expiry, &QTimer::timeout, this, &HttpIdleConnections::Expire);
+
+    moveToThread(m_thread->qthread());
+    m_thread->start();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpIdleConnections::~HttpIdleConnections()
+{
+    // The notifiers and timer can only be stopped from their own thread
+    QMetaObject::invokeMethod(this, "Teardown", Qt::BlockingQueuedConnection);
+
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/// Closes every connection, called on the idle connection thread.
+void HttpIdleConnections::Teardown(void)
+{
+    m_expiry->stop();
+    delete m_expiry;
+    m_expiry = nullptr;
+
+    m_pendingLock.lock();
+    m_connections.insert(m_connections.end(), m_pending.begin(), m_pending.end());
+    m_pending.clear();
+    m_pendingLock.unlock();
+
+    for (auto &connection : m_connections)
+    {
+        delete connection.m_notifier;
+#ifndef _WIN32
+        close(connection.m_socket);
+#endif
+    }
+    m_connections.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/// Takes ownership of \p socket, which may be called from any thread.
+void HttpIdleConnections::Add(qt_socket_fd_t socket,
+                              std::chrono::milliseconds timeout)
+{
+    Connection connection;
+    connection.m_socket  = socket;
+    connection.m_timeout = timeout;
+    connection.m_idle.start();
+
+    m_pendingLock.lock();
+    m_pending.push_back(connection);
+    m_pendingLock.unlock();
+
+    QMetaObject::invokeMethod(this, "AddPending", Qt::QueuedConnection);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpIdleConnections::AddPending(void)
+{
+    m_pendingLock.lock();
+    std::vector<Connection> pending;
+    pending.swap(m_pending);
+    m_pendingLock.unlock();
+
+    if (!m_expiry) // Torn down
+    {
+#ifndef _WIN32
+        for (auto &connection : pending)
+            close(connection.m_socket);
+#endif
+        return;
+    }
+
+    for (auto &connection : pending)
+    {
+        connection.m_notifier = new QSocketNotifier(connection.m_socket,
+                                                    QSocketNotifier::Read,
+                                                    this);
+        connect(connection.m_notifier, &QSocketNotifier::activated,
+                this, &HttpIdleConnections::Activated);
+        m_connections.push_back(connection);
+    }
+
+    if (!m_connections.empty() && !m_expiry->isActive())
+        m_expiry->start();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/// The next request, or the end of the connection, has arrived.
+void HttpIdleConnections::Activated(void)
+{
+    auto *notifier = qobject_cast<QSocketNotifier *>(sender());
+    auto it = std::find_if(m_connections.begin(), m_connections.end(),
+                           [notifier](const Connection &connection)
+                           { return connection.m_notifier == notifier; });
+    if (it == m_connections.end())
+        return;
+
+    qt_socket_fd_t socket = it->m_socket;
+    notifier->setEnabled(false);
+    notifier->deleteLater();
+    m_connections.erase(it);
+
+    m_httpServer.ResumeConnection(socket);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/// Closes the connections which have been idle for longer than their timeout.
+void HttpIdleConnections::Expire(void)
+{
+    auto it = m_connections.begin();
+    while (it != m_connections.end())
+    {
+        if (!it->m_idle.hasExpired(it->m_timeout.count()))
+        {
+            ++it;
+            continue;
+        }
+
+        LOG(VB_HTTP, LOG_INFO, QString("HttpIdleConnections(%1): "
+                                       "Keep-alive timeout, closing")
+                                        .arg(it->m_socket));
+        delete it->m_notifier;
+#ifndef _WIN32
+        close(it->m_socket);
+#endif
+        it = m_connections.erase(it);
+    }
+
+    if (m_connections.empty())
+        m_expiry->stop();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -447,15 +677,18 @@ HttpWorker::HttpWorker(HttpServer &httpServer, qt_socket_fd_t sock,
 #ifndef QT_NO_OPENSSL
                        , const QSslConfiguration& sslConfig
 #endif
+                       , bool bResumed
 )
            : m_httpServer(httpServer), m_socket(sock),
-             m_socketTimeout(5s), m_connectionType(type)
+             m_socketTimeout(5s), m_connectionType(type),
+             m_bResumed(bResumed)
 #ifndef QT_NO_OPENSSL
              , m_sslConfig(sslConfig)
 #endif
 {
-    LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): New connection")
-                                        .arg(m_socket));
+    LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): %2 connection")
+                                        .arg(m_socket)
+                                        .arg(m_bResumed ? "Resumed" : "New"));
 }                  
 
 /////////////////////////////////////////////////////////////////////////////
@@ -471,6 +704,7 @@ void HttpWorker::run(void)
 
     bool                    bTimeout   = false;
     bool                    bKeepAlive = true;
+    bool                    bIdle      = false;
     HTTPRequest            *pRequest   = nullptr;
     QTcpSocket             *pSocket    = nullptr;
     bool                    bEncrypted = false;
@@ -516,7 +750,7 @@ void HttpWorker::run(void)
     {
         pSocket = new QTcpSocket();
         pSocket->setSocketDescriptor(m_socket);
-        if (!gCoreContext->CheckSubnet(pSocket))
+        if (!m_bResumed && !gCoreContext->CheckSubnet(pSocket))
         {
             delete pSocket;
             pSocket = nullptr;
@@ -533,14 +767,41 @@ void HttpWorker::run(void)
         while (m_httpServer.IsRunning() && bKeepAlive && pSocket->isValid() &&
                pSocket->state() == QAbstractSocket::ConnectedState)
         {
-            // We set a timeout on keep-alive connections to avoid blocking
-            // new clients from connecting - Default at time of writing was
-            // 5 seconds for initial connection, then up to 10 seconds of idle
-            // time between each subsequent request on the same connection
-            bTimeout = !(pSocket->waitForReadyRead(m_socketTimeout.count()));
+            // Requests pipelined behind the last one are already buffered,
+            // only wait when there is nothing left to read
+            if (pSocket->bytesAvailable() == 0)
+            {
+#ifndef _WIN32
+                // Unencrypted connections that go quiet are handed to
+                // HttpIdleConnections, so waiting for their next request
+                // doesn't tie up this thread
+                if (!bEncrypted && (m_socketTimeout > kIdleWait) &&
+                    !pSocket->waitForReadyRead(kIdleWait.count()) &&
+                    (pSocket->error() == QAbstractSocket::SocketTimeoutError) &&
+                    (pSocket->state() == QAbstractSocket::ConnectedState) &&
+                    (pSocket->bytesToWrite() == 0))
+                {
+                    int idleSocket = dup(pSocket->socketDescriptor());
+                    if (idleSocket >= 0)
+                    {
+                        m_httpServer.KeepAlive(idleSocket,
+                                               m_socketTimeout - kIdleWait);
+                        bIdle = true;
+                        break;
+                    }
+                }
+#endif
 
-            if (bTimeout) // Either client closed the socket or we timed out waiting for new data
-                break;
+                // We set a timeout on keep-alive connections to avoid blocking
+                // new clients from connecting - Default at time of writing was
+                // 5 seconds for initial connection, then up to 10 seconds of idle
+                // time between each subsequent request on the same connection
+                if (pSocket->bytesAvailable() == 0)
+                    bTimeout = !(pSocket->waitForReadyRead(m_socketTimeout.count()));
+
+                if (bTimeout) // Either client closed the socket or we timed out waiting for new data
+                    break;
+            }
 
             int64_t nBytes = pSocket->bytesAvailable();
             if (!m_httpServer.IsRunning())
@@ -679,9 +940,10 @@ void HttpWorker::run(void)
                                             .arg(pSocket->errorString()));
     }
 
-    LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 closed. %3 requests were handled")
+    LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 %3. %4 requests were handled")
                                         .arg(m_socket)
                                         .arg(pSocket->socketDescriptor())
+                                        .arg(bIdle ? "idle" : "closed")
                                         .arg(nRequestsHandled));
 
     pSocket->close();
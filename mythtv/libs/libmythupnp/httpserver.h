@@ -21,8 +21,10 @@
 #include <arpa/inet.h>
 #endif
 #include <utility>
+#include <vector>
 
 // Qt headers
+#include <QElapsedTimer>
 #include <QReadWriteLock>
 #include <QMultiMap>
 #include <QRunnable>
@@ -43,8 +45,12 @@
 #include "compat.h"
 
 class HttpWorkerThread;
+class HttpIdleConnections;
 class QScriptEngine;
+class QSocketNotifier;
+class QTimer;
 class HttpServer;
+class MThread;
 #ifndef QT_NO_OPENSSL
 class QSslKey;
 class QSslCertificate;
@@ -122,6 +128,8 @@ class UPNP_PUBLIC HttpServer : public ServerPool
      * \brief Get the idle socket timeout value for the relevant extension
      */
     uint GetSocketTimeout(HTTPRequest *pRequest) const;
+    void KeepAlive(qt_socket_fd_t socket, std::chrono::milliseconds timeout);
+    void ResumeConnection(qt_socket_fd_t socket);
 
     QString GetSharePath(void) const
     { // never modified after creation, so no need to lock
@@ -146,6 +154,7 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     QMultiMap< QString, HttpServerExtension* >  m_basePaths;
     QString                 m_sSharePath;
     MThreadPool             m_threadPool;
+    HttpIdleConnections    *m_idleConnections { nullptr };
     bool                    m_running    { true }; // protected by m_rwlock
 
     static QMutex           s_platformLock;
@@ -162,6 +171,58 @@ class UPNP_PUBLIC HttpServer : public ServerPool
 
   private:
     void LoadSSLConfig();
+    void StartWorker(qt_socket_fd_t socket, PoolServerType type, bool bResumed);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpIdleConnections Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Watches keep-alive connections between requests, so that a client
+ *        which keeps its connection open does not also keep an HttpWorker
+ *        and its thread.
+ *
+ * The connections are watched from one thread's event loop.  When the next
+ * request starts to arrive the connection is handed back to the HttpServer
+ * to start a new HttpWorker, if none arrives in time it is closed.
+ */
+class HttpIdleConnections : public QObject
+{
+    Q_OBJECT
+
+  public:
+    explicit HttpIdleConnections(HttpServer &httpServer);
+    ~HttpIdleConnections() override;
+
+    void Add(qt_socket_fd_t socket, std::chrono::milliseconds timeout);
+
+  private slots:
+    void AddPending(void);
+    void Activated(void);
+    void Expire(void);
+    void Teardown(void);
+
+  private:
+    struct Connection
+    {
+        qt_socket_fd_t            m_socket   { -1 };
+        std::chrono::milliseconds m_timeout  { 0ms };
+        QSocketNotifier          *m_notifier { nullptr };
+        QElapsedTimer             m_idle;
+    };
+
+    HttpServer             &m_httpServer;
+    MThread                *m_thread     { nullptr };
+    QTimer                 *m_expiry     { nullptr };
+    std::vector<Connection> m_connections;
+
+    QMutex                  m_pendingLock;
+    std::vector<Connection> m_pending; // protected by m_pendingLock
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -181,11 +242,14 @@ class HttpWorker : public QRunnable
      * \param sock       The socket
      * \param type       The type of connection - Plain TCP, SSL or other?
      * \param sslConfig  The SSL configuration (for SSL sockets)
+     * \param bResumed   Whether the connection is coming back from
+     *                   HttpIdleConnections, rather than new
      */
     HttpWorker(HttpServer &httpServer, qt_socket_fd_t sock, PoolServerType type
 #ifndef QT_NO_OPENSSL
                , const QSslConfiguration& sslConfig
 #endif
+               , bool bResumed = false
     );
 
     void run(void) override; // QRunnable
@@ -195,6 +259,7 @@ class HttpWorker : public QRunnable
     qt_socket_fd_t m_socket;
     std::chrono::milliseconds m_socketTimeout;
     PoolServerType m_connectionType;
+    bool           m_bResumed;
 
 #ifndef QT_NO_OPENSSL
     QSslConfiguration       m_sslConfig;
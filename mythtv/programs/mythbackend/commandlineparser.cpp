@@ -25,6 +25,19 @@ void MythBackendCommandLineParser::LoadArguments(void)
          << add("--testsched", "testsched", false,
                 "do some scheduler testing.", "")
 //                    ->SetDeprecated("use mythutil instead")
+         << add("--dumpsched", "dumpsched", "",
+                "Calculate the schedule from the database and save the "
+                "scheduler work list to a fixture file.",
+                "This command calculates the schedule like --testsched, "
+                "and saves everything the placement passes need to the "
+                "given file, so they can be replayed with --benchsched.")
+         << add("--benchsched", "benchsched", "",
+                "Replay a fixture saved with --dumpsched through the "
+                "scheduler placement passes.",
+                "This command runs the scheduler placement passes on the "
+                "given fixture file without using the database, and prints "
+                "the time taken by each phase, the memory used and a hash "
+                "of the resulting schedule.")
          << add("--resched", "resched", false,
                 "Trigger a run of the recording scheduler on the existing "
                 "master backend.",
@@ -3,6 +3,10 @@
 #include <QFileInfo>
 #include <utility>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "filetransfer.h"
 #include "io/mythmediabuffer.h"
 #include "mythdate.h"
@@ -10,16 +14,44 @@
 #include "programinfo.h"
 #include "mythlogging.h"
 
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif
+
+/// Whether the blocks of \p filename can be sent straight from the file,
+/// rather than read through a MythMediaBuffer first.
+static bool use_send_file(const QString &filename)
+{
+#ifdef __linux__
+    return QFileInfo(filename).isFile();
+#else
+    Q_UNUSED(filename);
+    return false;
+#endif
+}
+
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, std::chrono::milliseconds timeout) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
-    m_rbuffer(MythMediaBuffer::Create(filename, false, usereadahead, timeout, true)),
+    // Read ahead would copy the file into memory that SendBlock() has
+    // no use for.
+    m_rbuffer(MythMediaBuffer::Create(filename, false,
+                                      usereadahead && !use_send_file(filename),
+                                      timeout, true)),
     m_sock(remote)
 {
     m_pginfo = new ProgramInfo(filename);
     m_pginfo->MarkAsInUse(true, kFileTransferInUseID);
     if (m_rbuffer && m_rbuffer->IsOpen())
+    {
+        if (use_send_file(filename) &&
+            (m_rbuffer->GetType() == kMythBufferFile))
+        {
+            m_sendFd = open(filename.toLocal8Bit().constData(),
+                            O_RDONLY | O_LARGEFILE);
+        }
         m_rbuffer->Start();
+    }
 }
 
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote, bool write) :
@@ -43,6 +75,9 @@ FileTransfer::~FileTransfer()
     if (m_sock) // FileTransfer becomes responsible for deleting the socket
         m_sock->DecrRef();
 
+    if (m_sendFd >= 0)
+        close(m_sendFd);
+
     if (m_rbuffer)
     {
         delete m_rbuffer;
@@ -131,6 +166,18 @@ int FileTransfer::RequestBlock(int size)
     while (m_readsLocked)
         m_readsUnlockedCond.wait(&m_lock, 100 /*ms*/);
 
+    if (m_sendFd >= 0)
+    {
+        tot = SendBlock(size);
+        if (tot != -2)
+        {
+            if (m_pginfo)
+                m_pginfo->UpdateInUseMark();
+            return tot;
+        }
+        tot = 0;
+    }
+
     m_requestBuffer.resize(std::max((size_t)std::max(size,0) + 128, m_requestBuffer.size()));
     char *buf = &m_requestBuffer[0];
     while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
@@ -153,12 +200,47 @@ int FileTransfer::RequestBlock(int size)
             break; // we hit eof
     }
 
+    if (m_sendFd >= 0)
+        m_sendPos = m_rbuffer->GetReadPosition();
+
     if (m_pginfo)
         m_pginfo->UpdateInUseMark();
 
     return (ret < 0) ? -1 : tot;
 }
 
+/** \brief Sends the next \p size bytes straight from the file to the
+ *         socket, when they have all been written to disk.
+ *
+ *  Otherwise, if the file is still being recorded or has ended, m_rbuffer
+ *  is moved to m_sendPos so the caller can read the block through it,
+ *  which waits for the file to grow.
+ *  \return the number of bytes sent, -1 on error, or -2 if the caller
+ *          must read the block through m_rbuffer.
+ *  \note m_lock must be held.
+ */
+int FileTransfer::SendBlock(int size)
+{
+    struct stat st {};
+    if (fstat(m_sendFd, &st) == 0 && (m_sendPos + size <= st.st_size))
+    {
+        int sent = m_sock->SendFile(m_sendFd, m_sendPos, size);
+        if (sent >= 0)
+        {
+            m_sendPos += sent;
+            return (sent == size) ? sent : -1;
+        }
+
+        LOG(VB_FILE, LOG_INFO, "Unable to send file directly, reading it");
+        close(m_sendFd);
+        m_sendFd = -1;
+    }
+
+    if (m_rbuffer->GetReadPosition() != m_sendPos)
+        m_rbuffer->Seek(m_sendPos, SEEK_SET);
+    return -2;
+}
+
 int FileTransfer::WriteBlock(int size)
 {
     if (!m_writemode || !m_rbuffer)
@@ -234,7 +316,14 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
 
     Pause();
 
-    if (whence == SEEK_CUR)
+    if (whence == SEEK_CUR && m_sendFd >= 0)
+    {
+        // m_rbuffer is not read while blocks are sent directly, so its
+        // position may be behind curpos.
+        pos = curpos + pos;
+        whence = SEEK_SET;
+    }
+    else if (whence == SEEK_CUR)
     {
         long long desired = curpos + pos;
         long long realpos = m_rbuffer->GetReadPosition();
@@ -244,6 +333,12 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
 
     long long ret = m_rbuffer->Seek(pos, whence);
 
+    if (m_sendFd >= 0 && ret >= 0)
+    {
+        QMutexLocker locker(&m_lock);
+        m_sendPos = ret;
+    }
+
     Unpause();
 
     if (m_pginfo)
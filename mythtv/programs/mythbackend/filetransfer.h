@@ -48,6 +48,8 @@ class FileTransfer : public ReferenceCounter
   private:
    ~FileTransfer() override;
 
+    int SendBlock(int size);
+
     volatile bool   m_readthreadlive    {true};
     bool            m_readsLocked       {false};
     QWaitCondition  m_readsUnlockedCond;
@@ -59,6 +61,12 @@ class FileTransfer : public ReferenceCounter
 
     std::vector<char> m_requestBuffer;
 
+    /// The file opened again to send it with MythSocket::SendFile(), or
+    /// -1 if it must be read through m_rbuffer.
+    int             m_sendFd            {-1};
+    /// Where the next block is sent from, when m_sendFd is open.
+    long long       m_sendPos           {0};
+
     QMutex          m_lock              {QMutex::NonRecursive};
 
     bool            m_writemode         {false};
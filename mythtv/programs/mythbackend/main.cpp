@@ -134,7 +134,10 @@ int main(int argc, char **argv)
     (void)sd_notify(0, "STATUS=Connecting to databse.");
 #endif
     gContext = new MythContext(MYTH_BINARY_VERSION);
-    if (!gContext->Init(false))
+    if (!gContext->Init(false, /*use gui*/
+                        false, /*prompt for backend*/
+                        false, /*bypass auto discovery*/
+                        cmdline.toBool("benchsched"))) /*ignoreDB*/
     {
         LOG(VB_GENERAL, LOG_CRIT, "Failed to init MythContext.");
         return GENERIC_EXIT_NO_MYTHCONTEXT;
@@ -150,7 +153,8 @@ int main(int argc, char **argv)
         cmdline.toBool("setverbose")    || cmdline.toBool("printsched") ||
         cmdline.toBool("testsched")     || cmdline.toBool("resched") ||
         cmdline.toBool("scanvideos")    || cmdline.toBool("clearcache") ||
-        cmdline.toBool("printexpire")   || cmdline.toBool("setloglevel"))
+        cmdline.toBool("printexpire")   || cmdline.toBool("setloglevel") ||
+        cmdline.toBool("dumpsched")     || cmdline.toBool("benchsched"))
     {
         gCoreContext->SetAsBackend(false);
         return handle_command(cmdline);
@@ -414,6 +414,19 @@ int handle_command(const MythBackendCommandLineParser &cmdline)
         return GENERIC_EXIT_OK;
     }
 
+    if (cmdline.toBool("dumpsched"))
+    {
+        std::cout << "Calculating Schedule from database.\n";
+        ProgramInfo::CheckProgramIDAuthorities();
+        auto *sched = new Scheduler(false, &tvList);
+        sched->DumpFixture(cmdline.toString("dumpsched"));
+        delete sched;
+        return GENERIC_EXIT_OK;
+    }
+
+    if (cmdline.toBool("benchsched"))
+        return Scheduler::ReplayFixture(cmdline.toString("benchsched"));
+
     if (cmdline.toBool("resched"))
     {
         bool ok = false;
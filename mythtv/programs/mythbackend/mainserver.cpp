@@ -54,6 +54,7 @@
 #include "scheduler.h"
 #include "requesthandler/fileserverutil.h"
 #include "programinfo.h"
+#include "programinfobinary.h"
 #include "mythtimezone.h"
 #include "recordinginfo.h"
 #include "recordingrule.h"
@@ -139,8 +140,9 @@ const std::chrono::milliseconds MainServer::kMasterServerReconnectTimeout { 1s }
 class ProcessRequestRunnable : public QRunnable
 {
   public:
-    ProcessRequestRunnable(MainServer &parent, MythSocket *sock) :
-        m_parent(parent), m_sock(sock)
+    ProcessRequestRunnable(MainServer &parent, MythSocket *sock,
+                           QStringList listline = QStringList()) :
+        m_parent(parent), m_sock(sock), m_listline(std::move(listline))
     {
         m_sock->IncrRef();
     }
@@ -156,7 +158,10 @@ class ProcessRequestRunnable : public QRunnable
 
     void run(void) override // QRunnable
     {
-        m_parent.ProcessRequest(m_sock);
+        if (m_listline.empty())
+            m_parent.ProcessRequest(m_sock);
+        else
+            m_parent.ProcessRequest(m_sock, m_listline);
         m_sock->DecrRef();
         m_sock = nullptr;
     }
@@ -164,6 +169,7 @@ class ProcessRequestRunnable : public QRunnable
   private:
     MainServer &m_parent;
     MythSocket *m_sock;
+    QStringList m_listline;
 };
 
 class FreeSpaceUpdater : public QRunnable
@@ -238,7 +244,9 @@ MainServer::MainServer(bool master, int port,
                        Scheduler *sched, AutoExpire *_expirer) :
     m_encoderList(_tvList),
     m_ismaster(master), m_threadPool("ProcessRequestPool"),
-    m_sched(sched), m_expirer(_expirer)
+    m_sched(sched), m_expirer(_expirer),
+    m_recordingList([this](ProgramList &list)
+                    { LoadRecordedList(list, false, 1); })
 {
     PreviewGeneratorQueue::CreatePreviewGeneratorQueue(
         PreviewGenerator::kLocalAndRemote, ~0, 0s);
@@ -248,6 +256,8 @@ MainServer::MainServer(bool master, int port,
 
     m_masterBackendOverride =
         gCoreContext->GetBoolSetting("MasterBackendOverride", false);
+    m_readRequestsInline =
+        gCoreContext->GetBoolSetting("BackendReadRequestsInline", true);
 
     m_mythserver = new MythServer();
     m_mythserver->setProxy(QNetworkProxy::NoProxy);
@@ -431,7 +441,8 @@ void MainServer::autoexpireUpdate(void)
 void MainServer::NewConnection(qt_socket_fd_t socketDescriptor)
 {
     QWriteLocker locker(&m_sockListLock);
-    auto *ms =  new MythSocket(socketDescriptor, this);
+    auto *ms =  new MythSocket(socketDescriptor, this, false,
+                               m_readRequestsInline);
     if (ms->IsConnected())
         m_controlSocketList.insert(ms);
     else
@@ -447,6 +458,42 @@ void MainServer::readyRead(MythSocket *sock)
     QCoreApplication::processEvents();
 }
 
+/// Requests which are answered straight away on the client's socket
+/// thread when m_readRequestsInline is set.  These are frequent, and
+/// touch neither the database, the disk, nor another backend.  Nothing
+/// that can close the connection may be listed, as the socket would be
+/// deleted on its own thread while still handling the request.
+static bool is_inline_request(const QString &command)
+{
+    static const QStringList kInlineRequests {
+        "MESSAGE", "BACKEND_MESSAGE", "QUERY_LOAD", "QUERY_UPTIME", "QUERY_HOSTNAME", "QUERY_MEMSTATS",
+        "QUERY_TIME_ZONE", "QUERY_ACTIVE_BACKENDS", "QUERY_IS_ACTIVE_BACKEND",
+    };
+    return kInlineRequests.contains(command);
+}
+
+/** \brief Called on the socket's thread with each request that arrives,
+ *         when m_readRequestsInline is set.
+ *
+ *  Quick requests are answered there and then, the rest are passed to
+ *  the thread pool so that they cannot hold up the socket.
+ */
+void MainServer::readStringList(MythSocket *sock, QStringList &list)
+{
+    if (list.empty())
+        return;
+
+    if (is_inline_request(list[0].simplified().section(' ', 0, 0)))
+    {
+        ProcessRequest(sock, list);
+        return;
+    }
+
+    m_threadPool.startReserved(
+        new ProcessRequestRunnable(*this, sock, list),
+        "ProcessRequest", PRT_TIMEOUT);
+}
+
 void MainServer::ProcessRequest(MythSocket *sock)
 {
     if (sock->IsDataAvailable())
@@ -456,6 +503,20 @@ void MainServer::ProcessRequest(MythSocket *sock)
             .arg(sock->GetSocketDescriptor()));
 }
 
+/// Handles a request that has already been read by the socket.
+void MainServer::ProcessRequest(MythSocket *sock, QStringList &listline)
+{
+    m_sockListLock.lockForRead();
+    bool known = GetPlaybackBySock(sock) || m_controlSocketList.contains(sock);
+    m_sockListLock.unlock();
+
+    // The socket has been disconnected
+    if (!known)
+        return;
+
+    ProcessRequestWork(sock, listline);
+}
+
 void MainServer::ProcessRequestWork(MythSocket *sock)
 {
     m_sockListLock.lockForRead();
@@ -488,6 +549,11 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
         return;
     }
 
+    ProcessRequestWork(sock, listline);
+}
+
+void MainServer::ProcessRequestWork(MythSocket *sock, QStringList &listline)
+{
     QString line = listline[0];
 
     line = line.simplified();
@@ -518,7 +584,7 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
 
     m_sockListLock.lockForRead();
-    pbs = GetPlaybackBySock(sock);
+    PlaybackSock *pbs = GetPlaybackBySock(sock);
     if (!pbs)
     {
         m_sockListLock.unlock();
@@ -537,10 +603,17 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     }
     else if (command == "QUERY_RECORDINGS")
     {
-        if (tokens.size() != 2)
-            SendErrorResponse(pbs, "Bad QUERY_RECORDINGS query");
+        bool binary = (tokens.size() > 2) && (tokens.back() == "Binary");
+        int args = binary ? tokens.size() - 1 : tokens.size();
+        if (args == 2)
+            HandleQueryRecordings(tokens[1], pbs, binary);
+        else if (args == 5 && tokens[2] == "Page")
+            HandleQueryRecordingsPage(tokens[1], tokens[3].toUInt(),
+                                      tokens[4].toUInt(), pbs, binary);
+        else if (args == 3 && tokens[1] == "Since")
+            HandleQueryRecordingsSince(tokens[2].toULongLong(), pbs, binary);
         else
-            HandleQueryRecordings(tokens[1], pbs);
+            SendErrorResponse(pbs, "Bad QUERY_RECORDINGS query");
     }
     else if (command == "QUERY_RECORDING")
     {
@@ -1539,6 +1612,12 @@ void MainServer::customEvent(QEvent *e)
             }
         }
 
+        if (me->Message().startsWith("RECORDING_LIST_CHANGE") ||
+            me->Message().startsWith("UPDATE_FILE_SIZE"))
+        {
+            m_recordingList.HandleEvent(me->Message(), me->ExtraDataList());
+        }
+
         if (me->Message().startsWith("DOWNLOAD_FILE"))
         {
             QStringList extraDataList = me->ExtraDataList();
@@ -1661,9 +1740,10 @@ void MainServer::customEvent(QEvent *e)
 
 /**
  * \addtogroup myth_network_protocol
- * \par        MYTH_PROTO_VERSION \e version \e token
+ * \par        MYTH_PROTO_VERSION \e version \e token [\e extension ...]
  * Checks that \e version and \e token match the backend's version.
- * If it matches, the stringlist of "ACCEPT" \e "version" is returned.
+ * If it matches, the stringlist of "ACCEPT" \e "version" is returned,
+ * followed by those of the requested \e extensions the backend supports.
  * If it does not, "REJECT" \e "version" is returned,
  * and the socket is closed (for this client)
  */
@@ -1707,6 +1787,14 @@ void MainServer::HandleVersion(MythSocket *socket, const QStringList &slist)
     }
 
     retlist << "ACCEPT" << MYTH_PROTO_VERSION;
+
+    QStringList extensions = QString(MYTH_PROTO_EXTENSIONS).split(' ');
+    for (int i = 3; i < slist.size(); ++i)
+    {
+        if (extensions.contains(slist[i]) && !retlist.contains(slist[i]))
+            retlist << slist[i];
+    }
+
     socket->WriteStringList(retlist);
 }
 
@@ -2147,19 +2235,12 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
     }
 }
 
-/**
- * \addtogroup myth_network_protocol
- * \par        QUERY_RECORDINGS \e type
- * The \e type parameter can be either "Recording", "Unsorted", "Ascending",
- * or "Descending".
- * Returns programinfo (title, subtitle, description, category, chanid,
- * channum, callsign, channel.name, fileURL, \e et \e cetera)
- */
-void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
+/// Loads the recordings, oldest first if \p sort is positive and newest
+/// first if it is negative.
+void MainServer::LoadRecordedList(ProgramList &destination,
+                                  bool possiblyInProgressRecordingsOnly,
+                                  int sort)
 {
-    MythSocket *pbssock = pbs->getSocket();
-    QString playbackhost = pbs->getHostname();
-
     QMap<QString,ProgramInfo*> recMap;
     if (m_sched)
         recMap = m_sched->GetRecording();
@@ -2168,24 +2249,20 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
     QMap<QString,bool> isJobRunning =
         ProgramInfo::QueryJobsRunning(JOB_COMMFLAG);
 
-    int sort = 0;
-    // Allow "Play" and "Delete" for backwards compatibility with protocol
-    // version 56 and below.
-    if ((type == "Ascending") || (type == "Play"))
-        sort = 1;
-    else if ((type == "Descending") || (type == "Delete"))
-        sort = -1;
-
-    ProgramList destination;
     LoadFromRecorded(
-        destination, (type == "Recording"),
+        destination, possiblyInProgressRecordingsOnly,
         inUseMap, isJobRunning, recMap, sort);
 
     QMap<QString,ProgramInfo*>::iterator mit = recMap.begin();
     for (; mit != recMap.end(); mit = recMap.erase(mit))
         delete *mit;
+}
 
-    QStringList outputlist(QString::number(destination.size()));
+/// Sets the URL \p playbackhost should use to play each recording, and
+/// fills in any missing file sizes.
+void MainServer::FillRecordedPaths(ProgramList &destination,
+                                   const QString &playbackhost)
+{
     QMap<QString, int> backendPortMap;
     int port = gCoreContext->GetBackendServerPort();
     QString host = gCoreContext->GetHostName();
@@ -2270,10 +2347,127 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
 
         if (slave)
             slave->DecrRef();
+    }
+}
+
+/// Appends the count of \p programs and the programs themselves to \p list.
+static void append_programs(QStringList &list, const ProgramList &programs,
+                            bool binary)
+{
+    list << QString::number(programs.size());
+
+    if (binary)
+    {
+        ProgramInfoPacker packer;
+        for (auto *proginfo : programs)
+            packer.Add(*proginfo);
+        list << QString::fromLatin1(packer.Finish().toBase64());
+        return;
+    }
+
+    for (auto *proginfo : programs)
+        proginfo->ToStringList(list);
+}
+
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDINGS \e type [Binary]
+ * The \e type parameter can be either "Recording", "Unsorted", "Ascending",
+ * or "Descending".
+ * Returns programinfo (title, subtitle, description, category, chanid,
+ * channum, callsign, channel.name, fileURL, \e et \e cetera)
+ * With "Binary", which needs the PROGINFO_BINARY_1 protocol extension,
+ * the programinfo is packed into a single item by ProgramInfoPacker.
+ */
+void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs,
+                                       bool binary)
+{
+    MythSocket *pbssock = pbs->getSocket();
+
+    int sort = 0;
+    // Allow "Play" and "Delete" for backwards compatibility with protocol
+    // version 56 and below.
+    if ((type == "Ascending") || (type == "Play"))
+        sort = 1;
+    else if ((type == "Descending") || (type == "Delete"))
+        sort = -1;
+
+    ProgramList destination;
+    LoadRecordedList(destination, (type == "Recording"), sort);
+    FillRecordedPaths(destination, pbs->getHostname());
+
+    QStringList outputlist;
+    append_programs(outputlist, destination, binary);
+    SendResponse(pbssock, outputlist);
+}
 
-        proginfo->ToStringList(outputlist);
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDINGS \e type Page \e start \e count [Binary]
+ * Returns up to \e count recordings, starting with the \e start'th oldest
+ * if \e type is "Ascending" or "Unsorted", or the \e start'th newest if it
+ * is "Descending".  The reply is the generation of the recordings list,
+ * the total number of recordings, then the recordings as for
+ * QUERY_RECORDINGS.  Needs the RECLIST_DELTA_1 protocol extension.
+ */
+void MainServer::HandleQueryRecordingsPage(const QString &type, uint start,
+                                           uint count, PlaybackSock *pbs,
+                                           bool binary)
+{
+    MythSocket *pbssock = pbs->getSocket();
+
+    if (type != "Ascending" && type != "Descending" && type != "Unsorted")
+    {
+        SendErrorResponse(pbssock, "Bad QUERY_RECORDINGS Page type");
+        return;
     }
 
+    ProgramList page;
+    uint total = 0;
+    uint64_t generation =
+        m_recordingList.GetPage(type == "Descending", start, count, page, total);
+    FillRecordedPaths(page, pbs->getHostname());
+
+    QStringList outputlist;
+    outputlist << QString::number(generation) << QString::number(total);
+    append_programs(outputlist, page, binary);
+    SendResponse(pbssock, outputlist);
+}
+
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_RECORDINGS Since \e generation [Binary]
+ * Returns the recordings changed since \e generation of the recordings
+ * list, as returned by a previous QUERY_RECORDINGS Page or Since.  The
+ * reply is the current generation, the number of recordings deleted and
+ * their recordedids, then the changed recordings as for QUERY_RECORDINGS.
+ * If the changes are no longer known, the reply is the current generation
+ * and "RELOAD", and the whole list must be fetched again.  Needs the
+ * RECLIST_DELTA_1 protocol extension.
+ */
+void MainServer::HandleQueryRecordingsSince(uint64_t generation,
+                                            PlaybackSock *pbs, bool binary)
+{
+    MythSocket *pbssock = pbs->getSocket();
+
+    ProgramList changed;
+    QList<uint> deleted;
+    bool known = m_recordingList.GetChanges(generation, changed, deleted);
+
+    QStringList outputlist(QString::number(generation));
+    if (!known)
+    {
+        outputlist << "RELOAD";
+        SendResponse(pbssock, outputlist);
+        return;
+    }
+
+    outputlist << QString::number(deleted.size());
+    for (uint recordedid : qAsConst(deleted))
+        outputlist << QString::number(recordedid);
+
+    FillRecordedPaths(changed, pbs->getHostname());
+    append_programs(outputlist, changed, binary);
     SendResponse(pbssock, outputlist);
 }
 
@@ -2491,6 +2685,7 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
     nameFilters.push_back(fInfo.fileName() + ".old");
     nameFilters.push_back(fInfo.fileName() + ".map");
     nameFilters.push_back(fInfo.fileName() + ".tmp.map");
+    nameFilters.push_back(fInfo.fileName() + ".kfidx");
     nameFilters.push_back(fInfo.baseName() + ".srt");  // e.g. 1234_20150213165800.srt
 
     QDir dir (fInfo.path());
@@ -26,6 +26,7 @@
 #include "mythsocket.h"
 #include "mythdeque.h"
 #include "mythdownloadmanager.h"
+#include "recordinglistcache.h"
 
 #ifdef DeleteFile
 #undef DeleteFile
@@ -133,8 +134,11 @@ class MainServer : public QObject, public MythSocketCBs
     void ShutSlaveBackendsDown(const QString &haltcmd);
 
     void ProcessRequest(MythSocket *sock);
+    void ProcessRequest(MythSocket *sock, QStringList &listline);
 
     void readyRead(MythSocket *socket) override; // MythSocketCBs
+    void readStringList(MythSocket *socket,
+                        QStringList &list) override; // MythSocketCBs
     void connectionClosed(MythSocket *socket) override; // MythSocketCBs
     void connectionFailed(MythSocket *socket) override // MythSocketCBs
         { (void)socket; }
@@ -164,6 +168,7 @@ class MainServer : public QObject, public MythSocketCBs
   private:
 
     void ProcessRequestWork(MythSocket *sock);
+    void ProcessRequestWork(MythSocket *sock, QStringList &listline);
     void HandleAnnounce(QStringList &slist, QStringList commands,
                         MythSocket *socket);
     void HandleDone(MythSocket *socket);
@@ -176,7 +181,16 @@ class MainServer : public QObject, public MythSocketCBs
     bool HandleDeleteFile(const QStringList &slist, PlaybackSock *pbs);
     bool HandleDeleteFile(const QString& filename, const QString& storagegroup,
                           PlaybackSock *pbs = nullptr);
-    void HandleQueryRecordings(const QString& type, PlaybackSock *pbs);
+    void LoadRecordedList(ProgramList &destination,
+                          bool possiblyInProgressRecordingsOnly, int sort);
+    void FillRecordedPaths(ProgramList &destination,
+                           const QString &playbackhost);
+    void HandleQueryRecordings(const QString& type, PlaybackSock *pbs,
+                               bool binary = false);
+    void HandleQueryRecordingsPage(const QString &type, uint start, uint count,
+                                   PlaybackSock *pbs, bool binary);
+    void HandleQueryRecordingsSince(uint64_t generation, PlaybackSock *pbs,
+                                    bool binary);
     void HandleQueryRecording(QStringList &slist, PlaybackSock *pbs);
     void HandleStopRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleStopRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
@@ -336,9 +350,13 @@ class MainServer : public QObject, public MythSocketCBs
     MThreadPool m_threadPool;
 
     bool m_masterBackendOverride             {false};
+    /// Read requests as they arrive on each client's socket thread,
+    /// instead of from a thread pool thread on each readyRead().
+    bool m_readRequestsInline                {true};
 
     Scheduler  *m_sched                      {nullptr};
     AutoExpire *m_expirer                    {nullptr};
+    RecordingListCache m_recordingList;
     QMutex      m_addChildInputLock;
 
     struct DeferredDeleteStruct
@@ -0,0 +1,227 @@
+// Qt headers
+#include <QDateTime>
+#include <QSet>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "recordinglistcache.h"
+
+#define LOC QString("RecListCache: ")
+
+RecordingListCache::RecordingListCache(Loader loader)
+  : m_loader(std::move(loader)),
+    m_generation(QDateTime::currentMSecsSinceEpoch()),
+    m_oldest(m_generation),
+    m_membership(m_generation)
+{
+}
+
+/** \brief Notes the recording changed by a RECORDING_LIST_CHANGE or
+ *         UPDATE_FILE_SIZE event.
+ *
+ *  A RECORDING_LIST_CHANGE that does not name a recording may have
+ *  changed any of them, so it starts a new change log.  Updates are
+ *  queued along with the change, and the queue is applied to the list
+ *  before it is read, so that anyone who sees them in the log finds them
+ *  in the list.
+ */
+void RecordingListCache::HandleEvent(const QString &message,
+                                     const QStringList &extra)
+{
+#if QT_VERSION < QT_VERSION_CHECK(5,14,0)
+    QStringList tokens = message.simplified().split(' ', QString::SkipEmptyParts);
+#else
+    QStringList tokens = message.simplified().split(' ', Qt::SkipEmptyParts);
+#endif
+    if (tokens.isEmpty())
+        return;
+
+    uint recordedid = 0;
+    bool membership = true;
+    ProgramInfo updated;
+    bool hasUpdate = false;     // otherwise just the file size, if not membership
+    uint64_t filesize = 0;
+    if (tokens[0] == "RECORDING_LIST_CHANGE")
+    {
+        if (tokens.size() >= 3 && (tokens[1] == "ADD" || tokens[1] == "DELETE"))
+        {
+            recordedid = tokens[2].toUInt();
+        }
+        else if (tokens.size() >= 2 && tokens[1] == "UPDATE")
+        {
+            updated = ProgramInfo(extra);
+            recordedid = updated.GetRecordingID();
+            if (recordedid)
+            {
+                hasUpdate = true;
+                membership = false;
+            }
+        }
+    }
+    else if (tokens[0] == "UPDATE_FILE_SIZE")
+    {
+        if (tokens.size() < 3)
+            return;
+        recordedid = tokens[1].toUInt();
+        if (!recordedid)
+            return;
+        filesize = tokens[2].toULongLong();
+        membership = false;
+    }
+    else
+    {
+        return;
+    }
+
+    QMutexLocker locker(&m_changeLock);
+    if (hasUpdate)
+    {
+        // This includes the file size, so supersedes any queued one
+        m_updates[recordedid] = updated;
+        m_filesizes.remove(recordedid);
+    }
+    else if (!membership)
+    {
+        auto it = m_updates.find(recordedid);
+        if (it != m_updates.end())
+            it->SetFilesize(filesize);
+        else
+            m_filesizes[recordedid] = filesize;
+    }
+
+    m_generation++;
+    if (membership)
+        m_membership = m_generation;
+
+    if (!recordedid)
+    {
+        m_changes.clear();
+        m_oldest = m_generation;
+        return;
+    }
+
+    m_changes.push_back({m_generation, recordedid});
+    while (m_changes.size() > kMaxChanges)
+    {
+        m_oldest = m_changes.front().m_generation;
+        m_changes.pop_front();
+    }
+}
+
+/** \brief Copies up to \p count recordings into \p page, starting with
+ *         the \p start'th oldest (or newest).
+ *  \param total set to the number of recordings in the list.
+ *  \return the generation of the list the page was taken from, which
+ *          only changes when a recording is added or deleted.
+ */
+uint64_t RecordingListCache::GetPage(bool newestFirst, uint start, uint count,
+                                     ProgramList &page, uint &total)
+{
+    m_changeLock.lock();
+    uint64_t generation = m_membership;
+    m_changeLock.unlock();
+
+    QMutexLocker locker(&m_listLock);
+    Refresh(generation);
+
+    total = m_list.size();
+    for (uint i = start; (i < total) && (i - start < count); ++i)
+        page.push_back(new ProgramInfo(*m_list[newestFirst ? total - 1 - i : i]));
+
+    return m_listGeneration;
+}
+
+/** \brief Copies the recordings that have changed since \p generation
+ *         into \p changed, and lists those since deleted in \p deleted.
+ *
+ *  \p generation is updated to the current one, to be passed in next
+ *  time.
+ *  \return false if the changes are no longer known, or \p generation
+ *          is from a previous run of the backend, in which case the
+ *          whole list must be reloaded.
+ */
+bool RecordingListCache::GetChanges(uint64_t &generation, ProgramList &changed,
+                                    QList<uint> &deleted)
+{
+    QSet<uint> recordedids;
+    uint64_t membership = 0;
+    {
+        QMutexLocker locker(&m_changeLock);
+        if (generation < m_oldest || generation > m_generation)
+        {
+            LOG(VB_NETWORK, LOG_INFO, LOC +
+                QString("Changes since %1 are unknown, the oldest known is %2")
+                    .arg(generation).arg(m_oldest));
+            generation = m_generation;
+            return false;
+        }
+
+        for (auto it = m_changes.crbegin();
+             it != m_changes.crend() && it->m_generation > generation; ++it)
+        {
+            recordedids.insert(it->m_recordedId);
+        }
+        generation = m_generation;
+        membership = m_membership;
+    }
+
+    if (recordedids.isEmpty())
+        return true;
+
+    QMutexLocker locker(&m_listLock);
+    Refresh(membership);
+
+    for (uint recordedid : qAsConst(recordedids))
+    {
+        ProgramInfo *pginfo = m_byId.value(recordedid);
+        if (pginfo)
+            changed.push_back(new ProgramInfo(*pginfo));
+        else
+            deleted << recordedid;
+    }
+
+    return true;
+}
+
+/// Reloads the list if it predates the membership \p generation or has
+/// expired, then applies the queued updates to it.
+/// \note m_listLock must be held.
+void RecordingListCache::Refresh(uint64_t generation)
+{
+    if ((m_listGeneration < generation) || !m_listAge.isValid() ||
+        m_listAge.hasExpired(kMaxAge.count()))
+    {
+        m_byId.clear();
+        m_list.clear();
+        m_loader(m_list);
+        for (auto *pginfo : m_list)
+            m_byId[pginfo->GetRecordingID()] = pginfo;
+        m_listGeneration = generation;
+        m_listAge.start();
+
+        LOG(VB_NETWORK, LOG_INFO, LOC +
+            QString("Loaded %1 recordings for generation %2")
+                .arg(m_list.size()).arg(generation));
+    }
+
+    // Updates queued while loading may be newer than what was loaded
+    QHash<uint,ProgramInfo> updates;
+    QHash<uint,uint64_t> filesizes;
+    m_changeLock.lock();
+    updates.swap(m_updates);
+    filesizes.swap(m_filesizes);
+    m_changeLock.unlock();
+
+    for (auto it = updates.cbegin(); it != updates.cend(); ++it)
+    {
+        ProgramInfo *pginfo = m_byId.value(it.key());
+        if (pginfo)
+            pginfo->clone(*it);
+    }
+    for (auto it = filesizes.cbegin(); it != filesizes.cend(); ++it)
+    {
+        ProgramInfo *pginfo = m_byId.value(it.key());
+        if (pginfo)
+            pginfo->SetFilesize(*it);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef RECORDING_LIST_CACHE_H
+#define RECORDING_LIST_CACHE_H
+
+// C++ headers
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+
+// MythTV headers
+#include "mythchrono.h"
+#include "programinfo.h"
+
+/** \brief The recorded programs list behind the paged and incremental
+ *         forms of QUERY_RECORDINGS.
+ *
+ *  Each RECORDING_LIST_CHANGE or UPDATE_FILE_SIZE event seen by the
+ *  backend increments the generation and notes the recording it names
+ *  in a change log.  Updates to a recording, which are frequent while
+ *  anything is recording, are queued and applied to the list in place
+ *  the next time it is read, so that an event never waits for the list
+ *  to be loaded.  The list is only reloaded when it is asked for and a
+ *  recording has been added or deleted since it was loaded, or it is
+ *  older than kMaxAge, so all frontends share one query of the recorded
+ *  table.
+ *
+ *  Pages are labelled with the generation of the last addition or
+ *  deletion, since only those move the other recordings between pages.
+ *
+ *  Generations start from the time the backend started, so one from a
+ *  previous run of the backend is never mistaken for a current one.
+ */
+class RecordingListCache
+{
+  public:
+    using Loader = std::function<void(ProgramList &list)>;
+
+    /// \p loader fills a list of the recordings, oldest first.
+    explicit RecordingListCache(Loader loader);
+
+    void HandleEvent(const QString &message, const QStringList &extra);
+
+    uint64_t GetPage(bool newestFirst, uint start, uint count,
+                     ProgramList &page, uint &total);
+    bool GetChanges(uint64_t &generation, ProgramList &changed,
+                    QList<uint> &deleted);
+
+    /// Changes older than this many are forgotten, their clients reload.
+    static constexpr size_t kMaxChanges { 10000 };
+    /// The list is reloaded after this long, to pick up flags such as
+    /// in use and commercial flagging which have no change events.
+    static constexpr std::chrono::milliseconds kMaxAge { 60s };
+
+  private:
+    void Refresh(uint64_t generation);
+
+    struct Change
+    {
+        uint64_t m_generation;
+        uint     m_recordedId;
+    };
+
+    Loader             m_loader;
+
+    QMutex             m_changeLock;
+    uint64_t           m_generation {0};     // protected by m_changeLock
+    /// All changes after this generation are in m_changes.
+    uint64_t           m_oldest     {0};     // protected by m_changeLock
+    /// The generation of the last recording added or deleted.
+    uint64_t           m_membership {0};     // protected by m_changeLock
+    std::deque<Change> m_changes;            // protected by m_changeLock
+    /// Updates not yet applied to the list, by recording.
+    QHash<uint,ProgramInfo> m_updates;       // protected by m_changeLock
+    /// New file sizes not yet applied to the list, by recording.
+    QHash<uint,uint64_t> m_filesizes;        // protected by m_changeLock
+
+    QMutex             m_listLock;
+    ProgramList        m_list;               // protected by m_listLock
+    QHash<uint,ProgramInfo*> m_byId;         // protected by m_listLock
+    uint64_t           m_listGeneration {0}; // protected by m_listLock
+    QElapsedTimer      m_listAge;            // protected by m_listLock
+};
+
+#endif // RECORDING_LIST_CACHE_H
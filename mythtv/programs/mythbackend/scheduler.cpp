@@ -15,6 +15,9 @@
 
 #include <sys/stat.h>
 #include <sys/time.h>
+#ifndef _WIN32
+#  include <sys/resource.h>
+#endif
 #include <sys/types.h>
 
 #include <QStringList>
@@ -24,9 +27,14 @@
 #include <QMutex>
 #include <QFile>
 #include <QMap>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QRunnable>
+#include <QThread>
 
 #include "mythmiscutil.h"
 #include "mythsystemlegacy.h"
+#include "mthreadpool.h"
 #include "scheduler.h"
 #include "encoderlink.h"
 #include "mainserver.h"
@@ -52,6 +60,20 @@
 #define LOC_ERR QString("Scheduler, Error: ")
 
 bool debugConflicts = false;
+bool debugSchedParallel = false;
+
+/// Resolves the conflicts of one independent part of the work list.
+class SchedComponentRunnable : public QRunnable
+{
+  public:
+    SchedComponentRunnable(Scheduler &sched, RecList &reclist) :
+        m_sched(sched), m_reclist(reclist) {}
+    void run(void) override { m_sched.SchedNewLevels(m_reclist); }
+
+  private:
+    Scheduler &m_sched;
+    RecList   &m_reclist;
+};
 
 Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
                      const QString& tmptable, Scheduler *master_sched) :
@@ -64,6 +86,7 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
     m_openEnd(openEndNever)
 {
     debugConflicts = qEnvironmentVariableIsSet("DEBUG_CONFLICTS");
+    debugSchedParallel = qEnvironmentVariableIsSet("DEBUG_SCHED_PARALLEL");
 
     if (master_sched)
         master_sched->GetAllPending(m_recList);
@@ -94,6 +117,18 @@ Scheduler::Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
     }
 }
 
+Scheduler::Scheduler(QMap<int, EncoderLink *> *tvList) :
+    MThread("Scheduler"),
+    m_recordTable("record"),
+    m_priorityTable("powerpriority"),
+    m_specSched(false),
+    m_tvList(tvList),
+    m_doRun(false),
+    m_openEnd(openEndNever),
+    m_fixtureReplay(true)
+{
+}
+
 Scheduler::~Scheduler()
 {
     QMutexLocker locker(&m_schedLock);
@@ -436,33 +471,66 @@ bool Scheduler::FillRecordList(void)
 {
     QReadLocker tvlocker(&TVRec::s_inputsLock);
 
-    m_schedTime = MythDate::current();
+    // A replayed fixture already has its work list and schedule time.
+    if (!m_fixtureReplay)
+        m_schedTime = MythDate::current();
+
+    // Wall time of each phase, reported once placement is done.
+    QStringList phases;
+    auto phasestart = nowAsDuration<std::chrono::microseconds>();
+    auto endPhase = [&phases, &phasestart](const QString &name)
+    {
+        auto phaseend = nowAsDuration<std::chrono::microseconds>();
+        phases << QString("%1 %2").arg(name)
+            .arg(duration_cast<floatsecs>(phaseend - phasestart).count(),
+                 0, 'f', 3);
+        phasestart = phaseend;
+    };
 
-    LOG(VB_SCHEDULE, LOG_INFO, "BuildWorkList...");
-    BuildWorkList();
+    if (!m_fixtureReplay)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "BuildWorkList...");
+        BuildWorkList();
+        endPhase("BuildWorkList");
+    }
 
     m_schedLock.unlock();
 
-    LOG(VB_SCHEDULE, LOG_INFO, "AddNewRecords...");
-    AddNewRecords();
-    LOG(VB_SCHEDULE, LOG_INFO, "AddNotListed...");
-    AddNotListed();
+    if (!m_fixtureReplay)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO, "AddNewRecords...");
+        AddNewRecords();
+        endPhase("AddNewRecords");
+        LOG(VB_SCHEDULE, LOG_INFO, "AddNotListed...");
+        AddNotListed();
+        endPhase("AddNotListed");
+    }
+
+    if (!m_fixtureFile.isEmpty())
+    {
+        SaveFixture(m_fixtureFile);
+        phasestart = nowAsDuration<std::chrono::microseconds>();
+    }
 
     LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
     SORT_RECLIST(m_workList, comp_overlap);
     LOG(VB_SCHEDULE, LOG_INFO, "PruneOverlaps...");
     PruneOverlaps();
+    endPhase("PruneOverlaps");
 
     LOG(VB_SCHEDULE, LOG_INFO, "Sort by priority...");
     SORT_RECLIST(m_workList, comp_priority);
     LOG(VB_SCHEDULE, LOG_INFO, "BuildListMaps...");
     BuildListMaps();
+    endPhase("BuildListMaps");
     LOG(VB_SCHEDULE, LOG_INFO, "SchedNewRecords...");
     SchedNewRecords();
+    endPhase("SchedNewRecords");
     LOG(VB_SCHEDULE, LOG_INFO, "SchedLiveTV...");
     SchedLiveTV();
     LOG(VB_SCHEDULE, LOG_INFO, "ClearListMaps...");
     ClearListMaps();
+    endPhase("SchedLiveTV");
 
     m_schedLock.lock();
 
@@ -470,11 +538,17 @@ bool Scheduler::FillRecordList(void)
     SORT_RECLIST(m_workList, comp_redundant);
     LOG(VB_SCHEDULE, LOG_INFO, "PruneRedundants...");
     PruneRedundants();
+    endPhase("PruneRedundants");
 
     LOG(VB_SCHEDULE, LOG_INFO, "Sort by time...");
     SORT_RECLIST(m_workList, comp_recstart);
     LOG(VB_SCHEDULE, LOG_INFO, "ClearWorkList...");
     bool res = ClearWorkList();
+    endPhase("ClearWorkList");
+
+    LOG(VB_SCHEDULE, LOG_INFO, "Place phase times (sec): " +
+        phases.join(", "));
+    m_placePhases = phases;
 
     return res;
 }
@@ -578,6 +652,263 @@ void Scheduler::FillRecordListFromMaster(void)
         m_recList.push_back(it);
 }
 
+/** \brief Calculates the schedule from the database like
+ *         FillRecordListFromDB(), and saves the work list as it is
+ *         just before placement to a fixture file.
+ *
+ *  The fixture can be replayed without a database by ReplayFixture().
+ */
+void Scheduler::DumpFixture(const QString &filename)
+{
+    m_fixtureFile = filename;
+    FillRecordListFromDB();
+    m_fixtureFile.clear();
+
+    std::cout << "Scheduled " << m_recList.size() << " items, hash "
+              << GetScheduleHash().toLocal8Bit().constData() << "\n";
+}
+
+/** \brief Runs the placement passes on a fixture saved by DumpFixture()
+ *         and prints the time taken by each phase and a hash of the
+ *         resulting schedule.
+ *
+ *  The hash matches the one printed by DumpFixture() unless the
+ *  scheduling code changed, or time dependent checks (like the 30
+ *  second grace period for recordings that have already started)
+ *  come out differently.
+ */
+int Scheduler::ReplayFixture(const QString &filename)
+{
+    QMap<int, EncoderLink *> tvList;
+    Scheduler sched(&tvList);
+    if (!sched.LoadFixture(filename))
+        return GENERIC_EXIT_NOT_OK;
+
+    size_t items = sched.m_workList.size();
+#ifndef _WIN32
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    long startrss = usage.ru_maxrss;
+#endif
+
+    auto start = nowAsDuration<std::chrono::microseconds>();
+    {
+        QMutexLocker locker(&sched.m_schedLock);
+        sched.FillRecordList();
+    }
+    auto end = nowAsDuration<std::chrono::microseconds>();
+
+    std::cout << "Placed " << items << " items in "
+              << duration_cast<floatsecs>(end - start).count() << " sec\n";
+    for (const auto & phase : qAsConst(sched.m_placePhases))
+        std::cout << "  " << phase.toLocal8Bit().constData() << "\n";
+#ifndef _WIN32
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "Peak RSS " << usage.ru_maxrss << " KiB (+"
+              << usage.ru_maxrss - startrss << " KiB)\n";
+#endif
+    std::cout << "Scheduled " << sched.m_recList.size() << " items, hash "
+              << sched.GetScheduleHash().toLocal8Bit().constData() << "\n";
+
+    return GENERIC_EXIT_OK;
+}
+
+static const quint32 kFixtureMagic   { 0x4d545346 }; // "MTSF"
+static const quint32 kFixtureVersion { 1 };
+
+static void write_uints(QDataStream &out, const vector<uint> &list)
+{
+    out << static_cast<quint32>(list.size());
+    for (uint value : list)
+        out << static_cast<quint32>(value);
+}
+
+static vector<uint> read_uints(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    vector<uint> list;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        quint32 value = 0;
+        in >> value;
+        list.push_back(value);
+    }
+    return list;
+}
+
+/// Saves the inputs and the work list, ready for placement.
+bool Scheduler::SaveFixture(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Unable to create fixture %1").arg(filename));
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kFixtureMagic << kFixtureVersion
+        << m_schedTime << static_cast<qint32>(
+            gCoreContext->GetNumSetting("SchedOpenEnd", openEndNever));
+
+    out << static_cast<quint32>(m_conflictLists.size());
+    out << static_cast<quint32>(m_sinputInfoMap.size());
+    for (const auto & siinfo : qAsConst(m_sinputInfoMap))
+    {
+        auto it = std::find(m_conflictLists.cbegin(), m_conflictLists.cend(),
+                            siinfo.m_conflictList);
+        qint32 conflictset = (it == m_conflictLists.cend()) ? -1 :
+            static_cast<qint32>(it - m_conflictLists.cbegin());
+        out << static_cast<quint32>(siinfo.m_inputId)
+            << static_cast<quint32>(siinfo.m_sgroupId)
+            << siinfo.m_schedGroup << conflictset;
+        write_uints(out, siinfo.m_groupInputs);
+        write_uints(out, siinfo.m_conflictingInputs);
+    }
+
+    out << static_cast<quint32>(m_workList.size());
+    for (auto *p : m_workList)
+    {
+        // Placement never looks at the recorded file, and loading it
+        // would need the database.
+        RecordingInfo ri(*p);
+        ri.SetRecordingID(0);
+        QStringList list;
+        ri.ToStringList(list);
+        out << list
+            << static_cast<qint32>(p->m_oldrecstatus) << p->m_future
+            << static_cast<qint32>(p->m_schedOrder)
+            << static_cast<quint32>(p->m_mplexId)
+            << static_cast<quint32>(p->m_sgroupId)
+            << p->GetDesiredStartTime() << p->GetDesiredEndTime();
+    }
+
+    if (out.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Error writing fixture %1").arg(filename));
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Saved %1 work list items to fixture %2")
+        .arg(m_workList.size()).arg(filename));
+    return true;
+}
+
+bool Scheduler::LoadFixture(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Unable to open fixture %1").arg(filename));
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 openend = 0;
+    in >> magic >> version >> m_schedTime >> openend;
+    if (magic != kFixtureMagic || version != kFixtureVersion)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("%1 is not a scheduler fixture").arg(filename));
+        return false;
+    }
+    m_openEnd = static_cast<OpenEndType>(openend);
+
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count; ++i)
+        m_conflictLists.push_back(new RecList());
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        quint32 inputid = 0;
+        quint32 sgroupid = 0;
+        bool schedgroup = false;
+        qint32 conflictset = -1;
+        in >> inputid >> sgroupid >> schedgroup >> conflictset;
+
+        SchedInputInfo &siinfo = m_sinputInfoMap[inputid];
+        siinfo.m_inputId = inputid;
+        siinfo.m_sgroupId = sgroupid;
+        siinfo.m_schedGroup = schedgroup;
+        siinfo.m_groupInputs = read_uints(in);
+        siinfo.m_conflictingInputs = read_uints(in);
+        if (conflictset >= 0 &&
+            conflictset < static_cast<qint32>(m_conflictLists.size()))
+            siinfo.m_conflictList = m_conflictLists[conflictset];
+    }
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QStringList list;
+        qint32 oldrecstatus = 0;
+        bool future = false;
+        qint32 schedorder = 0;
+        quint32 mplexid = 0;
+        quint32 sgroupid = 0;
+        QDateTime desiredstart;
+        QDateTime desiredend;
+        in >> list >> oldrecstatus >> future >> schedorder
+           >> mplexid >> sgroupid >> desiredstart >> desiredend;
+
+        QStringList::const_iterator it = list.cbegin();
+        auto *p = new RecordingInfo(it, list.cend());
+        if (!p->GetChanID())
+        {
+            delete p;
+            break;
+        }
+        p->m_oldrecstatus = static_cast<RecStatus::Type>(oldrecstatus);
+        p->m_future = future;
+        p->m_schedOrder = schedorder;
+        p->m_mplexId = mplexid;
+        p->m_sgroupId = sgroupid;
+        p->SetDesiredStartTime(desiredstart);
+        p->SetDesiredEndTime(desiredend);
+        m_workList.push_back(p);
+    }
+
+    if (in.status() != QDataStream::Ok || m_workList.size() != count)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            QString("Fixture %1 is truncated or corrupt").arg(filename));
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Loaded %1 work list items from fixture %2")
+        .arg(m_workList.size()).arg(filename));
+    return true;
+}
+
+/// Returns a hash of the placed schedule, to compare the results of
+/// different runs.
+QString Scheduler::GetScheduleHash(void) const
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (const auto *p : m_recList)
+    {
+        hash.addData(QString("%1 %2 %3 %4 %5\n")
+                     .arg(p->GetChanID())
+                     .arg(p->GetRecordingStartTime(MythDate::ISODate))
+                     .arg(p->GetRecordingRuleID())
+                     .arg(p->GetInputID())
+                     .arg(p->GetRecordingStatus()).toUtf8());
+    }
+    return QString(hash.result().toHex());
+}
+
 void Scheduler::PrintList(const RecList &list, bool onlyFutureRecordings)
 {
     if (!VERBOSE_LEVEL_CHECK(VB_SCHEDULE, LOG_DEBUG))
@@ -1047,16 +1378,24 @@ bool Scheduler::IsSameProgram(
     const RecordingInfo *a, const RecordingInfo *b) const
 {
     IsSameKey X(a,b);
-    IsSameCacheType::const_iterator it = m_cacheIsSameProgram.constFind(X);
-    if (it != m_cacheIsSameProgram.constEnd())
-        return *it;
-
     IsSameKey Y(b,a);
-    it = m_cacheIsSameProgram.constFind(Y);
-    if (it != m_cacheIsSameProgram.constEnd())
-        return *it;
+    {
+        QMutexLocker locker(&m_cacheIsSameProgramLock);
+        IsSameCacheType::const_iterator it = m_cacheIsSameProgram.constFind(X);
+        if (it != m_cacheIsSameProgram.constEnd())
+            return *it;
+
+        it = m_cacheIsSameProgram.constFind(Y);
+        if (it != m_cacheIsSameProgram.constEnd())
+            return *it;
+    }
 
-    return m_cacheIsSameProgram[X] = a->IsDuplicateProgram(*b);
+    // Compare outside of the lock, the result is the same no matter
+    // which thread gets to store it.
+    bool same = a->IsDuplicateProgram(*b);
+    QMutexLocker locker(&m_cacheIsSameProgramLock);
+    m_cacheIsSameProgram[X] = same;
+    return same;
 }
 
 bool Scheduler::FindNextConflict(
@@ -1182,21 +1521,26 @@ const RecordingInfo *Scheduler::FindConflict(
 
 void Scheduler::MarkOtherShowings(RecordingInfo *p)
 {
-    RecList *showinglist = &m_titleListMap[p->GetTitle().toLower()];
-    MarkShowingsList(*showinglist, p);
+    // Only look up the list maps here, this may run concurrently for
+    // independent parts of the work list.
+    auto tit = m_titleListMap.constFind(p->GetTitle().toLower());
+    if (tit != m_titleListMap.constEnd())
+        MarkShowingsList(*tit, p);
 
+    uint recordid = 0;
     if (p->GetRecordingRuleType() == kOneRecord ||
         p->GetRecordingRuleType() == kDailyRecord ||
         p->GetRecordingRuleType() == kWeeklyRecord)
-    {
-        showinglist = &m_recordIdListMap[p->GetRecordingRuleID()];
-        MarkShowingsList(*showinglist, p);
-    }
+        recordid = p->GetRecordingRuleID();
     else if (p->GetRecordingRuleType() == kOverrideRecord && p->GetFindID())
-    {
-        showinglist = &m_recordIdListMap[p->GetParentRecordingRuleID()];
-        MarkShowingsList(*showinglist, p);
-    }
+        recordid = p->GetParentRecordingRuleID();
+
+    if (!recordid)
+        return;
+
+    auto rit = m_recordIdListMap.constFind(recordid);
+    if (rit != m_recordIdListMap.constEnd())
+        MarkShowingsList(*rit, p);
 }
 
 void Scheduler::MarkShowingsList(const RecList &showinglist, RecordingInfo *p)
@@ -1224,17 +1568,17 @@ void Scheduler::MarkShowingsList(const RecList &showinglist, RecordingInfo *p)
     }
 }
 
-void Scheduler::BackupRecStatus(void)
+void Scheduler::BackupRecStatus(const RecList &reclist)
 {
-    for (auto *p : m_workList)
+    for (auto *p : reclist)
     {
         p->m_savedrecstatus = p->GetRecordingStatus();
     }
 }
 
-void Scheduler::RestoreRecStatus(void)
+void Scheduler::RestoreRecStatus(const RecList &reclist)
 {
-    for (auto *p : m_workList)
+    for (auto *p : reclist)
     {
         p->SetRecordingStatus(p->m_savedrecstatus);
     }
@@ -1251,7 +1595,11 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
         p->GetRecordingStatus() == RecStatus::Pending)
         return false;
 
-    RecList *showinglist = &m_recordIdListMap[p->GetRecordingRuleID()];
+    // Only read here, conflict sets may be placed in parallel
+    auto rule = m_recordIdListMap.constFind(p->GetRecordingRuleID());
+    if (rule == m_recordIdListMap.constEnd())
+        return false;
+    const RecList *showinglist = &(*rule);
 
     RecStatus::Type oldstatus = p->GetRecordingStatus();
     p->SetRecordingStatus(RecStatus::LaterShowing);
@@ -1337,8 +1685,7 @@ bool Scheduler::TryAnotherShowing(RecordingInfo *p, bool samePriority,
 
         best->SetRecordingStatus(RecStatus::WillRecord);
         MarkOtherShowings(best);
-        if (best->GetRecordingStartTime() < m_livetvTime)
-            m_livetvTime = best->GetRecordingStartTime();
+        UpdateLiveTVTime(best->GetRecordingStartTime());
         PrintRec(p, "    -");
         PrintRec(best, "    +");
         return true;
@@ -1371,8 +1718,11 @@ void Scheduler::SchedNewRecords(void)
     }
 
     m_livetvTime = MythDate::current().addSecs(3600);
-    m_openEnd =
-        (OpenEndType)gCoreContext->GetNumSetting("SchedOpenEnd", openEndNever);
+    if (!m_fixtureReplay)
+    {
+        m_openEnd = (OpenEndType)gCoreContext->GetNumSetting("SchedOpenEnd",
+                                                             openEndNever);
+    }
 
     auto i = m_workList.begin();
     for ( ; i != m_workList.end(); ++i)
@@ -1384,14 +1734,106 @@ void Scheduler::SchedNewRecords(void)
         MarkOtherShowings(*i);
     }
 
-    while (i != m_workList.end())
+    // Keep the debug output in order by resolving everything serially
+    // when it is requested.
+    vector<RecList> components;
+    if (!debugConflicts && !VERBOSE_LEVEL_CHECK(VB_SCHEDULE, LOG_DEBUG))
+        components = SplitSchedComponents(i, m_workList.cend());
+
+    if (components.size() < 2)
+    {
+        RecList reclist(i, m_workList.end());
+        SchedNewLevels(reclist);
+        return;
+    }
+
+    // Save the starting state so the serial result can be checked
+    // against the parallel one.
+    vector<RecStatus::Type> startStatus;
+    QDateTime startLivetvTime = m_livetvTime;
+    if (debugSchedParallel)
+    {
+        for (auto *p : m_workList)
+            startStatus.push_back(p->GetRecordingStatus());
+    }
+
+    int threads = std::min(static_cast<int>(components.size()),
+                           QThread::idealThreadCount());
+    LOG(VB_SCHEDULE, LOG_INFO,
+        QString("Resolving %1 independent conflict sets on %2 threads")
+        .arg(components.size()).arg(threads));
+
+    MThreadPool pool("SchedNewRecords");
+    pool.setMaxThreadCount(threads);
+    for (auto & reclist : components)
+        pool.start(new SchedComponentRunnable(*this, reclist),
+                   "SchedComponent");
+    pool.waitForDone();
+
+    if (!debugSchedParallel)
+        return;
+
+    vector<RecStatus::Type> parallelStatus;
+    for (auto *p : m_workList)
+        parallelStatus.push_back(p->GetRecordingStatus());
+    QDateTime parallelLivetvTime = m_livetvTime;
+
+    size_t n = 0;
+    for (auto *p : m_workList)
+        p->SetRecordingStatus(startStatus[n++]);
+    m_livetvTime = startLivetvTime;
+    {
+        QMutexLocker locker(&m_cacheIsSameProgramLock);
+        m_cacheIsSameProgram.clear();
+    }
+
+    RecList reclist(i, m_workList.end());
+    SchedNewLevels(reclist);
+
+    uint mismatches = 0;
+    n = 0;
+    for (auto *p : m_workList)
+    {
+        if (p->GetRecordingStatus() != parallelStatus[n++])
+        {
+            ++mismatches;
+            LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+                QString("Parallel schedule mismatch for '%1' on input %2 "
+                        "at %3: serial %4, parallel %5")
+                .arg(p->GetTitle()).arg(p->GetInputID())
+                .arg(p->GetScheduledStartTime(MythDate::ISODate))
+                .arg(RecStatus::toString(p->GetRecordingStatus(),
+                                         p->GetInputID()),
+                     RecStatus::toString(parallelStatus[n - 1],
+                                         p->GetInputID())));
+        }
+    }
+    if (m_livetvTime != parallelLivetvTime)
+    {
+        ++mismatches;
+        LOG(VB_GENERAL, LOG_ERR, LOC_ERR +
+            "Parallel schedule mismatch for the LiveTV time");
+    }
+
+    LOG(VB_GENERAL, mismatches ? LOG_ERR : LOG_INFO, LOC +
+        QString("Parallel schedule check: %1 mismatches in %2 entries")
+        .arg(mismatches).arg(m_workList.size()));
+}
+
+// Resolve the given, priority ordered list of new recordings one
+// priority level at a time.  The list is either the whole work list
+// or one independent component of it.
+void Scheduler::SchedNewLevels(RecList &reclist)
+{
+    auto i = reclist.begin();
+    while (i != reclist.end())
     {
         auto levelStart = i;
         int recpriority = (*i)->GetRecordingPriority();
 
-        while (i != m_workList.end())
+        while (i != reclist.end())
         {
-            if (i == m_workList.end() ||
+            if (i == reclist.end() ||
                 (*i)->GetRecordingPriority() != recpriority)
                 break;
 
@@ -1400,20 +1842,110 @@ void Scheduler::SchedNewRecords(void)
             LOG(VB_SCHEDULE, LOG_DEBUG, QString("Trying priority %1/%2...")
                 .arg(recpriority).arg(recpriority2));
             // First pass for anything in this priority sublevel.
-            SchedNewFirstPass(i, m_workList.end(), recpriority, recpriority2);
+            SchedNewFirstPass(i, reclist.end(), recpriority, recpriority2);
 
             LOG(VB_SCHEDULE, LOG_DEBUG, QString("Retrying priority %1/%2...")
                 .arg(recpriority).arg(recpriority2));
-            SchedNewRetryPass(sublevelStart, i, true);
+            SchedNewRetryPass(reclist, sublevelStart, i, true);
         }
 
         // Retry pass for anything in this priority level.
         LOG(VB_SCHEDULE, LOG_DEBUG, QString("Retrying priority %1/*...")
             .arg(recpriority));
-        SchedNewRetryPass(levelStart, i, false);
+        SchedNewRetryPass(reclist, levelStart, i, false);
     }
 }
 
+// Split the remaining work list into parts that can not affect each
+// other.  Showings are only compared against others in the same
+// conflict list, with the same title, or from the same rule (or its
+// parent rule), so any showings connected that way must stay
+// together.  Each part keeps the priority order of the work list,
+// which makes resolving the parts separately give the same result as
+// resolving the whole list at once.
+vector<RecList> Scheduler::SplitSchedComponents(
+    RecConstIter start, const RecConstIter &end) const
+{
+    // Union-find over the conflict lists, which are the roots that
+    // everything else gets merged into.
+    QMap<const RecList*, int> setIndex;
+    vector<int> parent;
+    auto find = [&parent](int x)
+    {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    auto unite = [&parent, &find](int x, int y)
+    {
+        x = find(x);
+        y = find(y);
+        if (x != y)
+            parent[std::max(x, y)] = std::min(x, y);
+    };
+
+    QMap<QString, int> titleSet;
+    QMap<uint, int> ruleSet;
+    vector<int> itemSet;
+    for (auto it = start; it != end; ++it)
+    {
+        const RecordingInfo *p = *it;
+        const RecList *conflictlist =
+            qAsConst(m_sinputInfoMap)[p->GetInputID()].m_conflictList;
+        auto sit = setIndex.constFind(conflictlist);
+        int set = 0;
+        if (sit == setIndex.constEnd())
+        {
+            set = static_cast<int>(parent.size());
+            parent.push_back(set);
+            setIndex.insert(conflictlist, set);
+        }
+        else
+        {
+            set = *sit;
+        }
+        itemSet.push_back(set);
+
+        QString title = p->GetTitle().toLower();
+        auto tit = titleSet.constFind(title);
+        if (tit == titleSet.constEnd())
+            titleSet.insert(title, set);
+        else
+            unite(set, *tit);
+
+        for (uint recordid : { p->GetRecordingRuleID(),
+                               p->GetParentRecordingRuleID() })
+        {
+            if (!recordid)
+                continue;
+            auto rit = ruleSet.constFind(recordid);
+            if (rit == ruleSet.constEnd())
+                ruleSet.insert(recordid, set);
+            else
+                unite(set, *rit);
+        }
+    }
+
+    // Number the parts in order of their first showing so the split is
+    // the same on every run.
+    vector<RecList> components;
+    QMap<int, size_t> componentIndex;
+    size_t n = 0;
+    for (auto it = start; it != end; ++it)
+    {
+        int root = find(itemSet[n++]);
+        auto cit = componentIndex.constFind(root);
+        if (cit == componentIndex.constEnd())
+        {
+            cit = componentIndex.insert(root, components.size());
+            components.emplace_back();
+        }
+        components[*cit].push_back(*it);
+    }
+
+    return components;
+}
+
 // Perform the first pass for scheduling new recordings for programs
 // in the same priority sublevel.  For each program/starttime, choose
 // the first one with the highest affinity that doesn't conflict.
@@ -1486,16 +2018,23 @@ void Scheduler::SchedNewFirstPass(RecIter &start, const RecIter& end,
             PrintRec(best, "  +");
             best->SetRecordingStatus(RecStatus::WillRecord);
             MarkOtherShowings(best);
-            if (best->GetRecordingStartTime() < m_livetvTime)
-                m_livetvTime = best->GetRecordingStartTime();
+            UpdateLiveTVTime(best->GetRecordingStartTime());
         }
     }
 }
 
+void Scheduler::UpdateLiveTVTime(const QDateTime &starttime)
+{
+    QMutexLocker locker(&m_livetvTimeLock);
+    if (starttime < m_livetvTime)
+        m_livetvTime = starttime;
+}
+
 // Perform the retry passes for scheduling new recordings.  For each
 // unscheduled program, try to move the conflicting programs to
 // another time or tuner using the given constraints.
-void Scheduler::SchedNewRetryPass(const RecIter& start, const RecIter& end,
+void Scheduler::SchedNewRetryPass(const RecList &reclist,
+                                  const RecIter& start, const RecIter& end,
                                   bool samePriority, bool livetv)
 {
     RecList retry_list;
@@ -1518,28 +2057,28 @@ void Scheduler::SchedNewRetryPass(const RecIter& start, const RecIter& end,
             PrintRec(p, "  ?");
 
         // Assume we can successfully move all of the conflicts.
-        BackupRecStatus();
+        BackupRecStatus(reclist);
         p->SetRecordingStatus(RecStatus::WillRecord);
         if (!livetv)
             MarkOtherShowings(p);
 
         // Try to move each conflict.  Restore the old status if we
         // can't.
-        RecList &conflictlist = *m_sinputInfoMap[p->GetInputID()].m_conflictList;
+        RecList &conflictlist =
+            *qAsConst(m_sinputInfoMap)[p->GetInputID()].m_conflictList;
         auto k = conflictlist.cbegin();
         for ( ; FindNextConflict(conflictlist, p, k); ++k)
         {
             if (!TryAnotherShowing(*k, samePriority, livetv))
             {
-                RestoreRecStatus();
+                RestoreRecStatus(reclist);
                 break;
             }
         }
 
         if (!livetv && p->GetRecordingStatus() == RecStatus::WillRecord)
         {
-            if (p->GetRecordingStartTime() < m_livetvTime)
-                m_livetvTime = p->GetRecordingStartTime();
+            UpdateLiveTVTime(p->GetRecordingStartTime());
             PrintRec(p, "  +");
         }
     }
@@ -2277,6 +2816,164 @@ void Scheduler::ResetDuplicates(uint recordid, uint findid,
     }
  }
 
+static QStringList RequestTokens(const QStringList &request)
+{
+    if (request.empty())
+        return {};
+#if QT_VERSION < QT_VERSION_CHECK(5,14,0)
+    return request[0].split(' ', QString::SkipEmptyParts);
+#else
+    return request[0].split(' ', Qt::SkipEmptyParts);
+#endif
+}
+
+/// \brief Returns true for a MATCH request sent because of new guide data.
+static bool IsGuideMatchRequest(const QStringList &tokens)
+{
+    return tokens.size() >= 5 && tokens[0] == "MATCH" &&
+        tokens[1].toUInt() == 0 && tokens[2].toUInt() != 0;
+}
+
+/** \brief Drops queued MATCH requests made redundant by a later one.
+ *
+ *  During EIT scans the same source or multiplex is often rematched
+ *  many times before the scheduler gets to run. A queued MATCH
+ *  request is redundant when a later queued MATCH request covers the
+ *  same recording rule, source, multiplex and time range, since the
+ *  later request deletes and rebuilds all of those recordmatch rows
+ *  after anything queued in between has been handled.
+ */
+void Scheduler::CoalesceMatchRequests(void)
+{
+    struct MatchScope
+    {
+        uint      m_recordId {0};
+        uint      m_sourceId {0};
+        uint      m_mplexId  {0};
+        QDateTime m_maxStartTime;
+    };
+
+    auto parse = [](const QStringList &request, MatchScope &scope)
+    {
+        QStringList tokens = RequestTokens(request);
+        if (tokens.size() < 5 || tokens[0] != "MATCH")
+            return false;
+        scope.m_recordId     = tokens[1].toUInt();
+        scope.m_sourceId     = tokens[2].toUInt();
+        scope.m_mplexId      = tokens[3].toUInt();
+        scope.m_maxStartTime = MythDate::fromString(tokens[4]);
+        return true;
+    };
+
+    auto covers = [](const MatchScope &a, const MatchScope &b)
+    {
+        return (a.m_recordId == 0 || a.m_recordId == b.m_recordId) &&
+               (a.m_sourceId == 0 || a.m_sourceId == b.m_sourceId) &&
+               (a.m_mplexId  == 0 || a.m_mplexId  == b.m_mplexId)  &&
+               (!a.m_maxStartTime.isValid() ||
+                (b.m_maxStartTime.isValid() &&
+                 b.m_maxStartTime <= a.m_maxStartTime));
+    };
+
+    uint dropped = 0;
+    auto it = m_reschedQueue.begin();
+    while (it != m_reschedQueue.end())
+    {
+        MatchScope scope;
+        bool redundant = false;
+        if (parse(*it, scope))
+        {
+            for (auto later = it + 1;
+                 later != m_reschedQueue.end() && !redundant; ++later)
+            {
+                MatchScope laterScope;
+                redundant = parse(*later, laterScope) &&
+                    covers(laterScope, scope);
+            }
+        }
+
+        if (redundant)
+        {
+            LOG(VB_SCHEDULE, LOG_DEBUG, QString("Dropping redundant "
+                "reschedule request for %1").arg(it->join(" | ")));
+            it = m_reschedQueue.erase(it);
+            ++dropped;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (dropped)
+    {
+        LOG(VB_SCHEDULE, LOG_INFO,
+            QString("Dropped %1 redundant reschedule requests").arg(dropped));
+    }
+}
+
+/** \brief Returns true if every queued request is a guide data rematch.
+ *
+ *  These are the MATCH requests without a recording rule that are sent
+ *  for a whole source or multiplex when new guide data arrives, for
+ *  instance by the EIT scanner.
+ */
+bool Scheduler::IsGuideOnlyReschedule(void) const
+{
+    if (m_reschedQueue.empty())
+        return false;
+
+    return std::all_of(m_reschedQueue.cbegin(), m_reschedQueue.cend(),
+                       [](const QStringList &request)
+                           { return IsGuideMatchRequest(RequestTokens(request)); });
+}
+
+/** \brief Returns a digest of recordmatch and the matched showings.
+ *
+ *  Used to tell whether a guide data rematch changed anything the
+ *  placement passes depend on.  Every column of the matched program rows
+ *  is included, since the power priority rules may select on any of them.
+ *
+ *  \note m_recordMatchLock must be held when this is called.
+ */
+QString Scheduler::GetRecordMatchDigest(void)
+{
+    MSqlQuery query(m_dbConn);
+    query.prepare("SELECT COLUMN_NAME FROM INFORMATION_SCHEMA.COLUMNS "
+                  "WHERE TABLE_SCHEMA = DATABASE() AND "
+                  "      TABLE_NAME = 'program' "
+                  "ORDER BY ORDINAL_POSITION");
+    if (!query.exec())
+    {
+        MythDB::DBError("GetRecordMatchDigest", query);
+        return QString();
+    }
+
+    QStringList columns;
+    while (query.next())
+        columns << QString("p.`%1`").arg(query.value(0).toString());
+    if (columns.isEmpty())
+        return QString();
+
+    query.prepare(QString("SELECT COUNT(*), "
+                          "  SUM(CRC32(CONCAT_WS('|', rm.recordid, rm.chanid, "
+                          "    rm.starttime, rm.manualid, rm.oldrecduplicate, "
+                          "    rm.findid, %1))) "
+                          "FROM recordmatch rm "
+                          "LEFT JOIN program p ON p.chanid = rm.chanid AND "
+                          "    p.starttime = rm.starttime AND "
+                          "    p.manualid = rm.manualid")
+                  .arg(columns.join(", ")));
+    if (!query.exec() || !query.next())
+    {
+        MythDB::DBError("GetRecordMatchDigest", query);
+        return QString();
+    }
+
+    return QString("%1:%2").arg(query.value(0).toString(),
+                                query.value(1).toString());
+}
+
 bool Scheduler::HandleReschedule(void)
 {
     // We might have been inactive for a long time, so make
@@ -2288,18 +2985,33 @@ bool Scheduler::HandleReschedule(void)
     bool deleteFuture = false;
     bool runCheck = false;
 
+    CoalesceMatchRequests();
+
+    // Guide data updates, typically from EIT, often leave every matched
+    // showing unchanged, in which case placing everything again would
+    // only reproduce the current schedule. Remember what the matches
+    // looked like so placement can be skipped in that case.
+    QString matchDigest;
+    if (m_lastFullPlace.isValid() &&
+        (std::chrono::seconds(m_lastFullPlace.secsTo(MythDate::current())) <
+         kMaxPlaceSkipAge) &&
+        IsGuideOnlyReschedule())
+    {
+        m_schedLock.unlock();
+        m_recordMatchLock.lock();
+        matchDigest = GetRecordMatchDigest();
+        m_recordMatchLock.unlock();
+        m_schedLock.lock();
+    }
+
     while (HaveQueuedRequests())
     {
         QStringList request = m_reschedQueue.dequeue();
-        QStringList tokens;
-        if (!request.empty())
-        {
-#if QT_VERSION < QT_VERSION_CHECK(5,14,0)
-            tokens = request[0].split(' ', QString::SkipEmptyParts);
-#else
-            tokens = request[0].split(' ', Qt::SkipEmptyParts);
-#endif
-        }
+        QStringList tokens = RequestTokens(request);
+
+        // Anything else arriving while we work needs a full placement.
+        if (!IsGuideMatchRequest(tokens))
+            matchDigest.clear();
 
         if (request.empty() || tokens.empty())
         {
@@ -2379,6 +3091,26 @@ bool Scheduler::HandleReschedule(void)
             MythDB::DBError("DeleteFuture", query);
     }
 
+    if (!matchDigest.isEmpty())
+    {
+        m_schedLock.unlock();
+        m_recordMatchLock.lock();
+        bool unchanged = (GetRecordMatchDigest() == matchDigest);
+        m_recordMatchLock.unlock();
+        m_schedLock.lock();
+
+        if (unchanged && !HaveQueuedRequests())
+        {
+            auto skipTime = nowAsDuration<std::chrono::microseconds>() -
+                fillstart;
+            LOG(VB_GENERAL, LOG_INFO,
+                QString("Guide update changed no matched showings, "
+                        "kept current schedule after %1 match")
+                .arg(duration_cast<floatsecs>(skipTime).count(), 0, 'f', 2));
+            return false;
+        }
+    }
+
     auto fillend = nowAsDuration<std::chrono::microseconds>();
     auto matchTime = fillend - fillstart;
 
@@ -2406,6 +3138,7 @@ bool Scheduler::HandleReschedule(void)
     {
         UpdateNextRecord();
         PrintList();
+        m_lastFullPlace = MythDate::current();
     }
     else
     {
@@ -5611,7 +6344,8 @@ void Scheduler::SchedLiveTV(void)
     if (m_livetvList.empty())
         return;
 
-    SchedNewRetryPass(m_livetvList.begin(), m_livetvList.end(), false, true);
+    SchedNewRetryPass(m_workList, m_livetvList.begin(), m_livetvList.end(),
+                      false, true);
 
     while (!m_livetvList.empty())
     {
@@ -44,6 +44,8 @@ class SchedInputInfo
 
 class Scheduler : public MThread, public MythScheduler
 {
+    friend class SchedComponentRunnable;
+
   public:
     Scheduler(bool runthread, QMap<int, EncoderLink *> *tvList,
               const QString& tmptable = "record", Scheduler *master_sched = nullptr);
@@ -69,6 +71,8 @@ class Scheduler : public MThread, public MythScheduler
     { AddRecording(RecordingInfo(prog)); };
     void FillRecordListFromDB(uint recordid = 0);
     void FillRecordListFromMaster(void);
+    void DumpFixture(const QString &filename);
+    static int ReplayFixture(const QString &filename);
 
     void UpdateRecStatus(RecordingInfo *pginfo);
     void UpdateRecStatus(uint cardid, uint chanid,
@@ -127,6 +131,9 @@ class Scheduler : public MThread, public MythScheduler
         openEndAlways = 2
     };
 
+    // Only used by ReplayFixture(), never touches the database.
+    explicit Scheduler(QMap<int, EncoderLink *> *tvList);
+
     QString m_recordTable;
     QString m_priorityTable;
 
@@ -137,6 +144,9 @@ class Scheduler : public MThread, public MythScheduler
     void DeleteTempTables(void);
     void UpdateDuplicates(void);
     bool FillRecordList(void);
+    bool SaveFixture(const QString &filename) const;
+    bool LoadFixture(const QString &filename);
+    QString GetScheduleHash(void) const;
     void UpdateMatches(uint recordid, uint sourceid, uint mplexid,
                        const QDateTime &maxstarttime);
     void UpdateManuals(uint recordid);
@@ -166,15 +176,20 @@ class Scheduler : public MThread, public MythScheduler
         const;
     void MarkOtherShowings(RecordingInfo *p);
     void MarkShowingsList(const RecList &showinglist, RecordingInfo *p);
-    void BackupRecStatus(void);
-    void RestoreRecStatus(void);
+    static void BackupRecStatus(const RecList &reclist);
+    static void RestoreRecStatus(const RecList &reclist);
     bool TryAnotherShowing(RecordingInfo *p,  bool samePriority,
                            bool livetv = false);
     void SchedNewRecords(void);
+    void SchedNewLevels(RecList &reclist);
+    vector<RecList> SplitSchedComponents(RecConstIter start,
+                                         const RecConstIter &end) const;
     void SchedNewFirstPass(RecIter &start, const RecIter& end,
                            int recpriority, int recpriority2);
-    void SchedNewRetryPass(const RecIter& start, const RecIter& end,
+    void SchedNewRetryPass(const RecList &reclist,
+                           const RecIter& start, const RecIter& end,
                            bool samePriority, bool livetv = false);
+    void UpdateLiveTVTime(const QDateTime &starttime);
     void SchedLiveTV(void);
     void PruneRedundants(void);
     void UpdateNextRecord(void);
@@ -202,6 +217,9 @@ class Scheduler : public MThread, public MythScheduler
     void ResetDuplicates(uint recordid, uint findid, const QString &title,
                          const QString &subtitle, const QString &descrip,
                          const QString &programid);
+    void CoalesceMatchRequests(void);
+    bool IsGuideOnlyReschedule(void) const;
+    QString GetRecordMatchDigest(void);
     bool HandleReschedule(void);
     bool HandleRunSchedulerStartup(
         std::chrono::seconds prerollseconds, std::chrono::minutes idleWaitForRecordingTime);
@@ -249,6 +267,16 @@ class Scheduler : public MThread, public MythScheduler
     QDateTime m_schedTime;
     bool m_recListChanged              {false};
 
+    // Work list fixtures for offline placement benchmarks
+    QString     m_fixtureFile;
+    bool        m_fixtureReplay        {false};
+    QStringList m_placePhases;
+
+    // Last time every showing was placed, and how long a guide data
+    // rematch that changed nothing may keep using that placement.
+    QDateTime m_lastFullPlace;
+    static constexpr std::chrono::minutes kMaxPlaceSkipAge { 60min };
+
     bool m_specSched;
     bool m_schedulingEnabled           {true};
     QMap<int, bool> m_schedAfterStartMap;
@@ -275,6 +303,7 @@ class Scheduler : public MThread, public MythScheduler
     std::array<QSet<QString>,4> m_sysEvents;
 
     // Try to avoid LiveTV sessions until this time
+    QMutex    m_livetvTimeLock;
     QDateTime m_livetvTime;
 
     QDateTime m_lastPrepareTime;
@@ -286,6 +315,7 @@ class Scheduler : public MThread, public MythScheduler
     // cache IsSameProgram()
     using IsSameKey = std::pair<const RecordingInfo*,const RecordingInfo*>;
     using IsSameCacheType = QMap<IsSameKey,bool>;
+    mutable QMutex          m_cacheIsSameProgramLock;
     mutable IsSameCacheType m_cacheIsSameProgram;
     int m_tmLastLog                    {0};
 };
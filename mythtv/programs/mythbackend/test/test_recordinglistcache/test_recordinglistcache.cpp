@@ -0,0 +1,278 @@
+/*
+ *  Class TestRecordingListCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "test_recordinglistcache.h"
+#include "recordinglistcache.h"
+
+#include <QSemaphore>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// Stands in for the recorded table, counting how often it is loaded.
+class FakeRecorded
+{
+  public:
+    explicit FakeRecorded(uint Count)
+    {
+        for (uint i = 1; i <= Count; ++i)
+            Add(i);
+    }
+
+    void Add(uint RecordedId)
+    {
+        ProgramInfo pginfo;
+        pginfo.SetRecordingID(RecordedId);
+        pginfo.SetTitle(QString("Recording %1").arg(RecordedId));
+        pginfo.SetFilesize(1000);
+        m_recordings.push_back(pginfo);
+    }
+
+    void Load(ProgramList &List)
+    {
+        m_loads++;
+        if (m_blockLoad)
+        {
+            m_loading.release();
+            m_gate.acquire();
+        }
+        for (const auto & pginfo : m_recordings)
+            List.push_back(new ProgramInfo(pginfo));
+    }
+
+    QList<ProgramInfo> m_recordings;
+    std::atomic_int    m_loads     { 0 };
+    bool               m_blockLoad { false };
+    QSemaphore         m_loading;
+    QSemaphore         m_gate;
+};
+
+static QStringList ToStringList(const ProgramInfo &ProgInfo)
+{
+    QStringList list;
+    ProgInfo.ToStringList(list);
+    return list;
+}
+
+// Returns the generation to pass to the next GetChanges().
+static uint64_t CurrentGeneration(RecordingListCache &Cache)
+{
+    uint64_t generation = 0;
+    ProgramList changed;
+    QList<uint> deleted;
+    Cache.GetChanges(generation, changed, deleted);
+    return generation;
+}
+
+void TestRecordingListCache::test_page(void)
+{
+    FakeRecorded recorded(5);
+    RecordingListCache cache([&](ProgramList &List) { recorded.Load(List); });
+
+    ProgramList page;
+    uint total = 0;
+    uint64_t generation = cache.GetPage(false, 1, 2, page, total);
+    QCOMPARE(total, 5U);
+    QCOMPARE(page.size(), static_cast<size_t>(2));
+    QCOMPARE(page[0]->GetRecordingID(), 2U);
+    QCOMPARE(page[1]->GetRecordingID(), 3U);
+
+    // Newest first, and running off the end
+    page.clear();
+    QCOMPARE(cache.GetPage(true, 3, 10, page, total), generation);
+    QCOMPARE(page.size(), static_cast<size_t>(2));
+    QCOMPARE(page[0]->GetRecordingID(), 2U);
+    QCOMPARE(page[1]->GetRecordingID(), 1U);
+
+    QCOMPARE(recorded.m_loads.load(), 1);
+}
+
+void TestRecordingListCache::test_update(void)
+{
+    FakeRecorded recorded(3);
+    RecordingListCache cache([&](ProgramList &List) { recorded.Load(List); });
+
+    ProgramList page;
+    uint total = 0;
+    uint64_t pageGeneration = cache.GetPage(false, 0, 3, page, total);
+    uint64_t generation = CurrentGeneration(cache);
+
+    ProgramInfo updated(recorded.m_recordings[1]);
+    updated.SetTitle("Updated");
+    cache.HandleEvent("RECORDING_LIST_CHANGE UPDATE", ToStringList(updated));
+
+    // The update is applied in place, without reloading the list
+    ProgramList changed;
+    QList<uint> deleted;
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(changed.size(), static_cast<size_t>(1));
+    QCOMPARE(changed[0]->GetRecordingID(), 2U);
+    QCOMPARE(changed[0]->GetTitle(), QString("Updated"));
+    QVERIFY(deleted.isEmpty());
+
+    // Updates do not move recordings between pages
+    page.clear();
+    QCOMPARE(cache.GetPage(false, 1, 1, page, total), pageGeneration);
+    QCOMPARE(page[0]->GetTitle(), QString("Updated"));
+    QCOMPARE(recorded.m_loads.load(), 1);
+
+    // Nothing more has changed
+    changed.clear();
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QVERIFY(changed.empty());
+}
+
+void TestRecordingListCache::test_filesize(void)
+{
+    FakeRecorded recorded(3);
+    RecordingListCache cache([&](ProgramList &List) { recorded.Load(List); });
+
+    ProgramList page;
+    uint total = 0;
+    cache.GetPage(false, 0, 3, page, total);
+    uint64_t generation = CurrentGeneration(cache);
+
+    cache.HandleEvent("UPDATE_FILE_SIZE 3 5000", QStringList());
+    cache.HandleEvent("UPDATE_FILE_SIZE 3 6000", QStringList());
+
+    ProgramList changed;
+    QList<uint> deleted;
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(changed.size(), static_cast<size_t>(1));
+    QCOMPARE(changed[0]->GetRecordingID(), 3U);
+    QCOMPARE(changed[0]->GetFilesize(), static_cast<uint64_t>(6000));
+
+    // A size for a full update still to be applied is applied to it
+    ProgramInfo updated(recorded.m_recordings[0]);
+    updated.SetTitle("Updated");
+    cache.HandleEvent("RECORDING_LIST_CHANGE UPDATE", ToStringList(updated));
+    cache.HandleEvent("UPDATE_FILE_SIZE 1 7000", QStringList());
+
+    changed.clear();
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(changed.size(), static_cast<size_t>(1));
+    QCOMPARE(changed[0]->GetTitle(), QString("Updated"));
+    QCOMPARE(changed[0]->GetFilesize(), static_cast<uint64_t>(7000));
+    QCOMPARE(recorded.m_loads.load(), 1);
+}
+
+void TestRecordingListCache::test_membership(void)
+{
+    FakeRecorded recorded(3);
+    RecordingListCache cache([&](ProgramList &List) { recorded.Load(List); });
+
+    ProgramList page;
+    uint total = 0;
+    uint64_t pageGeneration = cache.GetPage(false, 0, 3, page, total);
+    uint64_t generation = CurrentGeneration(cache);
+
+    recorded.Add(4);
+    cache.HandleEvent("RECORDING_LIST_CHANGE ADD 4", QStringList());
+    recorded.m_recordings.removeFirst();
+    cache.HandleEvent("RECORDING_LIST_CHANGE DELETE 1", QStringList());
+
+    // Additions and deletions reload the list, once
+    ProgramList changed;
+    QList<uint> deleted;
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(changed.size(), static_cast<size_t>(1));
+    QCOMPARE(changed[0]->GetRecordingID(), 4U);
+    QCOMPARE(deleted, QList<uint>({ 1 }));
+    QCOMPARE(recorded.m_loads.load(), 2);
+
+    page.clear();
+    uint64_t newGeneration = cache.GetPage(false, 0, 3, page, total);
+    QVERIFY(newGeneration > pageGeneration);
+    QCOMPARE(total, 3U);
+    QCOMPARE(page[0]->GetRecordingID(), 2U);
+    QCOMPARE(recorded.m_loads.load(), 2);
+}
+
+void TestRecordingListCache::test_reload(void)
+{
+    FakeRecorded recorded(3);
+    RecordingListCache cache([&](ProgramList &List) { recorded.Load(List); });
+
+    // A generation from a previous run of the backend, before or after
+    // this one started, is unknown
+    ProgramList changed;
+    QList<uint> deleted;
+    uint64_t generation = 1;
+    QVERIFY(!cache.GetChanges(generation, changed, deleted));
+    uint64_t current = generation;
+    QVERIFY(current > 1);
+
+    generation = current + 1000;
+    QVERIFY(!cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(generation, current);
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+
+    // Forget the oldest changes once there are too many
+    for (uint i = 0; i <= RecordingListCache::kMaxChanges; ++i)
+        cache.HandleEvent("UPDATE_FILE_SIZE 2 5000", QStringList());
+    QVERIFY(!cache.GetChanges(generation, changed, deleted));
+    QVERIFY(changed.empty());
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+
+    // A change that does not name a recording may have changed them all
+    cache.HandleEvent("RECORDING_LIST_CHANGE", QStringList());
+    QVERIFY(!cache.GetChanges(generation, changed, deleted));
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(recorded.m_loads.load(), 0);
+}
+
+void TestRecordingListCache::test_updatewhileloading(void)
+{
+    FakeRecorded recorded(3);
+    RecordingListCache cache([&](ProgramList &List) { recorded.Load(List); });
+    uint64_t generation = CurrentGeneration(cache);
+
+    recorded.m_blockLoad = true;
+    auto reader = std::async(std::launch::async, [&]()
+    {
+        ProgramList page;
+        uint total = 0;
+        cache.GetPage(false, 0, 3, page, total);
+        return page[1]->GetFilesize();
+    });
+    QVERIFY(recorded.m_loading.tryAcquire(1, 5000));
+
+    // Events are not held up by the load in progress...
+    auto event = std::async(std::launch::async, [&]()
+    {
+        cache.HandleEvent("UPDATE_FILE_SIZE 2 5000", QStringList());
+    });
+    bool handled = (event.wait_for(5s) == std::future_status::ready);
+    recorded.m_gate.release();
+    QVERIFY(handled);
+
+    // ...and are applied to what it loaded
+    QCOMPARE(reader.get(), static_cast<uint64_t>(5000));
+    ProgramList changed;
+    QList<uint> deleted;
+    QVERIFY(cache.GetChanges(generation, changed, deleted));
+    QCOMPARE(changed.size(), static_cast<size_t>(1));
+    QCOMPARE(changed[0]->GetFilesize(), static_cast<uint64_t>(5000));
+    QCOMPARE(recorded.m_loads.load(), 1);
+}
+
+QTEST_APPLESS_MAIN(TestRecordingListCache)
@@ -6,12 +6,16 @@
 
 #include "programinfocache.h"
 #include "mthreadpool.h"
+#include "mythchrono.h"
+#include "mythcorecontext.h"
 #include "mythlogging.h"
+#include "mythversion.h"
 #include "programinfo.h"
 #include "remoteutil.h"
 #include "mythevent.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QRunnable>
 
 #include <algorithm>
@@ -28,6 +32,148 @@ static void free_vec(VPI_ptr &v)
     }
 }
 
+static void free_vec_contents(vector<ProgramInfo *> &v)
+{
+    for (auto & it : v)
+        delete it;
+    v.clear();
+}
+
+/** \brief The recordings as last fetched from the backend.
+ *
+ *  This is shared by every ProgramInfoCache in the frontend, so that
+ *  once the list has been loaded only the recordings changed since then
+ *  need to be fetched, using the RECLIST_DELTA_1 protocol extension.
+ */
+class RecordingSnapshot
+{
+  public:
+    ~RecordingSnapshot() { Clear(); }
+
+    VPI_ptr Fetch(void);
+
+  private:
+    bool LoadAll(void);
+    void Clear(void);
+
+    /// Recordings fetched per QUERY_RECORDINGS Page request.
+    static constexpr uint kPageSize { 1000 };
+    /// The whole list is fetched again after this long, to pick up flags
+    /// such as in use which are not reported as changes.
+    static constexpr std::chrono::milliseconds kMaxAge { 5min };
+
+    QMutex                   m_lock;
+    QHash<uint,ProgramInfo*> m_programs;
+    uint64_t                 m_generation {0};
+    bool                     m_valid      {false};
+    QElapsedTimer            m_age;
+};
+
+static RecordingSnapshot s_snapshot;
+
+/// Returns a copy of the recordings, or nullptr if they could not be
+/// fetched.
+VPI_ptr RecordingSnapshot::Fetch(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_valid && !m_age.hasExpired(kMaxAge.count()))
+    {
+        vector<ProgramInfo*> changed;
+        vector<uint> deleted;
+        if (RemoteGetRecordingChanges(m_generation, changed, deleted))
+        {
+            for (uint recordedid : deleted)
+                delete m_programs.take(recordedid);
+            for (auto *pginfo : changed)
+            {
+                delete m_programs.value(pginfo->GetRecordingID());
+                m_programs[pginfo->GetRecordingID()] = pginfo;
+            }
+            LOG(VB_GUI, LOG_DEBUG,
+                QString("RecordingSnapshot: %1 changed, %2 deleted")
+                    .arg(changed.size()).arg(deleted.size()));
+        }
+        else
+        {
+            free_vec_contents(changed);
+            m_valid = false;
+        }
+    }
+
+    if (!m_valid && !LoadAll())
+        return nullptr;
+
+    auto *list = new vector<ProgramInfo*>;
+    list->reserve(m_programs.size());
+    for (auto *pginfo : qAsConst(m_programs))
+        list->push_back(new ProgramInfo(*pginfo));
+    return list;
+}
+
+/** \brief Fetches all of the recordings a page at a time.
+ *
+ *  The pages must all come from the same generation of the backend's
+ *  list, as a recording added or deleted between pages would shift the
+ *  rest, so the load starts over if the generation changes.
+ *  \note m_lock must be held.
+ */
+bool RecordingSnapshot::LoadAll(void)
+{
+    Clear();
+
+    for (int attempt = 0; attempt < 3; ++attempt)
+    {
+        vector<ProgramInfo*> list;
+        uint64_t generation = 0;
+        uint total = 0;
+        bool ok = true;
+
+        for (uint start = 0; ok && (start == 0 || list.size() < total);
+             start += kPageSize)
+        {
+            uint64_t page_generation = 0;
+            size_t before = list.size();
+            ok = RemoteGetRecordedPage(start, kPageSize, list, total,
+                                       page_generation);
+            if (start == 0)
+                generation = page_generation;
+            else if (page_generation != generation)
+                ok = false;
+            if (list.size() == before)
+                break;
+        }
+
+        if (!ok)
+        {
+            free_vec_contents(list);
+            continue;
+        }
+
+        for (auto *pginfo : list)
+        {
+            delete m_programs.value(pginfo->GetRecordingID());
+            m_programs[pginfo->GetRecordingID()] = pginfo;
+        }
+        m_generation = generation;
+        m_valid = true;
+        m_age.start();
+        return true;
+    }
+
+    LOG(VB_GENERAL, LOG_WARNING,
+        "RecordingSnapshot: Unable to load a consistent recordings list");
+    return false;
+}
+
+/// \note m_lock must be held.
+void RecordingSnapshot::Clear(void)
+{
+    qDeleteAll(m_programs);
+    m_programs.clear();
+    m_valid = false;
+}
+
 class ProgramInfoLoader : public QRunnable
 {
   public:
@@ -73,9 +219,14 @@ void ProgramInfoCache::Load(const bool updateUI)
 
     locker.unlock();
     /**/
-    // Get an unsorted list (sort = 0) from RemoteGetRecordedList
-    // we sort the list later anyway.
-    vector<ProgramInfo*> *tmp = RemoteGetRecordedList(0);
+    // Only fetch what has changed since the last load if the backend
+    // supports it, otherwise get an unsorted list (sort = 0) from
+    // RemoteGetRecordedList, we sort the list later anyway.
+    vector<ProgramInfo*> *tmp = nullptr;
+    if (gCoreContext->HasProtoExtension(MYTH_PROTO_RECLIST_DELTA))
+        tmp = s_snapshot.Fetch();
+    if (!tmp)
+        tmp = RemoteGetRecordedList(0);
     /**/
     locker.relock();
 
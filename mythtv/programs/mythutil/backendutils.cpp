@@ -1,13 +1,23 @@
 
 // C++ includes
+#include <algorithm>
+#include <deque>
 #include <iostream> // for cout
+#include <vector>
 using std::cout;
 using std::endl;
 
+// Qt includes
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTcpSocket>
+#include <QTimer>
+
 // libmythbase
 #include "exitcodes.h"
 #include "mythcorecontext.h"
 #include "mythlogging.h"
+#include "mythversion.h"
 
 // libmyth
 #include "remoteutil.h"
@@ -104,6 +114,360 @@ static int ParseVideoFilename(const MythUtilCommandLineParser &cmdline)
     return GENERIC_EXIT_OK;
 }
 
+/// One of the clients simulated by ProtocolLoadTest().
+struct LoadTestSession
+{
+    enum State { kVersion, kAnnounce, kRequests };
+
+    QTcpSocket    *m_socket {nullptr};
+    QByteArray     m_buffer;
+    State          m_state  {kVersion};
+    QElapsedTimer  m_sent;
+};
+
+static QByteArray to_frame(const QStringList &list)
+{
+    QByteArray utf8 = list.join("[]:[]").toUtf8();
+    return QByteArray::number(utf8.size()).leftJustified(8, ' ') + utf8;
+}
+
+/// Takes a string list off the front of \p buffer, if all of it is there.
+/// \return 0 if not, -1 if the buffer does not start with a valid size.
+static int take_frame(QByteArray &buffer, QStringList &list)
+{
+    if (buffer.size() < 8)
+        return 0;
+    int size = buffer.left(8).trimmed().toInt();
+    if (size < 1)
+        return -1;
+    if (buffer.size() < 8 + size)
+        return 0;
+    list = QString::fromUtf8(buffer.mid(8, size)).split("[]:[]");
+    buffer.remove(0, 8 + size);
+    return 1;
+}
+
+/// Prints the request rate and the spread of \p latencies.
+/// \return false if there were no requests.
+static bool print_latencies(std::vector<qint64> &latencies,
+                            std::chrono::seconds duration)
+{
+    cout << "Requests:   " << latencies.size() << ", "
+         << latencies.size() / duration.count() << "/s" << endl;
+
+    if (latencies.empty())
+        return false;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](int p)
+        { return latencies[(latencies.size() - 1) * p / 100]; };
+    cout << "Latency us: 50% " << percentile(50) << ", 90% " << percentile(90)
+         << ", 99% " << percentile(99) << ", max " << latencies.back() << endl;
+    return true;
+}
+
+/** \brief Simulates many clients sending requests to the master backend.
+ *
+ *  Each session connects, checks the protocol version and announces
+ *  itself as a monitor, then sends the request and waits for the reply
+ *  over and over until the time is up.  All sessions are run from one
+ *  thread so that hundreds of them do not need hundreds of threads.
+ */
+static int ProtocolLoadTest(const MythUtilCommandLineParser &cmdline)
+{
+    static constexpr int kConnectBatch { 50 };
+
+    int count = std::max(1, cmdline.toInt("sessions"));
+    std::chrono::seconds duration { std::max(1, cmdline.toInt("duration")) };
+    QStringList request(cmdline.toString("request"));
+    QString host = gCoreContext->GetMasterServerIP();
+    int port = MythCoreContext::GetMasterServerPort();
+
+    QStringList version(QString("MYTH_PROTO_VERSION %1 %2")
+                        .arg(MYTH_PROTO_VERSION).arg(MYTH_PROTO_TOKEN));
+    QStringList announce(QString("ANN Monitor %1_loadtest 0")
+                         .arg(gCoreContext->GetHostName()));
+
+    std::vector<LoadTestSession> sessions(count);
+    std::vector<qint64> latencies; // in microseconds
+    int announced = 0;
+    int failed = 0;
+
+    auto send = [](LoadTestSession &session, const QStringList &list)
+    {
+        session.m_sent.start();
+        session.m_socket->write(to_frame(list));
+    };
+
+    auto fail = [&failed](LoadTestSession &session, const QString &why)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Load test session failed: %1")
+            .arg(why));
+        session.m_socket->disconnect();
+        session.m_socket->abort();
+        failed++;
+    };
+
+    auto received = [&](LoadTestSession &session)
+    {
+        session.m_buffer += session.m_socket->readAll();
+
+        QStringList reply;
+        int ret = 0;
+        while ((ret = take_frame(session.m_buffer, reply)) > 0)
+        {
+            switch (session.m_state)
+            {
+                case LoadTestSession::kVersion:
+                    if (reply[0] != "ACCEPT")
+                        return fail(session, "version rejected");
+                    session.m_state = LoadTestSession::kAnnounce;
+                    send(session, announce);
+                    break;
+                case LoadTestSession::kAnnounce:
+                    if (reply[0] != "OK")
+                        return fail(session, "announce rejected");
+                    session.m_state = LoadTestSession::kRequests;
+                    announced++;
+                    send(session, request);
+                    break;
+                case LoadTestSession::kRequests:
+                    latencies.push_back(session.m_sent.nsecsElapsed() / 1000);
+                    send(session, request);
+                    break;
+            }
+        }
+        if (ret < 0)
+            fail(session, "bad reply size");
+    };
+
+    QEventLoop loop;
+    for (int i = 0; i < count; ++i)
+    {
+        LoadTestSession &session = sessions[i];
+        session.m_socket = new QTcpSocket();
+        QObject::connect(session.m_socket, &QTcpSocket::connected,
+                         [&session, &send, &version]()
+                         { send(session, version); });
+        QObject::connect(session.m_socket, &QIODevice::readyRead,
+                         [&session, &received]() { received(session); });
+#if QT_VERSION < QT_VERSION_CHECK(5,15,0)
+        QObject::connect(session.m_socket,
+                         qOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error),
+#else
+        QObject::connect(session.m_socket, &QAbstractSocket::errorOccurred,
+#endif
+                         [&session, &fail]()
+                         { fail(session, session.m_socket->errorString()); });
+
+        // Connect a batch at a time, so as not to overflow the backend's
+        // listen queue.
+        QTimer::singleShot((i / kConnectBatch) * 100ms, &loop,
+                           [&session, &host, port]()
+                           { session.m_socket->connectToHost(host, port); });
+    }
+
+    cout << "Running " << count << " sessions sending '"
+         << qPrintable(request.join(" ")) << "' to " << qPrintable(host)
+         << ":" << port << " for " << duration.count() << " seconds" << endl;
+
+    QTimer::singleShot(duration, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    for (auto &session : sessions)
+    {
+        session.m_socket->disconnect();
+        if (session.m_socket->state() == QAbstractSocket::ConnectedState)
+        {
+            session.m_socket->write(to_frame(QStringList("DONE")));
+            session.m_socket->disconnectFromHost();
+        }
+    }
+    for (auto &session : sessions)
+    {
+        if (session.m_socket->state() != QAbstractSocket::UnconnectedState)
+            session.m_socket->waitForDisconnected(1000);
+        delete session.m_socket;
+    }
+
+    cout << "Sessions:   " << announced << " announced, "
+         << failed << " failed" << endl;
+
+    if (!print_latencies(latencies, duration))
+        return GENERIC_EXIT_CONNECT_ERROR;
+
+    return (failed == 0) ? GENERIC_EXIT_OK : GENERIC_EXIT_CONNECT_ERROR;
+}
+
+/// One of the clients simulated by HttpLoadTest().
+struct HttpLoadTestSession
+{
+    QTcpSocket               *m_socket {nullptr};
+    QByteArray                m_buffer;
+    std::deque<QElapsedTimer> m_sent;   ///< One per request awaiting a reply
+    int                       m_next   {0};
+};
+
+/** \brief Takes an HTTP response off the front of \p buffer, if all of
+ *         it is there.
+ *  \return the response's status code, 0 if it is incomplete, or -1 if it
+ *          cannot be parsed or has no Content-Length.
+ */
+static int take_response(QByteArray &buffer)
+{
+    int end = buffer.indexOf("\r\n\r\n");
+    if (end < 0)
+        return 0;
+
+    QList<QByteArray> lines = buffer.left(end).split('\n');
+    QList<QByteArray> status = lines[0].split(' ');
+    if (status.size() < 2 || !status[0].startsWith("HTTP/"))
+        return -1;
+
+    int length = -1;
+    for (const auto &line : qAsConst(lines))
+    {
+        int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length")
+            length = line.mid(colon + 1).trimmed().toInt();
+    }
+    if (length < 0)
+        return -1;
+    if (buffer.size() < end + 4 + length)
+        return 0;
+
+    buffer.remove(0, end + 4 + length);
+    return status[1].toInt();
+}
+
+/** \brief Simulates many clients polling the master backend's services API.
+ *
+ *  Each session opens one keep-alive connection and keeps \p pipeline
+ *  requests outstanding on it, sending the next as each reply arrives and
+ *  cycling through the URLs given, like wrk does.  All sessions are run
+ *  from one thread.
+ *
+ *  The backend answers from whatever database it is configured with.
+ *  There is no built in stand-in, so to keep a production database out
+ *  of it, point MYTHCONFDIR at a config.xml for a copy of it.
+ */
+static int HttpLoadTest(const MythUtilCommandLineParser &cmdline)
+{
+    static constexpr int kConnectBatch { 50 };
+
+    int count = std::max(1, cmdline.toInt("sessions"));
+    std::chrono::seconds duration { std::max(1, cmdline.toInt("duration")) };
+    int pipeline = std::max(1, cmdline.toInt("pipeline"));
+    QStringList urls = cmdline.toString("urls").split(',');
+    QString host = gCoreContext->GetMasterServerIP();
+    int port = gCoreContext->GetMasterServerStatusPort();
+
+    std::vector<QByteArray> requests;
+    for (const auto &url : qAsConst(urls))
+    {
+        requests.push_back(QString("GET %1 HTTP/1.1\r\n"
+                                   "Host: %2:%3\r\n"
+                                   "Accept: application/json\r\n"
+                                   "\r\n")
+                           .arg(url.trimmed(), host).arg(port).toLatin1());
+    }
+
+    std::vector<HttpLoadTestSession> sessions(count);
+    std::vector<qint64> latencies; // in microseconds
+    int connected = 0;
+    int errors = 0;
+    int failed = 0;
+
+    auto send = [&requests](HttpLoadTestSession &session)
+    {
+        session.m_sent.emplace_back();
+        session.m_sent.back().start();
+        session.m_socket->write(requests[session.m_next]);
+        session.m_next = (session.m_next + 1) % requests.size();
+    };
+
+    auto fail = [&failed](HttpLoadTestSession &session, const QString &why)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Load test session failed: %1")
+            .arg(why));
+        session.m_socket->disconnect();
+        session.m_socket->abort();
+        failed++;
+    };
+
+    auto received = [&](HttpLoadTestSession &session)
+    {
+        session.m_buffer += session.m_socket->readAll();
+
+        int status = 0;
+        while ((status = take_response(session.m_buffer)) > 0)
+        {
+            if (session.m_sent.empty())
+                return fail(session, "unexpected response");
+            latencies.push_back(session.m_sent.front().nsecsElapsed() / 1000);
+            session.m_sent.pop_front();
+            if (status != 200)
+                errors++;
+            send(session);
+        }
+        if (status < 0)
+            fail(session, "bad response");
+    };
+
+    QEventLoop loop;
+    for (int i = 0; i < count; ++i)
+    {
+        HttpLoadTestSession &session = sessions[i];
+        session.m_socket = new QTcpSocket();
+        session.m_next = i % requests.size();
+        QObject::connect(session.m_socket, &QTcpSocket::connected,
+                         [&session, &send, &connected, pipeline]()
+                         {
+                             connected++;
+                             for (int j = 0; j < pipeline; ++j)
+                                 send(session);
+                         });
+        QObject::connect(session.m_socket, &QIODevice::readyRead,
+                         [&session, &received]() { received(session); });
+#if QT_VERSION < QT_VERSION_CHECK(5,15,0)
+        QObject::connect(session.m_socket,
+                         qOverload<QAbstractSocket::SocketError>(&QAbstractSocket::error),
+#else
+        QObject::connect(session.m_socket, &QAbstractSocket::errorOccurred,
+#endif
+                         [&session, &fail]()
+                         { fail(session, session.m_socket->errorString()); });
+
+        QTimer::singleShot((i / kConnectBatch) * 100ms, &loop,
+                           [&session, &host, port]()
+                           { session.m_socket->connectToHost(host, port); });
+    }
+
+    cout << "Running " << count << " sessions with " << pipeline
+         << " requests in flight against http://" << qPrintable(host) << ":"
+         << port << " for " << duration.count() << " seconds" << endl;
+
+    QTimer::singleShot(duration, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    for (auto &session : sessions)
+    {
+        session.m_socket->disconnect();
+        session.m_socket->abort();
+        delete session.m_socket;
+    }
+
+    cout << "Sessions:   " << connected << " connected, "
+         << failed << " failed" << endl;
+    cout << "Errors:     " << errors << " non-200 responses" << endl;
+
+    if (!print_latencies(latencies, duration))
+        return GENERIC_EXIT_CONNECT_ERROR;
+
+    return (failed == 0 && errors == 0) ? GENERIC_EXIT_OK
+                                        : GENERIC_EXIT_CONNECT_ERROR;
+}
+
 void registerBackendUtils(UtilMap &utilMap)
 {
     utilMap["clearcache"]           = &ClearSettingsCache;
@@ -112,6 +476,8 @@ void registerBackendUtils(UtilMap &utilMap)
     utilMap["scanvideos"]           = &ScanVideos;
     utilMap["systemevent"]          = &SendSystemEvent;
     utilMap["parsevideo"]           = &ParseVideoFilename;
+    utilMap["protoloadtest"]        = &ProtocolLoadTest;
+    utilMap["httploadtest"]         = &HttpLoadTest;
 }
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -125,6 +125,22 @@ void MythUtilCommandLineParser::LoadArguments(void)
                 "Diagnostic tool for testing filename formats against what "
                 "the Video Library name parser will detect them as.")
                 ->SetGroup("Backend")
+        << add("--protoloadtest", "protoloadtest", false,
+                "Load test the master backend's protocol server.",
+                "This command opens many connections to the master backend "
+                "and sends a request on each as fast as the backend answers, "
+                "then prints the request rate and reply latencies.")
+                ->SetGroup("Backend")
+        << add("--httploadtest", "httploadtest", false,
+                "Load test the master backend's services API.",
+                "This command opens many keep-alive connections to the "
+                "master backend's HTTP server and sends GET requests on "
+                "each as fast as they are answered, then prints the request "
+                "rate and response latencies. The requests are answered from "
+                "the backend's own database; to test against a copy, run the "
+                "backend and this command with MYTHCONFDIR set to a directory "
+                "whose config.xml names the copy.")
+                ->SetGroup("Backend")
 
         // jobutils.cpp
         << add("--queuejob", "queuejob", "",
@@ -275,6 +291,22 @@ void MythUtilCommandLineParser::LoadArguments(void)
     add("--fixseektable", "fixseektable", false, "(optional) fix the seektable if missing for a recording", "")
         ->SetChildOf("checkrecordings");
 
+    // backendutils.cpp
+    add("--sessions", "sessions", 200, "(optional) number of connections to open", "")
+        ->SetChildOf("protoloadtest")
+        ->SetChildOf("httploadtest");
+    add("--duration", "duration", 30, "(optional) seconds to run for", "")
+        ->SetChildOf("protoloadtest")
+        ->SetChildOf("httploadtest");
+    add("--request", "request", "QUERY_RECORDINGS Unsorted", "(optional) request to send", "")
+        ->SetChildOf("protoloadtest");
+    add("--urls", "urls",
+        "/Dvr/GetRecordedList?Count=50,/Capture/GetCaptureCardList,/Status/xml",
+        "(optional) comma separated paths to request in turn", "")
+        ->SetChildOf("httploadtest");
+    add("--pipeline", "pipeline", 1, "(optional) requests to keep in flight on each connection", "")
+        ->SetChildOf("httploadtest");
+
     // eitutils.cpp
     add("--sourceid", "sourceid", -1, "(optional) specify sourceid of video source to operate on instead of all", "")
         ->SetChildOf("cleareit");
@@ -22,3 +22,16 @@ using_backend {
 }
 
 using_mythtranscode: SUBDIRS += mythtranscode
+
+# unit tests mythbackend
+using_backend {
+    mythbackend-test.depends = sub-mythbackend
+    mythbackend-test.target = buildtestmythbackend
+    mythbackend-test.commands = cd mythbackend/test && $(QMAKE) && $(MAKE)
+    unix:QMAKE_EXTRA_TARGETS += mythbackend-test
+    unittest.depends = mythbackend-test
+}
+
+unittest.target = test
+unittest.commands = scripts/unittests.sh
+unix:QMAKE_EXTRA_TARGETS += unittest
@@ -757,6 +757,7 @@ void strings_null() {
     ThemeUI::tr("Delete Your Hardware Profile");
     ThemeUI::tr("Delete system Profile");
     ThemeUI::tr("Delete your hardware profile");
+    ThemeUI::tr("Demux queue :");
     ThemeUI::tr("Description");
     ThemeUI::tr("Description:");
     ThemeUI::tr("Description: %DESCRIPTION%\nErrata: %ERRATA%");
@@ -943,6 +944,7 @@ void strings_null() {
     ThemeUI::tr("Frame %1");
     ThemeUI::tr("Frame Number");
     ThemeUI::tr("Frame audio level +/-0.5");
+    ThemeUI::tr("Frame pool :");
     ThemeUI::tr("Frame: %framedisplay%  |  %cutindicator%");
     ThemeUI::tr("Frames decoded /free");
     ThemeUI::tr("Frames decoded/free :");